@@ -0,0 +1,200 @@
+#include "Centrality.hpp"
+#include "../utils/Parallel.hpp"
+#include <algorithm>
+#include <random>
+
+namespace netsim {
+namespace analysis {
+
+namespace {
+
+// Per-thread Brandes state: accumulators plus BFS scratch arrays
+struct BrandesWorker {
+    std::vector<double> betweenness;
+    std::vector<uint64_t> distSum;
+    std::vector<uint32_t> reached;
+    std::vector<int32_t> dist;
+    std::vector<double> sigma;
+    std::vector<double> delta;
+    std::vector<NodeId> order;
+
+    explicit BrandesWorker(size_t n)
+        : betweenness(n, 0.0), distSum(n, 0), reached(n, 0),
+          dist(n, -1), sigma(n, 0.0), delta(n, 0.0) {
+        order.reserve(n);
+    }
+
+    void expand(const GraphSnapshot& g, NodeId s) {
+        order.clear();
+        order.push_back(s);
+        dist[s] = 0;
+        sigma[s] = 1.0;
+        for (size_t head = 0; head < order.size(); ++head) {
+            NodeId v = order[head];
+            for (uint32_t a = g.offsets[v]; a < g.offsets[v + 1]; ++a) {
+                NodeId w = g.targets[a];
+                if (!g.isUsable(w)) continue;
+                if (dist[w] < 0) {
+                    dist[w] = dist[v] + 1;
+                    order.push_back(w);
+                }
+                if (dist[w] == dist[v] + 1) sigma[w] += sigma[v];
+            }
+        }
+        // Akumulacja zależności w odwrotnej kolejności BFS (poprzednicy: dist o 1 mniejszy)
+        for (size_t i = order.size(); i-- > 0;) {
+            NodeId w = order[i];
+            for (uint32_t a = g.offsets[w]; a < g.offsets[w + 1]; ++a) {
+                NodeId v = g.targets[a];
+                if (dist[v] >= 0 && dist[v] == dist[w] - 1)
+                    delta[v] += sigma[v] / sigma[w] * (1.0 + delta[w]);
+            }
+            if (w != s) betweenness[w] += delta[w];
+            distSum[w] += static_cast<uint64_t>(dist[w]);
+            reached[w]++;
+        }
+        for (NodeId w : order) {
+            dist[w] = -1;
+            sigma[w] = 0.0;
+            delta[w] = 0.0;
+        }
+    }
+};
+
+} // namespace
+
+std::vector<NodeId> CentralityReport::topByBetweenness(size_t count) const {
+    std::vector<NodeId> ranked = nodes;
+    count = std::min(count, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+        [this](NodeId a, NodeId b) {
+            return betweenness[a] != betweenness[b] ? betweenness[a] > betweenness[b] : a < b;
+        });
+    ranked.resize(count);
+    return ranked;
+}
+
+Centrality::Centrality(const GraphSnapshot& graph) : m_graph(graph) {
+}
+
+CentralityReport Centrality::compute(const CentralityOptions& options) const {
+    const size_t n = m_graph.nodeCount();
+    CentralityReport report;
+    for (NodeId u = 0; u < n; ++u)
+        if (m_graph.isUsable(u)) report.nodes.push_back(u);
+    const size_t usable = report.nodes.size();
+
+    std::vector<NodeId> sources = report.nodes;
+    if (options.sampleSources > 0 && options.sampleSources < usable) {
+        std::mt19937_64 gen(options.seed);
+        for (size_t i = 0; i < options.sampleSources; ++i) {
+            std::uniform_int_distribution<size_t> pick(i, sources.size() - 1);
+            std::swap(sources[i], sources[pick(gen)]);
+        }
+        sources.resize(options.sampleSources);
+        report.approximate = true;
+    }
+    report.sourcesUsed = sources.size();
+
+    unsigned workers = options.threads ? options.threads : utils::defaultWorkerCount();
+    workers = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(workers, sources.size())));
+    std::vector<BrandesWorker> state;
+    state.reserve(workers);
+    for (unsigned w = 0; w < workers; ++w) state.emplace_back(n);
+
+    utils::parallelFor(sources.size(), workers, [&](unsigned worker, size_t i) {
+        state[worker].expand(m_graph, sources[i]);
+    }, 4);
+
+    // Zsumuj akumulatory wątków
+    report.betweenness.assign(n, 0.0);
+    std::vector<uint64_t> distSum(n, 0);
+    std::vector<uint64_t> reached(n, 0);
+    for (const auto& w : state) {
+        for (size_t v = 0; v < n; ++v) {
+            report.betweenness[v] += w.betweenness[v];
+            distSum[v] += w.distSum[v];
+            reached[v] += w.reached[v];
+        }
+    }
+
+    const double scale = sources.empty() ? 0.0 : static_cast<double>(usable) / sources.size();
+    double norm = 0.5 * scale; // graf nieskierowany: każda para liczona dwa razy
+    if (options.normalized && usable > 2)
+        norm /= (usable - 1.0) * (usable - 2.0) / 2.0;
+    for (double& b : report.betweenness) b *= norm;
+
+    report.closeness.assign(n, 0.0);
+    for (NodeId v : report.nodes) {
+        double component = reached[v] * scale;     // szacowany rozmiar składowej
+        double total = distSum[v] * scale;         // szacowana suma odległości
+        if (total <= 0.0 || component <= 1.0) continue;
+        double c = (component - 1.0) / total;
+        if (options.normalized && usable > 1) c *= (component - 1.0) / (usable - 1.0);
+        report.closeness[v] = c;
+    }
+
+    report.degreeDistribution = degreeDistribution();
+    cutVerticesAndBridges(report.articulationPoints, report.bridges);
+    return report;
+}
+
+std::map<uint32_t, size_t> Centrality::degreeDistribution() const {
+    std::map<uint32_t, size_t> distribution;
+    for (NodeId u = 0; u < m_graph.nodeCount(); ++u) {
+        if (!m_graph.isUsable(u)) continue;
+        uint32_t degree = 0;
+        for (uint32_t a = m_graph.offsets[u]; a < m_graph.offsets[u + 1]; ++a)
+            if (m_graph.isUsable(m_graph.targets[a])) degree++;
+        distribution[degree]++;
+    }
+    return distribution;
+}
+
+void Centrality::cutVerticesAndBridges(std::vector<NodeId>& articulationPoints,
+                                       std::vector<std::pair<NodeId, NodeId>>& bridges) const {
+    const size_t n = m_graph.nodeCount();
+    std::vector<int64_t> disc(n, -1), low(n, 0);
+    std::vector<uint8_t> isCut(n, 0);
+    struct Frame { NodeId u; NodeId parent; uint32_t next; };
+    std::vector<Frame> stack;
+    int64_t timer = 0;
+
+    articulationPoints.clear();
+    bridges.clear();
+    for (NodeId root = 0; root < n; ++root) {
+        if (!m_graph.isUsable(root) || disc[root] >= 0) continue;
+        disc[root] = low[root] = timer++;
+        stack.push_back({root, GraphSnapshot::InvalidNode, m_graph.offsets[root]});
+        uint32_t rootChildren = 0;
+
+        while (!stack.empty()) {
+            Frame& f = stack.back();
+            if (f.next < m_graph.offsets[f.u + 1]) {
+                NodeId v = m_graph.targets[f.next++];
+                if (!m_graph.isUsable(v) || v == f.parent) continue;
+                if (disc[v] < 0) {
+                    disc[v] = low[v] = timer++;
+                    if (f.u == root) rootChildren++;
+                    stack.push_back({v, f.u, m_graph.offsets[v]});
+                } else {
+                    low[f.u] = std::min(low[f.u], disc[v]);
+                }
+            } else {
+                NodeId u = f.u;
+                stack.pop_back();
+                if (stack.empty()) break;
+                NodeId p = stack.back().u;
+                low[p] = std::min(low[p], low[u]);
+                if (p != root && low[u] >= disc[p]) isCut[p] = 1;
+                if (low[u] > disc[p]) bridges.emplace_back(p, u);
+            }
+        }
+        if (rootChildren > 1) isCut[root] = 1;
+    }
+    for (NodeId u = 0; u < n; ++u)
+        if (isCut[u]) articulationPoints.push_back(u);
+}
+
+} // namespace analysis
+} // namespace netsim
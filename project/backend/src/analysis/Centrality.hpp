@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../core/GraphSnapshot.hpp"
+#include <map>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace netsim {
+namespace analysis {
+
+/**
+ * @brief Options for centrality / bottleneck analytics
+ */
+struct CentralityOptions {
+    size_t sampleSources = 0;  // 0 = exact (all sources), otherwise sampled approximation
+    unsigned threads = 0;      // 0 = hardware_concurrency
+    uint64_t seed = 1;         // source sampling seed (deterministic results)
+    bool normalized = true;
+};
+
+/**
+ * @brief Centrality and structural bottleneck report (vectors indexed by NodeId)
+ */
+struct CentralityReport {
+    std::vector<NodeId> nodes;                      // analizowane (sprawne) węzły
+    std::vector<double> betweenness;
+    std::vector<double> closeness;                  // Wasserman-Faust closeness
+    std::map<uint32_t, size_t> degreeDistribution;  // stopień -> liczba węzłów
+    std::vector<NodeId> articulationPoints;
+    std::vector<std::pair<NodeId, NodeId>> bridges;
+    size_t sourcesUsed = 0;
+    bool approximate = false;
+
+    // Węzły o największym betweenness (malejąco)
+    std::vector<NodeId> topByBetweenness(size_t count) const;
+};
+
+/**
+ * @brief Chokepoint analytics over a GraphSnapshot (hop-count paths)
+ *
+ * Betweenness uses Brandes' algorithm with one BFS per source; sources are
+ * spread over worker threads and every worker accumulates dependencies into
+ * its own arrays, which are summed at the end. In sampled mode only
+ * sampleSources random sources are expanded and the scores are scaled by
+ * n/k; closeness is then estimated from the same sampled distances
+ * (distances are symmetric in the undirected graph). Failed nodes are
+ * treated as absent.
+ */
+class Centrality {
+public:
+    explicit Centrality(const GraphSnapshot& graph);
+
+    CentralityReport compute(const CentralityOptions& options = CentralityOptions()) const;
+
+    std::map<uint32_t, size_t> degreeDistribution() const;
+    // Punkty artykulacji i mosty (iteracyjny Tarjan, bez rekurencji)
+    void cutVerticesAndBridges(std::vector<NodeId>& articulationPoints,
+                               std::vector<std::pair<NodeId, NodeId>>& bridges) const;
+
+private:
+    const GraphSnapshot& m_graph;
+};
+
+} // namespace analysis
+} // namespace netsim
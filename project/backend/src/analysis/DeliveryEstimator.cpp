@@ -0,0 +1,165 @@
+#include "DeliveryEstimator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+
+namespace netsim {
+namespace analysis {
+
+namespace {
+
+constexpr size_t Lanes = 64;
+
+inline uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Kwantyl rozkładu normalnego (aproksymacja Acklama, błąd względny < 1.2e-9)
+double normalQuantile(double p) {
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    const double low = 0.02425;
+    if (p < low) {
+        double q = std::sqrt(-2 * std::log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+    if (p > 1 - low) return -normalQuantile(1 - p);
+    double q = p - 0.5, r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+} // namespace
+
+DeliveryEstimator::DeliveryEstimator(const GraphSnapshot& graph) : m_graph(graph) {
+}
+
+std::vector<NodeId> DeliveryEstimator::path(NodeId src, NodeId dst) const {
+    const size_t n = m_graph.nodeCount();
+    if (src >= n || dst >= n || !m_graph.present[src] || !m_graph.present[dst])
+        throw std::runtime_error("Unknown node id");
+    std::vector<NodeId> result;
+    if (!m_graph.isUsable(src) || !m_graph.isUsable(dst)) return result;
+
+    // Dijkstra: klucz = (opóźnienie, liczba hopów) jak w PacketSimulator
+    std::vector<uint64_t> dist(n, UINT64_MAX);
+    std::vector<NodeId> parent(n, GraphSnapshot::InvalidNode);
+    using Entry = std::pair<uint64_t, NodeId>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    dist[src] = 0;
+    heap.push({0, src});
+    while (!heap.empty()) {
+        auto [d, u] = heap.top();
+        heap.pop();
+        if (d > dist[u]) continue;
+        if (u == dst) break;
+        for (uint32_t a = m_graph.offsets[u]; a < m_graph.offsets[u + 1]; ++a) {
+            NodeId v = m_graph.targets[a];
+            if (!m_graph.isUsable(v)) continue;
+            uint64_t nd = d + (static_cast<uint64_t>(std::max(m_graph.delayMs[a], 0)) << 20) + 1;
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                parent[v] = u;
+                heap.push({nd, v});
+            }
+        }
+    }
+    if (dist[dst] == UINT64_MAX) return result;
+    for (NodeId v = dst; v != src; v = parent[v]) result.push_back(v);
+    result.push_back(src);
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+DeliveryEstimate DeliveryEstimator::estimate(NodeId src, NodeId dst, uint64_t count,
+                                             const DeliveryEstimateOptions& options) const {
+    if (options.confidence <= 0.0 || options.confidence >= 1.0)
+        throw std::runtime_error("Confidence must be in (0, 1)");
+
+    DeliveryEstimate est;
+    est.sent = count;
+    est.path = path(src, dst);
+    est.reachable = !est.path.empty();
+    const size_t hops = est.reachable ? est.path.size() - 1 : 0;
+    est.droppedPerHop.assign(hops, 0);
+
+    std::vector<double> loss(hops);
+    est.pathSurvival = est.reachable ? 1.0 : 0.0;
+    for (size_t h = 0; h < hops; ++h) {
+        uint32_t arc = m_graph.findArc(est.path[h], est.path[h + 1]);
+        loss[h] = std::min(std::max(m_graph.loss[arc], 0.0), 1.0);
+        est.pathSurvival *= 1.0 - loss[h];
+    }
+
+    if (!est.reachable) {
+        est.delivered = 0;
+    } else if (count <= options.perPacketSampleLimit) {
+        est.perPacket = true;
+        // Pakiet ginie gdy draw < loss * 2^64 (loss == 1 obsłużone osobno)
+        std::vector<uint64_t> threshold(hops);
+        for (size_t h = 0; h < hops; ++h)
+            threshold[h] = loss[h] >= 1.0 ? UINT64_MAX : static_cast<uint64_t>(std::min(std::ldexp(loss[h], 64), 0x1.fffffffffffffp63));
+
+        uint64_t draws[Lanes];
+        const uint64_t batches = (count + Lanes - 1) / Lanes;
+        for (uint64_t batch = 0; batch < batches; ++batch) {
+            uint64_t lanes = std::min<uint64_t>(Lanes, count - batch * Lanes);
+            uint64_t alive = lanes == Lanes ? ~uint64_t(0) : (uint64_t(1) << lanes) - 1;
+            for (size_t h = 0; h < hops && alive; ++h) {
+                if (threshold[h] == 0) continue;
+                uint64_t lost = alive;
+                if (loss[h] < 1.0) {
+                    uint64_t base = options.seed + (batch * hops + h) * Lanes * 0x9e3779b97f4a7c15ull;
+                    for (size_t k = 0; k < Lanes; ++k) draws[k] = mix(base + k * 0x9e3779b97f4a7c15ull);
+                    lost = 0;
+                    for (size_t k = 0; k < Lanes; ++k) lost |= static_cast<uint64_t>(draws[k] < threshold[h]) << k;
+                    lost &= alive;
+                }
+                est.droppedPerHop[h] += __builtin_popcountll(lost);
+                alive &= ~lost;
+            }
+            est.delivered += __builtin_popcountll(alive);
+        }
+    } else {
+        // Przerzedzanie dwumianowe: ocalali z hopu h ~ Bin(ocalali z h-1, 1 - loss[h])
+        std::mt19937_64 gen(options.seed);
+        uint64_t survivors = count;
+        for (size_t h = 0; h < hops && survivors > 0; ++h) {
+            if (loss[h] <= 0.0) continue;
+            uint64_t next = loss[h] >= 1.0 ? 0 : std::binomial_distribution<uint64_t>(survivors, 1.0 - loss[h])(gen);
+            est.droppedPerHop[h] = survivors - next;
+            survivors = next;
+        }
+        est.delivered = survivors;
+    }
+
+    est.deliveryRate = count ? static_cast<double>(est.delivered) / count : 0.0;
+    std::tie(est.confidenceLow, est.confidenceHigh) = wilsonInterval(est.delivered, count, options.confidence);
+    return est;
+}
+
+std::pair<double, double> DeliveryEstimator::wilsonInterval(uint64_t successes, uint64_t trials, double confidence) {
+    if (trials == 0) return {0.0, 1.0};
+    double z = normalQuantile(0.5 + confidence / 2);
+    double n = static_cast<double>(trials);
+    double p = successes / n;
+    double denom = 1 + z * z / n;
+    double center = (p + z * z / (2 * n)) / denom;
+    double half = z * std::sqrt(p * (1 - p) / n + z * z / (4 * n * n)) / denom;
+    return {std::max(0.0, center - half), std::min(1.0, center + half)};
+}
+
+} // namespace analysis
+} // namespace netsim
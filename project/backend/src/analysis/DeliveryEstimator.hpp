@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../core/GraphSnapshot.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace netsim {
+namespace analysis {
+
+struct DeliveryEstimateOptions {
+    uint64_t seed = 1;
+    double confidence = 0.95;                 // poziom przedziału ufności (Wilson)
+    uint64_t perPacketSampleLimit = 1 << 20;  // powyżej: losowanie dwumianowe na hop
+};
+
+/**
+ * @brief Monte Carlo delivery estimate for count packets along one path
+ */
+struct DeliveryEstimate {
+    bool reachable = false;
+    std::vector<NodeId> path;                 // src .. dst
+    double pathSurvival = 0.0;                // analitycznie: prod(1 - loss)
+    uint64_t sent = 0;
+    uint64_t delivered = 0;
+    std::vector<uint64_t> droppedPerHop;      // hop i = łącze path[i] -> path[i+1]
+    double deliveryRate = 0.0;
+    double confidenceLow = 0.0;
+    double confidenceHigh = 0.0;
+    bool perPacket = false;                   // true = każdy pakiet losowany osobno
+};
+
+/**
+ * @brief Statistical delivery engine over link packetLoss
+ *
+ * Packets follow the shortest-delay path (as in PacketSimulator). Up to
+ * perPacketSampleLimit packets are sampled individually, 64 at a time: the
+ * survivors of a batch are a bitmask and every hop draws 64 counter-based
+ * random numbers (no loop-carried RNG state, so the loop vectorizes) and
+ * clears the bits of lost packets. Larger counts thin the packet count hop
+ * by hop with binomial draws, which has the same distribution and costs
+ * O(hops) regardless of count. The delivery rate comes with a Wilson score
+ * interval.
+ */
+class DeliveryEstimator {
+public:
+    explicit DeliveryEstimator(const GraphSnapshot& graph);
+
+    DeliveryEstimate estimate(NodeId src, NodeId dst, uint64_t count,
+                              const DeliveryEstimateOptions& options = DeliveryEstimateOptions()) const;
+
+    // Najkrótsza (wg opóźnienia) ścieżka po sprawnych węzłach; pusta gdy brak
+    std::vector<NodeId> path(NodeId src, NodeId dst) const;
+
+    static std::pair<double, double> wilsonInterval(uint64_t successes, uint64_t trials, double confidence);
+
+private:
+    const GraphSnapshot& m_graph;
+};
+
+} // namespace analysis
+} // namespace netsim
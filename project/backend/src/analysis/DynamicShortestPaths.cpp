@@ -0,0 +1,270 @@
+#include "DynamicShortestPaths.hpp"
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+namespace netsim {
+namespace analysis {
+
+namespace {
+using HeapEntry = std::pair<int64_t, NodeId>;
+using MinHeap = std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>>;
+}
+
+DynamicShortestPaths::DynamicShortestPaths(const GraphSnapshot& graph) {
+    rebuild(graph);
+}
+
+void DynamicShortestPaths::rebuild(const GraphSnapshot& graph) {
+    const size_t n = graph.nodeCount();
+    m_adj.assign(n, {});
+    m_usable.assign(n, 0);
+    for (NodeId u = 0; u < n; ++u) {
+        m_usable[u] = graph.isUsable(u);
+        for (uint32_t a = graph.offsets[u]; a < graph.offsets[u + 1]; ++a)
+            m_adj[u].push_back({graph.targets[a], graph.delayMs[a]});
+    }
+    m_inAffected.assign(n, 0);
+    for (auto& tree : m_trees) {
+        tree.dist.assign(n, Unreachable);
+        tree.parent.assign(n, GraphSnapshot::InvalidNode);
+        computeFull(tree);
+    }
+    m_stats.fullRebuilds++;
+}
+
+void DynamicShortestPaths::addSource(NodeId source) {
+    if (hasSource(source)) return;
+    ensureNode(source);
+    Tree tree;
+    tree.source = source;
+    tree.dist.assign(m_adj.size(), Unreachable);
+    tree.parent.assign(m_adj.size(), GraphSnapshot::InvalidNode);
+    computeFull(tree);
+    m_trees.push_back(std::move(tree));
+}
+
+void DynamicShortestPaths::removeSource(NodeId source) {
+    m_trees.erase(std::remove_if(m_trees.begin(), m_trees.end(),
+        [source](const Tree& t) { return t.source == source; }), m_trees.end());
+}
+
+bool DynamicShortestPaths::hasSource(NodeId source) const {
+    return findTree(source) != nullptr;
+}
+
+const DynamicShortestPaths::Tree* DynamicShortestPaths::findTree(NodeId source) const {
+    for (const auto& tree : m_trees)
+        if (tree.source == source) return &tree;
+    return nullptr;
+}
+
+void DynamicShortestPaths::ensureNode(NodeId id) {
+    if (id < m_adj.size()) return;
+    const size_t n = id + 1;
+    m_adj.resize(n);
+    m_usable.resize(n, 1); // nowe węzły (addNode) są sprawne
+    m_inAffected.resize(n, 0);
+    for (auto& tree : m_trees) {
+        tree.dist.resize(n, Unreachable);
+        tree.parent.resize(n, GraphSnapshot::InvalidNode);
+    }
+}
+
+int* DynamicShortestPaths::edgeWeight(NodeId u, NodeId v) {
+    for (auto& e : m_adj[u])
+        if (e.to == v) return &e.weight;
+    return nullptr;
+}
+
+void DynamicShortestPaths::setEdge(NodeId u, NodeId v, int weight) {
+    if (int* w = edgeWeight(u, v)) *w = weight;
+    else m_adj[u].push_back({v, weight});
+}
+
+void DynamicShortestPaths::removeEdge(NodeId u, NodeId v) {
+    auto& edges = m_adj[u];
+    for (size_t i = 0; i < edges.size(); ++i) {
+        if (edges[i].to == v) {
+            edges[i] = edges.back();
+            edges.pop_back();
+            return;
+        }
+    }
+}
+
+void DynamicShortestPaths::apply(const TopologyChange& change) {
+    using Kind = TopologyChange::Kind;
+    m_stats.changesApplied++;
+    switch (change.kind) {
+    case Kind::LinkUp:
+        ensureNode(std::max(change.a, change.b));
+        setEdge(change.a, change.b, change.delayMs);
+        setEdge(change.b, change.a, change.delayMs);
+        onDecrease(change.a, change.b, change.delayMs);
+        break;
+    case Kind::LinkDown:
+        if (std::max(change.a, change.b) >= m_adj.size() || !edgeWeight(change.a, change.b)) break;
+        removeEdge(change.a, change.b);
+        removeEdge(change.b, change.a);
+        onIncrease(change.a, change.b);
+        break;
+    case Kind::LinkDelay: {
+        ensureNode(std::max(change.a, change.b));
+        int* current = edgeWeight(change.a, change.b);
+        int oldWeight = current ? *current : change.delayMs;
+        setEdge(change.a, change.b, change.delayMs);
+        setEdge(change.b, change.a, change.delayMs);
+        if (change.delayMs < oldWeight) onDecrease(change.a, change.b, change.delayMs);
+        else if (change.delayMs > oldWeight) onIncrease(change.a, change.b);
+        break;
+    }
+    case Kind::NodeFailed:
+    case Kind::NodeRemoved:
+        ensureNode(change.a);
+        if (!m_usable[change.a]) break;
+        m_usable[change.a] = 0;
+        for (auto& tree : m_trees) {
+            if (tree.source == change.a) computeFull(tree);
+            else if (tree.dist[change.a] != Unreachable) repairSubtree(tree, change.a);
+        }
+        break;
+    case Kind::Reset:
+        // Właściciel musi wywołać rebuild() z nowym GraphSnapshot
+        break;
+    }
+}
+
+void DynamicShortestPaths::computeFull(Tree& tree) {
+    std::fill(tree.dist.begin(), tree.dist.end(), Unreachable);
+    std::fill(tree.parent.begin(), tree.parent.end(), GraphSnapshot::InvalidNode);
+    if (tree.source >= m_adj.size() || !m_usable[tree.source]) return;
+    tree.dist[tree.source] = 0;
+    relaxFrom(tree, tree.source);
+}
+
+void DynamicShortestPaths::relaxFrom(Tree& tree, NodeId start) {
+    MinHeap heap;
+    heap.push({tree.dist[start], start});
+    while (!heap.empty()) {
+        auto [d, x] = heap.top();
+        heap.pop();
+        if (d > tree.dist[x]) continue;
+        m_stats.nodesRepaired++;
+        for (const auto& e : m_adj[x]) {
+            if (!m_usable[e.to]) continue;
+            int64_t nd = d + e.weight;
+            if (nd < tree.dist[e.to]) {
+                tree.dist[e.to] = nd;
+                tree.parent[e.to] = x;
+                heap.push({nd, e.to});
+            }
+        }
+    }
+}
+
+void DynamicShortestPaths::repairSubtree(Tree& tree, NodeId root) {
+    // 1. Poddrzewo SPT zawieszone pod root (po wskaźnikach parent)
+    m_affected.clear();
+    m_affected.push_back(root);
+    m_inAffected[root] = 1;
+    for (size_t i = 0; i < m_affected.size(); ++i) {
+        NodeId x = m_affected[i];
+        for (const auto& e : m_adj[x]) {
+            if (!m_inAffected[e.to] && tree.parent[e.to] == x) {
+                m_inAffected[e.to] = 1;
+                m_affected.push_back(e.to);
+            }
+        }
+    }
+    for (NodeId x : m_affected) {
+        tree.dist[x] = Unreachable;
+        tree.parent[x] = GraphSnapshot::InvalidNode;
+    }
+
+    // 2. Zasiej odległości z sąsiadów spoza poddrzewa
+    MinHeap heap;
+    for (NodeId x : m_affected) {
+        if (!m_usable[x]) continue;
+        for (const auto& e : m_adj[x]) {
+            if (m_inAffected[e.to] || !m_usable[e.to] || tree.dist[e.to] == Unreachable) continue;
+            int64_t nd = tree.dist[e.to] + e.weight;
+            if (nd < tree.dist[x]) {
+                tree.dist[x] = nd;
+                tree.parent[x] = e.to;
+            }
+        }
+        if (tree.dist[x] != Unreachable) heap.push({tree.dist[x], x});
+    }
+
+    // 3. Dijkstra ograniczona do poddrzewa
+    while (!heap.empty()) {
+        auto [d, x] = heap.top();
+        heap.pop();
+        if (d > tree.dist[x]) continue;
+        for (const auto& e : m_adj[x]) {
+            if (!m_inAffected[e.to] || !m_usable[e.to]) continue;
+            int64_t nd = d + e.weight;
+            if (nd < tree.dist[e.to]) {
+                tree.dist[e.to] = nd;
+                tree.parent[e.to] = x;
+                heap.push({nd, e.to});
+            }
+        }
+    }
+
+    m_stats.nodesRepaired += m_affected.size();
+    for (NodeId x : m_affected) m_inAffected[x] = 0;
+}
+
+void DynamicShortestPaths::onDecrease(NodeId u, NodeId v, int weight) {
+    if (!m_usable[u] || !m_usable[v]) return;
+    for (auto& tree : m_trees) {
+        for (auto [x, y] : {std::make_pair(u, v), std::make_pair(v, u)}) {
+            if (tree.dist[x] == Unreachable) continue;
+            int64_t nd = tree.dist[x] + weight;
+            if (nd < tree.dist[y]) {
+                tree.dist[y] = nd;
+                tree.parent[y] = x;
+                relaxFrom(tree, y);
+            }
+        }
+    }
+}
+
+void DynamicShortestPaths::onIncrease(NodeId u, NodeId v) {
+    for (auto& tree : m_trees) {
+        if (tree.parent[v] == u) repairSubtree(tree, v);
+        else if (tree.parent[u] == v) repairSubtree(tree, u);
+    }
+}
+
+int64_t DynamicShortestPaths::distance(NodeId source, NodeId target) const {
+    const Tree* tree = findTree(source);
+    if (!tree) throw std::runtime_error("Source is not tracked");
+    if (target >= tree->dist.size()) return Unreachable;
+    return tree->dist[target];
+}
+
+NodeId DynamicShortestPaths::parent(NodeId source, NodeId target) const {
+    const Tree* tree = findTree(source);
+    if (!tree) throw std::runtime_error("Source is not tracked");
+    if (target >= tree->parent.size()) return GraphSnapshot::InvalidNode;
+    return tree->parent[target];
+}
+
+std::vector<NodeId> DynamicShortestPaths::path(NodeId source, NodeId target) const {
+    std::vector<NodeId> result;
+    const Tree* tree = findTree(source);
+    if (!tree || target >= tree->dist.size() || tree->dist[target] == Unreachable)
+        return result;
+    for (NodeId at = target; at != GraphSnapshot::InvalidNode; at = tree->parent[at]) {
+        result.push_back(at);
+        if (at == source) break;
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+} // namespace analysis
+} // namespace netsim
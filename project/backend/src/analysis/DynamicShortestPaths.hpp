@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../core/GraphSnapshot.hpp"
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+namespace netsim {
+namespace analysis {
+
+/**
+ * @brief Shortest-path trees (by link delay) maintained incrementally
+ *
+ * Keeps one SPT per tracked source and repairs only the affected part of
+ * each tree when a TopologyChange arrives:
+ *  - weight decrease / link up: Dijkstra propagation from the improved
+ *    endpoint (Ramalingam-Reps insertion phase);
+ *  - weight increase / link down / node failure: the subtree hanging below
+ *    the changed tree edge is detached, re-seeded from its unaffected
+ *    neighbours and re-settled with a Dijkstra limited to that subtree.
+ * Zero-delay links are handled because affected sets follow parent
+ * pointers instead of distance comparisons.
+ */
+class DynamicShortestPaths {
+public:
+    static constexpr int64_t Unreachable = std::numeric_limits<int64_t>::max();
+
+    struct Stats {
+        uint64_t changesApplied = 0;
+        uint64_t nodesRepaired = 0;   // węzły, których odległość była przeliczana
+        uint64_t fullRebuilds = 0;
+    };
+
+    explicit DynamicShortestPaths(const GraphSnapshot& graph);
+
+    // Wczytuje graf od nowa i przelicza wszystkie drzewa (TopologyChange::Reset)
+    void rebuild(const GraphSnapshot& graph);
+
+    void addSource(NodeId source);
+    void removeSource(NodeId source);
+    bool hasSource(NodeId source) const;
+
+    void apply(const TopologyChange& change);
+
+    // Suma opóźnień najkrótszej ścieżki lub Unreachable
+    int64_t distance(NodeId source, NodeId target) const;
+    // Ścieżka source..target (pusta gdy brak trasy lub source nie jest śledzony)
+    std::vector<NodeId> path(NodeId source, NodeId target) const;
+    NodeId parent(NodeId source, NodeId target) const;
+
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct Edge {
+        NodeId to;
+        int weight;
+    };
+
+    struct Tree {
+        NodeId source;
+        std::vector<int64_t> dist;
+        std::vector<NodeId> parent;
+    };
+
+    std::vector<std::vector<Edge>> m_adj;
+    std::vector<uint8_t> m_usable;
+    std::vector<Tree> m_trees;
+    Stats m_stats;
+
+    // Bufory robocze współdzielone przez naprawy
+    std::vector<uint8_t> m_inAffected;
+    std::vector<NodeId> m_affected;
+
+    void ensureNode(NodeId id);
+    int* edgeWeight(NodeId u, NodeId v);
+    void setEdge(NodeId u, NodeId v, int weight);
+    void removeEdge(NodeId u, NodeId v);
+
+    const Tree* findTree(NodeId source) const;
+    void computeFull(Tree& tree);
+    void relaxFrom(Tree& tree, NodeId start);
+    void repairSubtree(Tree& tree, NodeId root);
+
+    void onDecrease(NodeId u, NodeId v, int weight);
+    void onIncrease(NodeId u, NodeId v);
+};
+
+} // namespace analysis
+} // namespace netsim
@@ -0,0 +1,217 @@
+#include "MaxFlow.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace netsim {
+namespace analysis {
+
+namespace {
+
+constexpr int64_t kInfinite = std::numeric_limits<int64_t>::max() / 4;
+
+// Residual graph in CSR form; graph arcs keep their row position,
+// super-source/super-sink arcs are appended at the end of each row.
+struct Residual {
+    uint32_t nodes = 0;
+    uint32_t source = 0;
+    uint32_t sink = 0;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> to;
+    std::vector<uint32_t> rev;
+    std::vector<int64_t> cap;
+    std::vector<int32_t> level;
+    std::vector<uint32_t> next;   // Dinic "current arc" pointers
+    std::vector<uint32_t> queue;
+    std::vector<uint32_t> path;
+
+    bool buildLevels() {
+        level.assign(nodes, -1);
+        queue.clear();
+        queue.push_back(source);
+        level[source] = 0;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            uint32_t u = queue[head];
+            for (uint32_t a = offsets[u]; a < offsets[u + 1]; ++a) {
+                uint32_t v = to[a];
+                if (cap[a] > 0 && level[v] < 0) {
+                    level[v] = level[u] + 1;
+                    queue.push_back(v);
+                }
+            }
+        }
+        return level[sink] >= 0;
+    }
+
+    // Iterative DFS for one augmenting path in the level graph (no recursion,
+    // so long chains do not grow the stack)
+    int64_t augmentPath() {
+        path.clear();
+        uint32_t u = source;
+        while (true) {
+            if (u == sink) {
+                int64_t bottleneck = kInfinite;
+                for (uint32_t a : path) bottleneck = std::min(bottleneck, cap[a]);
+                for (uint32_t a : path) {
+                    cap[a] -= bottleneck;
+                    cap[rev[a]] += bottleneck;
+                }
+                return bottleneck;
+            }
+            bool advanced = false;
+            for (uint32_t& a = next[u]; a < offsets[u + 1]; ++a) {
+                uint32_t v = to[a];
+                if (cap[a] > 0 && level[v] == level[u] + 1) {
+                    path.push_back(a);
+                    u = v;
+                    advanced = true;
+                    break;
+                }
+            }
+            if (!advanced) {
+                level[u] = -1; // ślepy zaułek w tej fazie
+                if (path.empty()) return 0;
+                uint32_t a = path.back();
+                path.pop_back();
+                u = to[rev[a]];
+                ++next[u];
+            }
+        }
+    }
+
+    int64_t run() {
+        int64_t total = 0;
+        while (buildLevels()) {
+            next.assign(offsets.begin(), offsets.end() - 1);
+            while (int64_t pushed = augmentPath()) total += pushed;
+        }
+        return total;
+    }
+};
+
+} // namespace
+
+MaxFlow::MaxFlow(const GraphSnapshot& graph, int64_t defaultCapacity)
+    : m_graph(graph), m_defaultCapacity(defaultCapacity) {
+}
+
+int64_t MaxFlow::linkCapacity(uint32_t arc) const {
+    int bw = m_graph.bandwidth[arc];
+    return bw > 0 ? bw : m_defaultCapacity;
+}
+
+FlowResult MaxFlow::compute(const std::string& source, const std::string& sink) const {
+    return computeById({m_graph.idOf(source)}, {m_graph.idOf(sink)});
+}
+
+FlowResult MaxFlow::compute(const std::vector<std::string>& sources,
+                            const std::vector<std::string>& sinks) const {
+    std::vector<NodeId> sourceIds, sinkIds;
+    for (const auto& name : sources) sourceIds.push_back(m_graph.idOf(name));
+    for (const auto& name : sinks) sinkIds.push_back(m_graph.idOf(name));
+    return computeById(sourceIds, sinkIds);
+}
+
+FlowResult MaxFlow::computeById(const std::vector<NodeId>& sources,
+                                const std::vector<NodeId>& sinks) const {
+    if (sources.empty() || sinks.empty())
+        throw std::runtime_error("Max-flow needs at least one source and one sink");
+
+    const uint32_t n = static_cast<uint32_t>(m_graph.nodeCount());
+    std::vector<uint8_t> role(n, 0); // 1 = source, 2 = sink
+    for (NodeId s : sources) {
+        if (s >= n || !m_graph.present[s]) throw std::runtime_error("Unknown source node");
+        role[s] = 1;
+    }
+    for (NodeId t : sinks) {
+        if (t >= n || !m_graph.present[t]) throw std::runtime_error("Unknown sink node");
+        if (role[t] == 1) throw std::runtime_error("Source and sink sets must be disjoint");
+        role[t] = 2;
+    }
+
+    Residual r;
+    r.nodes = n + 2;
+    r.source = n;
+    r.sink = n + 1;
+
+    // Rozmiary wierszy: łącza grafu + łuki do super-źródła/super-ujścia
+    std::vector<uint32_t> extra(r.nodes, 0);
+    for (uint32_t u = 0; u < n; ++u) {
+        if (role[u]) {
+            extra[u]++;
+            extra[role[u] == 1 ? r.source : r.sink]++;
+        }
+    }
+    r.offsets.assign(r.nodes + 1, 0);
+    for (uint32_t u = 0; u < r.nodes; ++u) {
+        uint32_t deg = (u < n ? m_graph.degree(u) : 0) + extra[u];
+        r.offsets[u + 1] = r.offsets[u] + deg;
+    }
+    const uint32_t arcs = r.offsets[r.nodes];
+    r.to.resize(arcs);
+    r.rev.resize(arcs);
+    r.cap.assign(arcs, 0);
+
+    for (uint32_t u = 0; u < n; ++u) {
+        uint32_t base = m_graph.offsets[u];
+        for (uint32_t a = base; a < m_graph.offsets[u + 1]; ++a) {
+            uint32_t ra = r.offsets[u] + (a - base);
+            NodeId v = m_graph.targets[a];
+            uint32_t b = m_graph.reverse[a];
+            r.to[ra] = v;
+            r.rev[ra] = r.offsets[v] + (b - m_graph.offsets[v]);
+            if (m_graph.isUsable(u) && m_graph.isUsable(v))
+                r.cap[ra] = linkCapacity(a);
+        }
+    }
+
+    std::vector<uint32_t> fill(r.nodes);
+    for (uint32_t u = 0; u < r.nodes; ++u)
+        fill[u] = r.offsets[u] + (u < n ? m_graph.degree(u) : 0);
+    for (uint32_t u = 0; u < n; ++u) {
+        if (!role[u]) continue;
+        uint32_t super = role[u] == 1 ? r.source : r.sink;
+        uint32_t a = fill[super]++;
+        uint32_t b = fill[u]++;
+        r.to[a] = u;
+        r.to[b] = super;
+        r.rev[a] = b;
+        r.rev[b] = a;
+        bool usable = m_graph.isUsable(u);
+        if (role[u] == 1) r.cap[a] = usable ? kInfinite : 0; // super-źródło -> s
+        else r.cap[b] = usable ? kInfinite : 0;              // t -> super-ujście
+    }
+
+    FlowResult result;
+    result.maxFlow = r.run();
+
+    // Minimalne cięcie: łącza z nasyconej granicy zbioru osiągalnego od źródła
+    std::vector<uint8_t> reachable(r.nodes, 0);
+    r.queue.clear();
+    r.queue.push_back(r.source);
+    reachable[r.source] = 1;
+    for (size_t head = 0; head < r.queue.size(); ++head) {
+        uint32_t u = r.queue[head];
+        for (uint32_t a = r.offsets[u]; a < r.offsets[u + 1]; ++a) {
+            uint32_t v = r.to[a];
+            if (r.cap[a] > 0 && !reachable[v]) {
+                reachable[v] = 1;
+                r.queue.push_back(v);
+            }
+        }
+    }
+    for (uint32_t u = 0; u < n; ++u) {
+        if (!reachable[u]) continue;
+        for (uint32_t a = m_graph.offsets[u]; a < m_graph.offsets[u + 1]; ++a) {
+            NodeId v = m_graph.targets[a];
+            if (reachable[v] || !m_graph.isUsable(u) || !m_graph.isUsable(v)) continue;
+            int64_t capacity = linkCapacity(a);
+            if (capacity > 0)
+                result.minCut.push_back({m_graph.nameOf(u), m_graph.nameOf(v), capacity});
+        }
+    }
+    return result;
+}
+
+} // namespace analysis
+} // namespace netsim
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../core/GraphSnapshot.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace netsim {
+namespace analysis {
+
+/**
+ * @brief Link on the minimum cut, oriented from the source side to the sink side
+ */
+struct CutLink {
+    std::string from;
+    std::string to;
+    int64_t capacity = 0;
+};
+
+/**
+ * @brief Result of a max-flow query
+ */
+struct FlowResult {
+    int64_t maxFlow = 0;           // achievable throughput (bandwidth units, Mbps)
+    std::vector<CutLink> minCut;   // bottleneck links limiting the flow
+};
+
+/**
+ * @brief Bandwidth-aware max-flow (Dinic) over an id-indexed GraphSnapshot
+ *
+ * Link capacities come from Network::setBandwidth; links without a bandwidth
+ * use defaultCapacity. Links are undirected: both directions share one
+ * capacity. Failed nodes carry no flow. Each query builds its own residual
+ * graph, so one MaxFlow can answer many queries against the same snapshot.
+ */
+class MaxFlow {
+public:
+    explicit MaxFlow(const GraphSnapshot& graph, int64_t defaultCapacity = 0);
+
+    /**
+     * @brief Achievable throughput and bottleneck links between two nodes
+     */
+    FlowResult compute(const std::string& source, const std::string& sink) const;
+
+    /**
+     * @brief Multi-source/multi-sink query (super source and super sink)
+     */
+    FlowResult compute(const std::vector<std::string>& sources,
+                       const std::vector<std::string>& sinks) const;
+
+    FlowResult computeById(const std::vector<NodeId>& sources,
+                           const std::vector<NodeId>& sinks) const;
+
+private:
+    const GraphSnapshot& m_graph;
+    int64_t m_defaultCapacity;
+
+    int64_t linkCapacity(uint32_t arc) const;
+};
+
+} // namespace analysis
+} // namespace netsim
@@ -0,0 +1,255 @@
+#include "Resilience.hpp"
+#include "../utils/Parallel.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace netsim {
+namespace analysis {
+
+namespace {
+
+constexpr uint32_t NoLabel = UINT32_MAX;
+
+inline void setBit(std::vector<uint64_t>& bits, size_t i) { bits[i >> 6] |= uint64_t(1) << (i & 63); }
+inline void clearBit(std::vector<uint64_t>& bits, size_t i) { bits[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+inline bool testBit(const std::vector<uint64_t>& bits, size_t i) { return (bits[i >> 6] >> (i & 63)) & 1; }
+
+// Stan wątku: maski awarii nałożone na wspólny, niezmienny snapshot
+struct MaskWorker {
+    std::vector<uint64_t> nodeMask;
+    std::vector<uint64_t> arcMask;
+    std::vector<uint32_t> label;
+    std::vector<NodeId> visited;
+    std::vector<uint32_t> countS, countT;
+    uint32_t components = 0;
+
+    MaskWorker(size_t nodes, size_t arcs)
+        : nodeMask((nodes + 63) / 64, 0), arcMask((arcs + 63) / 64, 0),
+          label(nodes, NoLabel), countS(nodes, 0), countT(nodes, 0) {
+        visited.reserve(nodes);
+    }
+
+    bool alive(const GraphSnapshot& g, NodeId u) const {
+        return g.isUsable(u) && !testBit(nodeMask, u);
+    }
+
+    void mask(const GraphSnapshot& g, const FailureSet& set, bool on) {
+        for (NodeId u : set.nodes) on ? setBit(nodeMask, u) : clearBit(nodeMask, u);
+        for (const auto& [a, b] : set.links) {
+            uint32_t arc = g.findArc(a, b);
+            for (uint32_t x : {arc, g.reverse[arc]}) on ? setBit(arcMask, x) : clearBit(arcMask, x);
+        }
+    }
+
+    // Etykietuje tylko składowe zawierające endpointy
+    void labelFrom(const GraphSnapshot& g, const std::vector<NodeId>& endpoints) {
+        components = 0;
+        for (NodeId e : endpoints) {
+            if (label[e] != NoLabel || !alive(g, e)) continue;
+            size_t head = visited.size();
+            label[e] = components;
+            visited.push_back(e);
+            while (head < visited.size()) {
+                NodeId v = visited[head++];
+                for (uint32_t a = g.offsets[v]; a < g.offsets[v + 1]; ++a) {
+                    NodeId w = g.targets[a];
+                    if (label[w] != NoLabel || testBit(arcMask, a) || !alive(g, w)) continue;
+                    label[w] = components;
+                    visited.push_back(w);
+                }
+            }
+            components++;
+        }
+    }
+
+    void resetLabels() {
+        for (NodeId v : visited) label[v] = NoLabel;
+        visited.clear();
+    }
+
+    uint64_t connectedPairs(const std::vector<NodeId>& sources, const std::vector<NodeId>& targets,
+                            const std::vector<NodeId>& shared) {
+        uint64_t connected = 0;
+        if (targets.empty()) {
+            for (NodeId s : sources) {
+                if (label[s] == NoLabel) continue;
+                connected += countS[label[s]]++;
+            }
+        } else {
+            for (NodeId s : sources) if (label[s] != NoLabel) countS[label[s]]++;
+            for (NodeId t : targets) if (label[t] != NoLabel) countT[label[t]]++;
+            for (uint32_t c = 0; c < components; ++c) connected += uint64_t(countS[c]) * countT[c];
+            for (NodeId x : shared) if (label[x] != NoLabel) connected--; // para (x, x)
+        }
+        std::fill(countS.begin(), countS.begin() + components, 0);
+        std::fill(countT.begin(), countT.begin() + components, 0);
+        return connected;
+    }
+};
+
+std::vector<NodeId> sortedUnique(std::vector<NodeId> ids) {
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+void checkCombinationCount(size_t items, size_t k, size_t maxSets) {
+    if (k == 0) throw std::runtime_error("Failure combination size must be positive");
+    // C(items, k) liczone przyrostowo z przerwaniem po przekroczeniu limitu
+    double count = 1.0;
+    for (size_t i = 0; i < k && i < items; ++i) {
+        count = count * (items - i) / (i + 1);
+        if (count > static_cast<double>(maxSets))
+            throw std::runtime_error("Too many failure combinations (limit " + std::to_string(maxSets) + ")");
+    }
+}
+
+} // namespace
+
+ResilienceAnalyzer::ResilienceAnalyzer(const GraphSnapshot& graph) : m_graph(graph) {
+}
+
+ResilienceReport ResilienceAnalyzer::evaluate(const std::vector<FailureSet>& sets,
+                                              const ResilienceQuery& query,
+                                              const ResilienceOptions& options) const {
+    const size_t n = m_graph.nodeCount();
+    auto checkNode = [&](NodeId id) {
+        if (id >= n || !m_graph.present[id]) throw std::runtime_error("Unknown node id: " + std::to_string(id));
+    };
+    for (const auto& set : sets) {
+        for (NodeId u : set.nodes) checkNode(u);
+        for (const auto& [a, b] : set.links) {
+            checkNode(a);
+            checkNode(b);
+            if (m_graph.findArc(a, b) == GraphSnapshot::InvalidArc)
+                throw std::runtime_error("Link not found: " + m_graph.nameOf(a) + " - " + m_graph.nameOf(b));
+        }
+    }
+
+    const std::vector<NodeId> sources = sortedUnique(query.sources);
+    const std::vector<NodeId> targets = sortedUnique(query.targets);
+    for (NodeId id : sources) checkNode(id);
+    for (NodeId id : targets) checkNode(id);
+    std::vector<NodeId> shared, endpoints;
+    std::set_intersection(sources.begin(), sources.end(), targets.begin(), targets.end(),
+                          std::back_inserter(shared));
+    std::set_union(sources.begin(), sources.end(), targets.begin(), targets.end(),
+                   std::back_inserter(endpoints));
+
+    ResilienceReport report;
+    report.totalPairs = targets.empty()
+        ? uint64_t(sources.size()) * (sources.size() > 0 ? sources.size() - 1 : 0) / 2
+        : uint64_t(sources.size()) * targets.size() - shared.size();
+
+    // Stan bazowy (bez awarii) - etykiety składowych endpointów
+    std::vector<uint32_t> baseLabel(n, NoLabel);
+    {
+        MaskWorker base(n, m_graph.arcCount());
+        base.labelFrom(m_graph, endpoints);
+        for (NodeId e : endpoints) baseLabel[e] = base.label[e];
+        report.baselineConnectedPairs = base.connectedPairs(sources, targets, shared);
+    }
+
+    unsigned workers = options.threads ? options.threads : utils::defaultWorkerCount();
+    workers = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(workers, sets.size())));
+    std::vector<MaskWorker> state;
+    state.reserve(workers);
+    for (unsigned w = 0; w < workers; ++w) state.emplace_back(n, m_graph.arcCount());
+
+    report.impacts.resize(sets.size());
+    utils::parallelFor(sets.size(), workers, [&](unsigned worker, size_t i) {
+        MaskWorker& ws = state[worker];
+        const FailureSet& set = sets[i];
+        FailureImpact& impact = report.impacts[i];
+        impact.setIndex = i;
+        impact.label = set.label;
+
+        ws.mask(m_graph, set, true);
+        ws.labelFrom(m_graph, endpoints);
+        for (NodeId e : endpoints)
+            if (m_graph.isUsable(e) && testBit(ws.nodeMask, e)) impact.failedEndpoints++;
+        impact.endpointComponents = ws.components;
+        impact.affectedPairs = report.baselineConnectedPairs - ws.connectedPairs(sources, targets, shared);
+
+        if (impact.affectedPairs > 0 && options.maxPairsPerSet > 0) {
+            auto lost = [&](NodeId a, NodeId b) {
+                return baseLabel[a] != NoLabel && baseLabel[a] == baseLabel[b] &&
+                       (ws.label[a] == NoLabel || ws.label[a] != ws.label[b]);
+            };
+            const uint64_t wanted = std::min<uint64_t>(impact.affectedPairs, options.maxPairsPerSet);
+            for (size_t s = 0; s < sources.size() && impact.pairs.size() < wanted; ++s) {
+                if (targets.empty()) {
+                    for (size_t t = s + 1; t < sources.size() && impact.pairs.size() < wanted; ++t)
+                        if (lost(sources[s], sources[t])) impact.pairs.emplace_back(sources[s], sources[t]);
+                } else {
+                    for (size_t t = 0; t < targets.size() && impact.pairs.size() < wanted; ++t)
+                        if (sources[s] != targets[t] && lost(sources[s], targets[t]))
+                            impact.pairs.emplace_back(sources[s], targets[t]);
+                }
+            }
+        }
+
+        ws.resetLabels();
+        ws.mask(m_graph, set, false);
+    });
+    return report;
+}
+
+std::vector<FailureSet> ResilienceAnalyzer::nodeCombinations(const GraphSnapshot& graph,
+                                                             std::vector<NodeId> candidates, size_t k,
+                                                             size_t maxSets) {
+    if (candidates.empty()) {
+        for (NodeId u = 0; u < graph.nodeCount(); ++u)
+            if (graph.isUsable(u)) candidates.push_back(u);
+    }
+    std::vector<FailureSet> singles;
+    for (NodeId u : sortedUnique(std::move(candidates))) {
+        if (u >= graph.nodeCount() || !graph.present[u])
+            throw std::runtime_error("Unknown node id: " + std::to_string(u));
+        singles.push_back({graph.nameOf(u), {u}, {}});
+    }
+    return groupCombinations(singles, k, maxSets);
+}
+
+std::vector<FailureSet> ResilienceAnalyzer::linkCombinations(const GraphSnapshot& graph, size_t k,
+                                                             size_t maxSets) {
+    std::vector<FailureSet> singles;
+    for (NodeId u = 0; u < graph.nodeCount(); ++u) {
+        for (uint32_t a = graph.offsets[u]; a < graph.offsets[u + 1]; ++a) {
+            NodeId v = graph.targets[a];
+            if (u < v) singles.push_back({graph.nameOf(u) + "-" + graph.nameOf(v), {}, {{u, v}}});
+        }
+    }
+    return groupCombinations(singles, k, maxSets);
+}
+
+std::vector<FailureSet> ResilienceAnalyzer::groupCombinations(const std::vector<FailureSet>& groups, size_t k,
+                                                              size_t maxSets) {
+    checkCombinationCount(groups.size(), k, maxSets);
+    std::vector<FailureSet> result;
+    if (k > groups.size()) return result;
+
+    std::vector<size_t> pick(k);
+    for (size_t i = 0; i < k; ++i) pick[i] = i;
+    while (true) {
+        FailureSet combined;
+        for (size_t i : pick) {
+            const FailureSet& g = groups[i];
+            combined.label += (combined.label.empty() ? "" : "+") + g.label;
+            combined.nodes.insert(combined.nodes.end(), g.nodes.begin(), g.nodes.end());
+            combined.links.insert(combined.links.end(), g.links.begin(), g.links.end());
+        }
+        result.push_back(std::move(combined));
+
+        // Następna kombinacja w porządku leksykograficznym
+        size_t i = k;
+        while (i > 0 && pick[i - 1] == groups.size() - k + i - 1) --i;
+        if (i == 0) break;
+        ++pick[i - 1];
+        for (size_t j = i; j < k; ++j) pick[j] = pick[j - 1] + 1;
+    }
+    return result;
+}
+
+} // namespace analysis
+} // namespace netsim
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../core/GraphSnapshot.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace netsim {
+namespace analysis {
+
+/**
+ * @brief One what-if scenario: nodes and links that fail together
+ *
+ * Also used to describe shared-risk groups (e.g. all links in one conduit).
+ */
+struct FailureSet {
+    std::string label;
+    std::vector<NodeId> nodes;
+    std::vector<std::pair<NodeId, NodeId>> links;
+};
+
+/**
+ * @brief Endpoints whose connectivity is checked
+ *
+ * With targets empty every unordered pair of sources is checked, otherwise
+ * every (source, target) pair with source != target.
+ */
+struct ResilienceQuery {
+    std::vector<NodeId> sources;
+    std::vector<NodeId> targets;
+};
+
+struct ResilienceOptions {
+    unsigned threads = 0;          // 0 = hardware_concurrency
+    size_t maxPairsPerSet = 100;   // limit listy par w raporcie (licznik jest zawsze pełny)
+};
+
+/**
+ * @brief Impact of one failure set
+ */
+struct FailureImpact {
+    size_t setIndex = 0;
+    std::string label;
+    uint64_t affectedPairs = 0;    // pary połączone w bazie, rozłączone po awarii
+    size_t failedEndpoints = 0;    // endpointy, które same uległy awarii
+    size_t endpointComponents = 0; // liczba składowych zawierających endpointy
+    std::vector<std::pair<NodeId, NodeId>> pairs;
+};
+
+struct ResilienceReport {
+    uint64_t totalPairs = 0;
+    uint64_t baselineConnectedPairs = 0;
+    std::vector<FailureImpact> impacts;  // w kolejności zbiorów wejściowych
+};
+
+/**
+ * @brief Parallel what-if failure analysis over an immutable GraphSnapshot
+ *
+ * The snapshot is never copied or modified: each worker thread owns a node
+ * bitset and an arc bitset, marks the failure set in them, labels the
+ * components reachable from the query endpoints and clears the bits again.
+ * Connected pairs are counted per component label, so the cost per set is
+ * one masked traversal regardless of the number of pairs.
+ */
+class ResilienceAnalyzer {
+public:
+    explicit ResilienceAnalyzer(const GraphSnapshot& graph);
+
+    // Rzuca std::runtime_error dla nieznanych węzłów lub łączy
+    ResilienceReport evaluate(const std::vector<FailureSet>& sets,
+                              const ResilienceQuery& query,
+                              const ResilienceOptions& options = ResilienceOptions()) const;
+
+    // Wszystkie k-elementowe kombinacje węzłów z candidates (puste = wszystkie sprawne)
+    static std::vector<FailureSet> nodeCombinations(const GraphSnapshot& graph,
+                                                    std::vector<NodeId> candidates, size_t k,
+                                                    size_t maxSets = 1000000);
+    // Wszystkie k-elementowe kombinacje łączy
+    static std::vector<FailureSet> linkCombinations(const GraphSnapshot& graph, size_t k,
+                                                    size_t maxSets = 1000000);
+    // Jednoczesna awaria k grup współdzielonego ryzyka (SRG)
+    static std::vector<FailureSet> groupCombinations(const std::vector<FailureSet>& groups, size_t k,
+                                                     size_t maxSets = 1000000);
+
+private:
+    const GraphSnapshot& m_graph;
+};
+
+} // namespace analysis
+} // namespace netsim
@@ -1,11 +1,19 @@
 #include "Engine.hpp"
+#include "GraphSnapshot.hpp"
+#include "../analysis/DynamicShortestPaths.hpp"
 #include <iostream>
 #include <queue>
 #include <map>
 #include <algorithm>
+#include <stdexcept>
 
 Engine::Engine(Network &network) : net(network) {}
 
+Engine::~Engine() {
+    if (topologyListenerId >= 0)
+        net.removeTopologyListener(topologyListenerId);
+}
+
 bool Engine::ping(const std::string &src, const std::string &dst, std::vector<std::string> &pathOut) {
     std::cout << "[PING] From " << src << " to " << dst << std::endl;
 
@@ -109,3 +117,57 @@ bool Engine::multicast(const std::string& srcName, const std::vector<std::string
     
     return allSuccessful;
 }
+
+
+// ===== Hot-source shortest paths =====
+
+void Engine::trackSource(const std::string& srcName) {
+    NodeId src = net.getNodeId(srcName);
+    if (!spt) {
+        spt = std::make_unique<netsim::analysis::DynamicShortestPaths>(GraphSnapshot::fromNetwork(net));
+        topologyListenerId = net.addTopologyListener(
+            [this](const TopologyChange& change) { onTopologyChange(change); });
+    }
+    spt->addSource(src);
+}
+
+void Engine::untrackSource(const std::string& srcName) {
+    if (spt) spt->removeSource(net.getNodeId(srcName));
+}
+
+void Engine::onTopologyChange(const TopologyChange& change) {
+    if (change.kind == TopologyChange::Kind::Reset)
+        spt->rebuild(GraphSnapshot::fromNetwork(net));
+    else
+        spt->apply(change);
+}
+
+bool Engine::shortestPath(const std::string& srcName, const std::string& dstName,
+                          std::vector<std::string>& pathOut) {
+    NodeId src = net.getNodeId(srcName);
+    NodeId dst = net.getNodeId(dstName);
+    if (!spt || !spt->hasSource(src)) trackSource(srcName);
+
+    pathOut.clear();
+    for (NodeId id : spt->path(src, dst))
+        pathOut.push_back(net.findById(id)->getName());
+    return !pathOut.empty();
+}
+
+std::vector<NodeId> Engine::shortestPathIds(NodeId src, NodeId dst) {
+    if (!spt || !spt->hasSource(src)) {
+        auto node = net.findById(src);
+        if (!node) throw std::runtime_error("Unknown node id");
+        trackSource(node->getName());
+    }
+    return spt->path(src, dst);
+}
+
+int Engine::getShortestDelay(const std::string& srcName, const std::string& dstName) {
+    NodeId src = net.getNodeId(srcName);
+    NodeId dst = net.getNodeId(dstName);
+    if (!spt || !spt->hasSource(src)) trackSource(srcName);
+
+    int64_t d = spt->distance(src, dst);
+    return d == netsim::analysis::DynamicShortestPaths::Unreachable ? -1 : static_cast<int>(d);
+}
@@ -3,10 +3,16 @@
 #include "Packet.hpp"
 #include <string>
 #include <vector>
+#include <memory>
+
+namespace netsim { namespace analysis { class DynamicShortestPaths; } }
 
 class Engine {
 public:
     explicit Engine(Network& net);
+    ~Engine();
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
     bool ping(const std::string &srcName,
                const std::string &dstName,
                std::vector<std::string> &path);
@@ -18,6 +24,20 @@ public:
     // Multicast - wysyłanie do wielu odbiorców
     bool multicast(const std::string& srcName, const std::vector<std::string>& destinations);
 
+    // Najkrótsze ścieżki po opóźnieniach łączy. Źródła są "gorące": ich drzewa SPT
+    // są naprawiane przyrostowo przy setLinkDelay/disconnect/failNode zamiast liczone od zera
+    void trackSource(const std::string& srcName);
+    void untrackSource(const std::string& srcName);
+    bool shortestPath(const std::string& srcName, const std::string& dstName,
+                      std::vector<std::string>& path);   // śledzi srcName jeśli trzeba
+    std::vector<NodeId> shortestPathIds(NodeId src, NodeId dst); // pusta gdy brak trasy
+    int getShortestDelay(const std::string& srcName, const std::string& dstName); // -1 gdy brak trasy
+    const netsim::analysis::DynamicShortestPaths* getShortestPathTrees() const { return spt.get(); }
+
 private:
     Network &net;
+    std::unique_ptr<netsim::analysis::DynamicShortestPaths> spt;
+    int topologyListenerId = -1;
+
+    void onTopologyChange(const TopologyChange& change);
 };
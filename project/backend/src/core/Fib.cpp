@@ -0,0 +1,566 @@
+#include "Fib.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+constexpr unsigned Stride = 6;
+constexpr size_t LargeTable = 65536;   // od tylu tras direct pointing na 20 bitach (4 MB)
+
+// Bity direct pointing: 32 - bits i 128 - bits dzielą się przez Stride, więc
+// /32 i /128 kończą się dokładnie na granicy węzła (bez powielania liści)
+inline unsigned directBitsFor(size_t routes) {
+    return routes >= LargeTable ? 20 : routes >= Fib::DirectThreshold ? 14 : 2;
+}
+constexpr size_t MaxDirtySlots = 4096;
+constexpr size_t MaxGroupBuckets = 65536;   // kubełki jednej grupy ECMP
+
+// n bitów klucza od pozycji offset (od najstarszego), 1 <= n <= 20
+inline unsigned chunk(uint64_t hi, uint64_t lo, unsigned offset, unsigned n) {
+    uint64_t v;
+    if (offset == 0) v = hi;
+    else if (offset < 64) v = (hi << offset) | (lo >> (64 - offset));
+    else v = lo << (offset - 64);
+    return static_cast<unsigned>(v >> (64 - n));
+}
+
+inline unsigned bitAt(uint64_t hi, uint64_t lo, unsigned depth) {
+    return depth < 64 ? (hi >> (63 - depth)) & 1 : (lo >> (127 - depth)) & 1;
+}
+
+inline void setBit(uint64_t& hi, uint64_t& lo, unsigned depth) {
+    if (depth < 64) hi |= 1ull << (63 - depth);
+    else lo |= 1ull << (127 - depth);
+}
+
+} // namespace
+
+Fib::Fib() : m_nextHops(1, nullptr) {}
+
+Fib::NextHopId Fib::internNextHop(Node* nextHop) {
+    auto it = m_nextHopIds.find(nextHop);
+    if (it != m_nextHopIds.end()) return it->second;
+    NextHopId id = static_cast<NextHopId>(m_nextHops.size());
+    m_nextHops.push_back(nextHop);
+    m_nextHopIds.emplace(nextHop, id);
+    return id;
+}
+
+bool Fib::set(const IpPrefix& prefix, NextHopId value, uint32_t* path, unsigned from) {
+    Table& t = table(prefix);
+    uint32_t index = path ? path[from] : 0;
+    for (unsigned depth = from; depth < prefix.length; ++depth) {
+        unsigned bit = bitAt(prefix.hi, prefix.lo, depth);
+        uint32_t next = t.rib[index].child[bit];
+        if (next == 0) {
+            if (value == 0) return false;
+            next = static_cast<uint32_t>(t.rib.size());
+            t.rib.emplace_back();
+            t.rib[index].child[bit] = next;
+        }
+        index = next;
+        if (path) path[depth + 1] = index;
+    }
+    bool existed = t.rib[index].value != 0;
+    t.rib[index].value = value;
+    t.routes = t.routes + (value != 0) - existed;
+    return existed;
+}
+
+void Fib::markDirty(Table& t, const IpPrefix& prefix) {
+    if (t.fullRebuild) return;
+    if (prefix.length >= t.directBits && t.dirtySlots.size() < MaxDirtySlots)
+        t.dirtySlots.push_back(chunk(prefix.hi, prefix.lo, 0, t.directBits));
+    else
+        t.fullRebuild = true;
+}
+
+void Fib::insert(const IpPrefix& prefix, Node* nextHop) {
+    set(prefix, internNextHop(nextHop));
+    markDirty(table(prefix), prefix);
+}
+
+void Fib::insertBulk(const std::vector<Route>& routes) {
+    Node* lastHop = nullptr;
+    NextHopId lastId = NoRoute;
+    // Ścieżka w RIB poprzedniej trasy każdej rodziny; następna zaczyna od wspólnego prefiksu
+    uint32_t path[2][129];
+    const IpPrefix* previous[2] = {nullptr, nullptr};
+    path[0][0] = path[1][0] = 0;
+    for (const Route& route : routes) {
+        // Kolejne trasy zwykle mają ten sam next hop - bez hashowania
+        if (lastId == NoRoute || route.nextHop != lastHop) {
+            lastHop = route.nextHop;
+            lastId = internNextHop(lastHop);
+        }
+        const IpPrefix& p = route.prefix;
+        unsigned from = 0;
+        if (const IpPrefix* q = previous[p.v6]) {
+            uint64_t hi = p.hi ^ q->hi, lo = p.lo ^ q->lo;
+            unsigned common = hi ? __builtin_clzll(hi) : lo ? 64 + __builtin_clzll(lo) : 128;
+            from = std::min({common, unsigned(p.length), unsigned(q->length)});
+        }
+        set(p, lastId, path[p.v6], from);
+        previous[p.v6] = &p;
+        table(p).fullRebuild = true;
+    }
+}
+
+bool Fib::remove(const IpPrefix& prefix) {
+    if (!set(prefix, 0)) return false;
+    markDirty(table(prefix), prefix);
+    return true;
+}
+
+void Fib::clear() {
+    m_v4 = Table(32);
+    m_v6 = Table(128);
+    m_nextHops.assign(1, nullptr);
+    m_nextHopIds.clear();
+    m_groups.clear();
+}
+
+bool Fib::contains(const IpPrefix& prefix) const {
+    return exact(prefix) != 0;
+}
+
+Fib::NextHopId Fib::exact(const IpPrefix& prefix) const {
+    const Table& t = table(prefix);
+    uint32_t index = 0;
+    for (unsigned depth = 0; depth < prefix.length; ++depth) {
+        index = t.rib[index].child[bitAt(prefix.hi, prefix.lo, depth)];
+        if (index == 0) return 0;
+    }
+    return t.rib[index].value;
+}
+
+void Fib::forEach(const std::function<void(const IpPrefix&, Node*)>& fn) const {
+    for (const Table* t : {&m_v4, &m_v6}) {
+        // (węzeł RIB, prefiks) - jawny stos zamiast rekurencji do głębokości 128
+        std::vector<std::pair<uint32_t, IpPrefix>> stack;
+        IpPrefix root;
+        root.v6 = t == &m_v6;
+        stack.push_back({0, root});
+        while (!stack.empty()) {
+            auto [index, prefix] = stack.back();
+            stack.pop_back();
+            const RibNode& node = t->rib[index];
+            if (node.value != 0) fn(prefix, resolve(node.value, 0));
+            for (int bit = 1; bit >= 0; --bit) {
+                if (node.child[bit] == 0) continue;
+                IpPrefix child = prefix;
+                if (bit) setBit(child.hi, child.lo, prefix.length);
+                child.length++;
+                stack.push_back({node.child[bit], child});
+            }
+        }
+    }
+}
+
+void Fib::remapNextHops(const std::function<Node*(Node*)>& peer) {
+    m_nextHopIds.clear();
+    for (NextHopId id = 1; id < m_nextHops.size(); ++id) {
+        if (m_nextHops[id]) m_nextHops[id] = peer(m_nextHops[id]);
+        m_nextHopIds.emplace(m_nextHops[id], id);
+    }
+}
+
+// --- Grupy ECMP/WCMP ---
+
+Fib::GroupId Fib::addGroup(const std::vector<GroupMember>& members, uint32_t buckets) {
+    if (m_groups.size() >= GroupFlag) throw std::runtime_error("Too many next-hop groups");
+    if (buckets == 0) {
+        uint64_t total = 0;
+        for (const GroupMember& m : members) total += m.weight;
+        buckets = static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(64, 16 * total), MaxGroupBuckets));
+    }
+    size_t size = 1;
+    while (size < buckets && size < MaxGroupBuckets) size <<= 1;
+
+    Group g;
+    g.buckets.assign(size, NoRoute);
+    g.owner.assign(size, NoOwner);
+    g.mask = static_cast<uint32_t>(size - 1);
+    m_groups.push_back(std::move(g));
+    GroupId id = static_cast<GroupId>(m_groups.size() - 1);
+    setGroupMembers(id, members);
+    return id;
+}
+
+void Fib::setGroupMembers(GroupId group, const std::vector<GroupMember>& members) {
+    if (group >= m_groups.size()) throw std::runtime_error("Unknown next-hop group: " + std::to_string(group));
+    Group& g = m_groups[group];
+
+    // Nowy skład (powtórzony next hop sumuje wagi); liczniki i kubełki idą za next hopem
+    std::vector<NextHopId> hops;
+    std::vector<uint32_t> weights;
+    for (const GroupMember& m : members) {
+        NextHopId hop = internNextHop(m.nextHop);
+        auto it = std::find(hops.begin(), hops.end(), hop);
+        if (it != hops.end()) {
+            weights[it - hops.begin()] += m.weight;
+        } else {
+            hops.push_back(hop);
+            weights.push_back(m.weight);
+        }
+    }
+    std::vector<uint32_t> remap(g.members.size(), NoOwner);
+    std::vector<uint64_t> packets(hops.size(), 0), bytes(hops.size(), 0);
+    for (size_t old = 0; old < g.members.size(); ++old) {
+        auto it = std::find(hops.begin(), hops.end(), g.members[old]);
+        if (it == hops.end()) continue;
+        size_t index = it - hops.begin();
+        remap[old] = static_cast<uint32_t>(index);
+        packets[index] = g.packets[old];
+        bytes[index] = g.bytes[old];
+    }
+    for (uint32_t& owner : g.owner)
+        if (owner != NoOwner) owner = remap[owner];
+    g.members = std::move(hops);
+    g.weights = std::move(weights);
+    g.packets = std::move(packets);
+    g.bytes = std::move(bytes);
+    assignBuckets(g);
+}
+
+void Fib::assignBuckets(Group& g) {
+    const size_t size = g.buckets.size(), count = g.members.size();
+    uint64_t total = 0;
+    for (uint32_t w : g.weights) total += w;
+    if (total == 0) {
+        std::fill(g.buckets.begin(), g.buckets.end(), NoRoute);
+        std::fill(g.owner.begin(), g.owner.end(), NoOwner);
+        return;
+    }
+
+    // Udziały proporcjonalne do wag, reszta kubełków wg największych reszt
+    std::vector<uint32_t> quota(count), order(count), held(count, 0);
+    size_t assigned = 0;
+    for (size_t i = 0; i < count; ++i) {
+        quota[i] = static_cast<uint32_t>(size * g.weights[i] / total);
+        assigned += quota[i];
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return size * g.weights[a] % total > size * g.weights[b] % total;
+    });
+    for (size_t k = 0; assigned < size; ++k, ++assigned) quota[order[k]]++;
+
+    // Kubełek zostaje u właściciela, dopóki ten mieści się w udziale; reszta trafia do niedoborów
+    for (uint32_t& owner : g.owner) {
+        if (owner != NoOwner && held[owner] < quota[owner]) held[owner]++;
+        else owner = NoOwner;
+    }
+    size_t next = 0;
+    for (size_t b = 0; b < size; ++b) {
+        if (g.owner[b] == NoOwner) {
+            while (held[next] >= quota[next]) ++next;
+            g.owner[b] = static_cast<uint32_t>(next);
+            held[next]++;
+        }
+        g.buckets[b] = g.members[g.owner[b]];
+    }
+}
+
+void Fib::insertGroup(const IpPrefix& prefix, GroupId group) {
+    if (group >= m_groups.size()) throw std::runtime_error("Unknown next-hop group: " + std::to_string(group));
+    set(prefix, GroupFlag | group);
+    markDirty(table(prefix), prefix);
+}
+
+bool Fib::groupAt(const IpPrefix& prefix, GroupId& group) const {
+    NextHopId value = exact(prefix);
+    if (!(value & GroupFlag)) return false;
+    group = value & ~GroupFlag;
+    return true;
+}
+
+std::vector<Fib::GroupMemberStats> Fib::groupStats(GroupId group) const {
+    const Group& g = m_groups.at(group);
+    std::vector<GroupMemberStats> out;
+    for (size_t i = 0; i < g.members.size(); ++i)
+        out.push_back({m_nextHops[g.members[i]], g.weights[i], 0, g.packets[i], g.bytes[i]});
+    for (uint32_t owner : g.owner)
+        if (owner != NoOwner) out[owner].buckets++;
+    return out;
+}
+
+Node* Fib::forward(const IpPrefix& address, uint32_t flowHash, uint32_t bytes) {
+    return forwardId(lookupId(address), flowHash, bytes);
+}
+
+Node* Fib::forwardId(NextHopId id, uint32_t flowHash, uint32_t bytes) {
+    if (id & GroupFlag) {
+        Group& g = m_groups[id & ~GroupFlag];
+        uint32_t bucket = flowHash & g.mask;
+        uint32_t owner = g.owner[bucket];
+        if (owner != NoOwner) {
+            g.packets[owner]++;
+            g.bytes[owner] += bytes;
+        }
+        id = g.buckets[bucket];
+    }
+    return m_nextHops[id];
+}
+
+// --- Kompilacja Poptrie ---
+
+uint32_t Fib::subtree(const Table& t, uint32_t ribIndex, unsigned depth, NextHopId inherited) {
+    const RibNode& node = t.rib[ribIndex];
+    if (node.child[0] == 0 && node.child[1] == 0) return LeafFlag | inherited;
+    uint32_t index = static_cast<uint32_t>(t.nodes.size());
+    t.nodes.emplace_back();
+    PtNode built = buildNode(t, ribIndex, depth, inherited);
+    t.nodes[index] = built;
+    return index;
+}
+
+Fib::PtNode Fib::buildNode(const Table& t, uint32_t ribIndex, unsigned depth, NextHopId inherited) {
+    // Dzieci 0..63 węzła: węzeł RIB na głębokości depth + Stride (0 = brak) i dziedziczony next hop
+    uint32_t childRib[64];
+    NextHopId childValue[64];
+    struct Frame {
+        uint32_t rib;
+        unsigned level;
+        unsigned bits;
+        NextHopId value;
+    };
+    Frame stack[2 * Stride + 2];
+    int top = 0;
+    stack[top++] = {ribIndex, 0, 0, inherited};
+    while (top > 0) {
+        Frame f = stack[--top];
+        if (f.level == Stride) {
+            childRib[f.bits] = f.rib;
+            childValue[f.bits] = f.value;
+            continue;
+        }
+        const RibNode& node = t.rib[f.rib];
+        for (unsigned bit = 0; bit < 2; ++bit) {
+            unsigned bits = f.bits << 1 | bit;
+            uint32_t child = node.child[bit];
+            if (child == 0) {
+                unsigned span = 1u << (Stride - f.level - 1);
+                std::fill(childRib + bits * span, childRib + (bits + 1) * span, 0u);
+                std::fill(childValue + bits * span, childValue + (bits + 1) * span, f.value);
+            } else {
+                NextHopId value = t.rib[child].value ? t.rib[child].value : f.value;
+                stack[top++] = {child, f.level + 1, bits, value};
+            }
+        }
+    }
+
+    PtNode result;
+    result.base1 = static_cast<uint32_t>(t.nodes.size());
+    result.base0 = static_cast<uint32_t>(t.leaves.size());
+    bool internal[64];
+    bool first = true;
+    NextHopId previous = 0;
+    for (unsigned i = 0; i < 64; ++i) {
+        const RibNode* node = childRib[i] ? &t.rib[childRib[i]] : nullptr;
+        internal[i] = node && (node->child[0] || node->child[1]);
+        if (internal[i]) {
+            result.vector |= 1ull << i;
+        } else if (first || childValue[i] != previous) {
+            result.leafvec |= 1ull << i;
+            t.leaves.push_back(childValue[i]);
+            previous = childValue[i];
+            first = false;
+        }
+    }
+    t.nodes.resize(t.nodes.size() + static_cast<size_t>(__builtin_popcountll(result.vector)));
+    uint32_t slot = result.base1;
+    for (unsigned i = 0; i < 64; ++i) {
+        if (!internal[i]) continue;
+        PtNode child = buildNode(t, childRib[i], depth + Stride, childValue[i]);
+        t.nodes[slot++] = child;
+    }
+    return result;
+}
+
+void Fib::fillTop(const Table& t, uint32_t ribIndex, unsigned depth, uint32_t bits, NextHopId inherited) {
+    if (depth == t.directBits) {
+        t.top[bits] = subtree(t, ribIndex, depth, inherited);
+        return;
+    }
+    const RibNode& node = t.rib[ribIndex];
+    for (unsigned bit = 0; bit < 2; ++bit) {
+        uint32_t next = bits << 1 | bit;
+        uint32_t child = node.child[bit];
+        if (child == 0) {
+            uint32_t span = 1u << (t.directBits - depth - 1);
+            std::fill(t.top.begin() + next * span, t.top.begin() + (next + 1) * span, LeafFlag | inherited);
+        } else {
+            fillTop(t, child, depth + 1, next, t.rib[child].value ? t.rib[child].value : inherited);
+        }
+    }
+}
+
+void Fib::compile(const Table& t) {
+    if (!t.dirty()) return;
+    unsigned directBits = directBitsFor(t.routes);
+    if (directBits != t.directBits || t.nodes.size() + t.leaves.size() > 2 * t.compactSize + 4096)
+        t.fullRebuild = true;
+
+    if (t.fullRebuild) {
+        t.directBits = directBits;
+        t.nodes.clear();
+        t.leaves.clear();
+        t.top.assign(size_t(1) << directBits, LeafFlag);
+        fillTop(t, 0, 0, 0, t.rib[0].value);
+        t.compactSize = t.nodes.size() + t.leaves.size();
+        t.fullRebuild = false;
+        t.dirtySlots.clear();
+        return;
+    }
+
+    // Tylko poddrzewa zmienionych slotów; stare węzły zostają jako śmieci do pełnej kompilacji
+    std::sort(t.dirtySlots.begin(), t.dirtySlots.end());
+    t.dirtySlots.erase(std::unique(t.dirtySlots.begin(), t.dirtySlots.end()), t.dirtySlots.end());
+    for (uint32_t slot : t.dirtySlots) {
+        uint32_t index = 0;
+        NextHopId value = t.rib[0].value;
+        unsigned depth = 0;
+        for (; depth < t.directBits; ++depth) {
+            index = t.rib[index].child[(slot >> (t.directBits - 1 - depth)) & 1];
+            if (index == 0) break;
+            if (t.rib[index].value) value = t.rib[index].value;
+        }
+        t.top[slot] = depth < t.directBits ? LeafFlag | value : subtree(t, index, depth, value);
+    }
+    t.dirtySlots.clear();
+}
+
+void Fib::compile() const {
+    compile(m_v4);
+    compile(m_v6);
+}
+
+// --- Wyszukiwanie ---
+
+Fib::NextHopId Fib::find(const Table& t, uint64_t hi, uint64_t lo) {
+    uint32_t entry = t.top[chunk(hi, lo, 0, t.directBits)];
+    if (entry & LeafFlag) return entry & ~LeafFlag;
+    const PtNode* node = &t.nodes[entry];
+    for (unsigned offset = t.directBits;; offset += Stride) {
+        unsigned v = chunk(hi, lo, offset, Stride);
+        uint64_t mask = (2ull << v) - 1;   // bity 0..v (dla v = 63 przepełnienie daje same jedynki)
+        if (!(node->vector >> v & 1))
+            return t.leaves[node->base0 + static_cast<uint32_t>(__builtin_popcountll(node->leafvec & mask)) - 1];
+        node = &t.nodes[node->base1 + static_cast<uint32_t>(__builtin_popcountll(node->vector & mask)) - 1];
+    }
+}
+
+Fib::NextHopId Fib::lookupId(const IpPrefix& address) const {
+    const Table& t = table(address);
+    if (t.dirty()) compile(t);
+    return find(t, address.hi, address.lo);
+}
+
+Node* Fib::lookup4(uint32_t address) const {
+    if (m_v4.dirty()) compile(m_v4);
+    return resolve(find(m_v4, uint64_t(address) << 32, 0), 0);
+}
+
+void Fib::walkLanes(const Table* const* tables, const uint64_t* hi, const uint64_t* lo, size_t count, NextHopId* out) {
+    const PtNode* node[Lanes];
+    unsigned offset[Lanes];
+    unsigned active[Lanes];
+    size_t live = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Table& t = *tables[i];
+        uint32_t entry = t.top[chunk(hi[i], lo[i], 0, t.directBits)];
+        if (entry & LeafFlag) {
+            out[i] = entry & ~LeafFlag;
+            continue;
+        }
+        node[i] = &t.nodes[entry];
+        offset[i] = t.directBits;
+        __builtin_prefetch(node[i]);
+        active[live++] = static_cast<unsigned>(i);
+    }
+    // Każda runda robi jeden krok we wszystkich aktywnych adresach - ich chybienia w cache się nakładają
+    while (live > 0) {
+        size_t next = 0;
+        for (size_t k = 0; k < live; ++k) {
+            unsigned i = active[k];
+            const Table& t = *tables[i];
+            unsigned v = chunk(hi[i], lo[i], offset[i], Stride);
+            uint64_t mask = (2ull << v) - 1;
+            const PtNode* n = node[i];
+            if (!(n->vector >> v & 1)) {
+                out[i] = t.leaves[n->base0 + static_cast<uint32_t>(__builtin_popcountll(n->leafvec & mask)) - 1];
+                continue;
+            }
+            node[i] = &t.nodes[n->base1 + static_cast<uint32_t>(__builtin_popcountll(n->vector & mask)) - 1];
+            offset[i] += Stride;
+            __builtin_prefetch(node[i]);
+            active[next++] = i;
+        }
+        live = next;
+    }
+}
+
+void Fib::lookupBatch4(const uint32_t* addresses, size_t count, Node** out) const {
+    if (m_v4.dirty()) compile(m_v4);
+    const Table* tables[Lanes];
+    uint64_t hi[Lanes], lo[Lanes] = {};
+    NextHopId ids[Lanes];
+    std::fill(tables, tables + Lanes, &m_v4);
+    for (size_t base = 0; base < count; base += Lanes) {
+        size_t n = std::min(Lanes, count - base);
+        for (size_t i = 0; i < n; ++i) hi[i] = uint64_t(addresses[base + i]) << 32;
+        walkLanes(tables, hi, lo, n, ids);
+        for (size_t i = 0; i < n; ++i) out[base + i] = resolve(ids[i], 0);
+    }
+}
+
+void Fib::lookupBatch(const IpPrefix* addresses, size_t count, Node** out) const {
+    compile();
+    const Table* tables[Lanes];
+    uint64_t hi[Lanes], lo[Lanes];
+    NextHopId ids[Lanes];
+    for (size_t base = 0; base < count; base += Lanes) {
+        size_t n = std::min(Lanes, count - base);
+        for (size_t i = 0; i < n; ++i) {
+            tables[i] = &table(addresses[base + i]);
+            hi[i] = addresses[base + i].hi;
+            lo[i] = addresses[base + i].lo;
+        }
+        walkLanes(tables, hi, lo, n, ids);
+        for (size_t i = 0; i < n; ++i) out[base + i] = resolve(ids[i], 0);
+    }
+}
+
+void Fib::forwardBatch(const IpPrefix* addresses, const uint32_t* flowHashes, const uint32_t* bytes,
+                       size_t count, Node** out) {
+    compile();
+    const Table* tables[Lanes];
+    uint64_t hi[Lanes], lo[Lanes];
+    NextHopId ids[Lanes];
+    for (size_t base = 0; base < count; base += Lanes) {
+        size_t n = std::min(Lanes, count - base);
+        for (size_t i = 0; i < n; ++i) {
+            tables[i] = &table(addresses[base + i]);
+            hi[i] = addresses[base + i].hi;
+            lo[i] = addresses[base + i].lo;
+        }
+        walkLanes(tables, hi, lo, n, ids);
+        for (size_t i = 0; i < n; ++i)
+            out[base + i] = forwardId(ids[i], flowHashes[base + i], bytes ? bytes[base + i] : 0);
+    }
+}
+
+Fib::Stats Fib::stats() const {
+    compile();
+    Stats s;
+    s.routes = size();
+    for (const Table* t : {&m_v4, &m_v6}) {
+        s.trieNodes += t->nodes.size();
+        s.leaves += t->leaves.size();
+        s.memoryBytes += t->top.size() * sizeof(uint32_t) + t->nodes.size() * sizeof(PtNode) +
+                         t->leaves.size() * sizeof(NextHopId);
+    }
+    return s;
+}
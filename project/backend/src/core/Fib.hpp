@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "IpAddress.hpp"
+
+class Node;
+
+/**
+ * @brief Flow identity used to pick a member of an ECMP group
+ *
+ * Addresses are any 64-bit identity of the endpoints (an IPv4 address, a
+ * folded IPv6 address or an interned node name).
+ */
+struct FlowKey {
+    uint64_t src = 0;
+    uint64_t dst = 0;
+    uint16_t srcPort = 0;
+    uint16_t dstPort = 0;
+    uint8_t protocol = 0;
+};
+
+// Szybki hash 5-krotki; seed różny na każdym routerze, żeby kolejne skoki nie wybierały tak samo
+inline uint32_t flowHash(const FlowKey& key, uint32_t seed = 0) {
+    auto mix = [](uint64_t x) {
+        x ^= x >> 32;
+        x *= 0xd6e8feb86659fd93ull;
+        x ^= x >> 32;
+        return x;
+    };
+    uint64_t ports = uint64_t(key.srcPort) << 24 | uint64_t(key.dstPort) << 8 | key.protocol;
+    uint64_t h = mix(key.src ^ (uint64_t(seed) << 32 | seed) ^ 0x9e3779b97f4a7c15ull);
+    h = mix(h ^ key.dst);
+    h = mix(h ^ ports);
+    return static_cast<uint32_t>(h);
+}
+
+/**
+ * @brief Longest-prefix-match forwarding table for IPv4 and IPv6 routes
+ *
+ * Routes are kept in a binary trie (the RIB) and compiled into a Poptrie
+ * per address family: a direct-pointing array on the first 2 bits (14 bits
+ * from DirectThreshold routes, 20 past 64k routes) followed by 64-ary nodes
+ * with a child bitmap and a leaf bitmap, where runs of equal leaves are
+ * stored once and a child is found with one popcount. The direct bits are
+ * chosen so that /32 and /128 end exactly on a node boundary. A lookup is a handful of dependent
+ * loads from a few compact arrays, independent of the table size.
+ *
+ * Changes are compiled lazily by the next lookup (or compile()). A change
+ * of a prefix at least as long as the direct bits rebuilds only the
+ * subtree of its slot; shorter prefixes and crossing a size threshold
+ * rebuild the family. Lookups are not thread-safe against
+ * modifications - call compile() before sharing a changed table.
+ *
+ * A route can point at an ECMP/WCMP next-hop group instead of a single
+ * next hop. A group is a power-of-two table of buckets, each owned by one
+ * member in proportion to its weight, and a flow hash picks the bucket, so
+ * a packet of a load-balanced route costs one extra load. Membership
+ * changes are resilient: buckets of remaining members stay in place and
+ * only the buckets of removed members, or the surplus of members whose
+ * share shrank, move - a change of one member of n remaps about 1/n of
+ * the flows. forward() counts packets and bytes per member.
+ */
+class Fib {
+public:
+    using NextHopId = uint32_t;                  // indeks w tablicy next hopów, 0 = brak trasy
+    static constexpr NextHopId NoRoute = 0;
+    static constexpr size_t DirectThreshold = 16384;
+
+    using GroupId = uint32_t;
+
+    struct Route {
+        IpPrefix prefix;
+        Node* nextHop;
+    };
+
+    struct GroupMember {
+        Node* nextHop;
+        uint32_t weight = 1;                     // 0 = członek bez ruchu (drenowany)
+    };
+
+    struct GroupMemberStats {
+        Node* nextHop;
+        uint32_t weight;
+        uint32_t buckets;
+        uint64_t packets;
+        uint64_t bytes;
+    };
+
+    struct Stats {
+        size_t routes = 0;
+        size_t trieNodes = 0;                    // węzły Poptrie obu rodzin
+        size_t leaves = 0;
+        size_t memoryBytes = 0;                  // skompilowane struktury (bez RIB)
+    };
+
+    Fib();
+
+    // Nadpisuje trasę o tym samym prefiksie; nextHop == nullptr to trasa bez next hopu
+    void insert(const IpPrefix& prefix, Node* nextHop);
+    // Jedna kompilacja na całą paczkę - dla tablic z dziesiątkami tysięcy prefiksów
+    void insertBulk(const std::vector<Route>& routes);
+    bool remove(const IpPrefix& prefix);
+    void clear();
+
+    // Dokładne dopasowanie prefiksu (nie LPM)
+    bool contains(const IpPrefix& prefix) const;
+    size_t size() const { return m_v4.routes + m_v6.routes; }
+
+    // Grupa ECMP/WCMP; buckets = 0 dobiera rozmiar do wag (zaokrąglany do potęgi dwójki, stały)
+    GroupId addGroup(const std::vector<GroupMember>& members, uint32_t buckets = 0);
+    // Odporna zmiana składu: przepływy pozostałych członków zostają na miejscu
+    void setGroupMembers(GroupId group, const std::vector<GroupMember>& members);
+    void insertGroup(const IpPrefix& prefix, GroupId group);
+    // Grupa, na którą wskazuje dokładnie ten prefiks; false dla trasy zwykłej lub jej braku
+    bool groupAt(const IpPrefix& prefix, GroupId& group) const;
+    size_t groupCount() const { return m_groups.size(); }
+    // Rzuca std::out_of_range dla nieznanej grupy
+    std::vector<GroupMemberStats> groupStats(GroupId group) const;
+
+    // Longest prefix match; nullptr gdy nic nie pasuje. Trasa-grupa bez hasha daje członka kubełka 0
+    Node* lookup(const IpPrefix& address) const { return resolve(lookupId(address), 0); }
+    Node* lookup(const IpPrefix& address, uint32_t flowHash) const { return resolve(lookupId(address), flowHash); }
+    // Jak lookup, ale liczy pakiet i bajty członka grupy (przekazywanie pakietu)
+    Node* forward(const IpPrefix& address, uint32_t flowHash, uint32_t bytes = 0);
+    Node* lookup4(uint32_t address) const;
+    NextHopId lookupId(const IpPrefix& address) const;
+    // Paczki adresów przechodzą trie równolegle, więc chybienia w cache nakładają się
+    void lookupBatch4(const uint32_t* addresses, size_t count, Node** out) const;
+    void lookupBatch(const IpPrefix* addresses, size_t count, Node** out) const;
+    // forward() dla paczki; bytes może być nullptr
+    void forwardBatch(const IpPrefix* addresses, const uint32_t* flowHashes, const uint32_t* bytes,
+                      size_t count, Node** out);
+
+    void forEach(const std::function<void(const IpPrefix&, Node*)>& fn) const;
+    void remapNextHops(const std::function<Node*(Node*)>& peer);
+    void compile() const;
+    Stats stats() const;
+
+private:
+    struct RibNode {
+        uint32_t child[2] = {0, 0};              // 0 = brak (korzeń ma indeks 0)
+        NextHopId value = 0;
+    };
+
+    struct PtNode {
+        uint64_t vector = 0;                     // dzieci będące węzłami
+        uint64_t leafvec = 0;                    // początki serii równych liści
+        uint32_t base0 = 0;                      // pierwszy liść
+        uint32_t base1 = 0;                      // pierwsze dziecko-węzeł
+    };
+
+    struct Table {
+        unsigned width;
+        std::vector<RibNode> rib;
+        size_t routes = 0;
+
+        // Skompilowany Poptrie, odbudowywany przez compile()
+        mutable std::vector<uint32_t> top;       // LeafFlag | next hop albo indeks węzła
+        mutable std::vector<PtNode> nodes;
+        mutable std::vector<NextHopId> leaves;
+        mutable unsigned directBits = 2;
+        mutable bool fullRebuild = true;
+        mutable std::vector<uint32_t> dirtySlots;
+        mutable size_t compactSize = 0;          // węzły + liście po pełnej kompilacji
+
+        explicit Table(unsigned width) : width(width), rib(1) {}
+        bool dirty() const { return fullRebuild || !dirtySlots.empty(); }
+    };
+
+    struct Group {
+        std::vector<NextHopId> buckets;          // kubełek -> next hop
+        std::vector<uint32_t> owner;             // kubełek -> indeks członka
+        std::vector<NextHopId> members;
+        std::vector<uint32_t> weights;
+        std::vector<uint64_t> packets;
+        std::vector<uint64_t> bytes;
+        uint32_t mask = 0;
+    };
+
+    static constexpr uint32_t LeafFlag = 0x80000000u;
+    static constexpr NextHopId GroupFlag = 0x40000000u;   // wartość trasy wskazująca grupę
+    static constexpr uint32_t NoOwner = UINT32_MAX;
+
+    Table m_v4{32};
+    Table m_v6{128};
+    std::vector<Node*> m_nextHops;               // [0] = nullptr
+    std::unordered_map<Node*, NextHopId> m_nextHopIds;
+    std::vector<Group> m_groups;
+
+    Node* resolve(NextHopId id, uint32_t flowHash) const {
+        if (id & GroupFlag) {
+            const Group& g = m_groups[id & ~GroupFlag];
+            id = g.buckets[flowHash & g.mask];
+        }
+        return m_nextHops[id];
+    }
+    Node* forwardId(NextHopId id, uint32_t flowHash, uint32_t bytes);
+    static void assignBuckets(Group& g);
+
+    Table& table(const IpPrefix& prefix) { return prefix.v6 ? m_v6 : m_v4; }
+    const Table& table(const IpPrefix& prefix) const { return prefix.v6 ? m_v6 : m_v4; }
+    NextHopId internNextHop(Node* nextHop);
+    // value 0 usuwa; zwraca czy trasa istniała. path (opcjonalna): węzły RIB na kolejnych
+    // głębokościach, aktualne do głębokości from - wstawianie posortowanych tras nie schodzi od korzenia
+    bool set(const IpPrefix& prefix, NextHopId value, uint32_t* path = nullptr, unsigned from = 0);
+    NextHopId exact(const IpPrefix& prefix) const;   // wartość trasy o dokładnie tym prefiksie, 0 gdy brak
+    static void markDirty(Table& t, const IpPrefix& prefix);
+
+    static void compile(const Table& t);
+    static uint32_t subtree(const Table& t, uint32_t ribIndex, unsigned depth, NextHopId inherited);
+    static PtNode buildNode(const Table& t, uint32_t ribIndex, unsigned depth, NextHopId inherited);
+    static void fillTop(const Table& t, uint32_t ribIndex, unsigned depth, uint32_t bits, NextHopId inherited);
+    static NextHopId find(const Table& t, uint64_t hi, uint64_t lo);
+    // Do Lanes adresów naraz, każdy w tablicy swojej rodziny
+    static constexpr size_t Lanes = 8;
+    static void walkLanes(const Table* const* tables, const uint64_t* hi, const uint64_t* lo, size_t count, NextHopId* out);
+};
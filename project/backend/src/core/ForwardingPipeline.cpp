@@ -0,0 +1,228 @@
+#include "ForwardingPipeline.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+ForwardingPipeline::ForwardingPipeline(Network& net)
+    : m_net(net), m_graph(GraphSnapshot::fromNetwork(net))
+{
+    size_t n = m_graph.nodeCount();
+    m_nodes.assign(n, nullptr);
+    m_routers.assign(n, nullptr);
+    m_seeds.assign(n, 0);
+    m_gateway.assign(n, NoNode);
+    for (NodeId id = 0; id < n; ++id) {
+        if (!m_graph.present[id]) continue;
+        Node* node = net.findById(id).get();
+        m_nodes[id] = node;
+        m_routers[id] = dynamic_cast<Router*>(node);
+        if (m_routers[id]) m_seeds[id] = m_routers[id]->flowSeed();
+        m_byEndpoint.emplace(Endpoint(node->getName()).id(), id);
+        if (!node->getIp().empty()) m_byEndpoint.emplace(Endpoint(node->getIp()).id(), id);
+    }
+    for (NodeId id = 0; id < n; ++id) {
+        if (!m_nodes[id] || m_routers[id]) continue;
+        for (uint32_t arc = m_graph.offsets[id]; arc < m_graph.offsets[id + 1]; ++arc) {
+            if (m_routers[m_graph.targets[arc]]) {
+                m_gateway[id] = m_graph.targets[arc];
+                break;
+            }
+        }
+    }
+}
+
+NodeId ForwardingPipeline::resolve(Endpoint endpoint) const
+{
+    auto it = m_byEndpoint.find(endpoint.id());
+    if (it != m_byEndpoint.end()) return it->second;
+    // Inny zapis tego samego adresu (np. IPv6) - indeks IPAM sieci
+    auto node = endpoint.ip().empty() ? nullptr : m_net.findByIp(endpoint.ip());
+    return node ? node->getId() : NoNode;
+}
+
+uint32_t ForwardingPipeline::allocate(const Packet& p)
+{
+    uint32_t slot;
+    if (!m_free.empty()) {
+        slot = m_free.back();
+        m_free.pop_back();
+        m_packets[slot] = p;
+    } else {
+        slot = static_cast<uint32_t>(m_packets.size());
+        m_packets.push_back(p);
+        m_at.push_back(NoNode);
+        m_next.push_back(NoNode);
+        m_dest.push_back(NoNode);
+        m_address.emplace_back();
+        m_flags.push_back(0);
+    }
+    m_dest[slot] = resolve(p.dest);
+    m_address[slot] = p.dest.ip().prefix();
+    m_flags[slot] = p.dest.ip().empty() ? 0 : HasAddress;
+    return slot;
+}
+
+void ForwardingPipeline::inject(const Packet& p)
+{
+    inject(p, p.src);
+}
+
+void ForwardingPipeline::inject(const Packet& p, const std::string& at)
+{
+    NodeId node = resolve(Endpoint(at));
+    if (node == NoNode) throw std::runtime_error("Node not found: " + at);
+    uint32_t slot = allocate(p);
+    m_at[slot] = node;
+    m_queue.push_back(slot);
+    m_stats.injected++;
+}
+
+size_t ForwardingPipeline::run()
+{
+    uint64_t finishedBefore = m_stats.delivered + m_stats.dropped();
+    // Runda = wszystko, co czeka w kolejce egress; pakiety przekazane dalej trafiają do następnej
+    while (!m_queue.empty()) {
+        m_round.swap(m_queue);
+        m_queue.clear();
+        for (size_t base = 0; base < m_round.size(); base += BatchSize)
+            processFrame(m_round.data() + base, std::min(BatchSize, m_round.size() - base));
+    }
+    return static_cast<size_t>(m_stats.delivered + m_stats.dropped() - finishedBefore);
+}
+
+void ForwardingPipeline::processFrame(const uint32_t* frame, size_t count)
+{
+    m_stats.batches++;
+    m_routedCount = 0;
+    m_egressCount = 0;
+    ingress(frame, count);
+    ttlAcl();
+    fibLookup();
+    egress();
+}
+
+void ForwardingPipeline::ingress(const uint32_t* frame, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t slot = frame[i];
+        NodeId at = m_at[slot];
+        if (m_dest[slot] == at) {
+            m_stats.delivered++;
+            if (m_onDeliver) m_onDeliver(m_packets[slot], *m_nodes[at]);
+            release(slot);
+        } else if (m_graph.failed[at]) {
+            m_stats.droppedFailed++;
+            release(slot);
+        } else if (m_routers[at]) {
+            m_routed[m_routedCount++] = slot;
+        } else if (!(m_flags[slot] & LeftSource) && m_gateway[at] != NoNode) {
+            // Host wysyła do celu, gdy jest sąsiadem, inaczej do swojego routera
+            NodeId dest = m_dest[slot];
+            bool adjacent = dest != NoNode && m_graph.findArc(at, dest) != GraphSnapshot::InvalidArc;
+            m_next[slot] = adjacent ? dest : m_gateway[at];
+            m_toEgress[m_egressCount++] = slot;
+        } else {
+            m_stats.noRoute++;
+            release(slot);
+        }
+    }
+}
+
+bool ForwardingPipeline::allowed(uint32_t slot)
+{
+    const Packet& p = m_packets[slot];
+    AclKey key{p.src.id(), p.dest.id(), p.type.code()};
+    auto it = m_acl.find(key);
+    if (it != m_acl.end()) return it->second;
+    // Reguły zapory są po nazwach węzłów; nadawca lub cel spoza sieci nie ma reguły
+    NodeId src = resolve(p.src);
+    NodeId dst = m_dest[slot];
+    bool verdict = src == NoNode || dst == NoNode ||
+                   m_net.isAllowed(m_graph.nameOf(src), m_graph.nameOf(dst), p.type);
+    m_acl.emplace(key, verdict);
+    return verdict;
+}
+
+void ForwardingPipeline::ttlAcl()
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < m_routedCount; ++i) {
+        uint32_t slot = m_routed[i];
+        Packet& p = m_packets[slot];
+        if (p.ttl <= 0) {
+            m_stats.droppedTtl++;
+            release(slot);
+            continue;
+        }
+        p.ttl--;
+        if (!(m_flags[slot] & AclChecked)) {
+            m_flags[slot] |= AclChecked;
+            if (!allowed(slot)) {
+                m_stats.droppedAcl++;
+                release(slot);
+                continue;
+            }
+        }
+        m_routed[kept++] = slot;
+    }
+    m_routedCount = kept;
+}
+
+void ForwardingPipeline::fibLookup()
+{
+    // Pakiety jednego routera obok siebie - jedno forwardBatch na router (stabilnie: kolejność przepływów)
+    std::stable_sort(m_routed.begin(), m_routed.begin() + m_routedCount,
+                     [this](uint32_t a, uint32_t b) { return m_at[a] < m_at[b]; });
+
+    IpPrefix addresses[BatchSize];
+    uint32_t hashes[BatchSize], bytes[BatchSize], slots[BatchSize];
+    Node* next[BatchSize];
+    for (size_t begin = 0; begin < m_routedCount;) {
+        NodeId at = m_at[m_routed[begin]];
+        Router& router = *m_routers[at];
+        uint32_t seed = m_seeds[at];
+        size_t n = 0, end = begin;
+        for (; end < m_routedCount && m_at[m_routed[end]] == at; ++end) {
+            uint32_t slot = m_routed[end];
+            const Packet& p = m_packets[slot];
+            uint32_t hash = flowHash(FlowKey{p.src.id(), p.dest.id(), 0, 0, p.protocol.code()}, seed);
+            if (m_flags[slot] & HasAddress) {
+                addresses[n] = m_address[slot];
+                hashes[n] = hash;
+                bytes[n] = static_cast<uint32_t>(p.payload.size());
+                slots[n++] = slot;
+            } else {
+                Node* hop = router.getNextHop(p.dest, hash);
+                if (hop) {
+                    m_next[slot] = hop->getId();
+                    m_toEgress[m_egressCount++] = slot;
+                } else {
+                    m_stats.noRoute++;
+                    release(slot);
+                }
+            }
+        }
+        router.getFib().forwardBatch(addresses, hashes, bytes, n, next);
+        for (size_t i = 0; i < n; ++i) {
+            if (next[i]) {
+                m_next[slots[i]] = next[i]->getId();
+                m_toEgress[m_egressCount++] = slots[i];
+            } else {
+                m_stats.noRoute++;
+                release(slots[i]);
+            }
+        }
+        begin = end;
+    }
+}
+
+void ForwardingPipeline::egress()
+{
+    for (size_t i = 0; i < m_egressCount; ++i) {
+        uint32_t slot = m_toEgress[i];
+        m_nodes[m_at[slot]]->incrementPacketCount();
+        m_at[slot] = m_next[slot];
+        m_flags[slot] |= LeftSource;
+        m_queue.push_back(slot);
+    }
+    m_stats.forwarded += m_egressCount;
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include "Fib.hpp"
+#include "GraphSnapshot.hpp"
+#include "Network.hpp"
+#include "Router.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct PipelineStats {
+    uint64_t injected = 0;
+    uint64_t delivered = 0;
+    uint64_t forwarded = 0;         // skoki (pakiet wysłany do następnego węzła)
+    uint64_t droppedTtl = 0;
+    uint64_t droppedAcl = 0;
+    uint64_t droppedFailed = 0;     // pakiet dotarł do węzła po failNode()
+    uint64_t noRoute = 0;
+    uint64_t batches = 0;           // przetworzone ramki (do BatchSize pakietów)
+
+    uint64_t dropped() const { return droppedTtl + droppedAcl + droppedFailed + noRoute; }
+};
+
+/**
+ * @brief Batched, iterative packet forwarding through Routers (VPP-style)
+ *
+ * Router::receivePacket handles one packet per call and hands it to the next
+ * hop, so every packet runs the whole per-hop code once per router. Here
+ * packets move in frames of up to BatchSize through a fixed graph of stages,
+ * each a tight loop over the frame:
+ *
+ *  - ingress: delivery when the node is the destination, failed nodes drop,
+ *    a host sends a packet it originates to its gateway (the destination
+ *    itself when adjacent, else its first router neighbour);
+ *  - ttl/acl: TTL decrement as in Router::receivePacket, the firewall
+ *    (Network::isAllowed on the node names of src/dest and the packet type)
+ *    checked once per packet at its first router, with verdicts cached;
+ *  - fib: the frame sorted by router, each router's run of IP destinations
+ *    looked up with one Fib::forwardBatch (trie walks interleaved, ECMP
+ *    member counters updated), node-name destinations via getNextHop;
+ *  - egress: the packet count of the sending node, the packet appended to
+ *    the egress queue that feeds the next round of frames.
+ *
+ * Destinations are parsed and resolved to a NodeId once at inject(), and
+ * packet metadata is kept in flat arrays indexed by pool slot, so the stages
+ * touch little beyond the FIB. Packets are processed without recursion,
+ * whatever the path length. The topology (nodes, links, failures) is read
+ * at construction - build a new pipeline after changing it; routes are
+ * read from the Routers' FIBs at forwarding time.
+ */
+class ForwardingPipeline {
+public:
+    static constexpr size_t BatchSize = 256;
+    using DeliveryCallback = std::function<void(const Packet&, Node& at)>;
+
+    explicit ForwardingPipeline(Network& net);
+    ForwardingPipeline(const ForwardingPipeline&) = delete;
+    ForwardingPipeline& operator=(const ForwardingPipeline&) = delete;
+
+    // Pakiet wchodzi w węźle nadawcy (p.src: nazwa albo IP węzła); rzuca std::runtime_error dla nieznanego
+    void inject(const Packet& p);
+    void inject(const Packet& p, const std::string& at);
+    // Przekazuje wszystkie pakiety aż do doręczenia albo odrzucenia; zwraca liczbę zakończonych
+    size_t run();
+    size_t pending() const { return m_queue.size(); }
+
+    void setDeliveryCallback(DeliveryCallback callback) { m_onDeliver = std::move(callback); }
+    const PipelineStats& stats() const { return m_stats; }
+    void resetStats() { m_stats = PipelineStats(); }
+
+private:
+    static constexpr NodeId NoNode = GraphSnapshot::InvalidNode;
+    static constexpr uint8_t HasAddress = 1;       // cel jest adresem IP (m_address)
+    static constexpr uint8_t AclChecked = 2;
+    static constexpr uint8_t LeftSource = 4;       // pakiet opuścił węzeł, w którym wszedł
+
+    struct AclKey {
+        uint32_t src, dst;                          // Endpoint::id() nadawcy i celu
+        uint8_t type;
+        friend bool operator==(const AclKey& a, const AclKey& b) {
+            return a.src == b.src && a.dst == b.dst && a.type == b.type;
+        }
+    };
+    struct AclKeyHash {
+        size_t operator()(const AclKey& k) const { return flowHash(FlowKey{k.src, k.dst, 0, 0, k.type}); }
+    };
+
+    using Frame = std::array<uint32_t, BatchSize>;
+
+    Network& m_net;
+    GraphSnapshot m_graph;
+    std::vector<Node*> m_nodes;                     // NodeId -> węzeł
+    std::vector<Router*> m_routers;                 // NodeId -> router albo nullptr
+    std::vector<uint32_t> m_seeds;                  // NodeId -> ziarno hasha przepływu routera
+    std::vector<NodeId> m_gateway;                  // NodeId -> pierwszy router sąsiad (nie-routery)
+    std::unordered_map<uint32_t, NodeId> m_byEndpoint;   // Endpoint::id() nazwy albo IP -> węzeł
+    std::unordered_map<AclKey, bool, AclKeyHash> m_acl;
+
+    // Pula pakietów: metadane w osobnych tablicach po slocie
+    std::vector<Packet> m_packets;
+    std::vector<NodeId> m_at;
+    std::vector<NodeId> m_next;
+    std::vector<NodeId> m_dest;
+    std::vector<IpPrefix> m_address;
+    std::vector<uint8_t> m_flags;
+    std::vector<uint32_t> m_free;
+
+    std::vector<uint32_t> m_queue;                  // kolejka egress - wejście następnej rundy
+    std::vector<uint32_t> m_round;
+    Frame m_routed, m_toEgress;
+    size_t m_routedCount = 0, m_egressCount = 0;
+
+    PipelineStats m_stats;
+    DeliveryCallback m_onDeliver;
+
+    NodeId resolve(Endpoint endpoint) const;
+    uint32_t allocate(const Packet& p);
+    void release(uint32_t slot) { m_free.push_back(slot); }
+
+    void processFrame(const uint32_t* frame, size_t count);
+    void ingress(const uint32_t* frame, size_t count);
+    void ttlAcl();
+    void fibLookup();
+    void egress();
+    bool allowed(uint32_t slot);
+};
@@ -0,0 +1,85 @@
+#include "GraphSnapshot.hpp"
+#include <algorithm>
+
+GraphSnapshot GraphSnapshot::fromNetwork(const Network& net) {
+    GraphSnapshot g;
+    const size_t n = net.nextNodeId;
+    g.names.assign(n, std::string());
+    g.present.assign(n, 0);
+    g.failed.assign(n, 0);
+
+    for (const auto& node : net.nodes) {
+        NodeId id = node->getId();
+        g.names[id] = node->getName();
+        g.present[id] = 1;
+        g.ids[node->getName()] = id;
+    }
+    for (const auto& name : net.failedNodes) {
+        auto it = g.ids.find(name);
+        if (it != g.ids.end()) g.failed[it->second] = 1;
+    }
+
+    // Zbierz krawędzie jako pary id i ułóż je w CSR
+    std::vector<std::pair<NodeId, NodeId>> arcs;
+    for (const auto& [name, neighbors] : net.adj) {
+        auto itU = g.ids.find(name);
+        if (itU == g.ids.end()) continue;
+        for (const auto& neighbor : neighbors) {
+            auto itV = g.ids.find(neighbor);
+            if (itV == g.ids.end()) continue;
+            arcs.emplace_back(itU->second, itV->second);
+        }
+    }
+    std::sort(arcs.begin(), arcs.end());
+
+    g.offsets.assign(n + 1, 0);
+    for (const auto& arc : arcs) g.offsets[arc.first + 1]++;
+    for (size_t u = 0; u < n; ++u) g.offsets[u + 1] += g.offsets[u];
+    g.targets.resize(arcs.size());
+    for (size_t a = 0; a < arcs.size(); ++a) g.targets[a] = arcs[a].second;
+
+    g.reverse.assign(arcs.size(), InvalidArc);
+    for (size_t a = 0; a < arcs.size(); ++a)
+        g.reverse[a] = g.findArc(arcs[a].second, arcs[a].first);
+
+    g.delayMs.assign(arcs.size(), 0);
+    g.bandwidth.assign(arcs.size(), 0);
+    g.loss.assign(arcs.size(), 0.0);
+
+    // Właściwości łączy są trzymane per kierunek, wpisy po disconnect są pomijane
+    auto arcOf = [&g](const std::pair<std::string, std::string>& link) {
+        auto itA = g.ids.find(link.first);
+        auto itB = g.ids.find(link.second);
+        if (itA == g.ids.end() || itB == g.ids.end()) return InvalidArc;
+        return g.findArc(itA->second, itB->second);
+    };
+    for (const auto& [link, delay] : net.linkDelays) {
+        uint32_t a = arcOf(link);
+        if (a != InvalidArc) g.delayMs[a] = delay;
+    }
+    for (const auto& [link, bw] : net.bandwidths) {
+        uint32_t a = arcOf(link);
+        if (a != InvalidArc) g.bandwidth[a] = bw;
+    }
+    for (const auto& [link, prob] : net.packetLoss) {
+        uint32_t a = arcOf(link);
+        if (a != InvalidArc) g.loss[a] = prob;
+    }
+    return g;
+}
+
+NodeId GraphSnapshot::idOf(const std::string& name) const {
+    auto it = ids.find(name);
+    if (it == ids.end())
+        throw std::runtime_error("Node not found: " + name);
+    return it->second;
+}
+
+uint32_t GraphSnapshot::findArc(NodeId u, NodeId v) const {
+    if (u >= nodeCount()) return InvalidArc;
+    auto begin = targets.begin() + offsets[u];
+    auto end = targets.begin() + offsets[u + 1];
+    auto it = std::lower_bound(begin, end, v);
+    if (it == end || *it != v) return InvalidArc;
+    return static_cast<uint32_t>(it - targets.begin());
+}
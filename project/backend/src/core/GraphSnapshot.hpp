@@ -0,0 +1,45 @@
+#pragma once
+#include "Network.hpp"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Immutable, id-indexed view of the Network graph (CSR layout)
+ *
+ * Rows are indexed by NodeId, so arrays sized getNodeIdBound() can be used
+ * directly by graph algorithms. Every undirected link is stored as two arcs
+ * (u->v and v->u); arcs of a row are sorted by target id and reverse[a]
+ * points at the opposite arc. Ids of removed nodes stay as empty rows.
+ */
+struct GraphSnapshot {
+    static constexpr NodeId InvalidNode = UINT32_MAX;
+    static constexpr uint32_t InvalidArc = UINT32_MAX;
+
+    std::vector<std::string> names;   // NodeId -> nazwa ("" dla usuniętych id)
+    std::vector<uint8_t> present;     // NodeId -> czy węzeł istnieje
+    std::vector<uint8_t> failed;      // NodeId -> failNode()
+    std::vector<uint32_t> offsets;    // wiersz u to arcs [offsets[u], offsets[u+1])
+    std::vector<NodeId> targets;      // arc -> węzeł docelowy
+    std::vector<uint32_t> reverse;    // arc -> arc przeciwny
+    std::vector<int> delayMs;         // arc -> setLinkDelay (0 gdy brak)
+    std::vector<int> bandwidth;       // arc -> setBandwidth (0 gdy brak)
+    std::vector<double> loss;         // arc -> setPacketLoss (0.0 gdy brak)
+
+    static GraphSnapshot fromNetwork(const Network& net);
+
+    size_t nodeCount() const { return names.size(); }
+    size_t arcCount() const { return targets.size(); }
+    uint32_t degree(NodeId u) const { return offsets[u + 1] - offsets[u]; }
+
+    // Rzuca std::runtime_error dla nieznanej nazwy
+    NodeId idOf(const std::string& name) const;
+    const std::string& nameOf(NodeId id) const { return names[id]; }
+    bool isUsable(NodeId id) const { return present[id] && !failed[id]; }
+
+    // Arc u->v albo InvalidArc (wyszukiwanie binarne w wierszu u)
+    uint32_t findArc(NodeId u, NodeId v) const;
+
+private:
+    std::map<std::string, NodeId> ids;
+};
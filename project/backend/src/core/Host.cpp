@@ -1,10 +1,10 @@
 #include "Host.hpp"
 
 Host::Host(const std::string& name, const std::string& address, int port)
-    : Node(name, address), address(address), port(port) {}
+    : Node(name, address), port(port) {}
 
 std::string Host::getAddress() const {
-    return address;
+    return ip;
 }
 
 int Host::getPort() const {
@@ -12,7 +12,7 @@ int Host::getPort() const {
 }
 
 void Host::setAddress(const std::string& address) {
-    this->address = address;
+    setIp(address);
 }
 
 void Host::setPort(int port) {
@@ -21,7 +21,9 @@ void Host::setPort(int port) {
 
 void Host::receivePacket(Packet& p) {
     // TODO: Implement packet handling logic here
-    if (p.dest == address) {
+    // Adresy IP porównywane binarnie (zapisy IPv6 bywają różne), inne adresy jako napisy
+    bool forMe = ipAddress.empty() ? p.dest == ip : p.dest.ip() == ipAddress;
+    if (forMe) {
         packet = p; // Store the received packet
         // Further processing can be done here
         if (packet.ttl > 0) {
@@ -34,7 +36,7 @@ void Host::receivePacket(Packet& p) {
         }
         
 
-        if (packet.dest == ip) {
+        if (forMe) {
             std::cout << "[HOST " << name << "] Received: " << packet.payload << std::endl;
         } else {
             std::cout << "[HOST " << name << "] Packet not for me.\n";
@@ -8,14 +8,15 @@
 class Host : public Node {
     public:
         int port;
-        std::string address;
 
         Host(const std::string& name, const std::string& address, int port);
+        // Adres hosta to adres IP węzła (getIp)
         std::string getAddress() const;
         int getPort() const;
         void setAddress(const std::string& address);
         void setPort(int port);
         std::string getType() const override { return "host"; }
+        std::shared_ptr<Node> clone() const override { return std::make_shared<Host>(*this); }
 
         void receivePacket(Packet& p) override;
         void sendPacket(Packet& p, Node& dest);
@@ -0,0 +1,209 @@
+#include "IpAddress.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+inline void applyMask(IpPrefix& p) {
+    if (p.length == 0) {
+        p.hi = p.lo = 0;
+    } else if (p.length < 64) {
+        p.hi &= ~0ull << (64 - p.length);
+        p.lo = 0;
+    } else if (p.length == 64) {
+        p.lo = 0;
+    } else {
+        p.lo &= ~0ull << (128 - p.length);
+    }
+}
+
+// Liczba dziesiętna 0..max bez zer wiodących poza samym "0"
+bool parseDecimal(const std::string& s, size_t begin, size_t end, unsigned max, unsigned& out) {
+    if (begin >= end || end - begin > 3 || (s[begin] == '0' && end - begin > 1)) return false;
+    unsigned v = 0;
+    for (size_t i = begin; i < end; ++i) {
+        if (s[i] < '0' || s[i] > '9') return false;
+        v = v * 10 + static_cast<unsigned>(s[i] - '0');
+    }
+    if (v > max) return false;
+    out = v;
+    return true;
+}
+
+bool parseIpv4(const std::string& s, size_t begin, size_t end, uint32_t& out) {
+    uint32_t address = 0;
+    for (int part = 0; part < 4; ++part) {
+        size_t dot = part < 3 ? s.find('.', begin) : end;
+        if (dot == std::string::npos || dot > end) return false;
+        unsigned octet;
+        if (!parseDecimal(s, begin, dot, 255, octet)) return false;
+        address = address << 8 | octet;
+        begin = dot + 1;
+    }
+    out = address;
+    return true;
+}
+
+bool parseIpv6(const std::string& s, size_t begin, size_t end, uint64_t& hi, uint64_t& lo) {
+    uint16_t head[8], tail[8];
+    int heads = 0, tails = 0;
+    bool compressed = false;
+    if (s.compare(begin, 2, "::") == 0) {
+        compressed = true;
+        begin += 2;
+    }
+    while (begin < end) {
+        size_t colon = s.find(':', begin);
+        if (colon == std::string::npos || colon > end) colon = end;
+        uint16_t* groups = compressed ? tail : head;
+        int& count = compressed ? tails : heads;
+        if (colon == end && s.find('.', begin) < end) {
+            // Końcowy adres IPv4 (::ffff:10.0.0.1) zajmuje dwie grupy
+            uint32_t v4;
+            if (count > 6 || !parseIpv4(s, begin, end, v4)) return false;
+            groups[count++] = static_cast<uint16_t>(v4 >> 16);
+            groups[count++] = static_cast<uint16_t>(v4);
+            begin = end;
+            break;
+        }
+        if (colon == begin || colon - begin > 4 || count >= 8) return false;
+        unsigned v = 0;
+        for (size_t i = begin; i < colon; ++i) {
+            char c = s[i];
+            int d = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+            if (d < 0) return false;
+            v = v << 4 | static_cast<unsigned>(d);
+        }
+        groups[count++] = static_cast<uint16_t>(v);
+        begin = colon + 1;
+        if (colon < end && begin < end && s[begin] == ':') {
+            if (compressed) return false;
+            compressed = true;
+            begin++;
+        } else if (colon < end && begin == end) {
+            return false;   // ":" na końcu
+        }
+    }
+    if (heads + tails > (compressed ? 7 : 8) || (!compressed && heads != 8)) return false;
+    uint16_t groups[8] = {};
+    std::copy(head, head + heads, groups);
+    std::copy(tail, tail + tails, groups + 8 - tails);
+    hi = lo = 0;
+    for (int i = 0; i < 4; ++i) hi = hi << 16 | groups[i];
+    for (int i = 4; i < 8; ++i) lo = lo << 16 | groups[i];
+    return true;
+}
+
+} // namespace
+
+bool IpPrefix::parse(const std::string& text, IpPrefix& out) {
+    size_t slash = text.find('/');
+    size_t end = slash == std::string::npos ? text.size() : slash;
+    IpPrefix p;
+    if (text.find(':') < end) {
+        if (!parseIpv6(text, 0, end, p.hi, p.lo)) return false;
+        p.v6 = true;
+    } else {
+        uint32_t address;
+        if (!parseIpv4(text, 0, end, address)) return false;
+        p.hi = uint64_t(address) << 32;
+    }
+    unsigned length = p.width();
+    if (slash != std::string::npos && !parseDecimal(text, slash + 1, text.size(), p.width(), length)) return false;
+    p.length = static_cast<uint8_t>(length);
+    applyMask(p);
+    out = p;
+    return true;
+}
+
+IpPrefix IpPrefix::fromIpv4(uint32_t address, uint8_t length) {
+    IpPrefix p;
+    p.hi = uint64_t(address) << 32;
+    p.length = std::min<uint8_t>(length, 32);
+    applyMask(p);
+    return p;
+}
+
+std::string IpPrefix::str() const {
+    char buffer[64];
+    std::string out;
+    if (!v6) {
+        uint32_t a = ipv4();
+        std::snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", a >> 24, (a >> 16) & 255, (a >> 8) & 255, a & 255);
+        out = buffer;
+    } else {
+        uint16_t groups[8];
+        for (int i = 0; i < 4; ++i) groups[i] = static_cast<uint16_t>(hi >> (48 - 16 * i));
+        for (int i = 0; i < 4; ++i) groups[4 + i] = static_cast<uint16_t>(lo >> (48 - 16 * i));
+        // Najdłuższa seria (>= 2) zerowych grup jako "::"
+        int bestStart = -1, bestLength = 1;
+        for (int i = 0; i < 8;) {
+            int j = i;
+            while (j < 8 && groups[j] == 0) ++j;
+            if (j - i > bestLength) {
+                bestStart = i;
+                bestLength = j - i;
+            }
+            i = j == i ? i + 1 : j;
+        }
+        for (int i = 0; i < 8; ++i) {
+            if (i == bestStart) {
+                out += "::";
+                i += bestLength - 1;
+                continue;
+            }
+            if (!out.empty() && out.back() != ':') out += ':';
+            std::snprintf(buffer, sizeof(buffer), "%x", groups[i]);
+            out += buffer;
+        }
+    }
+    if (length != width()) out += "/" + std::to_string(length);
+    return out;
+}
+
+bool IpAddress::parse(const std::string& text, IpAddress& out) {
+    IpPrefix p;
+    if (text.find('/') != std::string::npos || !IpPrefix::parse(text, p)) return false;
+    out.hi = p.hi;
+    out.lo = p.lo;
+    out.family = p.v6 ? 6 : 4;
+    return true;
+}
+
+IpAddress IpAddress::fromIpv4(uint32_t address) {
+    IpAddress a;
+    a.hi = uint64_t(address) << 32;
+    a.family = 4;
+    return a;
+}
+
+IpAddress IpAddress::network(const IpPrefix& prefix) {
+    IpAddress a;
+    a.hi = prefix.hi;
+    a.lo = prefix.lo;
+    a.family = prefix.v6 ? 6 : 4;
+    return a;
+}
+
+bool IpAddress::in(const IpPrefix& prefix) const {
+    if (empty() || v6() != prefix.v6) return false;
+    IpPrefix masked{hi, lo, prefix.length, prefix.v6};
+    applyMask(masked);
+    return masked.hi == prefix.hi && masked.lo == prefix.lo;
+}
+
+IpAddress IpAddress::next() const {
+    IpAddress a = *this;
+    if (empty()) return a;
+    if (!v6()) {
+        if (ipv4() == UINT32_MAX) return IpAddress();
+        a.hi += 1ull << 32;
+    } else if (++a.lo == 0 && ++a.hi == 0) {
+        return IpAddress();
+    }
+    return a;
+}
+
+std::string IpAddress::str() const {
+    return empty() ? std::string() : prefix().str();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief IPv4 or IPv6 prefix held as a left-aligned 128-bit key
+ *
+ * IPv4 addresses occupy the top 32 bits of hi. Bits past length are always
+ * zero, so two prefixes are equal when their fields are.
+ */
+struct IpPrefix {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+    uint8_t length = 0;
+    bool v6 = false;
+
+    // "10.0.0.0/8", "10.0.0.1" (= /32), "2001:db8::/32"; false gdy tekst nie jest adresem IP
+    static bool parse(const std::string& text, IpPrefix& out);
+    static IpPrefix fromIpv4(uint32_t address, uint8_t length = 32);
+
+    uint32_t ipv4() const { return static_cast<uint32_t>(hi >> 32); }
+    unsigned width() const { return v6 ? 128 : 32; }
+    std::string str() const;   // adres bez "/len" dla pełnej długości
+
+    friend bool operator==(const IpPrefix& a, const IpPrefix& b) {
+        return a.hi == b.hi && a.lo == b.lo && a.length == b.length && a.v6 == b.v6;
+    }
+};
+
+/**
+ * @brief Packed IPv4 or IPv6 host address
+ *
+ * Same left-aligned 128-bit layout as IpPrefix, so an address is a /32 or
+ * /128 prefix without conversion and compares as an integer. The default
+ * value is "no address": nodes whose ip is empty or a free-form string.
+ * Addresses order by family, then numerically.
+ */
+struct IpAddress {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+    uint8_t family = 0;                          // 0 = brak adresu, 4 albo 6
+
+    // Sam adres, bez "/len"; false gdy tekst nim nie jest
+    static bool parse(const std::string& text, IpAddress& out);
+    static IpAddress fromIpv4(uint32_t address);
+    // Pierwszy adres prefiksu
+    static IpAddress network(const IpPrefix& prefix);
+
+    bool empty() const { return family == 0; }
+    bool v6() const { return family == 6; }
+    uint32_t ipv4() const { return static_cast<uint32_t>(hi >> 32); }
+    IpPrefix prefix() const { return IpPrefix{hi, lo, static_cast<uint8_t>(v6() ? 128 : 32), v6()}; }
+    bool in(const IpPrefix& prefix) const;
+    // Kolejny adres (bez przeniesienia poza rodzinę: ostatni adres daje pusty)
+    IpAddress next() const;
+    std::string str() const;                     // "" dla braku adresu
+
+    friend bool operator==(const IpAddress& a, const IpAddress& b) {
+        return a.hi == b.hi && a.lo == b.lo && a.family == b.family;
+    }
+    friend bool operator!=(const IpAddress& a, const IpAddress& b) { return !(a == b); }
+    friend bool operator<(const IpAddress& a, const IpAddress& b) {
+        if (a.family != b.family) return a.family < b.family;
+        return a.hi != b.hi ? a.hi < b.hi : a.lo < b.lo;
+    }
+};
+
+struct IpAddressHash {
+    size_t operator()(const IpAddress& a) const {
+        uint64_t x = a.hi ^ (a.lo * 0x9e3779b97f4a7c15ull) ^ a.family;
+        x ^= x >> 32;
+        x *= 0xd6e8feb86659fd93ull;
+        return static_cast<size_t>(x ^ (x >> 32));
+    }
+};
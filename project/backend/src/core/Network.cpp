@@ -1,14 +1,104 @@
 #include "Network.hpp"
+#include "../sim/TcpSimulator.hpp"
 #include <nlohmann/json.hpp>
+#include <cmath>
 #include <iostream>
+#include <unordered_map>
 using json = nlohmann::json;
 
+Network::Network() {
+    deliveryEvent = scheduler.registerHandler([this](const netsim::sim::Event& ev) {
+        deliverScheduledPacket(static_cast<uint32_t>(ev.arg0));
+    });
+}
+
+Network::~Network() {
+    releaseNodes();
+}
+
+void Network::releaseNodes() {
+    // Węzły trzymane jeszcze poza siecią zmieniają adres już bez indeksu
+    for (const auto& node : nodes) node->network = nullptr;
+    nodes.clear();
+}
+
+std::unique_ptr<Network> Network::fork() {
+    auto branch = std::make_unique<Network>();
+    Network* raw = branch.get();
+
+    // Klony węzłów; wskaźniki na sąsiadów i next-hopy przepinane na klony
+    std::unordered_map<Node*, Node*> peers;
+    branch->nodes.reserve(nodes.size());
+    for (const auto& node : nodes) {
+        auto copy = node->clone();
+        copy->network = raw;
+        peers[node.get()] = copy.get();
+        branch->nodes.push_back(copy);
+        branch->nodesByName[copy->getName()] = copy;
+    }
+    branch->nodesById.resize(nodesById.size());
+    for (size_t id = 0; id < nodesById.size(); ++id)
+        if (nodesById[id]) branch->nodesById[id] = branch->nodesByName.at(nodesById[id]->getName());
+    auto peer = [&peers](Node* node) {
+        auto it = peers.find(node);
+        return it == peers.end() ? nullptr : it->second;
+    };
+    for (const auto& node : branch->nodes) node->remapPeers(peer);
+    branch->nextNodeId = nextNodeId;
+    branch->nodesByIp = nodesByIp;
+    branch->ipOrder = ipOrder;
+    branch->uniqueAddresses = uniqueAddresses;
+
+    branch->adj = adj;
+    branch->linkDelays = linkDelays;
+    branch->vlans = vlans;
+    branch->bandwidths = bandwidths;
+    branch->firewallRules = firewallRules;
+    branch->failedNodes = failedNodes;
+    branch->packetLoss = packetLoss;
+    branch->wirelessRanges = wirelessRanges;
+    branch->packetsSent = packetsSent;
+    branch->packetsReceived = packetsReceived;
+    branch->linkTrafficCount = linkTrafficCount;
+    branch->wirelessNodeRanges = wirelessNodeRanges;
+    branch->positions = positions;
+    branch->positioned = positioned;
+    branch->radioRanges = radioRanges;
+    branch->wirelessPeers = wirelessPeers;
+    branch->wirelessLinkCount = wirelessLinkCount;
+    branch->wirelessDirty = wirelessDirty;
+    branch->wirelessDirtyFlag = wirelessDirtyFlag;
+    branch->wirelessIndex = wirelessIndex;
+    branch->wirelessIndexed = wirelessIndexed;
+    branch->interferenceLevel = interferenceLevel;
+    branch->cloudNodes = cloudNodes;
+    branch->cloudGroups = cloudGroups;
+    branch->cloudInstanceCounter = cloudInstanceCounter;
+    branch->iotDevices = iotDevices;
+    branch->iotBatteries = iotBatteries;
+
+    branch->scheduler = scheduler.fork();
+    branch->scheduler.setHandler(deliveryEvent, [raw](const netsim::sim::Event& ev) {
+        raw->deliverScheduledPacket(static_cast<uint32_t>(ev.arg0));
+    });
+    branch->deliveryEvent = deliveryEvent;
+    branch->inFlightPackets = inFlightPackets.fork();
+    branch->freeInFlightSlots = freeInFlightSlots;
+    branch->deliveryQueues = deliveryQueues;
+    branch->reassembly = reassembly;
+    return branch;
+}
 
 void Network::connect(std::shared_ptr<Node> a, std::shared_ptr<Node> b) {
     if (!a || !b)
         throw std::runtime_error("Cannot connect null nodes");
-    adj[a->getName()].insert(b->getName());
+    bool added = adj[a->getName()].insert(b->getName()).second;
     adj[b->getName()].insert(a->getName());
+    if (added && !topologyListeners.empty()) {
+        auto it = linkDelays.find({a->getName(), b->getName()});
+        int delay = it != linkDelays.end() ? it->second : 0;
+        notifyTopologyChange({TopologyChange::Kind::LinkUp, a->getId(), b->getId(), delay});
+    }
 }
 
 void Network::connect(const std::string& nameA, const std::string& nameB) {
@@ -26,6 +116,122 @@ std::shared_ptr<Node> Network::findByName(const std::string& name) const {
     return it->second;
 }
 
+std::shared_ptr<Node> Network::findById(NodeId id) const {
+    if (id >= nodesById.size() || !nodesById[id])
+        throw std::runtime_error("Node not found: #" + std::to_string(id));
+    return nodesById[id];
+}
+
+// --- IPAM ---
+
+void Network::indexAddress(const Node& node) {
+    const IpAddress& address = node.getIpAddress();
+    if (address.empty()) return;
+    auto it = nodesByIp.find(address);
+    if (it != nodesByIp.end() && uniqueAddresses)
+        throw std::runtime_error("IP address already in use: " + address.str() + " (" + nodesById[it->second]->getName() + ")");
+    nodesByIp.emplace(address, node.getId());
+    ipOrder.emplace(address, node.getId());
+}
+
+void Network::unindexAddress(const Node& node) {
+    const IpAddress& address = node.getIpAddress();
+    auto range = ipOrder.equal_range(address);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == node.getId()) {
+            ipOrder.erase(it);
+            break;
+        }
+    }
+    // Adres przechodzi na kolejny węzeł z tym samym adresem
+    auto owner = nodesByIp.find(address);
+    if (owner == nodesByIp.end() || owner->second != node.getId()) return;
+    auto rest = ipOrder.find(address);
+    if (rest != ipOrder.end()) owner->second = rest->second;
+    else nodesByIp.erase(owner);
+}
+
+std::shared_ptr<Node> Network::findByIp(const IpAddress& address) const {
+    auto it = nodesByIp.find(address);
+    return it != nodesByIp.end() ? nodesById[it->second] : nullptr;
+}
+
+std::shared_ptr<Node> Network::findNode(const std::string& nameOrIp) const {
+    auto it = nodesByName.find(nameOrIp);
+    if (it != nodesByName.end()) return it->second;
+    IpAddress address;
+    if (IpAddress::parse(nameOrIp, address))
+        if (auto node = findByIp(address)) return node;
+    throw std::runtime_error("Node not found: " + nameOrIp);
+}
+
+std::string Network::resolveNodeName(const std::string& nameOrIp) const {
+    if (nodesByName.count(nameOrIp)) return nameOrIp;
+    IpAddress address;
+    if (IpAddress::parse(nameOrIp, address))
+        if (auto node = findByIp(address)) return node->getName();
+    return nameOrIp;
+}
+
+void Network::setNodeIp(const std::string& name, const std::string& ip) {
+    auto node = findByName(name);
+    IpAddress address;
+    if (uniqueAddresses && IpAddress::parse(ip, address)) {
+        auto owner = findByIp(address);
+        if (owner && owner != node)
+            throw std::runtime_error("IP address already in use: " + address.str() + " (" + owner->getName() + ")");
+    }
+    unindexAddress(*node);
+    node->assignIp(ip);
+    indexAddress(*node);
+}
+
+std::vector<std::shared_ptr<Node>> Network::findInPrefix(const IpPrefix& prefix) const {
+    std::vector<std::shared_ptr<Node>> result;
+    for (auto it = ipOrder.lower_bound(IpAddress::network(prefix)); it != ipOrder.end() && it->first.in(prefix); ++it)
+        result.push_back(nodesById[it->second]);
+    return result;
+}
+
+IpAddress Network::allocateAddress(const IpPrefix& prefix) const {
+    IpAddress candidate = IpAddress::network(prefix);
+    IpAddress last = candidate;
+    // Ostatni adres prefiksu: bity hosta ustawione
+    if (prefix.length < 64) {
+        last.hi |= ~0ull >> prefix.length;
+        if (prefix.v6) last.lo = ~0ull;
+    } else {
+        last.lo |= prefix.length == 128 ? 0 : ~0ull >> (prefix.length - 64);
+    }
+    if (!prefix.v6) {
+        last.hi &= ~0ull << 32;
+        // Adres sieci i broadcast IPv4 nie są adresami hostów (poza /31 i /32)
+        if (prefix.length < 31) {
+            candidate = candidate.next();
+            last.hi -= 1ull << 32;
+        }
+    }
+    // Zajęte adresy prefiksu są kolejno w ipOrder - pierwsza luka to wolny adres
+    for (auto it = ipOrder.lower_bound(candidate); it != ipOrder.end() && !(candidate < it->first); ++it) {
+        if (it->first < candidate) continue;   // duplikat poprzedniego adresu
+        if (candidate == last) throw std::runtime_error("No free address in " + prefix.str());
+        candidate = candidate.next();
+    }
+    return candidate;
+}
+
+std::map<IpAddress, std::vector<std::string>> Network::getAddressConflicts() const {
+    std::map<IpAddress, std::vector<std::string>> conflicts;
+    for (auto it = ipOrder.begin(); it != ipOrder.end();) {
+        auto end = ipOrder.upper_bound(it->first);
+        if (std::next(it) != end)
+            for (auto member = it; member != end; ++member)
+                conflicts[it->first].push_back(nodesById[member->second]->getName());
+        it = end;
+    }
+    return conflicts;
+}
+
 std::vector<std::string> Network::getNeighbors(const std::string& name) const {
     std::vector<std::string> result;
     if (adj.count(name))
@@ -44,11 +250,31 @@ const std::map<std::string, std::set<std::string>>& Network::getAdjacency() cons
     return adj;
 }
 
+NodeId Network::getNodeId(const std::string& name) const {
+    return findByName(name)->getId();
+}
+
+int Network::addTopologyListener(TopologyListener listener) {
+    int id = nextListenerId++;
+    topologyListeners[id] = std::move(listener);
+    return id;
+}
+
+void Network::removeTopologyListener(int listenerId) {
+    topologyListeners.erase(listenerId);
+}
+
+void Network::notifyTopologyChange(const TopologyChange& change) {
+    for (auto& [id, listener] : topologyListeners)
+        listener(change);
+}
+
 void Network::removeNode(const std::string& name)
 {
     auto nodeIt = nodesByName.find(name);
     if (nodeIt == nodesByName.end())
         throw std::runtime_error("Node not found: " + name);
+    NodeId removedId = nodeIt->second->getId();
 
     if (!getNeighbors(name).empty())
         throw std::runtime_error("Cannot remove node with connections: " + name);
@@ -65,7 +291,17 @@ void Network::removeNode(const std::string& name)
 
 
 
+    unindexAddress(*nodeIt->second);
+    nodeIt->second->network = nullptr;
     nodesByName.erase(name);
+    nodesById[removedId].reset();
+    if (removedId < positioned.size()) {
+        positioned[removedId] = 0;
+        radioRanges[removedId] = 0;
+        wirelessIndex.remove(removedId);
+    }
+    if (removedId < deliveryQueues.size()) deliveryQueues[removedId].clear();
+    notifyTopologyChange({TopologyChange::Kind::NodeRemoved, removedId, 0, 0});
 }
 
 void Network::disconnect(const std::string &nameA, const std::string &nameB)
@@ -84,6 +320,9 @@ void Network::disconnect(const std::string &nameA, const std::string &nameB)
 
     adj[a->getName()].erase(b->getName());
     adj[b->getName()].erase(a->getName());
+    // Łącze zerwane ręcznie updateWirelessLinks może utworzyć ponownie
+    removeWirelessPeer(a->getId(), b->getId());
+    notifyTopologyChange({TopologyChange::Kind::LinkDown, a->getId(), b->getId(), 0});
 }
 
 void Network::setLinkDelay(const std::string &nameA, const std::string &nameB, int delayMs)
@@ -106,7 +345,7 @@ void Network::setLinkDelay(const std::string &nameA, const std::string &nameB, i
 
     linkDelays[{nameA, nameB}] = delayMs;
     linkDelays[{nameB, nameA}] = delayMs; // symetryczne ustawienie
-
+    notifyTopologyChange({TopologyChange::Kind::LinkDelay, a->getId(), b->getId(), delayMs});
 
 }
 
@@ -237,6 +476,11 @@ bool Network::canCommunicate(const std::string& nameA, const std::string& nameB)
     return itA->second == itB->second;
 }
 
+int Network::getVLAN(const std::string& name) const {
+    auto it = vlans.find(name);
+    return it == vlans.end() ? 0 : it->second;
+}
+
 // Bandwidth
 void Network::setBandwidth(const std::string& nameA, const std::string& nameB, int bw) {
     if (nameA == nameB) throw std::runtime_error("Cannot set bandwidth for same node");
@@ -286,8 +530,9 @@ bool Network::isAllowed(const std::string& src, const std::string& dst, const st
 
 // Node failure
 void Network::failNode(const std::string& name) {
-    findByName(name);
-    failedNodes.insert(name);
+    auto node = findByName(name);
+    if (failedNodes.insert(name).second)
+        notifyTopologyChange({TopologyChange::Kind::NodeFailed, node->getId(), 0, 0});
 }
 
 bool Network::isFailed(const std::string& name) const {
@@ -301,7 +546,8 @@ void Network::sendPacket(const Packet& pkt) {
     if (isFailed(pkt.src) || isFailed(pkt.dest)) throw std::runtime_error("Node failed");
     if (!isAllowed(pkt.src, pkt.dest, pkt.type)) throw std::runtime_error("Firewall blocked");
     // Assume direct send for simplicity
-    dst->receivePacket(const_cast<Packet&>(pkt));
+    Packet copy = pkt; // kopia pakietu nie alokuje - odbiorca może ją modyfikować (TTL)
+    dst->receivePacket(copy);
 }
 
 // Packet Loss
@@ -318,32 +564,22 @@ void Network::setPacketLoss(const std::string& nameA, const std::string& nameB,
 
 // TCP Simulation
 bool Network::initiateTCPConnection(const std::string& client, const std::string& server) {
-    // Simple 3-way handshake simulation
-    // 1. Client sends SYN
-    Packet synPkt(client, server, "tcp", "tcp", "");
-    synPkt.syn = true;
-    synPkt.seqNum = 1000; // Example seq
-    // Assume send (in real, check response)
-    // 2. Server responds SYN-ACK
-    Packet synAckPkt(server, client, "tcp", "tcp", "");
-    synAckPkt.syn = true;
-    synAckPkt.ack = true;
-    synAckPkt.ackNum = 1001;
-    synAckPkt.seqNum = 2000;
-    // 3. Client sends ACK
-    Packet ackPkt(client, server, "tcp", "tcp", "");
-    ackPkt.ack = true;
-    ackPkt.ackNum = 2001;
-    // For simplicity, assume success if connected
-    return adj.count(client) && adj.count(server) && adj.at(client).count(server);
+    if (!adj.count(client) || !adj.count(server)) return false;
+    // SYN, SYN-ACK, ACK jako pakiety w symulacji (z retransmisją SYN po RTO)
+    netsim::sim::TcpSimulator tcp(*this);
+    auto id = tcp.connect(client, server, 0);
+    tcp.run();
+    return tcp.state(id) == netsim::sim::TcpState::Finished;
 }
 
 bool Network::sendTCPPacket(const std::string& src, const std::string& dst, Packet pkt) {
-    // Send packet, simulate ACK
+    if (!adj.count(src) || !adj.count(dst)) return false;
     pkt.protocol = "tcp";
-    // Assume sendPacket handles it, with retransmission on loss
-    // For test, just check if sent
-    return true; // Simplified
+    // Handshake i przesłanie payloadu z potwierdzeniami i retransmisjami
+    netsim::sim::TcpSimulator tcp(*this);
+    auto id = tcp.connect(src, dst, pkt.payload.size());
+    tcp.run();
+    return tcp.state(id) == netsim::sim::TcpState::Finished;
 }
 
 // UDP Simulation
@@ -359,35 +595,85 @@ bool Network::sendUDPPacket(const std::string& src, const std::string& dst, Pack
 
 // Time-Based Simulation
 void Network::advanceTime(int ms) {
-    currentTime += ms;
-    // Deliver packets that have arrived
-    for (auto it = scheduledPackets.begin(); it != scheduledPackets.end(); ) {
-        if (it->first <= currentTime) {
-            for (const auto& pkt : it->second) {
-                arrivedPackets[pkt.dest] = true;
-            }
-            it = scheduledPackets.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    if (ms < 0) throw std::runtime_error("Cannot move simulation time backwards");
+    scheduler.runUntil(scheduler.now() + static_cast<netsim::sim::SimTime>(ms) * netsim::sim::Millisecond);
+    reassembly.expire(scheduler.now());
 }
 
-void Network::schedulePacketDelivery(const Packet& pkt, int delay) {
+netsim::sim::EventId Network::schedulePacketDelivery(const Packet& pkt, int delay) {
     int linkDelay = getLinkDelay(pkt.src, pkt.dest);
     int totalDelay = delay + pkt.delayMs + linkDelay;
-    int arrivalTime = currentTime + totalDelay;
-    scheduledPackets[arrivalTime].push_back(pkt);
+
+    uint32_t slot;
+    if (!freeInFlightSlots.empty()) {
+        slot = freeInFlightSlots.back();
+        freeInFlightSlots.pop_back();
+        inFlightPackets.mut(slot) = pkt;
+    } else {
+        slot = static_cast<uint32_t>(inFlightPackets.size());
+        inFlightPackets.push_back(pkt);
+    }
+    return scheduler.scheduleAfter(static_cast<netsim::sim::SimTime>(std::max(totalDelay, 0)) * netsim::sim::Millisecond,
+                                   deliveryEvent, slot);
 }
 
-bool Network::hasPacketArrived(const std::string& node) const {
-    auto it = arrivedPackets.find(node);
-    if (it != arrivedPackets.end() && it->second) {
-        // Reset for next check
-        const_cast<Network*>(this)->arrivedPackets[node] = false;
-        return true;
+size_t Network::scheduleFragmentedDelivery(const Packet& pkt, int delay) {
+    int mtu = std::min(findByName(pkt.src)->getMTU(), findByName(pkt.dest)->getMTU());
+    auto fragments = pkt.fragmentPacket(mtu);
+    for (const auto& frag : fragments) schedulePacketDelivery(frag, delay);
+    return fragments.size();
+}
+
+bool Network::cancelPacketDelivery(netsim::sim::EventId id) {
+    // Najpierw typ: identyfikator spoza dostarczeń nie może anulować cudzego zdarzenia
+    netsim::sim::Event ev;
+    if (!scheduler.peek(id, ev) || ev.type != deliveryEvent) return false;
+    scheduler.cancel(id);
+    takeInFlight(static_cast<uint32_t>(ev.arg0));
+    return true;
+}
+
+Packet Network::takeInFlight(uint32_t slot) {
+    Packet& stored = inFlightPackets.mut(slot);
+    Packet pkt = std::move(stored);
+    stored = Packet();
+    freeInFlightSlots.push_back(slot);
+    return pkt;
+}
+
+void Network::deliverScheduledPacket(uint32_t slot) {
+    Packet pkt = takeInFlight(slot);
+    if (pkt.fragmentId != 0) {
+        Packet whole;
+        if (reassembly.insert(pkt, scheduler.now(), whole) != ReassemblyStatus::Complete) return;
+        pkt = std::move(whole);
     }
-    return false;
+    auto it = nodesByName.find(pkt.dest);
+    if (it == nodesByName.end()) return; // węzeł usunięty w trakcie lotu pakietu
+    NodeId id = it->second->getId();
+    if (deliveryQueues.size() <= id) deliveryQueues.resize(id + 1);
+    deliveryQueues[id].push_back(std::move(pkt));
+}
+
+bool Network::hasPacketArrived(const std::string& node) const {
+    return getDeliveredCount(node) > 0;
+}
+
+size_t Network::getDeliveredCount(const std::string& node) const {
+    auto it = nodesByName.find(node);
+    if (it == nodesByName.end()) return 0;
+    NodeId id = it->second->getId();
+    return id < deliveryQueues.size() ? deliveryQueues[id].size() : 0;
+}
+
+bool Network::receiveDeliveredPacket(const std::string& node, Packet& out) {
+    auto it = nodesByName.find(node);
+    if (it == nodesByName.end()) return false;
+    NodeId id = it->second->getId();
+    if (id >= deliveryQueues.size() || deliveryQueues[id].empty()) return false;
+    out = std::move(deliveryQueues[id].front());
+    deliveryQueues[id].pop_front();
+    return true;
 }
 
 
@@ -400,8 +686,14 @@ void Network::connectWirelessRange(const std::string &nameA, const std::string &
     if (!nodeA || !nodeB)
         throw std::runtime_error("Cannot connect null nodes");
 
-    
+    if (hasPosition(nameA) && hasPosition(nameB)) {
+        Position a = getPosition(nameA), b = getPosition(nameB);
+        if (std::hypot(a.x - b.x, a.y - b.y) > range)
+            throw std::runtime_error("Nodes out of wireless range: " + nameA + " - " + nameB);
+    }
     connect(nameA, nameB);
+    wirelessRanges[{nameA, nameB}] = range;
+    wirelessRanges[{nameB, nameA}] = range;
 }
 
 void Network::connectWireless(const std::string &nameA, const std::string &nameB)
@@ -419,9 +711,14 @@ void Network::setQueueSize(const std::string& name, int size) {
     if (node) node->setMaxQueueSize(size);
 }
 
-void Network::enqueuePacket(const std::string& name, const Packet& pkt) {
+void Network::setQueueDiscipline(const std::string& name, const QueueConfig& config) {
+    auto node = findByName(name);
+    if (node) node->setQueueDiscipline(config);
+}
+
+bool Network::enqueuePacket(const std::string& name, const Packet& pkt) {
     auto node = findByName(name);
-    if (node) node->enqueuePacket(pkt);
+    return node ? node->enqueuePacket(pkt) : false;
 }
 
 void Network::dequeuePacket(const std::string& name) {
@@ -442,6 +739,10 @@ std::string Network::exportToJson() const {
         nlohmann::json node;
         node["name"] = n->getName();
         node["ip"] = n->getIp();
+        if (n->getId() < positioned.size() && positioned[n->getId()]) {
+            node["x"] = positions[n->getId()].x;
+            node["y"] = positions[n->getId()].y;
+        }
         j["nodes"].push_back(node);
     }
     j["connections"] = nlohmann::json::array();
@@ -458,14 +759,22 @@ std::string Network::exportToJson() const {
 void Network::importFromJson(const std::string& jsonStr) {
     nlohmann::json j = nlohmann::json::parse(jsonStr);
     // Clear current
-    nodes.clear();
+    releaseNodes();
     nodesByName.clear();
+    nodesByIp.clear();
+    ipOrder.clear();
+    clearPositions();
     adj.clear();
+    nextNodeId = 0;
+    nodesById.clear();
+    deliveryQueues.clear();
+    reassembly.clear();
     // Add nodes
     for (auto& node : j["nodes"]) {
         std::string name = node["name"];
         std::string ip = node["ip"];
         addNode<DummyNode>(name, ip); // Assume DummyNode for simplicity
+        if (node.contains("x") && node.contains("y")) setPosition(name, node["x"], node["y"]);
     }
     // Add connections
     for (auto& conn : j["connections"]) {
@@ -473,6 +782,7 @@ void Network::importFromJson(const std::string& jsonStr) {
         std::string b = conn[1];
         connect(a, b);
     }
+    notifyTopologyChange({TopologyChange::Kind::Reset, 0, 0, 0});
 }
 
 // ===== Network Statistics Implementation =====
@@ -597,6 +907,254 @@ void Network::setWirelessRange(const std::string& name, int range) {
         throw std::runtime_error("Node not found: " + name);
     }
     wirelessNodeRanges[name] = range;
+    resizeNodeArrays();
+    NodeId id = nodesByName.at(name)->getId();
+    radioRanges[id] = std::max(range, 0);
+    markWirelessMoved(id);
+}
+
+double Network::wirelessRangeOf(const std::string& nameA, const std::string& nameB) const {
+    auto link = wirelessRanges.find({nameA, nameB});
+    if (link != wirelessRanges.end()) return link->second;
+    auto rangeA = wirelessNodeRanges.find(nameA);
+    auto rangeB = wirelessNodeRanges.find(nameB);
+    if (rangeA != wirelessNodeRanges.end() && rangeB != wirelessNodeRanges.end())
+        return std::min(rangeA->second, rangeB->second);
+    if (rangeA != wirelessNodeRanges.end()) return rangeA->second;
+    return rangeB != wirelessNodeRanges.end() ? rangeB->second : 0;
+}
+
+void Network::resizeNodeArrays() {
+    if (positions.size() >= nodesById.size()) return;
+    positions.resize(nodesById.size());
+    positioned.resize(nodesById.size(), 0);
+    radioRanges.resize(nodesById.size(), 0);
+    wirelessPeers.resize(nodesById.size());
+    wirelessDirtyFlag.resize(nodesById.size(), 0);
+}
+
+void Network::clearPositions() {
+    positions.clear();
+    positioned.clear();
+    radioRanges.clear();
+    wirelessPeers.clear();
+    wirelessLinkCount = 0;
+    wirelessDirty.clear();
+    wirelessDirtyFlag.clear();
+    wirelessIndex.clear(wirelessIndex.cellSize());
+    wirelessIndexed = false;
+}
+
+void Network::markWirelessMoved(NodeId id) {
+    if (!wirelessDirtyFlag[id]) {
+        wirelessDirtyFlag[id] = 1;
+        wirelessDirty.push_back(id);
+    }
+    if (!wirelessIndexed) return;
+    if (positioned[id] && radioRanges[id] > 0)
+        wirelessIndex.move(id, positions[id]);
+    else
+        wirelessIndex.remove(id);
+}
+
+bool Network::linkedById(NodeId a, NodeId b) const {
+    auto it = adj.find(nodesById[a]->getName());
+    return it != adj.end() && it->second.count(nodesById[b]->getName()) > 0;
+}
+
+void Network::addWirelessPeer(NodeId a, NodeId b) {
+    wirelessPeers[a].push_back(b);
+    wirelessPeers[b].push_back(a);
+    wirelessLinkCount++;
+}
+
+void Network::removeWirelessPeer(NodeId a, NodeId b) {
+    if (a >= wirelessPeers.size() || b >= wirelessPeers.size()) return;
+    auto& peersA = wirelessPeers[a];
+    auto it = std::find(peersA.begin(), peersA.end(), b);
+    if (it == peersA.end()) return;
+    *it = peersA.back();
+    peersA.pop_back();
+    auto& peersB = wirelessPeers[b];
+    auto back = std::find(peersB.begin(), peersB.end(), a);
+    *back = peersB.back();
+    peersB.pop_back();
+    wirelessLinkCount--;
+}
+
+size_t Network::getWirelessDegree(NodeId id) const {
+    return id < wirelessPeers.size() ? wirelessPeers[id].size() : 0;
+}
+
+void Network::setPosition(const std::string& name, double x, double y) {
+    setPosition(findByName(name)->getId(), Position{x, y});
+}
+
+void Network::setPosition(NodeId id, const Position& position) {
+    findById(id);
+    if (!std::isfinite(position.x) || !std::isfinite(position.y))
+        throw std::runtime_error("Invalid position");
+    resizeNodeArrays();
+    positions[id] = position;
+    positioned[id] = 1;
+    markWirelessMoved(id);
+}
+
+bool Network::hasPosition(const std::string& name) const {
+    return hasPosition(findByName(name)->getId());
+}
+
+bool Network::hasPosition(NodeId id) const {
+    return id < positioned.size() && positioned[id] && nodesById[id];
+}
+
+Position Network::getPosition(const std::string& name) const {
+    NodeId id = findByName(name)->getId();
+    if (!hasPosition(id))
+        throw std::runtime_error("Node has no position: " + name);
+    return positions[id];
+}
+
+Position Network::getPosition(NodeId id) const {
+    if (!hasPosition(id))
+        throw std::runtime_error("Node has no position: #" + std::to_string(id));
+    return positions[id];
+}
+
+WirelessUpdate Network::updateWirelessLinks(std::vector<TopologyChange>* changes) {
+    resizeNodeArrays();
+    size_t n = nodesById.size();
+    std::vector<uint8_t> active(n, 0);
+    double maxRange = 0;
+    for (size_t id = 0; id < n; ++id) {
+        active[id] = nodesById[id] && positioned[id] && radioRanges[id] > 0;
+        if (active[id]) maxRange = std::max(maxRange, radioRanges[id]);
+    }
+
+    // Pary w zasięgu z siatki o komórce = największy zasięg
+    std::vector<std::pair<NodeId, NodeId>> found, inRange;
+    if (maxRange > 0) {
+        SpatialGrid grid;
+        grid.build(positions, active, maxRange);
+        grid.forEachPair([&](uint32_t a, uint32_t b, double d2) {
+            double range = std::min(radioRanges[a], radioRanges[b]);
+            if (d2 <= range * range) found.emplace_back(std::min(a, b), std::max(a, b));
+        });
+        // Sortowanie przez zliczanie po pierwszym węźle, potem krótkie listy sąsiadów
+        std::vector<uint32_t> start(n + 1, 0);
+        for (const auto& pair : found) start[pair.first + 1]++;
+        for (size_t id = 0; id < n; ++id) start[id + 1] += start[id];
+        inRange.resize(found.size());
+        std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+        for (const auto& pair : found) inRange[fill[pair.first]++] = pair;
+        for (size_t id = 0; id < n; ++id)
+            std::sort(inRange.begin() + start[id], inRange.begin() + start[id + 1]);
+    }
+
+    // Scalanie z łączami utworzonymi poprzednio: zmieniane są tylko różnice
+    WirelessUpdate update;
+    update.inRange = inRange.size();
+    std::vector<std::pair<NodeId, NodeId>> previous;
+    previous.reserve(wirelessLinkCount);
+    for (NodeId a = 0; a < wirelessPeers.size(); ++a) {
+        size_t begin = previous.size();
+        for (NodeId b : wirelessPeers[a])
+            if (a < b) previous.emplace_back(a, b);
+        std::sort(previous.begin() + begin, previous.end());
+    }
+    size_t i = 0, j = 0;
+    while (i < inRange.size() || j < previous.size()) {
+        if (j == previous.size() || (i < inRange.size() && inRange[i] < previous[j])) {
+            auto [a, b] = inRange[i++];
+            if (linkedById(a, b)) continue; // łącze przewodowe albo dodane ręcznie
+            connect(nodesById[a], nodesById[b]);
+            addWirelessPeer(a, b);
+            update.added++;
+            if (changes) changes->push_back({TopologyChange::Kind::LinkUp, a, b, 0});
+        } else if (i == inRange.size() || previous[j] < inRange[i]) {
+            auto [a, b] = previous[j++];
+            disconnect(nodesById[a]->getName(), nodesById[b]->getName());
+            update.removed++;
+            if (changes) changes->push_back({TopologyChange::Kind::LinkDown, a, b, 0});
+        } else {
+            i++;
+            j++;
+        }
+    }
+    for (NodeId id : wirelessDirty) wirelessDirtyFlag[id] = 0;
+    wirelessDirty.clear();
+    update.links = wirelessLinkCount;
+    return update;
+}
+
+WirelessUpdate Network::updateMovedWirelessLinks(std::vector<TopologyChange>* changes) {
+    resizeNodeArrays();
+    if (!wirelessIndexed) {
+        // Komórka = największy zasięg; późniejsze większe zasięgi przeszukują więcej komórek
+        double maxRange = 0;
+        for (size_t id = 0; id < nodesById.size(); ++id)
+            if (nodesById[id] && positioned[id]) maxRange = std::max(maxRange, radioRanges[id]);
+        wirelessIndex.clear(maxRange > 0 ? maxRange : 1.0);
+        for (size_t id = 0; id < nodesById.size(); ++id)
+            if (nodesById[id] && positioned[id] && radioRanges[id] > 0)
+                wirelessIndex.move(static_cast<uint32_t>(id), positions[id]);
+        wirelessIndexed = true;
+    }
+
+    WirelessUpdate update;
+    std::vector<NodeId> moved;
+    moved.swap(wirelessDirty);
+    std::vector<NodeId> inRange, before;
+    for (NodeId a : moved) {
+        wirelessDirtyFlag[a] = 0;
+        if (!nodesById[a]) continue;
+        update.checked++;
+        inRange.clear();
+        if (wirelessIndex.contains(a)) {
+            double range = radioRanges[a];
+            wirelessIndex.forEachWithin(positions[a], range, [&](uint32_t b, double d2) {
+                double pairRange = std::min(range, radioRanges[b]);
+                if (b != a && d2 <= pairRange * pairRange) inRange.push_back(b);
+            });
+        }
+        update.inRange += inRange.size();
+        std::sort(inRange.begin(), inRange.end());
+        before = wirelessPeers[a];
+        std::sort(before.begin(), before.end());
+
+        // Para dwóch przesuniętych węzłów jest już aktualna, gdy przychodzi kolej drugiego
+        size_t i = 0, j = 0;
+        while (i < inRange.size() || j < before.size()) {
+            if (j == before.size() || (i < inRange.size() && inRange[i] < before[j])) {
+                NodeId b = inRange[i++];
+                if (linkedById(a, b)) continue;
+                connect(nodesById[a], nodesById[b]);
+                addWirelessPeer(a, b);
+                update.added++;
+                if (changes) changes->push_back({TopologyChange::Kind::LinkUp, std::min(a, b), std::max(a, b), 0});
+            } else if (i == inRange.size() || before[j] < inRange[i]) {
+                NodeId b = before[j++];
+                disconnect(nodesById[a]->getName(), nodesById[b]->getName());
+                update.removed++;
+                if (changes) changes->push_back({TopologyChange::Kind::LinkDown, std::min(a, b), std::max(a, b), 0});
+            } else {
+                i++;
+                j++;
+            }
+        }
+    }
+    update.links = wirelessLinkCount;
+    return update;
+}
+
+std::vector<std::string> Network::getNodesWithin(double x, double y, double radius) const {
+    std::vector<std::string> result;
+    for (size_t id = 0; id < positioned.size(); ++id) {
+        if (!positioned[id] || !nodesById[id]) continue;
+        double dx = positions[id].x - x, dy = positions[id].y - y;
+        if (dx * dx + dy * dy <= radius * radius) result.push_back(nodesById[id]->getName());
+    }
+    return result;
 }
 
 bool Network::isWirelessConnected(const std::string& nameA, const std::string& nameB) const {
@@ -618,9 +1176,13 @@ bool Network::isWirelessConnected(const std::string& nameA, const std::string& n
     auto rangeB = wirelessNodeRanges.find(nameB);
     
     // Jeśli któryś węzeł ma ustawiony zasięg, połączenie jest wireless
-    if (rangeA != wirelessNodeRanges.end() || rangeB != wirelessNodeRanges.end()) {
-        // Dla uproszczenia, jeśli jest połączenie i jeden ma zasięg, uznajemy za OK
-        // W rzeczywistej symulacji sprawdzalibyśmy odległość fizyczną
+    if (rangeA != wirelessNodeRanges.end() || rangeB != wirelessNodeRanges.end() || wirelessRanges.count({nameA, nameB})) {
+        // Odległość sprawdzana, gdy oba węzły mają pozycje
+        double range = wirelessRangeOf(nameA, nameB);
+        if (range > 0 && hasPosition(nameA) && hasPosition(nameB)) {
+            Position a = getPosition(nameA), b = getPosition(nameB);
+            if (std::hypot(a.x - b.x, a.y - b.y) > range) return false;
+        }
         
         // Sprawdź interferencje
         auto interA = interferenceLevel.find(nameA);
@@ -890,9 +1452,16 @@ bool Network::loadTopologyFromDB() {
         netsim::db::LinkRepository linkRepo(dbManager);
 
         // Clear current topology
-        nodes.clear();
+        releaseNodes();
         nodesByName.clear();
+        nodesByIp.clear();
+        ipOrder.clear();
+        clearPositions();
         adj.clear();
+        nextNodeId = 0;
+        nodesById.clear();
+        deliveryQueues.clear();
+        reassembly.clear();
         linkDelays.clear();
         bandwidths.clear();
         packetLoss.clear();
@@ -946,6 +1515,7 @@ bool Network::loadTopologyFromDB() {
             }
         }
 
+        notifyTopologyChange({TopologyChange::Kind::Reset, 0, 0, 0});
         std::cout << "[Network] Topology loaded from database successfully" << std::endl;
         std::cout << "[Network] Loaded " << nodes.size() << " nodes and " 
                   << (dbLinks.size()) << " links" << std::endl;
@@ -6,7 +6,14 @@
 #include <set>
 #include <stdexcept>
 #include <tuple>
+#include <functional>
+#include <deque>
+#include <unordered_map>
 #include "Node.hpp"
+#include "ReassemblyTable.hpp"
+#include "SpatialGrid.hpp"
+#include "../sim/EventScheduler.hpp"
+#include "../utils/CowVector.hpp"
 #include <algorithm>
 
 // Struktura dla statystyk ruchu sieciowego
@@ -18,17 +25,52 @@ struct TrafficStats {
     double averagePacketsPerNode = 0.0;              // średnia liczba pakietów na węzeł
 };
 
+// Zmiana topologii zgłaszana słuchaczom (np. przyrostowe drzewa SPT w Engine)
+struct TopologyChange {
+    enum class Kind { LinkUp, LinkDown, LinkDelay, NodeFailed, NodeRemoved, Reset };
+    Kind kind;
+    NodeId a = 0;
+    NodeId b = 0;
+    int delayMs = 0; // aktualne opóźnienie łącza dla LinkUp/LinkDelay
+};
+using TopologyListener = std::function<void(const TopologyChange&)>;
+
+// Wynik Network::updateWirelessLinks
+struct WirelessUpdate {
+    size_t inRange = 0;     // pary węzłów w zasięgu radiowym
+    size_t links = 0;       // łącza utrzymywane automatycznie (pary w zasięgu bez łącza przewodowego)
+    size_t checked = 0;     // węzły sprawdzone przez updateMovedWirelessLinks
+    size_t added = 0;
+    size_t removed = 0;
+};
+
 // DummyNode for testing
 class DummyNode : public Node {
 public:
     bool received = false;
     DummyNode(const std::string& n, const std::string& ip) : Node(n, ip) {}
     void receivePacket(Packet& pkt) override { received = true; }
+    std::shared_ptr<Node> clone() const override { return std::make_shared<DummyNode>(*this); }
 };
 
  // Reprezentuje całą sieć jako graf (node'y + połączenia)
 class Network {
 public:
+    Network();
+    ~Network();
+    // Handlery zdarzeń trzymają wskaźnik this - sieci nie kopiujemy, tylko forkujemy
+    Network(const Network&) = delete;
+    Network& operator=(const Network&) = delete;
+
+    // Gałąź "co jeśli": niezależna kopia całego stanu symulacji - tabel, węzłów z kolejkami
+    // i tablicami tras, zdarzeń schedulera (czas i kolejność), pakietów w locie, dostarczonych
+    // i składanych fragmentów. Pakiety w locie są współdzielone copy-on-write, więc fork
+    // kosztuje kopię tabel i puli zdarzeń, a nie pakietów. Checkpoint to gałąź, której się
+    // nie uruchamia. Słuchacze topologii i persystencja nie przechodzą do gałęzi; handlery
+    // dodane przez getScheduler() wskazują oryginał i trzeba je podmienić (setHandler).
+    // Rzuca std::runtime_error w trakcie advanceTime.
+    std::unique_ptr<Network> fork();
+
     // Tworzy i dodaje nowy węzeł dowolnego typu (Host, Router, itp.)
     template<typename T, typename... Args>
     std::shared_ptr<T> addNode(Args&&... args);
@@ -41,6 +83,26 @@ public:
 
     // Znajdź node po nazwie
     std::shared_ptr<Node> findByName(const std::string& name) const;
+    // Znajdź node po NodeId (rzuca dla usuniętych/nieznanych id)
+    std::shared_ptr<Node> findById(NodeId id) const;
+
+    // IPAM: indeks adresów IP węzłów (węzły bez adresu IP nie są w nim). Przy
+    // setUniqueAddresses(true) addNode i setNodeIp rzucają std::runtime_error dla adresu
+    // zajętego przez inny węzeł; bez tego duplikaty są dozwolone, a findByIp daje pierwszy węzeł
+    void setUniqueAddresses(bool unique) { uniqueAddresses = unique; }
+    bool hasUniqueAddresses() const { return uniqueAddresses; }
+    std::shared_ptr<Node> findByIp(const IpAddress& address) const; // nullptr gdy brak
+    // Po nazwie albo adresie IP; rzuca std::runtime_error gdy brak węzła
+    std::shared_ptr<Node> findNode(const std::string& nameOrIp) const;
+    // Nazwa węzła o tej nazwie albo adresie; nieznany tekst wraca bez zmian (REST)
+    std::string resolveNodeName(const std::string& nameOrIp) const;
+    void setNodeIp(const std::string& name, const std::string& ip);
+    // Węzły z adresem w prefiksie, rosnąco po adresie
+    std::vector<std::shared_ptr<Node>> findInPrefix(const IpPrefix& prefix) const;
+    // Najniższy wolny adres hosta w prefiksie; rzuca std::runtime_error gdy pula jest pełna
+    IpAddress allocateAddress(const IpPrefix& prefix) const;
+    // Adresy używane przez więcej niż jeden węzeł -> nazwy tych węzłów
+    std::map<IpAddress, std::vector<std::string>> getAddressConflicts() const;
 
     // Lista sąsiadów danego node’a
     std::vector<std::string> getNeighbors(const std::string& name) const;
@@ -51,7 +113,15 @@ public:
     // Getter do grafu połączeń
     const std::map<std::string, std::set<std::string>>& getAdjacency() const;
 
+    // Stabilne identyfikatory węzłów (NodeId) dla grafów indeksowanych id
+    NodeId getNodeId(const std::string& name) const;
+    NodeId getNodeIdBound() const { return nextNodeId; } // wszystkie id < bound
+
     void removeNode(const std::string& name);
+
+    // Słuchacze zmian topologii (connect/disconnect/setLinkDelay/failNode/import)
+    int addTopologyListener(TopologyListener listener);
+    void removeTopologyListener(int listenerId);
     
     // links
     void setLinkDelay(const std::string& nameA, const std::string& nameB, int delayMs);
@@ -67,6 +137,7 @@ public:
     // VLAN
     void assignVLAN(const std::string& name, int vlanId);
     bool canCommunicate(const std::string& nameA, const std::string& nameB) const;
+    int getVLAN(const std::string& name) const; // 0 = brak VLAN
 
     // Bandwidth
     void setBandwidth(const std::string& nameA, const std::string& nameB, int bw);
@@ -88,29 +159,62 @@ public:
 
     // Congestion Control
     void setQueueSize(const std::string& name, int size);
-    void enqueuePacket(const std::string& name, const Packet& pkt);
+    void setQueueDiscipline(const std::string& name, const QueueConfig& config);
+    bool enqueuePacket(const std::string& name, const Packet& pkt);
     void dequeuePacket(const std::string& name);
     bool isCongested(const std::string& name) const;
 
     // Packet Loss
     void setPacketLoss(const std::string& nameA, const std::string& nameB, double lossProb);
 
-    // TCP Simulation
+    // TCP Simulation (sim::TcpSimulator na migawce sieci): handshake / przesłanie payloadu
     bool initiateTCPConnection(const std::string& client, const std::string& server);
     bool sendTCPPacket(const std::string& src, const std::string& dst, Packet pkt);
 
     // UDP Simulation
     bool sendUDPPacket(const std::string& src, const std::string& dst, Packet pkt);
 
-    // Time-Based Simulation
+    // Time-Based Simulation (zdarzenia na kole czasowym, czas w ns)
     void advanceTime(int ms);
-    void schedulePacketDelivery(const Packet& pkt, int delay);
+    netsim::sim::EventId schedulePacketDelivery(const Packet& pkt, int delay);
+    // Dzieli pakiet wg mniejszego MTU nadawcy i odbiorcy; fragmenty są składane u odbiorcy
+    size_t scheduleFragmentedDelivery(const Packet& pkt, int delay);
+    bool cancelPacketDelivery(netsim::sim::EventId id);
     bool hasPacketArrived(const std::string& node) const;
+    size_t getDeliveredCount(const std::string& node) const;
+    // Zdejmuje najstarszy dostarczony pakiet z kolejki węzła (false gdy pusta)
+    bool receiveDeliveredPacket(const std::string& node, Packet& out);
+    netsim::sim::SimTime getSimTime() const { return scheduler.now(); }
+    netsim::sim::EventScheduler& getScheduler() { return scheduler; }
+    const ReassemblyTable& getReassemblyTable() const { return reassembly; }
 
+    // Łączy, gdy węzły z pozycjami są w odległości <= range (inaczej rzuca std::runtime_error)
     void connectWirelessRange(const std::string& nameA, const std::string& nameB, int range);
     void connectWireless(const std::string& nameA, const std::string& nameB);
     void setWirelessRange(const std::string& name, int range);
+    // Łącze istnieje, węzły z pozycjami są w zasięgu, interferencje <= 0.5
     bool isWirelessConnected(const std::string& nameA, const std::string& nameB) const;
+
+    // Pozycje węzłów (metry) - odległości dla łączy bezprzewodowych
+    void setPosition(const std::string& name, double x, double y);
+    void setPosition(NodeId id, const Position& position);
+    bool hasPosition(const std::string& name) const;
+    bool hasPosition(NodeId id) const;
+    Position getPosition(const std::string& name) const; // rzuca gdy węzeł nie ma pozycji
+    Position getPosition(NodeId id) const;
+    // Łącza radiowe z odległości: węzły z pozycją i zasięgiem (setWirelessRange) łączą się,
+    // gdy odległość <= mniejszego z zasięgów. Tworzy brakujące łącza i zrywa utworzone
+    // tu wcześniej, które wyszły z zasięgu; łączy przewodowych nie rusza.
+    // changes (opcjonalnie) dostaje zmienione łącza jako LinkUp/LinkDown
+    WirelessUpdate updateWirelessLinks(std::vector<TopologyChange>* changes = nullptr);
+    // To samo tylko dla węzłów, którym od ostatniej aktualizacji zmieniono pozycję lub zasięg:
+    // sąsiedzi z indeksu przestrzennego aktualizowanego w miejscu, koszt zależy od liczby
+    // przesuniętych węzłów, a nie od rozmiaru sieci
+    WirelessUpdate updateMovedWirelessLinks(std::vector<TopologyChange>* changes = nullptr);
+    // Liczba łączy radiowych węzła utrzymywanych przez updateWirelessLinks
+    size_t getWirelessDegree(NodeId id) const;
+    // Węzły z pozycją w promieniu radius od (x, y)
+    std::vector<std::string> getNodesWithin(double x, double y, double radius) const;
     void simulateInterference(const std::string& name, double lossProb);
 
     // Network Statistics
@@ -157,8 +261,17 @@ public:
     bool isPersistenceEnabled() const;
 
 private:
+    friend struct GraphSnapshot; // buduje widok CSR bezpośrednio z map Network
+
     std::vector<std::shared_ptr<Node>> nodes;                // wszystkie węzły
     std::map<std::string, std::shared_ptr<Node>> nodesByName; // szybki lookup
+    NodeId nextNodeId = 0; // kolejny wolny NodeId (id nie są ponownie używane)
+    std::vector<std::shared_ptr<Node>> nodesById; // NodeId -> węzeł (nullptr po removeNode)
+    std::unordered_map<IpAddress, NodeId, IpAddressHash> nodesByIp; // IPAM: adres -> pierwszy węzeł
+    std::multimap<IpAddress, NodeId> ipOrder; // wszystkie adresy posortowane - prefiksy, wolne adresy, konflikty
+    bool uniqueAddresses = false;
+    void indexAddress(const Node& node); // rzuca dla zajętego adresu przy uniqueAddresses
+    void unindexAddress(const Node& node);
     std::map<std::string, std::set<std::string>> adj;         // graf połączeń
     std::map<std::pair<std::string, std::string>, int> linkDelays; // opóźnienia łączy
     std::map<std::string, int> vlans; // VLAN dla węzłów
@@ -166,9 +279,14 @@ private:
     std::map<std::tuple<std::string, std::string, std::string>, bool> firewallRules; // src, dst, protocol -> allow
     std::set<std::string> failedNodes; // failed węzły
     std::map<std::pair<std::string, std::string>, double> packetLoss; // link -> loss probability
-    int currentTime = 0; // current simulation time
-    std::map<int, std::vector<Packet>> scheduledPackets; // time -> packets to deliver
-    std::map<std::string, bool> arrivedPackets; // node -> has packet arrived
+    netsim::sim::EventScheduler scheduler; // dyskretne zdarzenia symulacji
+    netsim::sim::EventType deliveryEvent = 0;
+    netsim::utils::CowVector<Packet> inFlightPackets; // pakiety zaplanowanych dostarczeń (arg0 zdarzenia)
+    std::vector<uint32_t> freeInFlightSlots;
+    std::vector<std::deque<Packet>> deliveryQueues; // NodeId -> dostarczone pakiety
+    ReassemblyTable reassembly; // fragmenty czekające na złożenie u odbiorcy
+    void deliverScheduledPacket(uint32_t slot);
+    Packet takeInFlight(uint32_t slot);
     std::map<std::pair<std::string, std::string>, int> wirelessRanges; // link -> wireless range
     
     // Network Statistics
@@ -178,6 +296,23 @@ private:
     
     // Wireless Networks
     std::map<std::string, int> wirelessNodeRanges; // node -> wireless range
+    std::vector<Position> positions; // NodeId -> pozycja
+    std::vector<uint8_t> positioned; // NodeId -> czy ma pozycję
+    std::vector<double> radioRanges; // NodeId -> wirelessNodeRanges (0 = brak)
+    std::vector<std::vector<NodeId>> wirelessPeers; // NodeId -> łącza z updateWirelessLinks
+    size_t wirelessLinkCount = 0;
+    std::vector<NodeId> wirelessDirty; // zmieniona pozycja lub zasięg od ostatniej aktualizacji
+    std::vector<uint8_t> wirelessDirtyFlag;
+    SpatialHash wirelessIndex; // węzły z pozycją i zasięgiem; budowany przy pierwszym updateMovedWirelessLinks
+    bool wirelessIndexed = false;
+    void resizeNodeArrays();
+    void clearPositions();
+    void releaseNodes(); // czyści nodes i odpina węzły od indeksu adresów
+    void markWirelessMoved(NodeId id); // oznacza do aktualizacji i przesuwa w indeksie
+    bool linkedById(NodeId a, NodeId b) const;
+    void addWirelessPeer(NodeId a, NodeId b);
+    void removeWirelessPeer(NodeId a, NodeId b);
+    double wirelessRangeOf(const std::string& nameA, const std::string& nameB) const; // 0 = nieznany
     std::map<std::string, double> interferenceLevel; // node -> interference loss probability
     
     // Cloud Integration
@@ -191,6 +326,11 @@ private:
     
     // Database Persistence
     bool persistenceEnabled = false;
+
+    // Topology listeners
+    std::map<int, TopologyListener> topologyListeners;
+    int nextListenerId = 0;
+    void notifyTopologyChange(const TopologyChange& change);
 };
 
 // Implementacja szablonu w headerze
@@ -200,7 +340,12 @@ std::shared_ptr<T> Network::addNode(Args&&... args) {
     const auto& name = node->getName();
     if (nodesByName.count(name))
         throw std::runtime_error("Node already exists: " + name);
+    node->setId(nextNodeId);
+    indexAddress(*node);
+    node->network = this;
+    nextNodeId++;
     nodes.push_back(node);
+    nodesById.push_back(node);
     nodesByName[name] = node;
     return node;
 }
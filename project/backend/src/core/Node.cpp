@@ -1,4 +1,30 @@
 #include "Node.hpp"
+#include "Network.hpp"
+#include <algorithm>
+
+Node::Node(const Node& other)
+    : name(other.name), ip(other.ip), ipAddress(other.ipAddress), id(other.id), mtu(other.mtu), packet(other.packet),
+      connections(other.connections), packetCountByNeighbor(other.packetCountByNeighbor),
+      packetCount(other.packetCount), maxQueueSize(other.maxQueueSize), queueConfig(other.queueConfig),
+      packetQueue(other.packetQueue ? other.packetQueue->clone() : nullptr),
+      queueSlots(other.queueSlots), freeSlots(other.freeSlots) {}
+
+void Node::setIp(const std::string& newIp) {
+    if (network)
+        network->setNodeIp(name, newIp);
+    else
+        assignIp(newIp);
+}
+
+void Node::assignIp(const std::string& newIp) {
+    ip = newIp;
+    ipAddress = IpAddress();
+    IpAddress::parse(ip, ipAddress);
+}
+
+void Node::remapPeers(const std::function<Node*(Node*)>& peer) {
+    for (auto& neighbor : connections) neighbor = peer(neighbor);
+}
 
 void Node::sendPacket(Packet& p, Node& dest) {
     incrementPacketCount();
@@ -22,3 +48,62 @@ void Node::incrementPacketCountToNeighbor(const std::string& neighborName)
     packetCountByNeighbor[neighborName]++;
 }
 
+
+void Node::setMaxQueueSize(int size) {
+    maxQueueSize = size;
+    resetQueue();
+}
+
+void Node::setQueueDiscipline(const QueueConfig& config) {
+    QueueConfig checked = config;
+    checked.capacity = static_cast<uint32_t>(std::max(maxQueueSize, 0));
+    QueueDiscipline::create(checked); // walidacja parametrów przed podmianą
+    queueConfig = checked;
+    resetQueue();
+}
+
+std::vector<QueueStats> Node::getQueueStats() const {
+    return packetQueue ? packetQueue->bandStats() : std::vector<QueueStats>();
+}
+
+bool Node::enqueuePacket(const Packet& pkt, netsim::sim::SimTime now) {
+    if (!packetQueue) {
+        queueConfig.capacity = static_cast<uint32_t>(std::max(maxQueueSize, 0));
+        packetQueue = QueueDiscipline::create(queueConfig);
+        queueSlots.resize(queueConfig.capacity);
+        freeSlots.clear();
+        for (uint32_t slot = queueConfig.capacity; slot > 0; --slot) freeSlots.push_back(slot - 1);
+    }
+    // Zajęte sloty == pakiety w dyscyplinie, więc bez wolnego slotu enqueue odrzuci pakiet
+    QueueItem item;
+    item.handle = freeSlots.empty() ? 0 : freeSlots.back();
+    item.sizeBytes = static_cast<uint32_t>(40 + pkt.payload.size());
+    item.flow = pkt.src.id() * 0x9e3779b1u ^ pkt.dest.id();
+    item.priority = static_cast<uint8_t>(std::min(std::max(pkt.priority, 0), 255));
+    if (packetQueue->enqueue(item, now) != EnqueueResult::Queued) return false; // przepełnienie albo AQM
+    freeSlots.pop_back();
+    queueSlots[item.handle] = pkt;
+    return true;
+}
+
+bool Node::dequeuePacket(Packet* out, netsim::sim::SimTime now) {
+    if (!packetQueue) return false;
+    std::vector<QueueItem> dropped;
+    QueueItem item;
+    bool found = packetQueue->dequeue(now, item, &dropped);
+    for (const auto& d : dropped) {
+        queueSlots[d.handle] = Packet();
+        freeSlots.push_back(d.handle);
+    }
+    if (!found) return false;
+    if (out) *out = std::move(queueSlots[item.handle]);
+    queueSlots[item.handle] = Packet();
+    freeSlots.push_back(item.handle);
+    return true;
+}
+
+void Node::resetQueue() {
+    packetQueue.reset();
+    queueSlots.clear();
+    freeSlots.clear();
+}
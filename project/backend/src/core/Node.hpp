@@ -1,26 +1,50 @@
 #pragma once
+#include "IpAddress.hpp"
 #include "Packet.hpp"
+#include "QueueDiscipline.hpp"
+#include <algorithm>
+#include <functional>
 #include <map>
+#include <memory>
 #include <vector>
 #include <string>
-#include <queue>
+#include <cstdint>
 
+// Stabilny identyfikator węzła nadawany przez Network (indeks w grafach id-indexed)
+using NodeId = uint32_t;
+
+class Network;
 
 class Node {
 public:
     Node() = default;
-    Node(const std::string& name, const std::string& ip) : name(name), ip(ip) {}
+    Node(const std::string& name, const std::string& ip) : name(name), ip(ip) { IpAddress::parse(ip, ipAddress); }
     virtual ~Node() = default;
 
     std::string getName() const {return name;}
+    NodeId getId() const { return id; }
+    void setId(NodeId newId) { id = newId; }
     std::string getIp() const {return ip;}
-    void setIp(const std::string& newIp) { ip = newIp; }
+    // Adres IP węzła; pusty, gdy ip nie jest adresem (np. instancje chmurowe)
+    const IpAddress& getIpAddress() const { return ipAddress; }
+    // Węzeł w sieci zmienia adres przez Network::setNodeIp (indeks IPAM, kontrola duplikatów)
+    void setIp(const std::string& newIp);
     virtual std::string getType() const { return "node"; }
 
+    // Kopia węzła razem z kolejką (Network::fork); wskaźniki na inne węzły wskazują
+    // jeszcze oryginały - przepina je remapPeers
+    virtual std::shared_ptr<Node> clone() const = 0;
+    virtual void remapPeers(const std::function<Node*(Node*)>& peer);
+
     void setMTU(int newMtu) { mtu = newMtu; }
     int getMTU() const { return mtu; }
-    void setMaxQueueSize(int size) { maxQueueSize = size; }
+    void setMaxQueueSize(int size);
     int getMaxQueueSize() const { return maxQueueSize; }
+    // Dyscyplina kolejki węzła (capacity brane z maxQueueSize); kolejka z pakietami jest czyszczona
+    void setQueueDiscipline(const QueueConfig& config);
+    const QueueConfig& getQueueConfig() const { return queueConfig; }
+    // Liczniki per pasmo; puste dopóki nic nie trafiło do kolejki
+    std::vector<QueueStats> getQueueStats() const;
 
     virtual void receivePacket(Packet& p) = 0;
     void sendPacket(Packet& p, Node& dest);
@@ -30,21 +54,40 @@ public:
     void incrementPacketCountToNeighbor(const std::string& neighborName);
 
     void addNeighbor(Node* neighbor);
-    void enqueuePacket(const Packet& pkt) { if (packetQueue.size() < maxQueueSize) packetQueue.push(pkt); }
-    void dequeuePacket() { if (!packetQueue.empty()) packetQueue.pop(); }
-    bool isCongested() const { return packetQueue.size() >= maxQueueSize; }
+    // false gdy dyscyplina odrzuciła pakiet
+    bool enqueuePacket(const Packet& pkt, netsim::sim::SimTime now = 0);
+    // Wyjmuje następny pakiet wg dyscypliny (do out, jeśli podany); false gdy kolejka pusta
+    bool dequeuePacket(Packet* out = nullptr, netsim::sim::SimTime now = 0);
+    bool isCongested() const { return queuedPackets() >= static_cast<size_t>(std::max(maxQueueSize, 0)); }
+    size_t queuedPackets() const { return packetQueue ? packetQueue->size() : 0; }
 
 
     int getPacketCount() const { return packetCount; }
     protected:
+    Node(const Node& other);
+    Node& operator=(const Node&) = delete;
+
     std::string name;
     std::string ip;
+    IpAddress ipAddress;
+    NodeId id = 0;
     int mtu = 1500;
     Packet packet;
     std::vector<Node*> connections;
     std::map<std::string, int> packetCountByNeighbor;
     mutable int packetCount = 0;
-    std::queue<Packet> packetQueue; // For queueing packets
     int maxQueueSize = 10;
-    
+    QueueConfig queueConfig;
+    // Dyscyplina operuje na uchwytach slotów z preallokowanej puli pakietów (tworzona leniwie)
+    std::unique_ptr<QueueDiscipline> packetQueue;
+    std::vector<Packet> queueSlots;
+    std::vector<uint32_t> freeSlots;
+
+    void resetQueue();
+
+private:
+    friend class Network;
+    Network* network = nullptr; // sieć indeksująca adres; ustawia Network, kopia go nie dziedziczy
+
+    void assignIp(const std::string& newIp);
 };
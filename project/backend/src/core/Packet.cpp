@@ -1,39 +1,58 @@
 #include "Packet.hpp"
 #include <algorithm>
+#include <atomic>
+#include <stdexcept>
 
-std::vector<Packet> Packet::fragmentPacket(int mtu) {
+namespace {
+std::atomic<uint32_t> nextFragmentId{1};
+
+// Identyfikatory > 0 (0 = pakiet niefragmentowany), unikalne w obrębie procesu aż do zawinięcia
+int allocateFragmentId() {
+    uint32_t id;
+    do {
+        id = nextFragmentId.fetch_add(1, std::memory_order_relaxed) & 0x7fffffffu;
+    } while (id == 0);
+    return static_cast<int>(id);
+}
+}
+
+std::vector<Packet> Packet::fragmentPacket(int mtu) const {
+    if (mtu <= 0) throw std::runtime_error("MTU must be positive");
     std::vector<Packet> fragments;
-    if (payload.size() <= mtu) {
+    if (payload.size() <= static_cast<size_t>(mtu)) {
         fragments.push_back(*this);
         return fragments;
     }
-    int id = 0; // Simple id, can be improved
-    int numFragments = (payload.size() + mtu - 1) / mtu;
-    for (int i = 0; i < numFragments; ++i) {
-        Packet frag = *this;
+    int id = allocateFragmentId();
+    size_t numFragments = (payload.size() + mtu - 1) / mtu;
+    fragments.reserve(numFragments);
+    for (size_t i = 0; i < numFragments; ++i) {
+        fragments.push_back(*this);
+        Packet& frag = fragments.back();
         frag.fragmentId = id;
-        frag.seqNum = i;
-        int start = i * mtu;
-        int len = std::min(mtu, (int)payload.size() - start);
-        frag.payload = payload.substr(start, len);
+        frag.seqNum = static_cast<int>(i);
+        frag.payload = payload.slice(i * mtu, mtu);
         frag.isLast = (i == numFragments - 1);
-        fragments.push_back(frag);
     }
     return fragments;
 }
 
 Packet Packet::reassemblePacket(const std::vector<Packet>& fragments) {
     if (fragments.empty()) return Packet();
-    Packet reassembled = fragments[0];
-    reassembled.payload = "";
-    // Sort by seqNum
-    std::vector<Packet> sorted = fragments;
-    std::sort(sorted.begin(), sorted.end(), [](const Packet& a, const Packet& b) {
-        return a.seqNum < b.seqNum;
+    // Sort by seqNum (wskaźniki - bez kopiowania fragmentów)
+    std::vector<const Packet*> sorted;
+    sorted.reserve(fragments.size());
+    for (const auto& frag : fragments) sorted.push_back(&frag);
+    std::sort(sorted.begin(), sorted.end(), [](const Packet* a, const Packet* b) {
+        return a->seqNum < b->seqNum;
     });
-    for (const auto& frag : sorted) {
-        reassembled.payload += frag.payload;
+    std::vector<Payload> parts;
+    parts.reserve(sorted.size());
+    for (const Packet* frag : sorted) {
+        parts.push_back(frag->payload);
     }
+    Packet reassembled = fragments[0];
+    reassembled.payload = Payload::concat(parts);
     reassembled.isLast = false;
     return reassembled;
-}
\ No newline at end of file
+}
@@ -1,14 +1,22 @@
 #pragma once
 
+#include "PacketFields.hpp"
 #include <string>
 #include <vector>
 
+/**
+ * @brief Simulated packet - a compact value type
+ *
+ * Endpoints are interned names, type and protocol are one-byte tags and the
+ * payload is a shared, immutable slice, so copying a packet (queues,
+ * scheduled deliveries, fragments) never allocates.
+ */
 struct Packet {
-    std::string src;
-    std::string dest;
-    std::string type;
-    std::string protocol;
-    std::string payload;
+    Endpoint src;
+    Endpoint dest;
+    PacketTag<PacketType> type;
+    PacketTag<Protocol> protocol;
+    Payload payload;
     int delayMs = 10;
     int ttl = 64;
     int priority = 0;
@@ -17,16 +25,17 @@ struct Packet {
     int ackNum = 0;
     bool syn = false;
     bool ack = false;
-    // Fragmentation fields
+    // Fragmentation fields (fragmentId 0 = pakiet niefragmentowany, seqNum = numer fragmentu)
     int fragmentId = 0;
     bool isLast = false;
     Packet() = default;
-    Packet(std::string src, std::string dest, std::string type, std::string protocol, std::string payload)
-        : src(std::move(src)), dest(std::move(dest)), type(std::move(type)), protocol(std::move(protocol)), payload(std::move(payload)) {}
+    Packet(Endpoint src, Endpoint dest, PacketTag<PacketType> type, PacketTag<Protocol> protocol, Payload payload)
+        : src(src), dest(dest), type(type), protocol(protocol), payload(std::move(payload)) {}
 
     void setPriority(int p) { priority = p; }
     int getPriority() const { return priority; }
 
-    std::vector<Packet> fragmentPacket(int mtu);
+    // Fragmenty są wycinkami payloadu (bez kopiowania danych) ze wspólnym, unikalnym fragmentId
+    std::vector<Packet> fragmentPacket(int mtu) const;
     static Packet reassemblePacket(const std::vector<Packet>& fragments);
-};
\ No newline at end of file
+};
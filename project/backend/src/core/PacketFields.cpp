@@ -0,0 +1,266 @@
+#include "PacketFields.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+// Nazwy węzłów: kawałki o stałym adresie, więc odczyt po id nie wymaga blokady.
+// Adres IP nazwy parsowany raz, przy pierwszym użyciu nazwy
+class NameTable {
+public:
+    static constexpr unsigned ChunkBits = 12;
+    static constexpr uint32_t ChunkSize = 1u << ChunkBits;
+    static constexpr uint32_t MaxChunks = 4096;
+
+    NameTable() { intern(std::string_view()); }
+
+    uint32_t intern(std::string_view name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(name);
+        if (it != m_index.end()) return it->second;
+        uint32_t id = m_count;
+        if ((id >> ChunkBits) >= MaxChunks) throw std::runtime_error("Too many endpoint names");
+        auto& chunk = m_chunks[id >> ChunkBits];
+        if (!chunk) chunk = std::make_unique<Entry[]>(ChunkSize);
+        Entry& slot = chunk[id & (ChunkSize - 1)];
+        slot.name.assign(name.data(), name.size());
+        IpAddress::parse(slot.name, slot.address);
+        m_index.emplace(std::string_view(slot.name), id);
+        m_count = id + 1;
+        return id;
+    }
+
+    const std::string& name(uint32_t id) const { return entry(id).name; }
+    const IpAddress& address(uint32_t id) const { return entry(id).address; }
+
+private:
+    struct Entry {
+        std::string name;
+        IpAddress address;
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string_view, uint32_t> m_index;
+    std::unique_ptr<Entry[]> m_chunks[MaxChunks];
+    uint32_t m_count = 0;
+
+    const Entry& entry(uint32_t id) const { return m_chunks[id >> ChunkBits][id & (ChunkSize - 1)]; }
+};
+
+NameTable& names() {
+    static NameTable* table = new NameTable(); // celowo bez destruktora - Endpoint bywa statyczny
+    return *table;
+}
+
+std::mutex tagMutex;
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+} // namespace
+
+Endpoint::Endpoint(std::string_view name) : m_id(name.empty() ? 0 : names().intern(name)) {
+}
+
+const std::string& Endpoint::str() const {
+    return names().name(m_id);
+}
+
+const IpAddress& Endpoint::ip() const {
+    return names().address(m_id);
+}
+
+namespace packet_fields {
+
+TagTable::TagTable(std::vector<std::string> known) : m_count(1), m_known(known.size()) {
+    for (auto& name : known) {
+        m_kinds[m_count] = static_cast<uint8_t>(m_count);
+        m_names[m_count++] = std::move(name);
+    }
+    m_other = static_cast<uint8_t>(m_count);
+    m_names[m_count++] = "other";
+}
+
+uint8_t TagTable::intern(std::string_view name) {
+    if (name.empty()) return 0;
+    std::lock_guard<std::mutex> lock(tagMutex);
+    for (unsigned code = 1; code < m_count; ++code)
+        if (m_names[code] == name) return static_cast<uint8_t>(code);
+    if (m_count == MaxCodes || name.size() > MaxNameLength) return m_other;
+    m_names[m_count].assign(name.data(), name.size());
+    m_kinds[m_count] = kindOf(name);
+    return static_cast<uint8_t>(m_count++);
+}
+
+uint8_t TagTable::kindOf(std::string_view name) const {
+    for (size_t k = 1; k <= m_known; ++k)
+        if (equalsIgnoreCase(m_names[k], name)) return static_cast<uint8_t>(k);
+    return 0;
+}
+
+template<> TagTable& tagTable<PacketType>() {
+    static TagTable* table = new TagTable({"data", "ack", "control"});
+    return *table;
+}
+
+template<> TagTable& tagTable<Protocol>() {
+    static TagTable* table = new TagTable({"tcp", "udp", "icmp"});
+    return *table;
+}
+
+} // namespace packet_fields
+
+struct Payload::Buffer {
+    std::atomic<uint32_t> refs{1};
+    std::string bytes;
+    Buffer* nextFree = nullptr;
+};
+
+namespace {
+
+// Pula buforów wątku: zwolniony bufor zachowuje pojemność i wraca do puli wątku, który go zwolnił
+struct BufferPool {
+    static constexpr size_t MaxBuffers = 1024;
+    static constexpr size_t MaxPooledBytes = 64 * 1024;
+
+    Payload::Buffer* head = nullptr;
+    size_t count = 0;
+    bool closed = false;
+
+    ~BufferPool() {
+        while (head) {
+            Payload::Buffer* next = head->nextFree;
+            delete head;
+            head = next;
+        }
+        closed = true;
+    }
+
+    Payload::Buffer* acquire() {
+        if (!head) return new Payload::Buffer();
+        Payload::Buffer* buffer = head;
+        head = buffer->nextFree;
+        count--;
+        buffer->refs.store(1, std::memory_order_relaxed);
+        return buffer;
+    }
+
+    void recycle(Payload::Buffer* buffer) {
+        if (closed || count >= MaxBuffers || buffer->bytes.capacity() > MaxPooledBytes) {
+            delete buffer;
+            return;
+        }
+        buffer->nextFree = head;
+        head = buffer;
+        count++;
+    }
+};
+
+thread_local BufferPool bufferPool;
+
+void retain(Payload::Buffer* buffer) {
+    if (buffer) buffer->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void release(Payload::Buffer* buffer) {
+    if (buffer && buffer->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) bufferPool.recycle(buffer);
+}
+
+} // namespace
+
+Payload::Payload(std::string_view bytes) {
+    if (bytes.empty()) return;
+    if (bytes.size() > UINT32_MAX) throw std::runtime_error("Payload too large");
+    m_buffer = bufferPool.acquire();
+    m_buffer->bytes.assign(bytes.data(), bytes.size());
+    m_length = static_cast<uint32_t>(bytes.size());
+}
+
+Payload::Payload(const Payload& other) noexcept
+    : m_buffer(other.m_buffer), m_offset(other.m_offset), m_length(other.m_length) {
+    retain(m_buffer);
+}
+
+Payload::Payload(Payload&& other) noexcept
+    : m_buffer(other.m_buffer), m_offset(other.m_offset), m_length(other.m_length) {
+    other.m_buffer = nullptr;
+    other.m_offset = other.m_length = 0;
+}
+
+Payload& Payload::operator=(const Payload& other) noexcept {
+    retain(other.m_buffer);
+    release(m_buffer);
+    m_buffer = other.m_buffer;
+    m_offset = other.m_offset;
+    m_length = other.m_length;
+    return *this;
+}
+
+Payload& Payload::operator=(Payload&& other) noexcept {
+    if (this != &other) {
+        release(m_buffer);
+        m_buffer = other.m_buffer;
+        m_offset = other.m_offset;
+        m_length = other.m_length;
+        other.m_buffer = nullptr;
+        other.m_offset = other.m_length = 0;
+    }
+    return *this;
+}
+
+Payload::~Payload() {
+    release(m_buffer);
+}
+
+const char* Payload::data() const {
+    return m_buffer ? m_buffer->bytes.data() + m_offset : "";
+}
+
+Payload Payload::slice(size_t offset, size_t length) const {
+    if (offset > m_length) throw std::out_of_range("Payload slice out of range");
+    Payload part;
+    part.m_length = static_cast<uint32_t>(std::min<size_t>(length, m_length - offset));
+    if (part.m_length == 0) return part;
+    part.m_buffer = m_buffer;
+    part.m_offset = m_offset + static_cast<uint32_t>(offset);
+    retain(m_buffer);
+    return part;
+}
+
+Payload Payload::concat(const std::vector<Payload>& parts) {
+    // Sąsiednie kawałki jednego bufora - wynik jest po prostu szerszym wycinkiem
+    const Payload* first = nullptr;
+    bool contiguous = true;
+    size_t total = 0;
+    uint32_t end = 0;
+    for (const auto& part : parts) {
+        if (part.empty()) continue;
+        if (!first) first = &part;
+        else if (part.m_buffer != first->m_buffer || part.m_offset != end) contiguous = false;
+        end = part.m_offset + part.m_length;
+        total += part.m_length;
+    }
+    if (!first) return Payload();
+    if (contiguous) {
+        Payload whole = *first;
+        whole.m_length = static_cast<uint32_t>(total);
+        return whole;
+    }
+
+    if (total > UINT32_MAX) throw std::runtime_error("Payload too large");
+    Payload joined;
+    joined.m_buffer = bufferPool.acquire();
+    joined.m_buffer->bytes.clear();
+    joined.m_buffer->bytes.reserve(total);
+    for (const auto& part : parts) joined.m_buffer->bytes.append(part.data(), part.size());
+    joined.m_length = static_cast<uint32_t>(total);
+    return joined;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "IpAddress.hpp"
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Interned node name - a 32-bit id into a process-wide name table
+ *
+ * Copying and comparing endpoints is an integer operation; the name is
+ * looked up only when it is needed as a string. Id 0 is the empty name.
+ * A name that is an IP address is parsed once, when first interned.
+ */
+class Endpoint {
+public:
+    Endpoint() = default;
+    Endpoint(std::string_view name);
+    Endpoint(const std::string& name) : Endpoint(std::string_view(name)) {}
+    Endpoint(const char* name) : Endpoint(std::string_view(name)) {}
+
+    uint32_t id() const { return m_id; }
+    bool empty() const { return m_id == 0; }
+    const std::string& str() const;
+    operator const std::string&() const { return str(); }
+    // Adres IP, gdy nazwa nim jest (pusty dla nazw węzłów)
+    const IpAddress& ip() const;
+
+    friend bool operator==(Endpoint a, Endpoint b) { return a.m_id == b.m_id; }
+    friend bool operator!=(Endpoint a, Endpoint b) { return a.m_id != b.m_id; }
+    friend bool operator==(Endpoint a, const std::string& b) { return a.str() == b; }
+    friend bool operator!=(Endpoint a, const std::string& b) { return a.str() != b; }
+    friend bool operator==(Endpoint a, const char* b) { return a.str() == b; }
+    friend bool operator!=(Endpoint a, const char* b) { return a.str() != b; }
+    friend std::ostream& operator<<(std::ostream& os, Endpoint e) { return os << e.str(); }
+
+private:
+    uint32_t m_id = 0;
+};
+
+namespace std {
+template<> struct hash<Endpoint> {
+    size_t operator()(Endpoint e) const noexcept { return std::hash<uint32_t>()(e.id()); }
+};
+}
+
+// Znane typy i protokoły pakietów; inne napisy dostają kolejne kody (Other), po wyczerpaniu tabeli - "other"
+enum class PacketType : uint8_t { Other = 0, Data, Ack, Control };
+enum class Protocol : uint8_t { Other = 0, Tcp, Udp, Icmp };
+
+namespace packet_fields {
+// Tabela napisów jednego pola, kod 0 = "". Tabela żyje do końca procesu, więc napisy spoza znanych
+// (często z żądań) zajmują najwyżej MaxCodes kodów i MaxNameLength znaków; reszta dostaje wspólny kod "other"
+class TagTable {
+public:
+    static constexpr unsigned MaxCodes = 64;
+    static constexpr size_t MaxNameLength = 32;
+
+    explicit TagTable(std::vector<std::string> known);
+    uint8_t intern(std::string_view name);
+    // Rodzaj napisu bez dodawania go do tabeli (wielkość liter bez znaczenia)
+    uint8_t kindOf(std::string_view name) const;
+    const std::string& name(uint8_t code) const { return m_names[code]; }
+    uint8_t kind(uint8_t code) const { return m_kinds[code]; }
+
+private:
+    std::string m_names[MaxCodes];
+    uint8_t m_kinds[MaxCodes] = {};
+    unsigned m_count = 0;
+    size_t m_known = 0;
+    uint8_t m_other = 0;
+};
+
+template<typename Enum> TagTable& tagTable();
+template<> TagTable& tagTable<PacketType>();
+template<> TagTable& tagTable<Protocol>();
+} // namespace packet_fields
+
+/**
+ * @brief One-byte packet field (type, protocol) with an open set of values
+ *
+ * Values named by Enum have fixed codes; any other string is interned into
+ * the field's table and round-trips unchanged while the table has room.
+ * The table is bounded (TagTable::MaxCodes), so once it is full, or for
+ * overlong strings, the value becomes "other". kind() maps a value to its
+ * enumerator regardless of letter case ("TCP" -> Protocol::Tcp); kindOf()
+ * does the same for a string without interning it.
+ */
+template<typename Enum>
+class PacketTag {
+public:
+    PacketTag() = default;
+    PacketTag(Enum value) : m_code(static_cast<uint8_t>(value)) {}
+    PacketTag(std::string_view name) : m_code(packet_fields::tagTable<Enum>().intern(name)) {}
+    PacketTag(const std::string& name) : PacketTag(std::string_view(name)) {}
+    PacketTag(const char* name) : PacketTag(std::string_view(name)) {}
+
+    Enum kind() const { return static_cast<Enum>(packet_fields::tagTable<Enum>().kind(m_code)); }
+    static Enum kindOf(std::string_view name) { return static_cast<Enum>(packet_fields::tagTable<Enum>().kindOf(name)); }
+    uint8_t code() const { return m_code; }
+    const std::string& str() const { return packet_fields::tagTable<Enum>().name(m_code); }
+    operator const std::string&() const { return str(); }
+
+    friend bool operator==(PacketTag a, PacketTag b) { return a.m_code == b.m_code; }
+    friend bool operator!=(PacketTag a, PacketTag b) { return a.m_code != b.m_code; }
+    friend bool operator==(PacketTag a, Enum b) { return a.kind() == b; }
+    friend bool operator!=(PacketTag a, Enum b) { return a.kind() != b; }
+    friend bool operator==(PacketTag a, const std::string& b) { return a.str() == b; }
+    friend bool operator==(PacketTag a, const char* b) { return a.str() == b; }
+    friend std::ostream& operator<<(std::ostream& os, PacketTag t) { return os << t.str(); }
+
+private:
+    uint8_t m_code = 0;
+};
+
+/**
+ * @brief Immutable, reference-counted payload slice
+ *
+ * Copies share the buffer; slice() is zero-copy, and concat() of adjacent
+ * slices of one buffer (fragments of a packet in order) is zero-copy too.
+ * Buffers are recycled through a per-thread pool, so building payloads in a
+ * steady stream does not hit the heap once the pool is warm.
+ */
+class Payload {
+public:
+    Payload() = default;
+    Payload(std::string_view bytes);
+    Payload(const std::string& bytes) : Payload(std::string_view(bytes)) {}
+    Payload(const char* bytes) : Payload(std::string_view(bytes)) {}
+    Payload(const Payload& other) noexcept;
+    Payload(Payload&& other) noexcept;
+    Payload& operator=(const Payload& other) noexcept;
+    Payload& operator=(Payload&& other) noexcept;
+    ~Payload();
+
+    size_t size() const { return m_length; }
+    bool empty() const { return m_length == 0; }
+    const char* data() const;
+    std::string_view view() const { return std::string_view(data(), m_length); }
+    std::string str() const { return std::string(view()); }
+
+    // Rzuca std::out_of_range gdy offset > size(); length jest przycinane
+    Payload slice(size_t offset, size_t length) const;
+    static Payload concat(const std::vector<Payload>& parts);
+    bool sharesBufferWith(const Payload& other) const { return m_buffer && m_buffer == other.m_buffer; }
+
+    friend bool operator==(const Payload& a, const Payload& b) { return a.view() == b.view(); }
+    friend bool operator!=(const Payload& a, const Payload& b) { return a.view() != b.view(); }
+    friend bool operator==(const Payload& a, const std::string& b) { return a.view() == b; }
+    friend bool operator==(const Payload& a, const char* b) { return a.view() == b; }
+    friend std::ostream& operator<<(std::ostream& os, const Payload& p) { return os << p.view(); }
+
+    struct Buffer;
+
+private:
+    Buffer* m_buffer = nullptr;
+    uint32_t m_offset = 0;
+    uint32_t m_length = 0;
+};
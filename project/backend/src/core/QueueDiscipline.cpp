@@ -0,0 +1,345 @@
+#include "QueueDiscipline.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using netsim::sim::SimTime;
+using netsim::utils::RingBuffer;
+
+namespace {
+
+constexpr uint32_t MaxBands = 64;
+constexpr uint32_t MaxPacketBytes = 1514;   // CoDel: kolejka z jednym pakietem nie jest "stojąca"
+
+inline uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+class DropTailQueue : public QueueDiscipline {
+public:
+    explicit DropTailQueue(const QueueConfig& config) : QueueDiscipline(config, 1), m_queue(config.capacity) {}
+
+    std::unique_ptr<QueueDiscipline> clone() const override { return std::make_unique<DropTailQueue>(*this); }
+
+    EnqueueResult enqueue(QueueItem item, SimTime now) override {
+        if (full()) return reject(0, EnqueueResult::DroppedOverflow);
+        item.enqueuedAt = now;
+        m_queue.push(item);
+        accepted(0);
+        return EnqueueResult::Queued;
+    }
+
+    bool dequeue(SimTime now, QueueItem& out, std::vector<QueueItem>*) override {
+        if (m_queue.empty()) return false;
+        out = m_queue.pop();
+        departed(0, out, now);
+        return true;
+    }
+
+private:
+    RingBuffer<QueueItem> m_queue;
+};
+
+// Pasmo = priorytet (obcięty do bands - 1); maska niepustych pasm zamiast skanowania
+class StrictPriorityQueue : public QueueDiscipline {
+public:
+    explicit StrictPriorityQueue(const QueueConfig& config) : QueueDiscipline(config, config.bands) {
+        for (uint32_t b = 0; b < config.bands; ++b) m_bands.emplace_back(config.capacity);
+    }
+
+    std::unique_ptr<QueueDiscipline> clone() const override { return std::make_unique<StrictPriorityQueue>(*this); }
+
+    EnqueueResult enqueue(QueueItem item, SimTime now) override {
+        uint32_t band = std::min<uint32_t>(item.priority, m_config.bands - 1);
+        if (full()) return reject(band, EnqueueResult::DroppedOverflow);
+        item.enqueuedAt = now;
+        m_bands[band].push(item);
+        m_nonEmpty |= uint64_t(1) << band;
+        accepted(band);
+        return EnqueueResult::Queued;
+    }
+
+    bool dequeue(SimTime now, QueueItem& out, std::vector<QueueItem>*) override {
+        if (!m_nonEmpty) return false;
+        uint32_t band = 63 - __builtin_clzll(m_nonEmpty);
+        out = m_bands[band].pop();
+        if (m_bands[band].empty()) m_nonEmpty &= ~(uint64_t(1) << band);
+        departed(band, out, now);
+        return true;
+    }
+
+private:
+    std::vector<RingBuffer<QueueItem>> m_bands;
+    uint64_t m_nonEmpty = 0;
+};
+
+// Deficit Round Robin (Shreedhar, Varghese 1995): przepływy haszowane do bands kubełków,
+// aktywne kubełki w kolejce cyklicznej, każdy dostaje quantumBytes na rundę
+class DeficitRoundRobinQueue : public QueueDiscipline {
+public:
+    explicit DeficitRoundRobinQueue(const QueueConfig& config)
+        : QueueDiscipline(config, config.bands), m_active(config.bands), m_deficit(config.bands, 0) {
+        for (uint32_t b = 0; b < config.bands; ++b) m_buckets.emplace_back(config.capacity);
+    }
+
+    std::unique_ptr<QueueDiscipline> clone() const override { return std::make_unique<DeficitRoundRobinQueue>(*this); }
+
+    EnqueueResult enqueue(QueueItem item, SimTime now) override {
+        uint32_t bucket = static_cast<uint32_t>(mix(item.flow) % m_config.bands);
+        if (full()) return reject(bucket, EnqueueResult::DroppedOverflow);
+        item.enqueuedAt = now;
+        if (m_buckets[bucket].empty()) m_active.push(bucket);
+        m_buckets[bucket].push(item);
+        accepted(bucket);
+        return EnqueueResult::Queued;
+    }
+
+    bool dequeue(SimTime now, QueueItem& out, std::vector<QueueItem>*) override {
+        if (m_active.empty()) return false;
+        uint32_t bucket = m_active.front();
+        // Kubełek bez deficytu na pakiet z czoła dostaje kwant i idzie na koniec rundy
+        while (m_deficit[bucket] < m_buckets[bucket].front().sizeBytes) {
+            m_deficit[bucket] += m_config.quantumBytes;
+            m_active.push(m_active.pop());
+            bucket = m_active.front();
+        }
+        out = m_buckets[bucket].pop();
+        m_deficit[bucket] -= out.sizeBytes;
+        if (m_buckets[bucket].empty()) {
+            m_deficit[bucket] = 0;
+            m_active.pop();
+        }
+        departed(bucket, out, now);
+        return true;
+    }
+
+private:
+    std::vector<RingBuffer<QueueItem>> m_buckets;
+    RingBuffer<uint32_t> m_active;
+    std::vector<uint64_t> m_deficit;
+};
+
+class RedQueue : public QueueDiscipline {
+public:
+    explicit RedQueue(const QueueConfig& config) : QueueDiscipline(config, 1), m_queue(config.capacity) {}
+
+    std::unique_ptr<QueueDiscipline> clone() const override { return std::make_unique<RedQueue>(*this); }
+
+    EnqueueResult enqueue(QueueItem item, SimTime now) override {
+        const QueueConfig& c = m_config;
+        m_average = (1.0 - c.redWeight) * m_average + c.redWeight * static_cast<double>(m_queue.size());
+        if (m_average >= c.redMaxThreshold) {
+            m_count = 0;
+            return reject(0, EnqueueResult::DroppedEarly);
+        }
+        if (m_average >= c.redMinThreshold) {
+            // Odstępy między odrzuceniami ~ jednostajne: pa = pb / (1 - count * pb)
+            m_count++;
+            double pb = c.redMaxProbability * (m_average - c.redMinThreshold) / (c.redMaxThreshold - c.redMinThreshold);
+            double spread = 1.0 - m_count * pb;
+            double pa = spread > 0.0 ? pb / spread : 1.0;
+            if (random() < pa) {
+                m_count = 0;
+                return reject(0, EnqueueResult::DroppedEarly);
+            }
+        } else {
+            m_count = 0;
+        }
+        if (full()) return reject(0, EnqueueResult::DroppedOverflow);
+        item.enqueuedAt = now;
+        m_queue.push(item);
+        accepted(0);
+        return EnqueueResult::Queued;
+    }
+
+    bool dequeue(SimTime now, QueueItem& out, std::vector<QueueItem>*) override {
+        if (m_queue.empty()) return false;
+        out = m_queue.pop();
+        departed(0, out, now);
+        return true;
+    }
+
+private:
+    RingBuffer<QueueItem> m_queue;
+    double m_average = 0.0;
+    uint32_t m_count = 0;             // pakiety od ostatniego odrzucenia
+    uint64_t m_draws = 0;
+
+    double random() { return (mix(m_config.seed + ++m_draws * 0x9e3779b97f4a7c15ull) >> 11) * 0x1.0p-53; }
+};
+
+// CoDel wg pseudokodu z RFC 8289: odrzucanie przy wyjmowaniu, gdy czas w kolejce
+// przekracza target przez cały interval; kolejne odrzucenia co interval / sqrt(count)
+class CoDelQueue : public QueueDiscipline {
+public:
+    explicit CoDelQueue(const QueueConfig& config) : QueueDiscipline(config, 1), m_queue(config.capacity) {}
+
+    std::unique_ptr<QueueDiscipline> clone() const override { return std::make_unique<CoDelQueue>(*this); }
+
+    EnqueueResult enqueue(QueueItem item, SimTime now) override {
+        if (full()) return reject(0, EnqueueResult::DroppedOverflow);
+        item.enqueuedAt = now;
+        m_queue.push(item);
+        m_bytes += item.sizeBytes;
+        accepted(0);
+        return EnqueueResult::Queued;
+    }
+
+    bool dequeue(SimTime now, QueueItem& out, std::vector<QueueItem>* dropped) override {
+        bool okToDrop = false;
+        if (!pop(now, out, okToDrop)) {
+            m_dropping = false;
+            return false;
+        }
+        if (m_dropping) {
+            if (!okToDrop) {
+                m_dropping = false;
+            } else {
+                while (now >= m_dropNext && m_dropping) {
+                    drop(out, dropped);
+                    m_count++;
+                    if (!pop(now, out, okToDrop)) {
+                        m_dropping = false;
+                        return false;
+                    }
+                    if (!okToDrop) m_dropping = false;
+                    else m_dropNext = controlLaw(m_dropNext);
+                }
+            }
+        } else if (okToDrop) {
+            drop(out, dropped);
+            bool more = pop(now, out, okToDrop);
+            m_dropping = true;
+            // Wróć do poprzedniego tempa, jeśli stan odrzucania skończył się niedawno; m_dropNext bywa
+            // w przyszłości (wyjście przed kolejnym odrzuceniem), więc bez odejmowania na typie bez znaku
+            uint32_t delta = m_count - m_lastCount;
+            m_count = (delta > 1 && now < m_dropNext + 16 * m_config.codelInterval) ? delta : 1;
+            m_dropNext = controlLaw(now);
+            m_lastCount = m_count;
+            if (!more) return false;
+        }
+        departed(0, out, now);
+        return true;
+    }
+
+private:
+    RingBuffer<QueueItem> m_queue;
+    uint64_t m_bytes = 0;
+    SimTime m_firstAboveTime = 0;
+    SimTime m_dropNext = 0;
+    uint32_t m_count = 0;
+    uint32_t m_lastCount = 0;
+    bool m_dropping = false;
+
+    bool pop(SimTime now, QueueItem& out, bool& okToDrop) {
+        okToDrop = false;
+        if (m_queue.empty()) {
+            m_firstAboveTime = 0;
+            return false;
+        }
+        out = m_queue.pop();
+        m_bytes -= out.sizeBytes;
+        SimTime sojourn = now - out.enqueuedAt;
+        if (sojourn < m_config.codelTarget || m_bytes <= MaxPacketBytes) {
+            m_firstAboveTime = 0;
+        } else if (m_firstAboveTime == 0) {
+            m_firstAboveTime = now + m_config.codelInterval;
+        } else if (now >= m_firstAboveTime) {
+            okToDrop = true;
+        }
+        return true;
+    }
+
+    void drop(const QueueItem& item, std::vector<QueueItem>* dropped) {
+        m_stats[0].droppedEarly++;
+        m_size--;
+        if (dropped) dropped->push_back(item);
+    }
+
+    SimTime controlLaw(SimTime t) const {
+        return t + static_cast<SimTime>(m_config.codelInterval / std::sqrt(static_cast<double>(m_count)));
+    }
+};
+
+} // namespace
+
+QueueDisciplineType QueueConfig::parseType(const std::string& name) {
+    if (name == "droptail" || name == "fifo") return QueueDisciplineType::DropTail;
+    if (name == "priority" || name == "strict_priority") return QueueDisciplineType::StrictPriority;
+    if (name == "drr") return QueueDisciplineType::DeficitRoundRobin;
+    if (name == "red") return QueueDisciplineType::Red;
+    if (name == "codel") return QueueDisciplineType::CoDel;
+    throw std::runtime_error("Unknown queue discipline: " + name);
+}
+
+std::string QueueConfig::typeName(QueueDisciplineType type) {
+    switch (type) {
+    case QueueDisciplineType::DropTail: return "droptail";
+    case QueueDisciplineType::StrictPriority: return "priority";
+    case QueueDisciplineType::DeficitRoundRobin: return "drr";
+    case QueueDisciplineType::Red: return "red";
+    case QueueDisciplineType::CoDel: return "codel";
+    }
+    return "droptail";
+}
+
+std::unique_ptr<QueueDiscipline> QueueDiscipline::create(const QueueConfig& config) {
+    if (config.bands == 0 || config.bands > MaxBands)
+        throw std::runtime_error("Queue bands must be in [1, 64]");
+    if (config.type == QueueDisciplineType::DeficitRoundRobin && config.quantumBytes == 0)
+        throw std::runtime_error("DRR quantum must be positive");
+    if (config.type == QueueDisciplineType::Red &&
+        (config.redMinThreshold < 0.0 || config.redMaxThreshold <= config.redMinThreshold ||
+         config.redMaxProbability <= 0.0 || config.redMaxProbability > 1.0 ||
+         config.redWeight <= 0.0 || config.redWeight > 1.0))
+        throw std::runtime_error("Invalid RED parameters");
+    if (config.type == QueueDisciplineType::CoDel && (config.codelTarget == 0 || config.codelInterval == 0))
+        throw std::runtime_error("Invalid CoDel parameters");
+
+    switch (config.type) {
+    case QueueDisciplineType::DropTail: return std::make_unique<DropTailQueue>(config);
+    case QueueDisciplineType::StrictPriority: return std::make_unique<StrictPriorityQueue>(config);
+    case QueueDisciplineType::DeficitRoundRobin: return std::make_unique<DeficitRoundRobinQueue>(config);
+    case QueueDisciplineType::Red: return std::make_unique<RedQueue>(config);
+    case QueueDisciplineType::CoDel: return std::make_unique<CoDelQueue>(config);
+    }
+    throw std::runtime_error("Unknown queue discipline");
+}
+
+QueueDiscipline::QueueDiscipline(const QueueConfig& config, size_t bands) : m_config(config), m_stats(bands) {
+}
+
+QueueStats QueueDiscipline::totals() const {
+    QueueStats total;
+    for (const auto& s : m_stats) {
+        total.enqueued += s.enqueued;
+        total.dequeued += s.dequeued;
+        total.droppedOverflow += s.droppedOverflow;
+        total.droppedEarly += s.droppedEarly;
+        total.totalSojourn += s.totalSojourn;
+        total.maxSojourn = std::max(total.maxSojourn, s.maxSojourn);
+    }
+    return total;
+}
+
+EnqueueResult QueueDiscipline::reject(size_t band, EnqueueResult reason) {
+    if (reason == EnqueueResult::DroppedEarly) m_stats[band].droppedEarly++;
+    else m_stats[band].droppedOverflow++;
+    return reason;
+}
+
+void QueueDiscipline::accepted(size_t band) {
+    m_stats[band].enqueued++;
+    m_size++;
+}
+
+void QueueDiscipline::departed(size_t band, const QueueItem& item, SimTime now) {
+    QueueStats& s = m_stats[band];
+    SimTime sojourn = now - item.enqueuedAt;
+    s.dequeued++;
+    s.totalSojourn += sojourn;
+    s.maxSojourn = std::max(s.maxSojourn, sojourn);
+    m_size--;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../sim/EventScheduler.hpp"
+#include "../utils/RingBuffer.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class QueueDisciplineType : uint8_t {
+    DropTail,           // jedna kolejka FIFO, odrzucanie przy przepełnieniu
+    StrictPriority,     // pasmo = Packet::priority, wyższe pasmo zawsze pierwsze
+    DeficitRoundRobin,  // kolejki per przepływ (hash), sprawiedliwie w bajtach
+    Red,                // Random Early Detection (Floyd, Jacobson 1993)
+    CoDel               // Controlled Delay (RFC 8289)
+};
+
+struct QueueConfig {
+    QueueDisciplineType type = QueueDisciplineType::DropTail;
+    uint32_t capacity = 10;                  // pakiety, łącznie dla wszystkich pasm
+    uint32_t bands = 8;                      // StrictPriority / DRR
+    uint32_t quantumBytes = 1514;            // DRR
+    double redMinThreshold = 5.0;            // pakiety (średnia długość kolejki)
+    double redMaxThreshold = 15.0;
+    double redMaxProbability = 0.1;
+    double redWeight = 0.002;                // waga EWMA średniej
+    netsim::sim::SimTime codelTarget = 5 * netsim::sim::Millisecond;
+    netsim::sim::SimTime codelInterval = 100 * netsim::sim::Millisecond;
+    uint64_t seed = 1;                       // losowanie RED
+
+    // "droptail", "priority", "drr", "red", "codel"; rzuca std::runtime_error dla nieznanej
+    static QueueDisciplineType parseType(const std::string& name);
+    static std::string typeName(QueueDisciplineType type);
+};
+
+/**
+ * @brief Queued packet as seen by a discipline; handle is owner-defined
+ */
+struct QueueItem {
+    uint32_t handle = 0;
+    uint32_t sizeBytes = 0;
+    uint32_t flow = 0;                       // klucz przepływu dla DRR
+    uint8_t priority = 0;
+    netsim::sim::SimTime enqueuedAt = 0;
+};
+
+struct QueueStats {
+    uint64_t enqueued = 0;
+    uint64_t dequeued = 0;
+    uint64_t droppedOverflow = 0;            // pełny bufor
+    uint64_t droppedEarly = 0;               // decyzja AQM (RED, CoDel)
+    netsim::sim::SimTime totalSojourn = 0;   // czas w kolejce wyjętych pakietów
+    netsim::sim::SimTime maxSojourn = 0;
+
+    double averageSojournNs() const { return dequeued ? double(totalSojourn) / dequeued : 0.0; }
+};
+
+enum class EnqueueResult : uint8_t {
+    Queued,
+    DroppedOverflow,
+    DroppedEarly
+};
+
+/**
+ * @brief Queueing discipline of one node or port
+ *
+ * Items live in ring buffers preallocated for the full capacity, so
+ * enqueue/dequeue never allocate. Every band (the single queue, a priority
+ * level or a DRR flow bucket) keeps its own drop and sojourn counters.
+ */
+class QueueDiscipline {
+public:
+    virtual ~QueueDiscipline() = default;
+
+    static std::unique_ptr<QueueDiscipline> create(const QueueConfig& config);
+    // Pełna kopia: kolejka, liczniki i stan (średnia RED, losowanie, stan CoDel)
+    virtual std::unique_ptr<QueueDiscipline> clone() const = 0;
+
+    virtual EnqueueResult enqueue(QueueItem item, netsim::sim::SimTime now) = 0;
+    // false gdy kolejka pusta; pakiety porzucone przy wyjmowaniu (CoDel) trafiają do dropped
+    virtual bool dequeue(netsim::sim::SimTime now, QueueItem& out, std::vector<QueueItem>* dropped = nullptr) = 0;
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size >= m_config.capacity; }
+    const QueueConfig& config() const { return m_config; }
+    const std::vector<QueueStats>& bandStats() const { return m_stats; }
+    QueueStats totals() const;
+
+protected:
+    QueueDiscipline(const QueueConfig& config, size_t bands);
+
+    // Liczniki wspólne dla wszystkich dyscyplin
+    EnqueueResult reject(size_t band, EnqueueResult reason);
+    void accepted(size_t band);
+    void departed(size_t band, const QueueItem& item, netsim::sim::SimTime now);
+
+    QueueConfig m_config;
+    std::vector<QueueStats> m_stats;
+    size_t m_size = 0;
+};
@@ -0,0 +1,160 @@
+#include "ReassemblyTable.hpp"
+#include <algorithm>
+
+ReassemblyTable::ReassemblyTable(const ReassemblyOptions& options) : m_options(options) {
+}
+
+ReassemblyStatus ReassemblyTable::insert(const Packet& fragment, netsim::sim::SimTime now, Packet& out) {
+    if (fragment.fragmentId == 0) {
+        out = fragment;
+        return ReassemblyStatus::Complete;
+    }
+    expire(now);
+
+    const size_t size = fragment.payload.size();
+    if (fragment.seqNum < 0 || static_cast<uint32_t>(fragment.seqNum) >= m_options.maxFragmentsPerPacket ||
+        size > m_options.memoryBudgetBytes) {
+        m_stats.dropped++;
+        return ReassemblyStatus::Dropped;
+    }
+    const uint32_t seq = static_cast<uint32_t>(fragment.seqNum);
+
+    Key key{fragment.src.id(), fragment.dest.id(), static_cast<uint32_t>(fragment.fragmentId)};
+    auto it = m_index.find(key);
+    uint32_t index = it != m_index.end() ? it->second : createEntry(key, fragment, now);
+    Entry* entry = &m_entries[index];
+
+    if (seq < entry->received.size() && entry->received[seq]) {
+        m_stats.duplicates++;
+        return ReassemblyStatus::Duplicate;
+    }
+    // Niespójny fragment (za ostatnim albo drugi "ostatni") - porzuć cały pakiet
+    bool inconsistent = (entry->total != Unknown && seq >= entry->total) ||
+                        (fragment.isLast && (entry->total != Unknown || entry->received.size() > seq + 1));
+    if (inconsistent) {
+        m_stats.dropped++;
+        releaseEntry(index);
+        return ReassemblyStatus::Dropped;
+    }
+
+    while (m_bytesHeld + size > m_options.memoryBudgetBytes) {
+        if (!evictOldest(index)) {
+            m_stats.dropped++;
+            releaseEntry(index);
+            return ReassemblyStatus::Dropped;
+        }
+    }
+    entry = &m_entries[index];
+
+    if (seq >= entry->received.size()) {
+        entry->received.resize(seq + 1, 0);
+        entry->parts.resize(seq + 1);
+    }
+    entry->received[seq] = 1;
+    entry->parts[seq] = fragment.payload;
+    entry->count++;
+    entry->bytes += size;
+    m_bytesHeld += size;
+    if (fragment.isLast) entry->total = seq + 1;
+
+    if (entry->count != entry->total) return ReassemblyStatus::Pending;
+
+    out = entry->header;
+    out.payload = Payload::concat(entry->parts);
+    out.fragmentId = 0;
+    out.seqNum = 0;
+    out.isLast = false;
+    m_stats.completed++;
+    releaseEntry(index);
+    return ReassemblyStatus::Complete;
+}
+
+size_t ReassemblyTable::expire(netsim::sim::SimTime now) {
+    size_t expired = 0;
+    while (!m_fifo.empty()) {
+        auto [index, generation] = m_fifo.front();
+        const Entry& entry = m_entries[index];
+        if (entry.live && entry.generation == generation) {
+            if (entry.deadline > now) break;
+            releaseEntry(index);
+            m_stats.timedOut++;
+            expired++;
+        }
+        m_fifo.pop_front();
+    }
+    return expired;
+}
+
+void ReassemblyTable::clear() {
+    m_index.clear();
+    m_entries.clear();
+    m_freeEntries.clear();
+    m_fifo.clear();
+    m_bytesHeld = 0;
+}
+
+std::vector<uint32_t> ReassemblyTable::missingFragments(Endpoint src, Endpoint dest, int fragmentId) const {
+    std::vector<uint32_t> missing;
+    auto it = m_index.find(Key{src.id(), dest.id(), static_cast<uint32_t>(fragmentId)});
+    if (it == m_index.end()) return missing;
+    const Entry& entry = m_entries[it->second];
+    for (uint32_t seq = 0; seq < entry.received.size(); ++seq)
+        if (!entry.received[seq]) missing.push_back(seq);
+    return missing;
+}
+
+uint32_t ReassemblyTable::createEntry(const Key& key, const Packet& fragment, netsim::sim::SimTime now) {
+    uint32_t index;
+    if (!m_freeEntries.empty()) {
+        index = m_freeEntries.back();
+        m_freeEntries.pop_back();
+    } else {
+        index = static_cast<uint32_t>(m_entries.size());
+        m_entries.emplace_back();
+    }
+    Entry& entry = m_entries[index];
+    entry.key = key;
+    entry.header = fragment;
+    entry.header.payload = Payload();
+    entry.count = 0;
+    entry.total = Unknown;
+    entry.bytes = 0;
+    entry.deadline = now + m_options.timeout;
+    entry.live = true;
+    m_index.emplace(key, index);
+    m_fifo.emplace_back(index, entry.generation);
+    return index;
+}
+
+void ReassemblyTable::releaseEntry(uint32_t index) {
+    Entry& entry = m_entries[index];
+    m_index.erase(entry.key);
+    m_bytesHeld -= entry.bytes;
+    // Wektory zachowują pojemność do ponownego użycia wpisu
+    entry.parts.clear();
+    entry.received.clear();
+    entry.header = Packet();
+    entry.live = false;
+    entry.generation++;
+    m_freeEntries.push_back(index);
+}
+
+bool ReassemblyTable::evictOldest(uint32_t keep) {
+    for (auto it = m_fifo.begin(); it != m_fifo.end();) {
+        auto [index, generation] = *it;
+        const Entry& entry = m_entries[index];
+        if (!entry.live || entry.generation != generation) {
+            it = m_fifo.erase(it);
+            continue;
+        }
+        if (index == keep) {
+            ++it;
+            continue;
+        }
+        releaseEntry(index);
+        m_stats.evicted++;
+        m_fifo.erase(it);
+        return true;
+    }
+    return false;
+}
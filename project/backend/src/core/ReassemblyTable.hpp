@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Packet.hpp"
+#include "../sim/EventScheduler.hpp"
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+struct ReassemblyOptions {
+    netsim::sim::SimTime timeout = 30 * netsim::sim::Second; // jak ipfrag_time
+    size_t memoryBudgetBytes = 4 * 1024 * 1024;               // suma payloadów trzymanych fragmentów
+    uint32_t maxFragmentsPerPacket = 8192;
+};
+
+struct ReassemblyStats {
+    uint64_t completed = 0;
+    uint64_t duplicates = 0;
+    uint64_t timedOut = 0;     // pakiety porzucone po timeout
+    uint64_t evicted = 0;      // pakiety porzucone przez budżet pamięci
+    uint64_t dropped = 0;      // fragmenty odrzucone (niespójne, za duże)
+};
+
+enum class ReassemblyStatus : uint8_t {
+    Complete,    // out zawiera cały pakiet
+    Pending,     // brakuje fragmentów
+    Duplicate,
+    Dropped
+};
+
+/**
+ * @brief Streaming reassembly of fragments keyed by (src, dest, fragmentId)
+ *
+ * A fragment is filed at slot seqNum of its packet's entry in O(1); the
+ * entry tracks which slots are filled, so duplicates and gaps are known
+ * without sorting. Completed packets are concatenated from the fragment
+ * slices (zero-copy when they are adjacent slices of one buffer).
+ *
+ * Entries expire timeout after their first fragment and the bytes held by
+ * all entries stay under memoryBudgetBytes - the oldest entries are evicted
+ * first. Both use one creation-ordered FIFO, since every entry has the same
+ * lifetime.
+ */
+class ReassemblyTable {
+public:
+    explicit ReassemblyTable(const ReassemblyOptions& options = ReassemblyOptions());
+
+    // Fragment z fragmentId == 0 jest całym pakietem i wraca od razu jako Complete
+    ReassemblyStatus insert(const Packet& fragment, netsim::sim::SimTime now, Packet& out);
+    // Porzuca wpisy starsze niż timeout; zwraca liczbę porzuconych pakietów
+    size_t expire(netsim::sim::SimTime now);
+    void clear();
+
+    // Brakujące numery fragmentów (do ostatniego znanego); pusty gdy pakietu nie ma w tablicy
+    std::vector<uint32_t> missingFragments(Endpoint src, Endpoint dest, int fragmentId) const;
+
+    size_t pending() const { return m_index.size(); }
+    size_t bytesHeld() const { return m_bytesHeld; }
+    const ReassemblyStats& stats() const { return m_stats; }
+    const ReassemblyOptions& options() const { return m_options; }
+
+private:
+    static constexpr uint32_t Unknown = UINT32_MAX;
+
+    struct Key {
+        uint32_t src;
+        uint32_t dest;
+        uint32_t fragmentId;
+        bool operator==(const Key& o) const { return src == o.src && dest == o.dest && fragmentId == o.fragmentId; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            uint64_t h = (uint64_t(k.src) << 32 | k.dest) * 0x9e3779b97f4a7c15ull;
+            return static_cast<size_t>(h ^ (uint64_t(k.fragmentId) * 0xbf58476d1ce4e5b9ull) ^ (h >> 29));
+        }
+    };
+
+    struct Entry {
+        Key key{};
+        Packet header;                 // pola pierwszego fragmentu
+        std::vector<Payload> parts;    // seqNum -> payload
+        std::vector<uint8_t> received; // seqNum -> czy dotarł
+        uint32_t count = 0;
+        uint32_t total = Unknown;      // znane po fragmencie isLast
+        size_t bytes = 0;
+        netsim::sim::SimTime deadline = 0;
+        uint32_t generation = 0;
+        bool live = false;
+    };
+
+    ReassemblyOptions m_options;
+    std::unordered_map<Key, uint32_t, KeyHash> m_index;
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_freeEntries;
+    std::deque<std::pair<uint32_t, uint32_t>> m_fifo; // (wpis, generacja) w kolejności tworzenia
+    size_t m_bytesHeld = 0;
+    ReassemblyStats m_stats;
+
+    uint32_t createEntry(const Key& key, const Packet& fragment, netsim::sim::SimTime now);
+    void releaseEntry(uint32_t index);
+    bool evictOldest(uint32_t keep);
+};
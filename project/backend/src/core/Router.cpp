@@ -1,29 +1,107 @@
 #include "Router.hpp"
+#include <stdexcept>
 
-Node *Router::getNextHop(const std::string &dst)
+void Router::addRoute(const std::string& dst, Node* next)
 {
-    auto it = routingTable.find(dst);
-    if (it != routingTable.end()) return it->second;
+    IpPrefix prefix;
+    if (IpPrefix::parse(dst, prefix)) fib.insert(prefix, next);
+    else namedRoutes[dst] = next;
+}
+
+void Router::addRoutes(const std::vector<std::pair<std::string, Node*>>& routes)
+{
+    std::vector<Fib::Route> prefixes;
+    prefixes.reserve(routes.size());
+    for (const auto& route : routes) {
+        IpPrefix prefix;
+        if (IpPrefix::parse(route.first, prefix)) prefixes.push_back({prefix, route.second});
+        else namedRoutes[route.first] = route.second;
+    }
+    fib.insertBulk(prefixes);
+}
+
+Fib::GroupId Router::addRouteGroup(const std::string& dst, const std::vector<Fib::GroupMember>& members)
+{
+    IpPrefix prefix;
+    if (!IpPrefix::parse(dst, prefix)) throw std::runtime_error("ECMP route needs an IP prefix: " + dst);
+    // Prefiks z grupą dostaje nowy skład tej samej grupy - przepływy pozostałych członków zostają na miejscu
+    Fib::GroupId group;
+    if (fib.groupAt(prefix, group)) {
+        fib.setGroupMembers(group, members);
+        return group;
+    }
+    group = fib.addGroup(members);
+    fib.insertGroup(prefix, group);
+    return group;
+}
+
+bool Router::removeRoute(const std::string& dst)
+{
+    IpPrefix prefix;
+    if (IpPrefix::parse(dst, prefix)) return fib.remove(prefix);
+    return namedRoutes.erase(dst) > 0;
+}
+
+Node *Router::getNextHop(const std::string &dst) const
+{
+    IpPrefix address;
+    if (IpPrefix::parse(dst, address)) return fib.lookup(address);
+    auto it = namedRoutes.find(dst);
+    if (it != namedRoutes.end()) return it->second;
     return nullptr;
 }
 
+Node* Router::getNextHop(const std::string& dst, uint32_t flowHash) const
+{
+    IpPrefix address;
+    if (IpPrefix::parse(dst, address)) return fib.lookup(address, flowHash);
+    auto it = namedRoutes.find(dst);
+    return it != namedRoutes.end() ? it->second : nullptr;
+}
+
+uint32_t Router::flowHashOf(const Packet& p) const
+{
+    return flowHash(FlowKey{p.src.id(), p.dest.id(), 0, 0, p.protocol.code()}, flowSeed());
+}
+
+Node* Router::nextHopFor(const Packet& p)
+{
+    const IpAddress& address = p.dest.ip();
+    if (!address.empty())
+        return fib.forward(address.prefix(), flowHashOf(p), static_cast<uint32_t>(p.payload.size()));
+    auto it = namedRoutes.find(p.dest);
+    return it != namedRoutes.end() ? it->second : nullptr;
+}
+
+bool Router::hasRouteTo(const std::string& dst) const
+{
+    IpPrefix prefix;
+    if (IpPrefix::parse(dst, prefix)) return fib.contains(prefix);
+    return namedRoutes.find(dst) != namedRoutes.end();
+}
+
 void Router::receivePacket(Packet &p)
 {
-    std::cout << "[ROUTER " << name << "] Received packet destined for " << p.dest << std::endl;
+    // Kolejne routery na ścieżce w pętli, nie rekurencyjnie - stos nie rośnie z długością ścieżki
+    Router* router = this;
+    while (router) {
+        std::cout << "[ROUTER " << router->name << "] Received packet destined for " << p.dest << std::endl;
 
-    if (p.ttl > 0) {
-        p.ttl--;
-    } else {
-        std::cout << "[ROUTER " << name << "] Packet TTL expired.\n";
-        return;
-    }
+        if (p.ttl > 0) {
+            p.ttl--;
+        } else {
+            std::cout << "[ROUTER " << router->name << "] Packet TTL expired.\n";
+            return;
+        }
 
-    auto it = routingTable.find(p.dest);
-    if (it != routingTable.end()) {
-        Node* nextHop = it->second;
-        std::cout << "[ROUTER " << name << "] Forwarding packet to next hop: " << nextHop->getName() << std::endl;
-        sendPacket(p, *nextHop);
-    } else {
-        std::cout << "[ROUTER " << name << "] No route to destination: " << p.dest << std::endl;
+        Node* nextHop = router->nextHopFor(p);
+        if (!nextHop) {
+            std::cout << "[ROUTER " << router->name << "] No route to destination: " << p.dest << std::endl;
+            return;
+        }
+        std::cout << "[ROUTER " << router->name << "] Forwarding packet to next hop: " << nextHop->getName() << std::endl;
+        router->incrementPacketCount();
+        router = dynamic_cast<Router*>(nextHop);
+        if (!router) nextHop->receivePacket(p);
     }
-}
\ No newline at end of file
+}
@@ -1,20 +1,32 @@
 #pragma once
 #include "Node.hpp"
+#include "Fib.hpp"
+#include <functional>
 #include <map>
 #include <iostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class Router : public Node {
-    std::map<std::string, Node*> routingTable; // IP → next hop
+    // Trasy do adresów i prefiksów IP (LPM); pozostałe cele (nazwy węzłów) - dokładne dopasowanie
+    Fib fib;
+    std::unordered_map<std::string, Node*> namedRoutes;
 
 public:
     using Node::Node;
     
     std::string getType() const override { return "router"; }
-
-    Node* getNextHop(const std::string& dst);
+    std::shared_ptr<Node> clone() const override { return std::make_shared<Router>(*this); }
+    void remapPeers(const std::function<Node*(Node*)>& peer) override {
+        Node::remapPeers(peer);
+        fib.remapNextHops(peer);
+        for (auto& entry : namedRoutes)
+            if (entry.second) entry.second = peer(entry.second);
+    }
 
     bool forwardPacket(Packet& p) {
-        Node* nextHop = getNextHop(p.dest);
+        Node* nextHop = nextHopFor(p);
         if (nextHop) {
             nextHop->receivePacket(p);
             return true;
@@ -22,89 +34,85 @@ public:
         return false; // No route found
     }
 
-    void addRoute(const std::string& ip, Node* next) {
-        routingTable[ip] = next;
-    }
+    // dst: "10.0.0.1", "10.0.0.0/24", "2001:db8::/32" albo nazwa węzła
+    void addRoute(const std::string& dst, Node* next);
+    // Trasy instalowane razem, FIB kompilowany raz
+    void addRoutes(const std::vector<std::pair<std::string, Node*>>& routes);
+    bool removeRoute(const std::string& dst);
+    // Trasa ECMP/WCMP do prefiksu IP; zwraca grupę do zmian składu (getFib().setGroupMembers).
+    // Ponowne dodanie prefiksu z grupą zmienia skład tej grupy (odporne haszowanie, liczniki zostają).
+    // Rzuca std::runtime_error gdy dst nie jest adresem ani prefiksem IP
+    Fib::GroupId addRouteGroup(const std::string& dst, const std::vector<Fib::GroupMember>& members);
 
-    Node* getNextHop(const std::string& dst) const {
-        auto it = routingTable.find(dst);
-        if (it != routingTable.end()) return it->second;
-        return nullptr;
-    }
+    // Longest prefix match dla adresów IP, dokładne dopasowanie dla nazw
+    Node* getNextHop(const std::string& dst) const;
+    Node* getNextHop(uint32_t ipv4) const { return fib.lookup4(ipv4); }
+    Node* getNextHop(const IpAddress& address) const { return fib.lookup(address.prefix()); }
+    // Trasy-grupy wybierają członka po hashu przepływu
+    Node* getNextHop(const std::string& dst, uint32_t flowHash) const;
+    // Next hop pakietu: hash przepływu (nadawca, cel, protokół), liczniki członka grupy
+    Node* nextHopFor(const Packet& p);
+    uint32_t flowHashOf(const Packet& p) const;
+
+    // Tablica przekazywania: wsadowe wyszukiwanie (lookupBatch4) i statystyki
+    const Fib& getFib() const { return fib; }
+    Fib& getFib() { return fib; }
+    size_t getRouteCount() const { return fib.size() + namedRoutes.size(); }
 
     void receivePacket(Packet& p) override;
 
     void printRoutingTable() const {
         std::cout << "Routing Table for Router " << name << ":\n";
-        for (const auto& entry : routingTable) {
-            std::cout << "  Destination: " << entry.first << " -> Next Hop: " << entry.second->getName() << "\n";
-        }
+        forEachRoute([](const std::string& dst, Node* next) {
+            std::cout << "  Destination: " << dst << " -> Next Hop: " << (next ? next->getName() : "-") << "\n";
+        });
+    }
+
+    void forEachRoute(const std::function<void(const std::string&, Node*)>& fn) const {
+        fib.forEach([&](const IpPrefix& prefix, Node* next) { fn(prefix.str(), next); });
+        for (const auto& entry : namedRoutes) fn(entry.first, entry.second);
     }
 
     void clearRoutingTable() {
-        routingTable.clear();
+        fib.clear();
+        namedRoutes.clear();
     }
 
     void routeAll(const std::map<std::string, Node*>& allNodes) {
         for (const auto& entry : allNodes) {
             if (entry.first != ip) {
-                routingTable[entry.first] = nullptr;
+                addRoute(entry.first, nullptr);
             }
         }
     }
 
     void exchangeRoutingInfo(Router* otherRouter) {
         if (!otherRouter) return;
-        for (const auto& entry : routingTable) {
-            if (!otherRouter->hasRouteTo(entry.first)) {
-                otherRouter->addRoute(entry.first, this);
+        forEachRoute([&](const std::string& dst, Node*) {
+            if (!otherRouter->hasRouteTo(dst)) {
+                otherRouter->addRoute(dst, this);
             }
-        }
+        });
     }
 
-    bool hasRouteTo(const std::string& dst) const {
-        return routingTable.find(dst) != routingTable.end();
-    }
+    // Dokładnie ta trasa (prefiks albo nazwa), bez LPM
+    bool hasRouteTo(const std::string& dst) const;
     
     // Dynamic Routing - aktualizacja tras
     void updateRoute(const std::string& dst, Node* newNextHop) {
-        if (routingTable.find(dst) != routingTable.end()) {
+        if (hasRouteTo(dst)) {
             std::cout << "Updating route to " << dst << " via " << newNextHop->getName() << std::endl;
-            routingTable[dst] = newNextHop;
-        } else {
-            addRoute(dst, newNextHop);
         }
+        addRoute(dst, newNextHop);
     }
     
-    // Load Balancing - wybór następnego węzła na podstawie obciążenia
-    std::string getBalancedNextHop(const std::string& dst) {
-        // Znajdź wszystkie możliwe trasy do danego celu
-        std::vector<Node*> possibleNextHops;
-        
-        for (const auto& entry : routingTable) {
-            // Sprawdź czy trasa prowadzi do sieci docelowej (uproszczona wersja)
-            if (entry.first.find(dst.substr(0, dst.find_last_of('.'))) != std::string::npos) {
-                if (entry.second != nullptr) {
-                    possibleNextHops.push_back(entry.second);
-                }
-            }
-        }
-        
-        if (possibleNextHops.empty()) {
-            return "";
-        }
-        
-        // Wybierz węzeł z najmniejszym obciążeniem (najmniejsza liczba pakietów)
-        Node* bestNextHop = possibleNextHops[0];
-        int minPackets = bestNextHop->getPacketCount();
-        
-        for (auto* nextHop : possibleNextHops) {
-            if (nextHop->getPacketCount() < minPackets) {
-                minPackets = nextHop->getPacketCount();
-                bestNextHop = nextHop;
-            }
-        }
-        
-        return bestNextHop->getName();
+    // Load Balancing - członek grupy ECMP dla przepływu wyznaczonego samym celem (O(1), stały dla celu);
+    // cel haszowany jako napis - dowolne cele z zapytań nie trafiają do tabeli nazw Endpoint
+    std::string getBalancedNextHop(const std::string& dst) const {
+        Node* next = getNextHop(dst, flowHash(FlowKey{0, std::hash<std::string>()(dst)}, flowSeed()));
+        return next ? next->getName() : "";
     }
+
+    // Ziarno flowHashOf - różne na każdym routerze, inaczej kolejne skoki dzielą ruch identycznie (polaryzacja)
+    uint32_t flowSeed() const { return Endpoint(name).id() * 0x9e3779b9u; }
 };
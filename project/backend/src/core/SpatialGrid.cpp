@@ -0,0 +1,128 @@
+#include "SpatialGrid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+constexpr double MaxCellsPerPoint = 4;   // więcej komórek niż punktów to głównie puste przebiegi
+
+} // namespace
+
+void SpatialGrid::build(const std::vector<Position>& points, const std::vector<uint8_t>& active, double radius) {
+    if (!(radius > 0)) throw std::runtime_error("Grid radius must be positive");
+    double cellSize = radius;
+    size_t n = std::min(points.size(), active.size());
+    double minX = 0, minY = 0, maxX = 0, maxY = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!active[i]) continue;
+        const Position& p = points[i];
+        if (count++ == 0) {
+            minX = maxX = p.x;
+            minY = maxY = p.y;
+        } else {
+            minX = std::min(minX, p.x);
+            maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y);
+            maxY = std::max(maxY, p.y);
+        }
+    }
+
+    // Rzadkie punkty na dużym obszarze: większe komórki, liczba komórek O(n)
+    double budget = std::max<double>(16, MaxCellsPerPoint * count);
+    double cols = std::floor((maxX - minX) / cellSize) + 1;
+    double rows = std::floor((maxY - minY) / cellSize) + 1;
+    if (cols * rows > budget) {
+        cellSize *= std::sqrt(cols * rows / budget) * 1.01;
+        cols = std::floor((maxX - minX) / cellSize) + 1;
+        rows = std::floor((maxY - minY) / cellSize) + 1;
+    }
+    m_radius = radius;
+    m_cell = cellSize;
+    m_minX = minX;
+    m_minY = minY;
+    m_cols = static_cast<uint32_t>(cols);
+    m_rows = static_cast<uint32_t>(rows);
+
+    // Sortowanie przez zliczanie po komórkach
+    std::vector<uint32_t> cellOf(n);
+    m_start.assign(static_cast<size_t>(m_cols) * m_rows + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        if (!active[i]) continue;
+        auto col = static_cast<uint32_t>(clampCol(points[i].x));
+        auto row = static_cast<uint32_t>(clampRow(points[i].y));
+        cellOf[i] = row * m_cols + col;
+        m_start[cellOf[i] + 1]++;
+    }
+    for (size_t c = 1; c < m_start.size(); ++c) m_start[c] += m_start[c - 1];
+    m_items.resize(count);
+    m_x.resize(count);
+    m_y.resize(count);
+    std::vector<uint32_t> fill(m_start.begin(), m_start.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        if (!active[i]) continue;
+        uint32_t k = fill[cellOf[i]]++;
+        m_items[k] = static_cast<uint32_t>(i);
+        m_x[k] = points[i].x;
+        m_y[k] = points[i].y;
+    }
+}
+
+int64_t SpatialGrid::clampCol(double x) const {
+    double col = std::floor((x - m_minX) / m_cell);
+    return static_cast<int64_t>(std::clamp(col, 0.0, static_cast<double>(m_cols) - 1));
+}
+
+int64_t SpatialGrid::clampRow(double y) const {
+    double row = std::floor((y - m_minY) / m_cell);
+    return static_cast<int64_t>(std::clamp(row, 0.0, static_cast<double>(m_rows) - 1));
+}
+
+void SpatialHash::clear(double cellSize) {
+    if (!(cellSize > 0)) throw std::runtime_error("Grid cell size must be positive");
+    m_cell = cellSize;
+    m_size = 0;
+    m_cells.clear();
+    m_cellOf.clear();
+    m_slot.clear();
+}
+
+int64_t SpatialHash::coord(double v) const {
+    // Poza zakresem int32 komórki się sklejają - wynik nadal poprawny, tylko wolniejszy
+    double c = std::floor(v / m_cell);
+    return static_cast<int64_t>(std::clamp(c, -2147483648.0, 2147483647.0));
+}
+
+void SpatialHash::move(uint32_t id, const Position& p) {
+    uint64_t cell = key(coord(p.x), coord(p.y));
+    if (contains(id) && m_cellOf[id] == cell) {
+        Entry& e = m_cells[cell][m_slot[id]];
+        e.x = p.x;
+        e.y = p.y;
+        return;
+    }
+    remove(id);
+    if (id >= m_slot.size()) {
+        m_slot.resize(id + 1, Absent);
+        m_cellOf.resize(id + 1, 0);
+    }
+    auto& entries = m_cells[cell];
+    m_slot[id] = static_cast<uint32_t>(entries.size());
+    m_cellOf[id] = cell;
+    entries.push_back(Entry{id, p.x, p.y});
+    m_size++;
+}
+
+void SpatialHash::remove(uint32_t id) {
+    if (!contains(id)) return;
+    auto it = m_cells.find(m_cellOf[id]);
+    auto& entries = it->second;
+    uint32_t slot = m_slot[id];
+    entries[slot] = entries.back();
+    m_slot[entries[slot].id] = slot;
+    entries.pop_back();
+    if (entries.empty()) m_cells.erase(it);
+    m_slot[id] = Absent;
+    m_size--;
+}
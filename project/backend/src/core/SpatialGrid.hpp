@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Pozycja węzła na płaszczyźnie, w metrach
+struct Position {
+    double x = 0;
+    double y = 0;
+};
+
+/**
+ * @brief Uniform grid over 2D points for fixed-radius neighbour search
+ *
+ * Points are bucketed into square cells of at least radius by a counting
+ * sort, and their coordinates are copied in cell order, so a cell is a
+ * contiguous run. Any two points within radius are in the same or
+ * adjacent cells: forEachPair() visits each cell with half of its
+ * neighbours and reports every such pair once, in O(n + k) for n points
+ * and k candidate pairs instead of O(n^2). The cell count is kept within a
+ * small multiple of n by growing cells for sparse, spread-out point sets.
+ */
+class SpatialGrid {
+public:
+    // Punkty z active[i] != 0; radius > 0 to promień dla forEachPair
+    void build(const std::vector<Position>& points, const std::vector<uint8_t>& active, double radius);
+
+    size_t size() const { return m_items.size(); }
+    double radius() const { return m_radius; }
+    double cellSize() const { return m_cell; }   // >= radius
+
+    // fn(i, j, d2) dla każdej pary i != j odległej o d2 <= radius^2 (kwadrat odległości)
+    template<typename Fn>
+    void forEachPair(Fn&& fn) const {
+        const double limit = m_radius * m_radius;
+        for (uint32_t row = 0; row < m_rows; ++row) {
+            for (uint32_t col = 0; col < m_cols; ++col) {
+                uint32_t cell = row * m_cols + col;
+                uint32_t begin = m_start[cell], end = m_start[cell + 1];
+                if (begin == end) continue;
+                for (uint32_t a = begin; a < end; ++a)
+                    for (uint32_t b = a + 1; b < end; ++b) check(a, b, limit, fn);
+                // Połowa sąsiedztwa: prawy, i trzy w wierszu niżej - każda para komórek raz
+                if (col + 1 < m_cols) across(begin, end, cell + 1, limit, fn);
+                if (row + 1 < m_rows) {
+                    uint32_t below = cell + m_cols;
+                    if (col > 0) across(begin, end, below - 1, limit, fn);
+                    across(begin, end, below, limit, fn);
+                    if (col + 1 < m_cols) across(begin, end, below + 1, limit, fn);
+                }
+            }
+        }
+    }
+
+    // fn(i, d2) dla punktów w odległości <= radius od p (dowolny promień)
+    template<typename Fn>
+    void forEachWithin(const Position& p, double radius, Fn&& fn) const {
+        if (m_items.empty()) return;
+        const double limit = radius * radius;
+        int64_t c0 = clampCol(p.x - radius), c1 = clampCol(p.x + radius);
+        int64_t r0 = clampRow(p.y - radius), r1 = clampRow(p.y + radius);
+        for (int64_t row = r0; row <= r1; ++row) {
+            for (int64_t col = c0; col <= c1; ++col) {
+                uint32_t cell = static_cast<uint32_t>(row) * m_cols + static_cast<uint32_t>(col);
+                for (uint32_t k = m_start[cell]; k < m_start[cell + 1]; ++k) {
+                    double dx = m_x[k] - p.x, dy = m_y[k] - p.y;
+                    double d2 = dx * dx + dy * dy;
+                    if (d2 <= limit) fn(m_items[k], d2);
+                }
+            }
+        }
+    }
+
+private:
+    double m_radius = 1;
+    double m_cell = 1;
+    double m_minX = 0, m_minY = 0;
+    uint32_t m_cols = 0, m_rows = 0;
+    std::vector<uint32_t> m_start;               // komórka -> początek w m_items (+1 na końcu)
+    std::vector<uint32_t> m_items;               // indeksy punktów w kolejności komórek
+    std::vector<double> m_x, m_y;                // współrzędne w tej samej kolejności
+
+    template<typename Fn>
+    void check(uint32_t a, uint32_t b, double limit, Fn& fn) const {
+        double dx = m_x[a] - m_x[b], dy = m_y[a] - m_y[b];
+        double d2 = dx * dx + dy * dy;
+        if (d2 <= limit) fn(m_items[a], m_items[b], d2);
+    }
+
+    template<typename Fn>
+    void across(uint32_t begin, uint32_t end, uint32_t other, double limit, Fn& fn) const {
+        uint32_t otherBegin = m_start[other], otherEnd = m_start[other + 1];
+        for (uint32_t a = begin; a < end; ++a)
+            for (uint32_t b = otherBegin; b < otherEnd; ++b) check(a, b, limit, fn);
+    }
+
+    int64_t clampCol(double x) const;
+    int64_t clampRow(double y) const;
+};
+
+/**
+ * @brief Hashed grid of moving points for incremental neighbour search
+ *
+ * Unlike SpatialGrid it is updated in place: move() costs O(1) expected,
+ * only touching the old and new cell, so the index of a large population
+ * stays current while a few points move. Cells are square, keyed by their
+ * column and row in a hash map, and hold (id, position) entries; a point id
+ * remembers its cell and slot. forEachWithin() visits the cells covering
+ * the query circle, so a cell size close to the usual radius is best.
+ */
+class SpatialHash {
+public:
+    explicit SpatialHash(double cellSize = 1) { clear(cellSize); }
+
+    // Usuwa punkty; cellSize > 0
+    void clear(double cellSize);
+    // Wstawia albo przesuwa punkt id
+    void move(uint32_t id, const Position& p);
+    void remove(uint32_t id);
+    bool contains(uint32_t id) const { return id < m_slot.size() && m_slot[id] != Absent; }
+    size_t size() const { return m_size; }
+    double cellSize() const { return m_cell; }
+
+    // fn(id, d2) dla punktów w odległości <= radius od p
+    template<typename Fn>
+    void forEachWithin(const Position& p, double radius, Fn&& fn) const {
+        const double limit = radius * radius;
+        int64_t c0 = coord(p.x - radius), c1 = coord(p.x + radius);
+        int64_t r0 = coord(p.y - radius), r1 = coord(p.y + radius);
+        for (int64_t row = r0; row <= r1; ++row) {
+            for (int64_t col = c0; col <= c1; ++col) {
+                auto it = m_cells.find(key(col, row));
+                if (it == m_cells.end()) continue;
+                for (const Entry& e : it->second) {
+                    double dx = e.x - p.x, dy = e.y - p.y;
+                    double d2 = dx * dx + dy * dy;
+                    if (d2 <= limit) fn(e.id, d2);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t Absent = UINT32_MAX;
+
+    struct Entry {
+        uint32_t id;
+        double x, y;
+    };
+
+    double m_cell = 1;
+    size_t m_size = 0;
+    std::unordered_map<uint64_t, std::vector<Entry>> m_cells;
+    std::vector<uint64_t> m_cellOf;              // id -> klucz komórki
+    std::vector<uint32_t> m_slot;                // id -> pozycja w komórce albo Absent
+
+    int64_t coord(double v) const;
+    static uint64_t key(int64_t col, int64_t row) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(col)) << 32) | static_cast<uint32_t>(row);
+    }
+};
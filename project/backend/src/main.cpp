@@ -4,12 +4,32 @@
 #include <cpprest/http_listener.h>
 #include <cpprest/json.h>
 #include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <filesystem>
 
 #include "core/Network.hpp"
 #include "core/Engine.hpp"
 #include "core/Host.hpp"
 #include "core/Router.hpp"
+#include "core/GraphSnapshot.hpp"
+#include "core/ForwardingPipeline.hpp"
+#include "analysis/MaxFlow.hpp"
+#include "analysis/Centrality.hpp"
+#include "analysis/Resilience.hpp"
+#include "sim/PacketSimulator.hpp"
+#include "sim/FluidSimulator.hpp"
+#include "sim/TcpSimulator.hpp"
+#include "sim/TrafficGenerator.hpp"
+#include "sim/PacketCapture.hpp"
+#include "sim/BranchRunner.hpp"
+#include "sim/MobilitySimulator.hpp"
+#include "routing/SpfRouting.hpp"
+#include "routing/ConvergenceSimulator.hpp"
 #include "utils/JsonAdapter.hpp"
+#include "utils/Parallel.hpp"
+#include "utils/SandboxPath.hpp"
 #include "scenario/ScenarioTypes.hpp"
 #include "scenario/ScenarioRunner.hpp"
 
@@ -41,6 +61,70 @@ web::json::value string_vector_to_json(const std::vector<std::string>& vec) {
     return arr;
 }
 
+// Opcjonalne przechwytywanie pcapng symulacji pakietowej:
+// "capture": {path, filter, snapLength, bufferMB, nodes: [...], links: [[from, to], ...]}, domyślnie wszystkie węzły;
+// path jest względna wobec captureDir (NETSIM_CAPTURE_DIR), bez ".." i ścieżek bezwzględnych
+std::unique_ptr<netsim::sim::PacketCapture> capture_from_json(const web::json::value& jv, const Network& net,
+                                                              const std::string& captureDir) {
+    if (!jv.has_field(U("capture"))) return nullptr;
+    const auto& c = jv.at(U("capture"));
+    netsim::sim::CaptureOptions options;
+    if (c.has_field(U("filter"))) options.filter = utility::conversions::to_utf8string(c.at(U("filter")).as_string());
+    if (c.has_field(U("snapLength"))) options.snapLength = c.at(U("snapLength")).as_integer();
+    if (c.has_field(U("bufferMB"))) options.bufferBytes = static_cast<size_t>(c.at(U("bufferMB")).as_integer()) << 20;
+    auto capture = std::make_unique<netsim::sim::PacketCapture>(
+        net, netsim::utils::sandboxedPath(captureDir, utility::conversions::to_utf8string(c.at(U("path")).as_string())),
+        options);
+    if (c.has_field(U("nodes")))
+        for (const auto& node : c.at(U("nodes")).as_array())
+            capture->tapNode(utility::conversions::to_utf8string(node.as_string()));
+    if (c.has_field(U("links")))
+        for (const auto& link : c.at(U("links")).as_array())
+            capture->tapLink(utility::conversions::to_utf8string(link.at(0).as_string()),
+                             utility::conversions::to_utf8string(link.at(1).as_string()));
+    if (capture->taps().empty()) capture->tapAllNodes();
+    return capture;
+}
+
+web::json::value capture_stats_to_json(netsim::sim::PacketCapture& capture) {
+    capture.close();
+    auto stats = capture.stats();
+    web::json::value resp;
+    resp[U("path")] = web::json::value::string(utility::conversions::to_string_t(capture.path()));
+    resp[U("seen")] = web::json::value::number((uint64_t)stats.seen);
+    resp[U("filtered")] = web::json::value::number((uint64_t)stats.filtered);
+    resp[U("captured")] = web::json::value::number((uint64_t)stats.captured);
+    resp[U("dropped")] = web::json::value::number((uint64_t)stats.dropped);
+    resp[U("bytesWritten")] = web::json::value::number((uint64_t)stats.bytesWritten);
+    return resp;
+}
+
+// base + ms z żądania; rzuca std::runtime_error dla wartości ujemnych, NaN i wykraczających poza SimTime
+netsim::sim::SimTime sim_time_after(netsim::sim::SimTime base, double ms, const std::string& field) {
+    const double limit = double((UINT64_MAX - base) / netsim::sim::Millisecond);
+    if (!(ms >= 0)) throw std::runtime_error(field + " must be a non-negative number");
+    if (ms >= limit) throw std::runtime_error(field + " is out of range");
+    return base + static_cast<netsim::sim::SimTime>(ms * netsim::sim::Millisecond);
+}
+
+web::json::value convergence_report_to_json(const netsim::routing::ConvergenceReport& report) {
+    const double ms = double(netsim::sim::Millisecond);
+    web::json::value resp;
+    resp[U("startedAtMs")] = web::json::value::number(report.startedAt / ms);
+    resp[U("convergenceMs")] = web::json::value::number(report.convergenceTime() / ms);
+    resp[U("quiescentAtMs")] = web::json::value::number(report.quiescentAt / ms);
+    resp[U("messages")] = web::json::value::number(report.messages);
+    resp[U("entries")] = web::json::value::number(report.entries);
+    resp[U("routeChanges")] = web::json::value::number(report.routeChanges);
+    resp[U("spfRuns")] = web::json::value::number(report.spfRuns);
+    resp[U("loopsFormed")] = web::json::value::number(report.loopsFormed);
+    resp[U("loopsOpen")] = web::json::value::number(report.loopsOpen);
+    resp[U("loopTimeMs")] = web::json::value::number(report.loopTime / ms);
+    resp[U("longestLoopMs")] = web::json::value::number(report.longestLoop / ms);
+    resp[U("unreachable")] = web::json::value::number(report.unreachable);
+    return resp;
+}
+
 // Helper function to extract JWT token from Authorization header
 std::string extractToken(const http_request& request) {
     auto headers = request.headers();
@@ -130,7 +214,10 @@ void checkRateLimit(
 
 int main() {
     Network net;
+    net.setUniqueAddresses(true); // REST: adres IP identyfikuje węzeł tak jak nazwa
     Engine engine(net);
+    // Routing SPF włączany przez POST /routing/spf; po włączeniu śledzi zmiany topologii
+    std::unique_ptr<netsim::routing::SpfRouting> spf;
     
     // Get environment variables for auth configuration
     const char* jwt_secret_env = std::getenv("JWT_SECRET");
@@ -141,6 +228,8 @@ int main() {
     const char* redis_host_env = std::getenv("REDIS_HOST");
     const char* redis_port_env = std::getenv("REDIS_PORT");
     const char* redis_pass_env = std::getenv("REDIS_PASS");
+    const char* capture_dir_env = std::getenv("NETSIM_CAPTURE_DIR");
+    const char* trace_dir_env = std::getenv("NETSIM_TRACE_DIR");
     
     std::string jwt_secret = jwt_secret_env ? jwt_secret_env : "dev-jwt-secret-not-for-production-use-only-32chars";
     std::string db_host = db_host_env ? db_host_env : "localhost";
@@ -150,6 +239,13 @@ int main() {
     std::string redis_host = redis_host_env ? redis_host_env : "localhost";
     int redis_port = redis_port_env ? std::stoi(redis_port_env) : 6379;
     std::string redis_pass = redis_pass_env ? redis_pass_env : "DevPassword123!";
+    // Pliki wskazywane w żądaniach REST: zapis pcapng tylko do capture_dir, ślady tylko z trace_dir
+    std::string capture_dir = capture_dir_env ? capture_dir_env : "captures";
+    std::string trace_dir = trace_dir_env ? trace_dir_env : "traces";
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(capture_dir, ec);
+    }
     
     // Initialize authentication service
     std::shared_ptr<AuthService> auth_service;
@@ -239,6 +335,103 @@ int main() {
                 request.reply(status_codes::InternalError, resp);
             }
             
+        } else if (path == U("/ipam")) {
+            // GET /ipam?prefix=10.1.0.0/16 - węzły w prefiksie i wolny adres; ?ip=A - węzeł o adresie
+            try {
+                auto query = uri::split_query(request.request_uri().query());
+                auto nodeJson = [](const Node& node) {
+                    web::json::value entry;
+                    entry[U("name")] = web::json::value::string(utility::conversions::to_string_t(node.getName()));
+                    entry[U("ip")] = web::json::value::string(utility::conversions::to_string_t(node.getIpAddress().str()));
+                    entry[U("type")] = web::json::value::string(utility::conversions::to_string_t(node.getType()));
+                    return entry;
+                };
+                web::json::value resp;
+                if (query.count(U("ip"))) {
+                    auto text = utility::conversions::to_utf8string(query[U("ip")]);
+                    IpAddress address;
+                    if (!IpAddress::parse(text, address)) throw std::runtime_error("Invalid IP address: " + text);
+                    auto node = net.findByIp(address);
+                    if (!node) throw std::runtime_error("No node with address " + text);
+                    resp = nodeJson(*node);
+                } else {
+                    auto text = query.count(U("prefix")) ? utility::conversions::to_utf8string(query[U("prefix")]) : std::string("0.0.0.0/0");
+                    IpPrefix prefix;
+                    if (!IpPrefix::parse(text, prefix)) throw std::runtime_error("Invalid prefix: " + text);
+                    auto nodes = net.findInPrefix(prefix);
+                    web::json::value list = web::json::value::array();
+                    for (size_t i = 0; i < nodes.size(); ++i) list[i] = nodeJson(*nodes[i]);
+                    resp[U("prefix")] = web::json::value::string(utility::conversions::to_string_t(prefix.str()));
+                    resp[U("nodes")] = list;
+                    resp[U("count")] = web::json::value::number((int)nodes.size());
+                    try {
+                        resp[U("nextFree")] = web::json::value::string(utility::conversions::to_string_t(net.allocateAddress(prefix).str()));
+                    } catch (const std::runtime_error&) {
+                        resp[U("nextFree")] = web::json::value::null();
+                    }
+                }
+                request.reply(status_codes::OK, resp);
+            } catch (const std::exception& e) {
+                web::json::value resp;
+                resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                request.reply(status_codes::BadRequest, resp);
+            }
+
+        } else if (path == U("/analytics/centrality")) {
+            // GET /analytics/centrality?sample=N&top=K - Chokepoint analytics
+            try {
+                auto query = uri::split_query(request.request_uri().query());
+                netsim::analysis::CentralityOptions options;
+                size_t top = 20;
+                if (query.count(U("sample"))) options.sampleSources = std::stoul(utility::conversions::to_utf8string(query[U("sample")]));
+                if (query.count(U("top"))) top = std::stoul(utility::conversions::to_utf8string(query[U("top")]));
+
+                auto snapshot = GraphSnapshot::fromNetwork(net);
+                auto report = netsim::analysis::Centrality(snapshot).compute(options);
+                auto nodeName = [&](NodeId id) {
+                    return web::json::value::string(utility::conversions::to_string_t(snapshot.nameOf(id)));
+                };
+
+                web::json::value resp;
+                web::json::value ranking = web::json::value::array();
+                auto ranked = report.topByBetweenness(top);
+                for (size_t i = 0; i < ranked.size(); ++i) {
+                    web::json::value entry;
+                    entry[U("node")] = nodeName(ranked[i]);
+                    entry[U("betweenness")] = web::json::value::number(report.betweenness[ranked[i]]);
+                    entry[U("closeness")] = web::json::value::number(report.closeness[ranked[i]]);
+                    ranking[i] = entry;
+                }
+                resp[U("topBetweenness")] = ranking;
+
+                web::json::value degrees = web::json::value::object();
+                for (const auto& [degree, count] : report.degreeDistribution)
+                    degrees[utility::conversions::to_string_t(std::to_string(degree))] = web::json::value::number((int)count);
+                resp[U("degreeDistribution")] = degrees;
+
+                web::json::value cutNodes = web::json::value::array();
+                for (size_t i = 0; i < report.articulationPoints.size(); ++i)
+                    cutNodes[i] = nodeName(report.articulationPoints[i]);
+                resp[U("articulationPoints")] = cutNodes;
+
+                web::json::value bridges = web::json::value::array();
+                for (size_t i = 0; i < report.bridges.size(); ++i) {
+                    web::json::value link;
+                    link[U("from")] = nodeName(report.bridges[i].first);
+                    link[U("to")] = nodeName(report.bridges[i].second);
+                    bridges[i] = link;
+                }
+                resp[U("bridges")] = bridges;
+                resp[U("nodesAnalyzed")] = web::json::value::number((int)report.nodes.size());
+                resp[U("sourcesUsed")] = web::json::value::number((int)report.sourcesUsed);
+                resp[U("approximate")] = web::json::value::boolean(report.approximate);
+                request.reply(status_codes::OK, resp);
+            } catch (const std::exception& e) {
+                web::json::value resp;
+                resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                request.reply(status_codes::BadRequest, resp);
+            }
+            
         } else if (path == U("/db/save")) {
             // GET /db/save - Save topology to database
             try {
@@ -481,9 +674,16 @@ int main() {
                     checkRateLimit(auth_service, auth_result.user_id, "/node/add", 100, 60);
                     
                     auto name = utility::conversions::to_utf8string(jv[U("name")].as_string());
-                    auto ip = jv.has_field(U("ip")) 
-                        ? utility::conversions::to_utf8string(jv[U("ip")].as_string()) 
-                        : std::string("127.0.0.1");
+                    // Bez "ip" pierwszy wolny adres z "subnet" (domyślnie 10.0.0.0/8)
+                    std::string ip;
+                    if (jv.has_field(U("ip"))) {
+                        ip = utility::conversions::to_utf8string(jv[U("ip")].as_string());
+                    } else {
+                        auto subnet = jv.has_field(U("subnet")) ? utility::conversions::to_utf8string(jv[U("subnet")].as_string()) : std::string("10.0.0.0/8");
+                        IpPrefix prefix;
+                        if (!IpPrefix::parse(subnet, prefix)) throw std::runtime_error("Invalid subnet: " + subnet);
+                        ip = net.allocateAddress(prefix).str();
+                    }
                     auto type = jv.has_field(U("type"))
                         ? utility::conversions::to_utf8string(jv[U("type")].as_string())
                         : std::string("host");
@@ -502,6 +702,7 @@ int main() {
                     resp[U("result")] = web::json::value::string(U("node added"));
                     resp[U("name")] = web::json::value::string(utility::conversions::to_string_t(name));
                     resp[U("type")] = web::json::value::string(utility::conversions::to_string_t(type));
+                    resp[U("ip")] = web::json::value::string(utility::conversions::to_string_t(ip));
                     request.reply(status_codes::OK, resp);
 
                 } catch (const std::runtime_error& e) {
@@ -539,7 +740,7 @@ int main() {
                     // Check rate limit
                     checkRateLimit(auth_service, auth_result.user_id, "/node/remove", 50, 60);
                     
-                    auto name = utility::conversions::to_utf8string(jv[U("name")].as_string());
+                    auto name = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("name")].as_string()));
                     net.removeNode(name);
                     
                     // Broadcast WebSocket event
@@ -578,7 +779,7 @@ int main() {
         } else if (path == U("/node/fail")) {
             request.extract_json().then([&](web::json::value jv) {
                 try {
-                    auto name = utility::conversions::to_utf8string(jv[U("name")].as_string());
+                    auto name = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("name")].as_string()));
                     net.failNode(name);
                     
                     // Broadcast WebSocket event
@@ -617,7 +818,7 @@ int main() {
                     // Update IP if provided
                     if (jv.has_field(U("ip"))) {
                         auto ip = utility::conversions::to_utf8string(jv.at(U("ip")).as_string());
-                        node->setIp(ip);
+                        net.setNodeIp(name, ip);
                     }
 
                     // Update MTU if provided
@@ -632,6 +833,23 @@ int main() {
                         node->setMaxQueueSize(queueSize);
                     }
 
+                    // Queue discipline: droptail, priority, drr, red, codel (+ optional parameters)
+                    if (jv.has_field(U("queueDiscipline"))) {
+                        QueueConfig queue;
+                        queue.type = QueueConfig::parseType(utility::conversions::to_utf8string(jv.at(U("queueDiscipline")).as_string()));
+                        if (jv.has_field(U("queueBands"))) queue.bands = jv.at(U("queueBands")).as_integer();
+                        if (jv.has_field(U("drrQuantum"))) queue.quantumBytes = jv.at(U("drrQuantum")).as_integer();
+                        if (jv.has_field(U("redMinThreshold"))) queue.redMinThreshold = jv.at(U("redMinThreshold")).as_double();
+                        if (jv.has_field(U("redMaxThreshold"))) queue.redMaxThreshold = jv.at(U("redMaxThreshold")).as_double();
+                        if (jv.has_field(U("redMaxProbability"))) queue.redMaxProbability = jv.at(U("redMaxProbability")).as_double();
+                        if (jv.has_field(U("redWeight"))) queue.redWeight = jv.at(U("redWeight")).as_double();
+                        if (jv.has_field(U("codelTargetMs")))
+                            queue.codelTarget = sim_time_after(0, jv.at(U("codelTargetMs")).as_double(), "codelTargetMs");
+                        if (jv.has_field(U("codelIntervalMs")))
+                            queue.codelInterval = sim_time_after(0, jv.at(U("codelIntervalMs")).as_double(), "codelIntervalMs");
+                        node->setQueueDiscipline(queue);
+                    }
+
                     // Broadcast update via WebSocket
                     netsim::ws::EventBroadcaster::getInstance().nodeUpdated(
                         name,
@@ -644,6 +862,8 @@ int main() {
                     web::json::value resp;
                     resp[U("result")] = web::json::value::string(U("node configuration updated"));
                     resp[U("name")] = web::json::value::string(utility::conversions::to_string_t(name));
+                    resp[U("queueDiscipline")] = web::json::value::string(utility::conversions::to_string_t(
+                        QueueConfig::typeName(node->getQueueConfig().type)));
                     request.reply(status_codes::OK, resp);
 
                 } catch (const std::runtime_error& e) {
@@ -679,8 +899,8 @@ int main() {
                     // Check rate limit
                     checkRateLimit(auth_service, auth_result.user_id, "/link/connect", 100, 60);
                     
-                    auto nodeA = utility::conversions::to_utf8string(jv[U("nodeA")].as_string());
-                    auto nodeB = utility::conversions::to_utf8string(jv[U("nodeB")].as_string());
+                    auto nodeA = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeA")].as_string()));
+                    auto nodeB = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeB")].as_string()));
                     int delay = jv.has_field(U("delay")) ? jv[U("delay")].as_integer() : 10;
                     int bandwidth = jv.has_field(U("bandwidth")) ? jv[U("bandwidth")].as_integer() : 1000;
                     net.connect(nodeA, nodeB);
@@ -728,8 +948,8 @@ int main() {
                     // Check rate limit
                     checkRateLimit(auth_service, auth_result.user_id, "/link/disconnect", 100, 60);
                     
-                    auto nodeA = utility::conversions::to_utf8string(jv[U("nodeA")].as_string());
-                    auto nodeB = utility::conversions::to_utf8string(jv[U("nodeB")].as_string());
+                    auto nodeA = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeA")].as_string()));
+                    auto nodeB = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeB")].as_string()));
                     net.disconnect(nodeA, nodeB);
 
                     web::json::value resp;
@@ -772,8 +992,8 @@ int main() {
                     // Check rate limit (higher limit for config changes)
                     checkRateLimit(auth_service, auth_result.user_id, "/link/delay", 200, 60);
                     
-                    auto nodeA = utility::conversions::to_utf8string(jv[U("nodeA")].as_string());
-                    auto nodeB = utility::conversions::to_utf8string(jv[U("nodeB")].as_string());
+                    auto nodeA = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeA")].as_string()));
+                    auto nodeB = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeB")].as_string()));
                     int delay = jv[U("delay")].as_integer();
                     net.setLinkDelay(nodeA, nodeB, delay);
 
@@ -816,8 +1036,8 @@ int main() {
                     // Check rate limit
                     checkRateLimit(auth_service, auth_result.user_id, "/link/bandwidth", 200, 60);
                     
-                    auto nodeA = utility::conversions::to_utf8string(jv[U("nodeA")].as_string());
-                    auto nodeB = utility::conversions::to_utf8string(jv[U("nodeB")].as_string());
+                    auto nodeA = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeA")].as_string()));
+                    auto nodeB = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeB")].as_string()));
                     int bandwidth = jv[U("bandwidth")].as_integer();
                     net.setBandwidth(nodeA, nodeB, bandwidth);
 
@@ -860,8 +1080,8 @@ int main() {
                     // Check rate limit
                     checkRateLimit(auth_service, auth_result.user_id, "/link/packetloss", 200, 60);
                     
-                    auto nodeA = utility::conversions::to_utf8string(jv[U("nodeA")].as_string());
-                    auto nodeB = utility::conversions::to_utf8string(jv[U("nodeB")].as_string());
+                    auto nodeA = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeA")].as_string()));
+                    auto nodeB = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeB")].as_string()));
                     double prob = jv[U("probability")].as_double();
                     net.setPacketLoss(nodeA, nodeB, prob);
 
@@ -904,7 +1124,7 @@ int main() {
                     // Check rate limit
                     checkRateLimit(auth_service, auth_result.user_id, "/vlan/assign", 100, 60);
                     
-                    auto name = utility::conversions::to_utf8string(jv[U("name")].as_string());
+                    auto name = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("name")].as_string()));
                     int vlanId = jv[U("vlanId")].as_integer();
                     net.assignVLAN(name, vlanId);
 
@@ -948,8 +1168,8 @@ int main() {
                     // Check rate limit (stricter for security operations)
                     checkRateLimit(auth_service, auth_result.user_id, "/firewall/rule", 50, 60);
                     
-                    auto src = utility::conversions::to_utf8string(jv[U("src")].as_string());
-                    auto dst = utility::conversions::to_utf8string(jv[U("dst")].as_string());
+                    auto src = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("src")].as_string()));
+                    auto dst = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("dst")].as_string()));
                     auto protocol = utility::conversions::to_utf8string(jv[U("protocol")].as_string());
                     bool allow = jv[U("allow")].as_bool();
                     net.addFirewallRule(src, dst, protocol, allow);
@@ -987,8 +1207,8 @@ int main() {
         } else if (path == U("/ping")) {
             request.extract_json().then([&](web::json::value jv) {
                 try {
-                    std::string src = utility::conversions::to_utf8string(jv[U("src")].as_string());
-                    std::string dst = utility::conversions::to_utf8string(jv[U("dst")].as_string());
+                    std::string src = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("src")].as_string()));
+                    std::string dst = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("dst")].as_string()));
                     std::vector<std::string> pathOut;
                     bool ok = engine.ping(src, dst, pathOut);
 
@@ -1009,8 +1229,8 @@ int main() {
         } else if (path == U("/traceroute")) {
             request.extract_json().then([&](web::json::value jv) {
                 try {
-                    std::string src = utility::conversions::to_utf8string(jv[U("src")].as_string());
-                    std::string dst = utility::conversions::to_utf8string(jv[U("dst")].as_string());
+                    std::string src = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("src")].as_string()));
+                    std::string dst = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("dst")].as_string()));
                     std::vector<std::string> pathOut;
                     bool ok = engine.traceroute(src, dst, pathOut);
 
@@ -1031,7 +1251,7 @@ int main() {
         } else if (path == U("/multicast")) {
             request.extract_json().then([&](web::json::value jv) {
                 try {
-                    std::string src = utility::conversions::to_utf8string(jv[U("src")].as_string());
+                    std::string src = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("src")].as_string()));
                     auto destArray = jv[U("destinations")].as_array();
                     std::vector<std::string> destinations;
                     for (const auto& dest : destArray) {
@@ -1056,13 +1276,37 @@ int main() {
         } else if (path == U("/tcp/connect")) {
             request.extract_json().then([&](web::json::value jv) {
                 try {
-                    std::string client = utility::conversions::to_utf8string(jv[U("client")].as_string());
-                    std::string server = utility::conversions::to_utf8string(jv[U("server")].as_string());
-                    bool ok = net.initiateTCPConnection(client, server);
+                    using namespace netsim::sim;
+                    std::string client = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("client")].as_string()));
+                    std::string server = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("server")].as_string()));
+                    uint64_t bytes = jv.has_field(U("bytes")) ? jv[U("bytes")].as_number().to_uint64() : 0;
+                    TcpOptions options;
+                    if (jv.has_field(U("congestionControl"))) {
+                        auto cc = utility::conversions::to_utf8string(jv[U("congestionControl")].as_string());
+                        if (cc == "cubic") options.congestionControl = TcpCongestionControl::Cubic;
+                        else if (cc != "reno") throw std::runtime_error("Unknown congestion control: " + cc);
+                    }
+                    if (jv.has_field(U("mss"))) options.mss = jv[U("mss")].as_integer();
+
+                    // Handshake i transfer jako pakiety w symulacji (kolejki, straty, retransmisje)
+                    TcpSimulator tcp(net, options);
+                    ConnectionId id = tcp.connect(client, server, bytes);
+                    tcp.run();
+                    auto stats = tcp.stats(id);
+                    bool ok = stats.state == TcpState::Finished;
 
                     web::json::value resp;
                     resp[U("success")] = web::json::value::boolean(ok);
                     resp[U("message")] = web::json::value::string(ok ? U("TCP connection established") : U("TCP connection failed"));
+                    if (stats.establishedAt > 0 || stats.state != TcpState::Failed)
+                        resp[U("handshakeLatencyMs")] = web::json::value::number(stats.handshakeLatency() / 1e6);
+                    resp[U("bytes")] = web::json::value::number(stats.bytes);
+                    resp[U("bytesAcked")] = web::json::value::number(stats.bytesAcked);
+                    resp[U("completionTimeMs")] = web::json::value::number((stats.finishedAt - stats.startedAt) / 1e6);
+                    resp[U("goodputMbps")] = web::json::value::number(stats.goodputMbps());
+                    resp[U("retransmissions")] = web::json::value::number(stats.retransmissions);
+                    resp[U("timeouts")] = web::json::value::number(stats.timeouts);
+                    resp[U("srttMs")] = web::json::value::number(stats.srtt / 1e6);
                     request.reply(status_codes::OK, resp);
 
                 } catch (const std::exception& e) {
@@ -1117,7 +1361,7 @@ int main() {
         } else if (path == U("/wireless/range")) {
             request.extract_json().then([&](web::json::value jv) {
                 try {
-                    auto name = utility::conversions::to_utf8string(jv[U("name")].as_string());
+                    auto name = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("name")].as_string()));
                     int range = jv[U("range")].as_integer();
                     net.setWirelessRange(name, range);
 
@@ -1138,7 +1382,7 @@ int main() {
         } else if (path == U("/wireless/interference")) {
             request.extract_json().then([&](web::json::value jv) {
                 try {
-                    auto name = utility::conversions::to_utf8string(jv[U("name")].as_string());
+                    auto name = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("name")].as_string()));
                     double lossProb = jv[U("lossProb")].as_double();
                     net.simulateInterference(name, lossProb);
 
@@ -1237,7 +1481,7 @@ int main() {
         } else if (path == U("/iot/battery")) {
             request.extract_json().then([&](web::json::value jv) {
                 try {
-                    auto name = utility::conversions::to_utf8string(jv[U("name")].as_string());
+                    auto name = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("name")].as_string()));
                     int percent = jv[U("percent")].as_integer();
                     net.simulateBatteryDrain(name, percent);
 
@@ -1260,7 +1504,7 @@ int main() {
             request.extract_json().then([&](web::json::value jv) {
                 try {
                     if (jv.has_field(U("node"))) {
-                        auto name = utility::conversions::to_utf8string(jv[U("node")].as_string());
+                        auto name = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("node")].as_string()));
                         net.resetNodeStatistics(name);
                         web::json::value resp;
                         resp[U("result")] = web::json::value::string(U("node statistics reset"));
@@ -1284,16 +1528,31 @@ int main() {
         } else if (path == U("/metrics/performance")) {
             request.extract_json().then([&](web::json::value jv) {
                 try {
-                    auto nodeA = utility::conversions::to_utf8string(jv[U("nodeA")].as_string());
-                    auto nodeB = utility::conversions::to_utf8string(jv[U("nodeB")].as_string());
+                    auto nodeA = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeA")].as_string()));
+                    auto nodeB = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("nodeB")].as_string()));
                     
                     int latency = net.getLatency(nodeA, nodeB);
-                    int throughput = net.getThroughput(nodeA, nodeB);
+                    int packetCount = net.getThroughput(nodeA, nodeB);
                     double packetLoss = net.getPacketLossRate(nodeA, nodeB);
 
+                    // Achievable throughput = max-flow over link bandwidths
+                    auto snapshot = GraphSnapshot::fromNetwork(net);
+                    auto flow = netsim::analysis::MaxFlow(snapshot).compute(nodeA, nodeB);
+
+                    web::json::value bottleneck = web::json::value::array();
+                    for (size_t i = 0; i < flow.minCut.size(); ++i) {
+                        web::json::value link;
+                        link[U("from")] = web::json::value::string(utility::conversions::to_string_t(flow.minCut[i].from));
+                        link[U("to")] = web::json::value::string(utility::conversions::to_string_t(flow.minCut[i].to));
+                        link[U("capacity")] = web::json::value::number(flow.minCut[i].capacity);
+                        bottleneck[i] = link;
+                    }
+
                     web::json::value resp;
                     resp[U("latency")] = web::json::value::number(latency);
-                    resp[U("throughput")] = web::json::value::number(throughput);
+                    resp[U("throughput")] = web::json::value::number(flow.maxFlow);
+                    resp[U("bottleneckLinks")] = bottleneck;
+                    resp[U("packetCount")] = web::json::value::number(packetCount);
                     resp[U("packetLossRate")] = web::json::value::number(packetLoss);
                     request.reply(status_codes::OK, resp);
 
@@ -1304,6 +1563,762 @@ int main() {
                 }
             }).wait();
 
+        // POST /analytics/resilience - What-if failure analysis
+        } else if (path == U("/analytics/resilience")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    using namespace netsim::analysis;
+                    auto snapshot = GraphSnapshot::fromNetwork(net);
+                    auto toIds = [&](const web::json::value& names) {
+                        std::vector<NodeId> ids;
+                        for (const auto& name : names.as_array())
+                            ids.push_back(snapshot.idOf(utility::conversions::to_utf8string(name.as_string())));
+                        return ids;
+                    };
+                    auto toSet = [&](const web::json::value& v, const std::string& fallback) {
+                        FailureSet set;
+                        set.label = v.has_field(U("label")) ? utility::conversions::to_utf8string(v.at(U("label")).as_string()) : fallback;
+                        if (v.has_field(U("nodes"))) set.nodes = toIds(v.at(U("nodes")));
+                        if (v.has_field(U("links"))) {
+                            for (const auto& link : v.at(U("links")).as_array()) {
+                                auto ends = toIds(link);
+                                if (ends.size() != 2) throw std::runtime_error("Link must have two endpoints");
+                                set.links.push_back({ends[0], ends[1]});
+                            }
+                        }
+                        return set;
+                    };
+
+                    // Domyślnie: łączność między wszystkimi hostami
+                    ResilienceQuery query;
+                    if (jv.has_field(U("endpoints"))) {
+                        query.sources = toIds(jv[U("endpoints")]);
+                    } else {
+                        for (const auto& name : net.getAllNodes())
+                            if (net.findByName(name)->getType() == "host") query.sources.push_back(snapshot.idOf(name));
+                    }
+                    if (jv.has_field(U("targets"))) query.targets = toIds(jv[U("targets")]);
+
+                    std::vector<FailureSet> sets;
+                    if (jv.has_field(U("failureSets"))) {
+                        auto explicitSets = jv[U("failureSets")].as_array();
+                        for (size_t i = 0; i < explicitSets.size(); ++i)
+                            sets.push_back(toSet(explicitSets[i], "set" + std::to_string(i)));
+                    }
+                    if (jv.has_field(U("k"))) {
+                        std::vector<NodeId> candidates;
+                        if (jv.has_field(U("candidates"))) candidates = toIds(jv[U("candidates")]);
+                        auto combos = ResilienceAnalyzer::nodeCombinations(snapshot, candidates, jv[U("k")].as_integer());
+                        sets.insert(sets.end(), combos.begin(), combos.end());
+                    }
+                    if (jv.has_field(U("linkK"))) {
+                        auto combos = ResilienceAnalyzer::linkCombinations(snapshot, jv[U("linkK")].as_integer());
+                        sets.insert(sets.end(), combos.begin(), combos.end());
+                    }
+                    if (jv.has_field(U("sharedRiskGroups"))) {
+                        std::vector<FailureSet> groups;
+                        auto srg = jv[U("sharedRiskGroups")].as_array();
+                        for (size_t i = 0; i < srg.size(); ++i)
+                            groups.push_back(toSet(srg[i], "srg" + std::to_string(i)));
+                        size_t groupK = jv.has_field(U("groupK")) ? jv[U("groupK")].as_integer() : 1;
+                        auto combos = ResilienceAnalyzer::groupCombinations(groups, groupK);
+                        sets.insert(sets.end(), combos.begin(), combos.end());
+                    }
+
+                    ResilienceOptions options;
+                    if (jv.has_field(U("maxPairs"))) options.maxPairsPerSet = jv[U("maxPairs")].as_integer();
+                    auto report = ResilienceAnalyzer(snapshot).evaluate(sets, query, options);
+
+                    // Tylko zbiory, które coś rozłączają, od najgorszego
+                    std::vector<const FailureImpact*> harmful;
+                    for (const auto& impact : report.impacts)
+                        if (impact.affectedPairs > 0) harmful.push_back(&impact);
+                    std::stable_sort(harmful.begin(), harmful.end(), [](const FailureImpact* a, const FailureImpact* b) {
+                        return a->affectedPairs > b->affectedPairs;
+                    });
+
+                    web::json::value impacts = web::json::value::array();
+                    for (size_t i = 0; i < harmful.size(); ++i) {
+                        web::json::value entry;
+                        entry[U("label")] = web::json::value::string(utility::conversions::to_string_t(harmful[i]->label));
+                        entry[U("affectedPairs")] = web::json::value::number((uint64_t)harmful[i]->affectedPairs);
+                        entry[U("failedEndpoints")] = web::json::value::number((int)harmful[i]->failedEndpoints);
+                        web::json::value pairs = web::json::value::array();
+                        for (size_t p = 0; p < harmful[i]->pairs.size(); ++p) {
+                            web::json::value pair = web::json::value::array();
+                            pair[0] = web::json::value::string(utility::conversions::to_string_t(snapshot.nameOf(harmful[i]->pairs[p].first)));
+                            pair[1] = web::json::value::string(utility::conversions::to_string_t(snapshot.nameOf(harmful[i]->pairs[p].second)));
+                            pairs[p] = pair;
+                        }
+                        entry[U("pairs")] = pairs;
+                        impacts[i] = entry;
+                    }
+
+                    web::json::value resp;
+                    resp[U("setsEvaluated")] = web::json::value::number((int)sets.size());
+                    resp[U("totalPairs")] = web::json::value::number((uint64_t)report.totalPairs);
+                    resp[U("baselineConnectedPairs")] = web::json::value::number((uint64_t)report.baselineConnectedPairs);
+                    resp[U("impacts")] = impacts;
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
+        // POST /simulation/packets - Hop-by-hop packet-level simulation
+        } else if (path == U("/simulation/packets")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    using namespace netsim::sim;
+                    PacketSimOptions options;
+                    if (jv.has_field(U("seed"))) options.seed = jv[U("seed")].as_number().to_uint64();
+                    if (jv.has_field(U("defaultBandwidth"))) options.defaultBandwidthMbps = jv[U("defaultBandwidth")].as_integer();
+                    if (jv.has_field(U("partitions"))) {
+                        // partitions^2 kanałów i wątek na partycję - nie więcej partycji niż rdzeni
+                        int partitions = jv[U("partitions")].as_integer();
+                        if (partitions > static_cast<int>(netsim::utils::defaultWorkerCount()))
+                            throw std::runtime_error("partitions must not exceed " +
+                                                     std::to_string(netsim::utils::defaultWorkerCount()));
+                        options.partitions = std::max(1, partitions);
+                    }
+                    PacketSimulator sim(net, options);
+                    auto capture = capture_from_json(jv, net, capture_dir);
+                    if (capture) sim.setCapture(capture.get());
+
+                    // flows: [{src, dst, count, intervalUs, sizeBytes, priority, protocol, srcPort, dstPort}];
+                    // wartości ujemne odrzucane, sizeBytes przycinane do 65535, priority do 255,
+                    // łączna liczba pakietów żądania do 1 000 000 (jak w /network/forward)
+                    const int maxPackets = 1000000;
+                    int injected = 0;
+                    struct FlowRange { std::string src, dst; PacketId first, last; };
+                    std::vector<FlowRange> flows;
+                    for (const auto& flow : jv[U("flows")].as_array()) {
+                        auto bounded = [&](const utility::char_t* key, int fallback, int max) {
+                            int value = flow.has_field(key) ? flow.at(key).as_integer() : fallback;
+                            if (value < 0)
+                                throw std::runtime_error(utility::conversions::to_utf8string(key) + " must not be negative");
+                            return std::min(value, max);
+                        };
+                        auto src = utility::conversions::to_utf8string(flow.at(U("src")).as_string());
+                        auto dst = utility::conversions::to_utf8string(flow.at(U("dst")).as_string());
+                        int count = bounded(U("count"), 1, maxPackets - injected);
+                        SimTime interval = static_cast<SimTime>(bounded(U("intervalUs"), 1000, INT_MAX)) * Microsecond;
+                        uint32_t size = static_cast<uint32_t>(bounded(U("sizeBytes"), 1500, 65535));
+                        uint8_t priority = static_cast<uint8_t>(bounded(U("priority"), 0, 255));
+                        Protocol protocol = flow.has_field(U("protocol"))
+                            ? PacketTag<Protocol>::kindOf(utility::conversions::to_utf8string(flow.at(U("protocol")).as_string()))
+                            : Protocol::Other;
+                        uint16_t srcPort = static_cast<uint16_t>(bounded(U("srcPort"), 0, 65535));
+                        uint16_t dstPort = static_cast<uint16_t>(bounded(U("dstPort"), 0, 65535));
+                        NodeId s = net.getNodeId(src), d = net.getNodeId(dst);
+                        PacketId first = static_cast<PacketId>(sim.records().size());
+                        for (int i = 0; i < count; ++i)
+                            sim.setFlow(sim.inject(s, d, size, i * interval, 64, priority), protocol, srcPort, dstPort);
+                        injected += count;
+                        flows.push_back({src, dst, first, static_cast<PacketId>(sim.records().size())});
+                    }
+                    sim.run();
+
+                    web::json::value flowStats = web::json::value::array();
+                    for (size_t f = 0; f < flows.size(); ++f) {
+                        std::vector<SimTime> latencies;
+                        for (PacketId id = flows[f].first; id < flows[f].last; ++id)
+                            if (sim.record(id).status == PacketStatus::Delivered) latencies.push_back(sim.record(id).latency());
+                        std::sort(latencies.begin(), latencies.end());
+                        auto percentileMs = [&](double q) {
+                            return latencies.empty() ? 0.0 : latencies[static_cast<size_t>(q * (latencies.size() - 1))] / 1e6;
+                        };
+                        web::json::value entry;
+                        entry[U("src")] = web::json::value::string(utility::conversions::to_string_t(flows[f].src));
+                        entry[U("dst")] = web::json::value::string(utility::conversions::to_string_t(flows[f].dst));
+                        entry[U("sent")] = web::json::value::number((int)(flows[f].last - flows[f].first));
+                        entry[U("delivered")] = web::json::value::number((int)latencies.size());
+                        entry[U("latencyP50Ms")] = web::json::value::number(percentileMs(0.5));
+                        entry[U("latencyP99Ms")] = web::json::value::number(percentileMs(0.99));
+                        flowStats[f] = entry;
+                    }
+
+                    const auto& stats = sim.stats();
+                    web::json::value resp;
+                    resp[U("flows")] = flowStats;
+                    resp[U("delivered")] = web::json::value::number((uint64_t)stats.delivered);
+                    resp[U("droppedQueue")] = web::json::value::number((uint64_t)stats.droppedQueue);
+                    resp[U("droppedLoss")] = web::json::value::number((uint64_t)stats.droppedLoss);
+                    resp[U("droppedTtl")] = web::json::value::number((uint64_t)stats.droppedTtl);
+                    resp[U("droppedAqm")] = web::json::value::number((uint64_t)stats.droppedAqm);
+                    resp[U("noRoute")] = web::json::value::number((uint64_t)stats.noRoute);
+
+                    // Porty z dyscypliną kolejki: liczniki per pasmo
+                    web::json::value queues = web::json::value::array();
+                    const auto& graph = sim.graph();
+                    size_t q = 0;
+                    for (NodeId u = 0; u < graph.nodeCount(); ++u) {
+                        if (!graph.present[u]) continue;
+                        for (uint32_t a = graph.offsets[u]; a < graph.offsets[u + 1]; ++a) {
+                            const QueueDiscipline* queue = sim.portQueue(a);
+                            if (!queue) continue;
+                            web::json::value bands = web::json::value::array();
+                            const auto& bandStats = queue->bandStats();
+                            for (size_t b = 0; b < bandStats.size(); ++b) {
+                                web::json::value band;
+                                band[U("enqueued")] = web::json::value::number((uint64_t)bandStats[b].enqueued);
+                                band[U("dequeued")] = web::json::value::number((uint64_t)bandStats[b].dequeued);
+                                band[U("droppedOverflow")] = web::json::value::number((uint64_t)bandStats[b].droppedOverflow);
+                                band[U("droppedEarly")] = web::json::value::number((uint64_t)bandStats[b].droppedEarly);
+                                band[U("averageSojournMs")] = web::json::value::number(bandStats[b].averageSojournNs() / 1e6);
+                                band[U("maxSojournMs")] = web::json::value::number(bandStats[b].maxSojourn / 1e6);
+                                bands[b] = band;
+                            }
+                            web::json::value port;
+                            port[U("from")] = web::json::value::string(utility::conversions::to_string_t(graph.nameOf(u)));
+                            port[U("to")] = web::json::value::string(utility::conversions::to_string_t(graph.nameOf(graph.targets[a])));
+                            port[U("discipline")] = web::json::value::string(utility::conversions::to_string_t(QueueConfig::typeName(queue->config().type)));
+                            port[U("bands")] = bands;
+                            queues[q++] = port;
+                        }
+                    }
+                    resp[U("queues")] = queues;
+                    resp[U("packetHops")] = web::json::value::number((uint64_t)stats.hops);
+                    resp[U("averageLatencyMs")] = web::json::value::number(stats.averageLatencyNs() / 1e6);
+                    resp[U("simulatedTimeMs")] = web::json::value::number(sim.now() / 1e6);
+                    resp[U("partitions")] = web::json::value::number((int)sim.partitionCount());
+                    if (capture) resp[U("capture")] = capture_stats_to_json(*capture);
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
+        // POST /simulation/flows - Flow-level (fluid) simulation with max-min fair sharing
+        } else if (path == U("/simulation/flows")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    using namespace netsim::sim;
+                    FluidOptions options;
+                    if (jv.has_field(U("defaultBandwidth"))) options.defaultBandwidthMbps = jv[U("defaultBandwidth")].as_integer();
+                    if (jv.has_field(U("recomputeQuantumUs"))) options.recomputeQuantum = jv[U("recomputeQuantumUs")].as_number().to_uint64() * Microsecond;
+                    FluidSimulator sim(net, engine, options);
+
+                    // flows: [{src, dst, bytes, startMs, rateCapMbps}]
+                    for (const auto& flow : jv[U("flows")].as_array()) {
+                        auto src = utility::conversions::to_utf8string(flow.at(U("src")).as_string());
+                        auto dst = utility::conversions::to_utf8string(flow.at(U("dst")).as_string());
+                        uint64_t bytes = flow.at(U("bytes")).as_number().to_uint64();
+                        SimTime start = flow.has_field(U("startMs")) ? flow.at(U("startMs")).as_number().to_uint64() * Millisecond : 0;
+                        double cap = flow.has_field(U("rateCapMbps")) ? flow.at(U("rateCapMbps")).as_double() : 0.0;
+                        sim.addFlow(src, dst, bytes, start, cap);
+                    }
+                    sim.run();
+
+                    web::json::value flowStats = web::json::value::array();
+                    for (FlowId id = 0; id < sim.flows().size(); ++id) {
+                        const auto& flow = sim.flow(id);
+                        web::json::value entry;
+                        entry[U("src")] = web::json::value::string(utility::conversions::to_string_t(sim.graph().nameOf(flow.src)));
+                        entry[U("dst")] = web::json::value::string(utility::conversions::to_string_t(sim.graph().nameOf(flow.dst)));
+                        entry[U("completed")] = web::json::value::boolean(flow.status == FlowStatus::Completed);
+                        if (flow.status == FlowStatus::Completed) {
+                            entry[U("completionTimeMs")] = web::json::value::number(flow.completionTime() / 1e6);
+                            entry[U("averageRateMbps")] = web::json::value::number(flow.averageRateMbps());
+                        }
+                        flowStats[id] = entry;
+                    }
+                    web::json::value links = web::json::value::array();
+                    size_t i = 0;
+                    for (const auto& link : sim.linkStats()) {
+                        web::json::value entry;
+                        entry[U("from")] = web::json::value::string(utility::conversions::to_string_t(sim.graph().nameOf(link.from)));
+                        entry[U("to")] = web::json::value::string(utility::conversions::to_string_t(sim.graph().nameOf(link.to)));
+                        entry[U("capacityMbps")] = web::json::value::number(link.capacityMbps);
+                        entry[U("utilization")] = web::json::value::number(link.utilization);
+                        entry[U("peakUtilization")] = web::json::value::number(link.peakUtilization);
+                        links[i++] = entry;
+                    }
+
+                    web::json::value resp;
+                    resp[U("flows")] = flowStats;
+                    resp[U("links")] = links;
+                    resp[U("reallocations")] = web::json::value::number((uint64_t)sim.reallocations());
+                    resp[U("simulatedTimeMs")] = web::json::value::number(sim.now() / 1e6);
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
+        // POST /simulation/traffic - Packet-level simulation fed by traffic generators
+        } else if (path == U("/simulation/traffic")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    using namespace netsim::sim;
+                    PacketSimOptions options;
+                    if (jv.has_field(U("seed"))) options.seed = jv[U("seed")].as_number().to_uint64();
+                    if (jv.has_field(U("defaultBandwidth"))) options.defaultBandwidthMbps = jv[U("defaultBandwidth")].as_integer();
+                    options.recyclePacketIds = true;
+                    PacketSimulator sim(net, options);
+                    TrafficGenerator traffic(net, sim);
+                    auto capture = capture_from_json(jv, net, capture_dir);
+                    if (capture) sim.setCapture(capture.get());
+
+                    // generators: [{pattern, src, dst, rateMbps, sizeBytes, priority, startMs, durationMs,
+                    //               maxPackets, meanOnMs, meanOffMs, shape, seed, path}]
+                    auto number = [](const web::json::value& g, const utility::char_t* key, double fallback) {
+                        return g.has_field(key) ? g.at(key).as_double() : fallback;
+                    };
+                    for (const auto& g : jv[U("generators")].as_array()) {
+                        TrafficOptions t;
+                        auto pattern = TrafficGenerator::parsePattern(utility::conversions::to_utf8string(g.at(U("pattern")).as_string()));
+                        t.rateMbps = number(g, U("rateMbps"), t.rateMbps);
+                        // Czasy i liczby całkowite bez znaku: ujemne, NaN i poza zakresem dają 400
+                        auto simTime = [&](SimTime base, const utility::char_t* key, double fallback) {
+                            return sim_time_after(base, number(g, key, fallback), utility::conversions::to_utf8string(key));
+                        };
+                        auto whole = [&](const utility::char_t* key, double fallback, double max) {
+                            double value = number(g, key, fallback);
+                            if (!(value >= 0)) throw std::runtime_error(utility::conversions::to_utf8string(key) + " must be a non-negative number");
+                            return std::min(value, max);
+                        };
+                        t.sizeBytes = static_cast<uint32_t>(whole(U("sizeBytes"), t.sizeBytes, 65535));
+                        t.priority = static_cast<uint8_t>(whole(U("priority"), 0, 255));
+                        t.start = simTime(0, U("startMs"), 0);
+                        t.stop = simTime(t.start, U("durationMs"), 1000);
+                        t.maxPackets = static_cast<uint64_t>(whole(U("maxPackets"), 0, 1e18));
+                        t.meanOn = simTime(0, U("meanOnMs"), t.meanOn / 1e6);
+                        t.meanOff = simTime(0, U("meanOffMs"), t.meanOff / 1e6);
+                        t.shape = number(g, U("shape"), t.shape);
+                        t.seed = static_cast<uint64_t>(whole(U("seed"), static_cast<double>(t.seed), 1e18));
+                        if (pattern == TrafficPattern::Trace) {
+                            traffic.addTrace(netsim::utils::sandboxedPath(
+                                trace_dir, utility::conversions::to_utf8string(g.at(U("path")).as_string())), t);
+                        } else {
+                            traffic.add(pattern, utility::conversions::to_utf8string(g.at(U("src")).as_string()),
+                                        utility::conversions::to_utf8string(g.at(U("dst")).as_string()), t);
+                        }
+                    }
+                    sim.run();
+
+                    web::json::value generators = web::json::value::array();
+                    for (GeneratorId id = 0; id < traffic.generatorCount(); ++id) {
+                        const auto& s = traffic.stats(id);
+                        web::json::value entry;
+                        entry[U("packets")] = web::json::value::number((uint64_t)s.packets);
+                        entry[U("bytes")] = web::json::value::number((uint64_t)s.bytes);
+                        entry[U("delivered")] = web::json::value::number((uint64_t)s.delivered);
+                        entry[U("dropped")] = web::json::value::number((uint64_t)s.dropped);
+                        entry[U("skipped")] = web::json::value::number((uint64_t)s.skipped);
+                        entry[U("offeredMbps")] = web::json::value::number(s.offeredMbps());
+                        entry[U("averageLatencyMs")] = web::json::value::number(s.averageLatencyNs() / 1e6);
+                        generators[id] = entry;
+                    }
+                    const auto& stats = sim.stats();
+                    web::json::value resp;
+                    resp[U("generators")] = generators;
+                    resp[U("injected")] = web::json::value::number((uint64_t)stats.injected);
+                    resp[U("delivered")] = web::json::value::number((uint64_t)stats.delivered);
+                    resp[U("droppedQueue")] = web::json::value::number((uint64_t)stats.droppedQueue);
+                    resp[U("droppedAqm")] = web::json::value::number((uint64_t)stats.droppedAqm);
+                    resp[U("droppedLoss")] = web::json::value::number((uint64_t)stats.droppedLoss);
+                    resp[U("averageLatencyMs")] = web::json::value::number(stats.averageLatencyNs() / 1e6);
+                    resp[U("simulatedTimeMs")] = web::json::value::number(sim.now() / 1e6);
+                    if (capture) resp[U("capture")] = capture_stats_to_json(*capture);
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
+        // POST /simulation/branches - What-if branches forked from the current simulation state
+        } else if (path == U("/simulation/branches")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    using namespace netsim::sim;
+                    auto text = [](const web::json::value& v) { return utility::conversions::to_utf8string(v.as_string()); };
+                    // Tylko wątki: fork() procesu w wielowątkowym serwerze jest niebezpieczny (zob. BranchRunner.hpp)
+                    BranchMode mode = jv.has_field(U("mode")) ? parseBranchMode(text(jv[U("mode")])) : BranchMode::Threads;
+                    if (mode != BranchMode::Threads)
+                        throw std::runtime_error("Only mode \"threads\" is available over REST");
+                    int workers = jv.has_field(U("workers")) ? jv[U("workers")].as_integer() : 0;
+                    if (workers < 0) throw std::runtime_error("workers must not be negative");
+                    workers = std::min(workers, static_cast<int>(netsim::utils::defaultWorkerCount()));
+
+                    // branches: [{name, failNodes: [..], disconnect: [[a, b]], connect: [[a, b]],
+                    //             linkDelays: [{a, b, ms}], advanceMs}]
+                    std::vector<Branch> branches;
+                    for (const auto& b : jv[U("branches")].as_array()) {
+                        Branch branch;
+                        branch.name = b.has_field(U("name")) ? text(b.at(U("name"))) : "branch" + std::to_string(branches.size());
+                        branch.run = [b, text](Network& n) {
+                            auto pairs = [&](const utility::char_t* key, auto apply) {
+                                if (!b.has_field(key)) return;
+                                for (const auto& pair : b.at(key).as_array()) apply(text(pair.at(0)), text(pair.at(1)));
+                            };
+                            if (b.has_field(U("failNodes")))
+                                for (const auto& node : b.at(U("failNodes")).as_array()) n.failNode(text(node));
+                            pairs(U("disconnect"), [&](const std::string& a, const std::string& c) { n.disconnect(a, c); });
+                            pairs(U("connect"), [&](const std::string& a, const std::string& c) { n.connect(a, c); });
+                            if (b.has_field(U("linkDelays")))
+                                for (const auto& d : b.at(U("linkDelays")).as_array())
+                                    n.setLinkDelay(text(d.at(U("a"))), text(d.at(U("b"))), d.at(U("ms")).as_integer());
+                            if (b.has_field(U("advanceMs"))) n.advanceTime(b.at(U("advanceMs")).as_integer());
+
+                            web::json::value out;
+                            web::json::value delivered;
+                            for (const auto& node : n.getAllNodes())
+                                delivered[utility::conversions::to_string_t(node)] = web::json::value::number((uint64_t)n.getDeliveredCount(node));
+                            out[U("delivered")] = delivered;
+                            out[U("simTimeMs")] = web::json::value::number(n.getSimTime() / 1e6);
+                            out[U("pendingEvents")] = web::json::value::number((uint64_t)n.getScheduler().pending());
+                            return utility::conversions::to_utf8string(out.serialize());
+                        };
+                        branches.push_back(std::move(branch));
+                    }
+                    auto results = runBranches(net, branches, mode, workers);
+
+                    web::json::value resp;
+                    web::json::value entries = web::json::value::array();
+                    for (size_t i = 0; i < results.size(); ++i) {
+                        const auto& r = results[i];
+                        web::json::value entry = r.ok ? web::json::value::parse(utility::conversions::to_string_t(r.output))
+                                                      : web::json::value();
+                        entry[U("name")] = web::json::value::string(utility::conversions::to_string_t(r.name));
+                        entry[U("ok")] = web::json::value::boolean(r.ok);
+                        if (!r.ok) entry[U("error")] = web::json::value::string(utility::conversions::to_string_t(r.output));
+                        entry[U("forkMs")] = web::json::value::number(r.forkMs);
+                        entry[U("runMs")] = web::json::value::number(r.runMs);
+                        entries[i] = entry;
+                    }
+                    resp[U("branches")] = entries;
+                    resp[U("simTimeMs")] = web::json::value::number(net.getSimTime() / 1e6);
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
+        // POST /router/routes - Bulk route installation into a router FIB (IPv4/IPv6 prefixes, ECMP groups)
+        } else if (path == U("/router/routes")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    auto name = net.resolveNodeName(utility::conversions::to_utf8string(jv.at(U("router")).as_string()));
+                    auto* router = dynamic_cast<Router*>(net.findByName(name).get());
+                    if (!router) throw std::runtime_error("Node is not a router: " + name);
+
+                    // routes: [{prefix, nextHop} | {prefix, nextHops: [{node, weight}]}] (grupa ECMP/WCMP),
+                    // replace: czyści tablicę przed instalacją
+                    if (jv.has_field(U("replace")) && jv[U("replace")].as_bool()) router->clearRoutingTable();
+                    std::vector<std::pair<std::string, Node*>> routes;
+                    size_t groups = 0;
+                    for (const auto& r : jv[U("routes")].as_array()) {
+                        auto prefix = utility::conversions::to_utf8string(r.at(U("prefix")).as_string());
+                        if (r.has_field(U("nextHops"))) {
+                            std::vector<Fib::GroupMember> members;
+                            for (const auto& m : r.at(U("nextHops")).as_array()) {
+                                Node* hop = net.findNode(utility::conversions::to_utf8string(m.at(U("node")).as_string())).get();
+                                members.push_back({hop, m.has_field(U("weight")) ? static_cast<uint32_t>(m.at(U("weight")).as_integer()) : 1u});
+                            }
+                            router->addRouteGroup(prefix, members);
+                            groups++;
+                            continue;
+                        }
+                        routes.push_back({prefix, net.findByName(utility::conversions::to_utf8string(r.at(U("nextHop")).as_string())).get()});
+                    }
+                    router->addRoutes(routes);
+
+                    auto stats = router->getFib().stats();
+                    web::json::value resp;
+                    resp[U("installed")] = web::json::value::number((uint64_t)(routes.size() + groups));
+                    resp[U("groups")] = web::json::value::number((uint64_t)groups);
+                    resp[U("routes")] = web::json::value::number((uint64_t)router->getRouteCount());
+                    resp[U("fibNodes")] = web::json::value::number((uint64_t)stats.trieNodes);
+                    resp[U("fibBytes")] = web::json::value::number((uint64_t)stats.memoryBytes);
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
+        // POST /router/lookup - Longest-prefix-match next hops for a list of destinations
+        } else if (path == U("/router/lookup")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    auto name = net.resolveNodeName(utility::conversions::to_utf8string(jv.at(U("router")).as_string()));
+                    auto* router = dynamic_cast<Router*>(net.findByName(name).get());
+                    if (!router) throw std::runtime_error("Node is not a router: " + name);
+
+                    web::json::value nextHops;
+                    for (const auto& d : jv[U("destinations")].as_array()) {
+                        Node* next = router->getNextHop(utility::conversions::to_utf8string(d.as_string()));
+                        nextHops[d.as_string()] = next ? web::json::value::string(utility::conversions::to_string_t(next->getName()))
+                                                       : web::json::value::null();
+                    }
+                    web::json::value resp;
+                    resp[U("nextHops")] = nextHops;
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
+        // POST /routing/spf - Enable/disable shortest-path routing for all routers
+        } else if (path == U("/routing/spf")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    // enable (domyślnie true): false wyłącza śledzenie zmian, trasy zostają w FIB
+                    bool enable = !jv.has_field(U("enable")) || jv[U("enable")].as_bool();
+                    if (!enable) {
+                        spf.reset();
+                    } else if (!spf) {
+                        netsim::routing::SpfOptions options;
+                        if (jv.has_field(U("workers"))) options.workers = jv[U("workers")].as_integer();
+                        if (jv.has_field(U("transitHosts"))) options.transitHosts = jv[U("transitHosts")].as_bool();
+                        spf.reset(new netsim::routing::SpfRouting(net, options));
+                    } else {
+                        spf->computeAll();
+                    }
+
+                    web::json::value resp;
+                    resp[U("enabled")] = web::json::value::boolean(spf != nullptr);
+                    if (spf) {
+                        const auto& stats = spf->stats();
+                        resp[U("fullRuns")] = web::json::value::number(stats.fullRuns);
+                        resp[U("incrementalRuns")] = web::json::value::number(stats.incrementalRuns);
+                        resp[U("routersComputed")] = web::json::value::number(stats.routersComputed);
+                        resp[U("routesInstalled")] = web::json::value::number(stats.routesInstalled);
+                        resp[U("routesWithdrawn")] = web::json::value::number(stats.routesWithdrawn);
+                        resp[U("lastRunMs")] = web::json::value::number(stats.lastRunMs);
+                    }
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
+        // POST /routing/convergence - Simulate DV/LS protocol convergence after failures
+        } else if (path == U("/routing/convergence")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    using netsim::sim::Millisecond;
+                    netsim::routing::ConvergenceOptions options;
+                    std::string protocol = jv.has_field(U("protocol")) ? utility::conversions::to_utf8string(jv[U("protocol")].as_string()) : "dv";
+                    if (protocol == "ls" || protocol == "link-state") options.protocol = netsim::routing::RoutingProtocol::LinkState;
+                    else if (protocol != "dv" && protocol != "distance-vector") throw std::runtime_error("Unknown protocol: " + protocol);
+                    if (jv.has_field(U("updateDelayMs"))) options.updateDelay = jv[U("updateDelayMs")].as_double() * Millisecond;
+                    if (jv.has_field(U("spfDelayMs"))) options.spfDelay = jv[U("spfDelayMs")].as_double() * Millisecond;
+                    if (jv.has_field(U("detectionDelayMs"))) options.detectionDelay = jv[U("detectionDelayMs")].as_double() * Millisecond;
+                    if (jv.has_field(U("splitHorizon"))) options.splitHorizon = jv[U("splitHorizon")].as_bool();
+                    if (jv.has_field(U("poisonReverse"))) options.poisonReverse = jv[U("poisonReverse")].as_bool();
+
+                    netsim::routing::ConvergenceSimulator sim(net, options);
+                    web::json::value resp;
+                    resp[U("coldStart")] = convergence_report_to_json(sim.run());
+
+                    // events: [{type: linkDown|linkUp|nodeDown, a, b | node, atMs}], atMs liczone od zbieżności zimnego startu
+                    if (jv.has_field(U("events"))) {
+                        netsim::sim::SimTime base = sim.now();
+                        for (const auto& e : jv[U("events")].as_array()) {
+                            auto type = utility::conversions::to_utf8string(e.at(U("type")).as_string());
+                            auto at = sim_time_after(base, e.at(U("atMs")).as_double(), "atMs");
+                            auto field = [&](const char* key) { return utility::conversions::to_utf8string(e.at(utility::conversions::to_string_t(key)).as_string()); };
+                            if (type == "linkDown") sim.failLink(field("a"), field("b"), at);
+                            else if (type == "linkUp") sim.restoreLink(field("a"), field("b"), at);
+                            else if (type == "nodeDown") sim.failNode(field("node"), at);
+                            else throw std::runtime_error("Unknown event type: " + type);
+                        }
+                        resp[U("events")] = convergence_report_to_json(sim.run());
+                    }
+                    if (jv.has_field(U("install")) && jv[U("install")].as_bool()) sim.install();
+                    if (options.protocol == netsim::routing::RoutingProtocol::DistanceVector)
+                        resp[U("infinity")] = web::json::value::number(sim.infinity());
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
+        } else if (path == U("/network/forward")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    // packets: [{src, dest, count?, ttl?, type?, protocol?, payloadSize?}] - przekazywane paczkami przez routery;
+                    // src i dest to nazwy albo adresy istniejących węzłów (nazwy pakietów są internowane na stałe);
+                    // payloadSize przycinane do 65535 B, łączna liczba pakietów żądania do 1 000 000
+                    const int maxPayload = 65535;
+                    const int maxPackets = 1000000;
+                    int injected = 0;
+                    ForwardingPipeline pipeline(net);
+                    for (const auto& f : jv.at(U("packets")).as_array()) {
+                        auto field = [&](const char* key, const char* fallback) {
+                            auto k = utility::conversions::to_string_t(key);
+                            return f.has_field(k) ? utility::conversions::to_utf8string(f.at(k).as_string()) : std::string(fallback);
+                        };
+                        std::string src = field("src", ""), dest = field("dest", "");
+                        net.findByName(net.resolveNodeName(src));   // rzuca "Node not found"
+                        net.findByName(net.resolveNodeName(dest));
+                        int payloadSize = f.has_field(U("payloadSize")) ? f.at(U("payloadSize")).as_integer() : 0;
+                        int count = f.has_field(U("count")) ? f.at(U("count")).as_integer() : 1;
+                        if (payloadSize < 0) throw std::runtime_error("payloadSize must not be negative");
+                        if (count < 0) throw std::runtime_error("count must not be negative");
+                        payloadSize = std::min(payloadSize, maxPayload);
+                        count = std::min(count, maxPackets - injected);
+                        Packet p(src, dest, field("type", "data"), field("protocol", "udp"), std::string(payloadSize, 'x'));
+                        if (f.has_field(U("ttl"))) p.ttl = f.at(U("ttl")).as_integer();
+                        for (int i = 0; i < count; i++) pipeline.inject(p);
+                        injected += count;
+                    }
+                    auto start = std::chrono::steady_clock::now();
+                    pipeline.run();
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                    const PipelineStats& s = pipeline.stats();
+                    web::json::value resp;
+                    resp[U("injected")] = web::json::value::number(s.injected);
+                    resp[U("delivered")] = web::json::value::number(s.delivered);
+                    resp[U("hops")] = web::json::value::number(s.forwarded);
+                    resp[U("droppedTtl")] = web::json::value::number(s.droppedTtl);
+                    resp[U("droppedAcl")] = web::json::value::number(s.droppedAcl);
+                    resp[U("droppedFailed")] = web::json::value::number(s.droppedFailed);
+                    resp[U("noRoute")] = web::json::value::number(s.noRoute);
+                    resp[U("frames")] = web::json::value::number(s.batches);
+                    resp[U("timeMs")] = web::json::value::number(ms);
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
+        } else if (path == U("/wireless/positions")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    // positions: [{node, x, y, range?}] w metrach; potem łącza radiowe z odległości
+                    if (jv.has_field(U("positions"))) {
+                        for (const auto& p : jv.at(U("positions")).as_array()) {
+                            auto name = net.resolveNodeName(utility::conversions::to_utf8string(p.at(U("node")).as_string()));
+                            net.setPosition(name, p.at(U("x")).as_double(), p.at(U("y")).as_double());
+                            if (p.has_field(U("range"))) net.setWirelessRange(name, p.at(U("range")).as_integer());
+                        }
+                    }
+                    auto start = std::chrono::steady_clock::now();
+                    WirelessUpdate update = net.updateWirelessLinks();
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                    web::json::value resp;
+                    resp[U("inRange")] = web::json::value::number(static_cast<uint64_t>(update.inRange));
+                    resp[U("wirelessLinks")] = web::json::value::number(static_cast<uint64_t>(update.links));
+                    resp[U("added")] = web::json::value::number(static_cast<uint64_t>(update.added));
+                    resp[U("removed")] = web::json::value::number(static_cast<uint64_t>(update.removed));
+                    resp[U("timeMs")] = web::json::value::number(ms);
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
+        } else if (path == U("/mobility/run")) {
+            request.extract_json().then([&](web::json::value jv) {
+                try {
+                    // {model, nodes[], durationMs, tickMs?, area?{minX,minY,maxX,maxY}, minSpeed?, maxSpeed?, seed?}
+                    using namespace netsim::sim;
+                    MobilityOptions options;
+                    if (jv.has_field(U("tickMs"))) options.tick = sim_time_after(0, jv.at(U("tickMs")).as_double(), "tickMs");
+                    if (jv.has_field(U("area"))) {
+                        auto area = jv.at(U("area"));
+                        options.minX = area.at(U("minX")).as_double();
+                        options.minY = area.at(U("minY")).as_double();
+                        options.maxX = area.at(U("maxX")).as_double();
+                        options.maxY = area.at(U("maxY")).as_double();
+                    }
+                    if (jv.has_field(U("minSpeed"))) options.minSpeed = jv.at(U("minSpeed")).as_double();
+                    if (jv.has_field(U("maxSpeed"))) options.maxSpeed = jv.at(U("maxSpeed")).as_double();
+                    if (jv.has_field(U("meanSpeed"))) options.meanSpeed = jv.at(U("meanSpeed")).as_double();
+                    if (jv.has_field(U("interferencePerNeighbor")))
+                        options.interferencePerNeighbor = jv.at(U("interferencePerNeighbor")).as_double();
+                    if (jv.has_field(U("seed"))) options.seed = jv.at(U("seed")).as_number().to_uint64();
+                    int durationMs = jv.at(U("durationMs")).as_integer();
+                    if (durationMs <= 0) throw std::runtime_error("durationMs must be positive");
+
+                    MobilitySimulator mobility(net, options);
+                    MobilityModel model = MobilitySimulator::parseModel(utility::conversions::to_utf8string(jv.at(U("model")).as_string()));
+                    if (jv.has_field(U("trace")))
+                        mobility.loadTrace(netsim::utils::sandboxedPath(
+                            trace_dir, utility::conversions::to_utf8string(jv.at(U("trace")).as_string())));
+                    if (jv.has_field(U("nodes"))) {
+                        for (const auto& n : jv.at(U("nodes")).as_array())
+                            mobility.addNode(net.resolveNodeName(utility::conversions::to_utf8string(n.as_string())), model);
+                    }
+                    // Zmiany łączy w odpowiedzi - najwyżej 1000 pierwszych
+                    web::json::value changes = web::json::value::array();
+                    size_t changeCount = 0;
+                    mobility.setCallback([&](SimTime at, const std::vector<TopologyChange>& tick) {
+                        for (const auto& change : tick) {
+                            if (changeCount < 1000) {
+                                web::json::value c;
+                                c[U("timeMs")] = web::json::value::number(static_cast<double>(at) / Millisecond);
+                                c[U("nodeA")] = web::json::value::string(utility::conversions::to_string_t(net.findById(change.a)->getName()));
+                                c[U("nodeB")] = web::json::value::string(utility::conversions::to_string_t(net.findById(change.b)->getName()));
+                                c[U("up")] = web::json::value::boolean(change.kind == TopologyChange::Kind::LinkUp);
+                                changes[changeCount] = c;
+                            }
+                            changeCount++;
+                        }
+                    });
+                    auto start = std::chrono::steady_clock::now();
+                    net.advanceTime(durationMs);
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                    const MobilityStats& stats = mobility.stats();
+                    web::json::value resp;
+                    resp[U("nodes")] = web::json::value::number(static_cast<uint64_t>(mobility.nodeCount()));
+                    resp[U("ticks")] = web::json::value::number(stats.ticks);
+                    resp[U("moves")] = web::json::value::number(stats.moves);
+                    resp[U("linksUp")] = web::json::value::number(stats.linksUp);
+                    resp[U("linksDown")] = web::json::value::number(stats.linksDown);
+                    resp[U("interferenceUpdates")] = web::json::value::number(stats.interferenceUpdates);
+                    resp[U("waypoints")] = web::json::value::number(stats.waypoints);
+                    resp[U("skipped")] = web::json::value::number(stats.skipped);
+                    resp[U("changes")] = changes;
+                    resp[U("simTimeMs")] = web::json::value::number(static_cast<double>(net.getSimTime()) / Millisecond);
+                    resp[U("timeMs")] = web::json::value::number(ms);
+                    request.reply(status_codes::OK, resp);
+
+                } catch (const std::exception& e) {
+                    web::json::value resp;
+                    resp[U("error")] = web::json::value::string(utility::conversions::to_string_t(e.what()));
+                    request.reply(status_codes::BadRequest, resp);
+                }
+            }).wait();
+
         // POST /db/enable - Enable database persistence
         } else if (path == U("/db/enable")) {
             request.extract_json().then([&](web::json::value jv) {
@@ -1357,7 +2372,7 @@ int main() {
         } else if (path == U("/assignVLAN")) {
             request.extract_json().then([&](web::json::value jv) {
                 try {
-                    std::string name = utility::conversions::to_utf8string(jv[U("name")].as_string());
+                    std::string name = net.resolveNodeName(utility::conversions::to_utf8string(jv[U("name")].as_string()));
                     int vlanId = jv[U("vlanId")].as_integer();
                     net.assignVLAN(name, vlanId);
 
@@ -1386,6 +2401,7 @@ int main() {
                     
                     // Run scenario
                     ScenarioRunner runner(net, engine);
+                    runner.setTraceDirectory(trace_dir);
                     auto result = runner.runScenario(scenario);
                     
                     // Convert result to cpprest JSON
@@ -1426,6 +2442,8 @@ int main() {
         std::cout << "GET  /topology            - Export topology" << std::endl;
         std::cout << "GET  /statistics          - Network statistics" << std::endl;
         std::cout << "GET  /cloudnodes          - List cloud nodes" << std::endl;
+        std::cout << "GET  /ipam                - Nodes in a prefix, next free address, node by IP" << std::endl;
+        std::cout << "GET  /analytics/centrality - Betweenness, closeness, cut nodes" << std::endl;
         std::cout << "POST /node/add            - Add node" << std::endl;
         std::cout << "POST /node/remove         - Remove node" << std::endl;
         std::cout << "POST /node/fail           - Fail node" << std::endl;
@@ -1437,6 +2455,16 @@ int main() {
         std::cout << "POST /vlan/assign         - Assign VLAN" << std::endl;
         std::cout << "POST /firewall/rule       - Add firewall rule" << std::endl;
         std::cout << "POST /scenario/run        - Execute network scenario" << std::endl;
+        std::cout << "POST /analytics/resilience - What-if failure analysis" << std::endl;
+        std::cout << "POST /simulation/packets  - Packet-level simulation" << std::endl;
+        std::cout << "POST /simulation/flows    - Flow-level simulation (max-min fair)" << std::endl;
+        std::cout << "POST /simulation/traffic  - Packet simulation with traffic generators" << std::endl;
+        std::cout << "POST /simulation/branches - What-if branches of the current simulation" << std::endl;
+        std::cout << "POST /router/routes       - Install routes (and ECMP groups) into a router FIB" << std::endl;
+        std::cout << "POST /router/lookup       - Longest-prefix-match next hops" << std::endl;
+        std::cout << "POST /routing/spf         - Shortest-path routing for all routers" << std::endl;
+        std::cout << "POST /routing/convergence - DV/LS convergence after failures" << std::endl;
+        std::cout << "POST /network/forward     - Batched packet forwarding through routers" << std::endl;
         std::cout << "POST /ping                - Ping nodes" << std::endl;
         std::cout << "POST /traceroute          - Traceroute" << std::endl;
         std::cout << "POST /multicast           - Multicast" << std::endl;
@@ -1444,6 +2472,8 @@ int main() {
         std::cout << "POST /topology/import     - Import topology" << std::endl;
         std::cout << "POST /wireless/range      - Set wireless range" << std::endl;
         std::cout << "POST /wireless/interference - Simulate interference" << std::endl;
+        std::cout << "POST /wireless/positions  - Node positions, radio links by range" << std::endl;
+        std::cout << "POST /mobility/run        - Move nodes (waypoint, gaussmarkov, trace)" << std::endl;
         std::cout << "POST /cloud/add           - Add cloud node" << std::endl;
         std::cout << "POST /cloud/scaleup       - Scale up cloud" << std::endl;
         std::cout << "POST /cloud/scaledown     - Scale down cloud" << std::endl;
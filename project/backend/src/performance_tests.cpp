@@ -2,10 +2,32 @@
 #include <chrono>
 #include <vector>
 #include <random>
+#include <thread>
+#include <cstdio>
 #include "core/Network.hpp"
 #include "core/Engine.hpp"
 #include "core/Host.hpp"
 #include "core/Router.hpp"
+#include "core/GraphSnapshot.hpp"
+#include "analysis/MaxFlow.hpp"
+#include "analysis/DynamicShortestPaths.hpp"
+#include "analysis/Centrality.hpp"
+#include "analysis/Resilience.hpp"
+#include "sim/EventScheduler.hpp"
+#include "sim/PacketSimulator.hpp"
+#include "analysis/DeliveryEstimator.hpp"
+#include "sim/FluidSimulator.hpp"
+#include "sim/TcpSimulator.hpp"
+#include "core/QueueDiscipline.hpp"
+#include "sim/TrafficGenerator.hpp"
+#include "sim/PacketCapture.hpp"
+#include "sim/BranchRunner.hpp"
+#include "routing/SpfRouting.hpp"
+#include "routing/ConvergenceSimulator.hpp"
+#include "core/ForwardingPipeline.hpp"
+#include "core/IpAddress.hpp"
+#include "core/SpatialGrid.hpp"
+#include "sim/MobilitySimulator.hpp"
 
 using namespace std::chrono;
 
@@ -298,6 +320,1172 @@ TEST_F(PerformanceTest, StressTest) {
     EXPECT_LT(time, 1000.0) << "Stress test too slow";
 }
 
+// Test 11: Max-flow on a 100k-edge graph
+TEST_F(PerformanceTest, MaxFlowPerformance) {
+    const int ROWS = 160;
+    const int COLS = 320; // siatka ~100k łączy
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> bw(1, 1000);
+
+    auto name = [](int r, int c) { return "N" + std::to_string(r) + "_" + std::to_string(c); };
+    for (int r = 0; r < ROWS; r++)
+        for (int c = 0; c < COLS; c++)
+            net.addNode<DummyNode>(name(r, c), "10.0.0.1");
+    int links = 0;
+    for (int r = 0; r < ROWS; r++) {
+        for (int c = 0; c < COLS; c++) {
+            if (c + 1 < COLS) { net.connect(name(r, c), name(r, c + 1)); net.setBandwidth(name(r, c), name(r, c + 1), bw(gen)); links++; }
+            if (r + 1 < ROWS) { net.connect(name(r, c), name(r + 1, c)); net.setBandwidth(name(r, c), name(r + 1, c), bw(gen)); links++; }
+        }
+    }
+
+    auto snapshot = GraphSnapshot::fromNetwork(net);
+    netsim::analysis::FlowResult flow;
+    auto time = measureTime([&]() {
+        flow = netsim::analysis::MaxFlow(snapshot).compute(name(0, 0), name(ROWS - 1, COLS - 1));
+    });
+
+    std::cout << "Max-flow on " << links << " links: " << flow.maxFlow << " in " << time << "ms" << std::endl;
+    EXPECT_GT(flow.maxFlow, 0);
+    EXPECT_LT(time, 500.0) << "Max-flow too slow";
+}
+
+// Test 12: Incremental SPT repair under link flaps
+TEST_F(PerformanceTest, IncrementalShortestPathPerformance) {
+    const int SIDE = 100; // 10k węzłów, ~20k łączy
+    const int NUM_CHANGES = 1000;
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<> coord(0, SIDE - 2), delay(1, 50);
+
+    auto name = [](int r, int c) { return "N" + std::to_string(r) + "_" + std::to_string(c); };
+    for (int r = 0; r < SIDE; r++)
+        for (int c = 0; c < SIDE; c++)
+            net.addNode<DummyNode>(name(r, c), "10.0.0.1");
+    for (int r = 0; r < SIDE; r++) {
+        for (int c = 0; c < SIDE; c++) {
+            if (c + 1 < SIDE) { net.connect(name(r, c), name(r, c + 1)); net.setLinkDelay(name(r, c), name(r, c + 1), delay(gen)); }
+            if (r + 1 < SIDE) { net.connect(name(r, c), name(r + 1, c)); net.setLinkDelay(name(r, c), name(r + 1, c), delay(gen)); }
+        }
+    }
+
+    Engine engine(net);
+    for (int i = 0; i < 4; i++) engine.trackSource(name(i * 30, i * 30));
+
+    auto time = measureTime([&]() {
+        for (int i = 0; i < NUM_CHANGES; i++) {
+            int r = coord(gen), c = coord(gen);
+            if (i % 4 == 0) {
+                net.disconnect(name(r, c), name(r, c + 1)); // link flap
+                net.connect(name(r, c), name(r, c + 1));
+            } else {
+                net.setLinkDelay(name(r, c), name(r + 1, c), delay(gen));
+            }
+        }
+    });
+
+    auto fullTime = measureTime([&]() {
+        netsim::analysis::DynamicShortestPaths full(GraphSnapshot::fromNetwork(net));
+        for (int i = 0; i < 4; i++) full.addSource(net.getNodeId(name(i * 30, i * 30)));
+    });
+
+    std::cout << NUM_CHANGES << " incremental SPT repairs (4 sources): " << time << "ms" << std::endl;
+    std::cout << "Full rebuild (4 sources): " << fullTime << "ms" << std::endl;
+    EXPECT_LT(time / NUM_CHANGES, 2.0) << "Incremental SPT repair too slow";
+}
+
+// Test 13: Parallel betweenness on a 5k-node mesh
+TEST_F(PerformanceTest, CentralityPerformance) {
+    const int SIDE = 70; // ~5k węzłów, ~10k łączy
+    auto name = [](int r, int c) { return "N" + std::to_string(r) + "_" + std::to_string(c); };
+    for (int r = 0; r < SIDE; r++)
+        for (int c = 0; c < SIDE; c++)
+            net.addNode<DummyNode>(name(r, c), "10.0.0.1");
+    for (int r = 0; r < SIDE; r++) {
+        for (int c = 0; c < SIDE; c++) {
+            if (c + 1 < SIDE) net.connect(name(r, c), name(r, c + 1));
+            if (r + 1 < SIDE) net.connect(name(r, c), name(r + 1, c));
+        }
+    }
+
+    auto snapshot = GraphSnapshot::fromNetwork(net);
+    netsim::analysis::Centrality centrality(snapshot);
+    netsim::analysis::CentralityReport exact, sampled;
+    auto exactTime = measureTime([&]() { exact = centrality.compute(); });
+    netsim::analysis::CentralityOptions options;
+    options.sampleSources = 256;
+    auto sampledTime = measureTime([&]() { sampled = centrality.compute(options); });
+
+    std::cout << "Exact betweenness (" << SIDE * SIDE << " nodes): " << exactTime << "ms" << std::endl;
+    std::cout << "Sampled betweenness (256 sources): " << sampledTime << "ms" << std::endl;
+    // Środek siatki jest najbardziej obciążony w obu trybach
+    NodeId center = snapshot.idOf(name(SIDE / 2, SIDE / 2));
+    EXPECT_GT(exact.betweenness[center], exact.betweenness[snapshot.idOf(name(0, 0))]);
+    EXPECT_GT(sampled.betweenness[center], sampled.betweenness[snapshot.idOf(name(0, 0))]);
+    EXPECT_LT(sampledTime, exactTime);
+}
+
+// Test 14: All single and sampled double failures on a 2k-node network
+TEST_F(PerformanceTest, ResilienceAnalysisPerformance) {
+    const int NUM_NODES = 2000;
+    const int NUM_HOSTS = 200;
+    std::mt19937 gen(7);
+
+    // Losowe drzewo + dodatkowe łącza (część węzłów to punkty artykulacji)
+    for (int i = 0; i < NUM_NODES; i++)
+        net.addNode<DummyNode>("N" + std::to_string(i), "10.0.0.1");
+    for (int i = 1; i < NUM_NODES; i++) {
+        std::uniform_int_distribution<> parent(0, i - 1);
+        net.connect("N" + std::to_string(i), "N" + std::to_string(parent(gen)));
+    }
+    std::uniform_int_distribution<> any(0, NUM_NODES - 1);
+    for (int i = 0; i < NUM_NODES / 2; i++) {
+        int a = any(gen), b = any(gen);
+        if (a != b) net.connect("N" + std::to_string(a), "N" + std::to_string(b));
+    }
+
+    auto snapshot = GraphSnapshot::fromNetwork(net);
+    netsim::analysis::ResilienceQuery query;
+    for (int i = 0; i < NUM_HOSTS; i++) query.sources.push_back(snapshot.idOf("N" + std::to_string(NUM_NODES - 1 - i)));
+
+    using netsim::analysis::ResilienceAnalyzer;
+    auto sets = ResilienceAnalyzer::nodeCombinations(snapshot, {}, 1);
+    std::vector<NodeId> core;
+    for (int i = 0; i < 60; i++) core.push_back(snapshot.idOf("N" + std::to_string(i)));
+    auto doubles = ResilienceAnalyzer::nodeCombinations(snapshot, core, 2);
+    sets.insert(sets.end(), doubles.begin(), doubles.end());
+
+    netsim::analysis::ResilienceReport report;
+    auto time = measureTime([&]() { report = ResilienceAnalyzer(snapshot).evaluate(sets, query); });
+
+    size_t harmful = 0;
+    for (const auto& impact : report.impacts) if (impact.affectedPairs > 0) harmful++;
+    std::cout << "Evaluated " << sets.size() << " failure sets in " << time << "ms ("
+              << harmful << " partition hosts)" << std::endl;
+    EXPECT_GT(harmful, 0);
+    EXPECT_LT(time, 5000.0) << "Resilience analysis too slow";
+}
+
+// Test 15: Timing-wheel event throughput
+TEST_F(PerformanceTest, EventSchedulerThroughput) {
+    using namespace netsim::sim;
+    const int IN_FLIGHT = 10000;
+    const uint64_t TOTAL_EVENTS = 20000000;
+    EventScheduler scheduler;
+    std::mt19937_64 gen(3);
+    std::uniform_int_distribution<SimTime> delay(1, 10 * Millisecond);
+    std::vector<SimTime> delays(4096);
+    for (auto& d : delays) d = delay(gen);
+
+    // Każde zdarzenie planuje następne (stała liczba zdarzeń w locie, jak pakiety w sieci)
+    uint64_t scheduled = 0;
+    EventType hop = 0;
+    hop = scheduler.registerHandler([&](const Event& ev) {
+        if (scheduled < TOTAL_EVENTS) {
+            scheduler.scheduleAfter(delays[(ev.arg0 + scheduled) & 4095], hop, ev.arg0);
+            scheduled++;
+        }
+    });
+    for (int i = 0; i < IN_FLIGHT; i++) {
+        scheduler.scheduleAfter(delays[i & 4095], hop, i);
+        scheduled++;
+    }
+
+    size_t executed = 0;
+    auto time = measureTime([&]() { executed = scheduler.run(); });
+    double perSecond = executed / (time / 1000.0);
+    std::cout << "Executed " << executed << " events in " << time << "ms ("
+              << perSecond / 1e6 << "M events/s)" << std::endl;
+    EXPECT_EQ(executed, TOTAL_EVENTS);
+    EXPECT_GT(perSecond, 5e6) << "Event scheduler too slow";
+}
+
+// Test 16: Packet-level simulation throughput (packet-hops per second)
+TEST_F(PerformanceTest, PacketSimulatorThroughput) {
+    using namespace netsim::sim;
+    const int SIDE = 30; // 900 węzłów
+    const int NUM_PACKETS = 200000;
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<> node(0, SIDE * SIDE - 1), delay(1, 5);
+
+    auto name = [](int i) { return "N" + std::to_string(i); };
+    for (int i = 0; i < SIDE * SIDE; i++) {
+        net.addNode<DummyNode>(name(i), "10.0.0.1");
+        net.findByName(name(i))->setMaxQueueSize(64);
+    }
+    for (int r = 0; r < SIDE; r++) {
+        for (int c = 0; c < SIDE; c++) {
+            int i = r * SIDE + c;
+            if (c + 1 < SIDE) { net.connect(name(i), name(i + 1)); net.setLinkDelay(name(i), name(i + 1), delay(gen)); net.setBandwidth(name(i), name(i + 1), 10000); }
+            if (r + 1 < SIDE) { net.connect(name(i), name(i + SIDE)); net.setLinkDelay(name(i), name(i + SIDE), delay(gen)); net.setBandwidth(name(i), name(i + SIDE), 10000); }
+        }
+    }
+
+    PacketSimulator sim(net);
+    for (int i = 0; i < NUM_PACKETS; i++) {
+        int src = node(gen), dst = node(gen);
+        if (src != dst) sim.inject(net.getNodeId(name(src)), net.getNodeId(name(dst)), 1500, i * 5 * Microsecond);
+    }
+    auto time = measureTime([&]() { sim.run(); });
+
+    const auto& stats = sim.stats();
+    double hopsPerSecond = stats.hops / (time / 1000.0);
+    std::cout << "Simulated " << stats.hops << " packet-hops in " << time << "ms ("
+              << hopsPerSecond / 1e6 << "M hops/s), delivered " << stats.delivered
+              << ", queue drops " << stats.droppedQueue
+              << ", avg latency " << stats.averageLatencyNs() / 1e6 << "ms" << std::endl;
+    EXPECT_GT(stats.delivered, 0);
+    EXPECT_GT(hopsPerSecond, 1e6) << "Packet simulation too slow";
+}
+
+// Test 17: Partitioned (parallel) packet simulation vs sequential run
+TEST_F(PerformanceTest, PacketSimulatorPartitioned) {
+    using namespace netsim::sim;
+    const int SIDE = 30;
+    const int NUM_PACKETS = 100000;
+    const unsigned PARTITIONS = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<> node(0, SIDE * SIDE - 1), delay(1, 5);
+
+    auto name = [](int i) { return "N" + std::to_string(i); };
+    for (int i = 0; i < SIDE * SIDE; i++) {
+        net.addNode<DummyNode>(name(i), "10.0.0.1");
+        net.findByName(name(i))->setMaxQueueSize(64);
+    }
+    for (int r = 0; r < SIDE; r++) {
+        for (int c = 0; c < SIDE; c++) {
+            int i = r * SIDE + c;
+            if (c + 1 < SIDE) { net.connect(name(i), name(i + 1)); net.setLinkDelay(name(i), name(i + 1), delay(gen)); net.setBandwidth(name(i), name(i + 1), 10000); }
+            if (r + 1 < SIDE) { net.connect(name(i), name(i + SIDE)); net.setLinkDelay(name(i), name(i + SIDE), delay(gen)); net.setBandwidth(name(i), name(i + SIDE), 10000); }
+        }
+    }
+    std::vector<std::pair<NodeId, NodeId>> flows;
+    for (int i = 0; i < NUM_PACKETS; i++) {
+        int src = node(gen), dst = node(gen);
+        if (src != dst) flows.emplace_back(net.getNodeId(name(src)), net.getNodeId(name(dst)));
+    }
+
+    auto simulate = [&](unsigned partitions, double& time) {
+        PacketSimOptions options;
+        options.partitions = partitions;
+        auto sim = std::make_unique<PacketSimulator>(net, options);
+        for (size_t i = 0; i < flows.size(); i++) sim->inject(flows[i].first, flows[i].second, 1500, i * 5 * Microsecond);
+        time = measureTime([&]() { sim->run(); });
+        return sim;
+    };
+    double sequentialTime, parallelTime;
+    auto sequential = simulate(1, sequentialTime);
+    auto parallel = simulate(PARTITIONS, parallelTime);
+
+    std::cout << "Sequential: " << sequentialTime << "ms, " << PARTITIONS << " partitions: " << parallelTime
+              << "ms (speedup " << sequentialTime / parallelTime << "x on "
+              << std::thread::hardware_concurrency() << " hardware threads), lookahead "
+              << parallel->lookahead() / 1e6 << "ms" << std::endl;
+    EXPECT_EQ(parallel->stats().delivered, sequential->stats().delivered);
+    EXPECT_EQ(parallel->stats().droppedQueue, sequential->stats().droppedQueue);
+    EXPECT_EQ(parallel->stats().totalLatency, sequential->stats().totalLatency);
+}
+
+// Test 18: Compact packets - scheduled delivery, fragmentation and reassembly throughput
+TEST_F(PerformanceTest, CompactPacketThroughput) {
+    const int NUM_PACKETS = 200000;
+    net.addNode<DummyNode>("A", "10.0.0.1");
+    net.addNode<DummyNode>("B", "10.0.0.2");
+    net.connect("A", "B");
+    Packet templatePkt("A", "B", "data", "udp", std::string(1500, 'x'));
+
+    auto time = measureTime([&]() {
+        Packet received;
+        for (int round = 0; round < NUM_PACKETS / 1000; round++) {
+            for (int i = 0; i < 1000; i++) net.schedulePacketDelivery(templatePkt, i % 7);
+            net.advanceTime(100);
+            while (net.receiveDeliveredPacket("B", received)) {
+                Packet whole = Packet::reassemblePacket(received.fragmentPacket(500));
+                ASSERT_EQ(whole.payload.size(), 1500);
+            }
+        }
+    });
+
+    double packetsPerSecond = NUM_PACKETS / (time / 1000.0);
+    std::cout << "Delivered, fragmented and reassembled " << NUM_PACKETS << " packets in " << time
+              << "ms (" << packetsPerSecond / 1e6 << "M packets/s)" << std::endl;
+    EXPECT_GT(packetsPerSecond, 2e5) << "Packet handling too slow";
+}
+
+// Test 19: Streaming reassembly of jumbo frames over a low-MTU path (interleaved, out of order)
+TEST_F(PerformanceTest, FragmentReassemblyThroughput) {
+    const int NUM_PACKETS = 20000;
+    const int IN_FLIGHT = 64;   // pakiety, których fragmenty się przeplatają
+    const int MTU = 576;
+    std::mt19937 gen(11);
+    Packet jumbo("A", "B", "data", "udp", std::string(9000, 'j'));
+
+    ReassemblyTable table;
+    size_t fragmentsIn = 0, completed = 0;
+    auto time = measureTime([&]() {
+        std::vector<Packet> window;
+        Packet out;
+        for (int batch = 0; batch < NUM_PACKETS / IN_FLIGHT; batch++) {
+            window.clear();
+            for (int i = 0; i < IN_FLIGHT; i++) {
+                auto fragments = jumbo.fragmentPacket(MTU);
+                window.insert(window.end(), fragments.begin(), fragments.end());
+            }
+            std::shuffle(window.begin(), window.end(), gen);
+            for (const auto& frag : window) {
+                if (table.insert(frag, batch, out) == ReassemblyStatus::Complete) completed++;
+            }
+            fragmentsIn += window.size();
+        }
+    });
+
+    double fragmentsPerSecond = fragmentsIn / (time / 1000.0);
+    std::cout << "Reassembled " << completed << " jumbo frames from " << fragmentsIn << " fragments in "
+              << time << "ms (" << fragmentsPerSecond / 1e6 << "M fragments/s)" << std::endl;
+    EXPECT_EQ(completed, (NUM_PACKETS / IN_FLIGHT) * IN_FLIGHT);
+    EXPECT_EQ(table.pending(), 0);
+    EXPECT_GT(fragmentsPerSecond, 1e6) << "Reassembly too slow";
+}
+
+// Test 20: Monte Carlo delivery estimation (per-packet batches and 10^8 packets)
+TEST_F(PerformanceTest, DeliveryEstimation) {
+    using namespace netsim::analysis;
+    const int HOPS = 8;
+    for (int i = 0; i <= HOPS; i++) net.addNode<DummyNode>("N" + std::to_string(i), "10.0.0.1");
+    for (int i = 0; i < HOPS; i++) {
+        net.connect("N" + std::to_string(i), "N" + std::to_string(i + 1));
+        net.setPacketLoss("N" + std::to_string(i), "N" + std::to_string(i + 1), 0.01);
+    }
+    auto snapshot = GraphSnapshot::fromNetwork(net);
+    DeliveryEstimator estimator(snapshot);
+    NodeId src = snapshot.idOf("N0"), dst = snapshot.idOf("N" + std::to_string(HOPS));
+
+    DeliveryEstimate sampled, huge;
+    auto sampledTime = measureTime([&]() { sampled = estimator.estimate(src, dst, 1 << 20); });
+    auto hugeTime = measureTime([&]() { huge = estimator.estimate(src, dst, 100000000); });
+
+    std::cout << "Per-packet: " << sampled.sent << " packets x " << HOPS << " hops in " << sampledTime << "ms ("
+              << sampled.sent * HOPS / (sampledTime / 1000.0) / 1e6 << "M draws/s), rate " << sampled.deliveryRate
+              << "; 10^8 packets in " << hugeTime << "ms, rate " << huge.deliveryRate
+              << " [" << huge.confidenceLow << ", " << huge.confidenceHigh << "]" << std::endl;
+    EXPECT_NEAR(huge.deliveryRate, huge.pathSurvival, 1e-3);
+    EXPECT_LT(hugeTime, 50) << "Large-count estimation should be O(hops)";
+}
+
+// Test 21: Flow-level fluid simulation - 100k flows on a ~10k-link grid (max-min fair sharing)
+TEST_F(PerformanceTest, FluidFlowSimulation) {
+    using namespace netsim::sim;
+    const int SIDE = 71;             // 2 * 71 * 70 = 9940 łączy
+    const int NUM_FLOWS = 100000;
+    const int NUM_SOURCES = 256;     // Engine trzyma drzewo SPT na źródło
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<> node(0, SIDE * SIDE - 1), delay(1, 5), sizeKb(10, 1000);
+
+    auto name = [](int i) { return "N" + std::to_string(i); };
+    for (int i = 0; i < SIDE * SIDE; i++) net.addNode<DummyNode>(name(i), "10.0.0.1");
+    for (int r = 0; r < SIDE; r++) {
+        for (int c = 0; c < SIDE; c++) {
+            int i = r * SIDE + c;
+            if (c + 1 < SIDE) { net.connect(name(i), name(i + 1)); net.setLinkDelay(name(i), name(i + 1), delay(gen)); net.setBandwidth(name(i), name(i + 1), 10000); }
+            if (r + 1 < SIDE) { net.connect(name(i), name(i + SIDE)); net.setLinkDelay(name(i), name(i + SIDE), delay(gen)); net.setBandwidth(name(i), name(i + SIDE), 10000); }
+        }
+    }
+    std::vector<int> sources;
+    for (int i = 0; i < NUM_SOURCES; i++) sources.push_back(node(gen));
+    Engine engine(net);
+
+    auto simulate = [&](SimTime quantum, double& addTime, double& runTime) {
+        FluidOptions options;
+        options.recomputeQuantum = quantum;
+        auto sim = std::make_unique<FluidSimulator>(net, engine, options);
+        std::mt19937 flowGen(3);
+        addTime = measureTime([&]() {
+            for (int i = 0; i < NUM_FLOWS; i++) {
+                NodeId src = net.getNodeId(name(sources[flowGen() % NUM_SOURCES]));
+                NodeId dst = net.getNodeId(name(node(flowGen)));
+                sim->addFlow(src, dst, sizeKb(flowGen) * 1000ull, i * 50 * Microsecond);
+            }
+        });
+        runTime = measureTime([&]() { sim->run(); });
+        return sim;
+    };
+    double addTime, exactTime, quantumAdd, quantumTime;
+    auto exact = simulate(0, addTime, exactTime);
+    auto batched = simulate(Millisecond, quantumAdd, quantumTime);
+
+    size_t completed = 0;
+    double fctSum = 0, exactFct = 0;
+    for (FlowId id = 0; id < NUM_FLOWS; id++) {
+        if (batched->flow(id).status != FlowStatus::Completed) continue;
+        completed++;
+        fctSum += batched->flow(id).completionTime();
+        exactFct += exact->flow(id).completionTime();
+    }
+    double maxUtil = 0;
+    for (const auto& link : exact->linkStats()) maxUtil = std::max(maxUtil, link.peakUtilization);
+
+    std::cout << "Routing " << NUM_FLOWS << " flows: " << addTime << "ms; exact run: " << exactTime << "ms ("
+              << exact->reallocations() << " reallocations), 1ms quantum: " << quantumTime << "ms ("
+              << batched->reallocations() << " reallocations)" << std::endl;
+    std::cout << "Mean FCT exact " << exactFct / completed / 1e6 << "ms, quantized " << fctSum / completed / 1e6
+              << "ms, simulated " << exact->now() / 1e9 << "s" << std::endl;
+    EXPECT_EQ(completed, static_cast<size_t>(NUM_FLOWS));
+    EXPECT_EQ(exact->activeFlows(), 0u);
+    EXPECT_LE(maxUtil, 1.0 + 1e-9);
+    EXPECT_LT(quantumTime, exactTime);
+    EXPECT_LT(exactTime + addTime, 30000.0);
+}
+
+// Test 22: 10k simultaneous TCP connections (Reno vs CUBIC) over the packet simulation
+TEST_F(PerformanceTest, TcpConnections) {
+    using namespace netsim::sim;
+    const int SIDE = 20;
+    const int NUM_CONNECTIONS = 10000;
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<> node(0, SIDE * SIDE - 1), delay(1, 3);
+
+    auto name = [](int i) { return "N" + std::to_string(i); };
+    for (int i = 0; i < SIDE * SIDE; i++) {
+        net.addNode<DummyNode>(name(i), "10.0.0.1");
+        net.findByName(name(i))->setMaxQueueSize(256);
+    }
+    for (int r = 0; r < SIDE; r++) {
+        for (int c = 0; c < SIDE; c++) {
+            int i = r * SIDE + c;
+            if (c + 1 < SIDE) { net.connect(name(i), name(i + 1)); net.setLinkDelay(name(i), name(i + 1), delay(gen)); net.setBandwidth(name(i), name(i + 1), 1000); }
+            if (r + 1 < SIDE) { net.connect(name(i), name(i + SIDE)); net.setLinkDelay(name(i), name(i + SIDE), delay(gen)); net.setBandwidth(name(i), name(i + SIDE), 1000); }
+        }
+    }
+    std::vector<std::pair<NodeId, NodeId>> pairs;
+    while (pairs.size() < NUM_CONNECTIONS) {
+        int src = node(gen), dst = node(gen);
+        if (src != dst) pairs.emplace_back(net.getNodeId(name(src)), net.getNodeId(name(dst)));
+    }
+
+    for (auto cc : {TcpCongestionControl::Reno, TcpCongestionControl::Cubic}) {
+        TcpOptions options;
+        options.congestionControl = cc;
+        TcpSimulator tcp(net, options);
+        for (size_t i = 0; i < pairs.size(); i++) tcp.connect(pairs[i].first, pairs[i].second, 32 * 1024, i * 10 * Microsecond);
+        size_t events = 0;
+        double time = measureTime([&]() { events = tcp.run(); });
+
+        size_t finished = 0;
+        uint64_t retransmissions = 0;
+        double handshakeMs = 0, goodput = 0;
+        for (ConnectionId id = 0; id < tcp.connectionCount(); id++) {
+            auto s = tcp.stats(id);
+            if (s.state != TcpState::Finished) continue;
+            finished++;
+            retransmissions += s.retransmissions;
+            handshakeMs += s.handshakeLatency() / 1e6;
+            goodput += s.goodputMbps();
+        }
+        std::cout << (cc == TcpCongestionControl::Reno ? "Reno" : "CUBIC") << ": " << time << "ms for " << events
+                  << " events (" << tcp.packets().stats().injected << " packets), mean handshake "
+                  << handshakeMs / finished << "ms, mean goodput " << goodput / finished << " Mbps, "
+                  << retransmissions << " retransmissions" << std::endl;
+        EXPECT_EQ(finished, static_cast<size_t>(NUM_CONNECTIONS));
+        EXPECT_LT(time, 20000.0);
+    }
+}
+
+// Test 23: Queue disciplines - raw enqueue/dequeue cost and TCP over a congested uplink
+TEST_F(PerformanceTest, QueueDisciplines) {
+    using namespace netsim::sim;
+    const int OPS = 5000000;
+    const QueueDisciplineType types[] = {QueueDisciplineType::DropTail, QueueDisciplineType::StrictPriority,
+                                         QueueDisciplineType::DeficitRoundRobin, QueueDisciplineType::Red,
+                                         QueueDisciplineType::CoDel};
+    for (auto type : types) {
+        QueueConfig config;
+        config.type = type;
+        config.capacity = 1024;
+        config.redMinThreshold = 200;
+        config.redMaxThreshold = 600;
+        auto queue = QueueDiscipline::create(config);
+        std::mt19937 gen(7);
+        uint64_t served = 0;
+        double time = measureTime([&]() {
+            QueueItem item, out;
+            // Kolejka wypełniona do połowy, potem naprzemiennie wstaw / wyjmij
+            for (int i = 0; i < OPS; i++) {
+                item.handle = i;
+                item.sizeBytes = 64 + (gen() & 1023);
+                item.flow = gen() & 255;
+                item.priority = gen() & 7;
+                SimTime now = static_cast<SimTime>(i) * Microsecond;
+                queue->enqueue(item, now);
+                if (i >= 512 && queue->dequeue(now, out)) served++;
+            }
+        });
+        auto totals = queue->totals();
+        std::cout << QueueConfig::typeName(type) << ": " << time * 1e6 / OPS << "ns per enqueue+dequeue, "
+                  << served << " served, " << totals.droppedOverflow + totals.droppedEarly << " dropped" << std::endl;
+        EXPECT_GT(served, static_cast<uint64_t>(OPS / 2));
+        EXPECT_LT(time, 5000.0);
+    }
+
+    // 40 połączeń TCP przez uplink 100 Mbps z buforem 2000 pakietów
+    const int SENDERS = 40;
+    net.addNode<DummyNode>("Edge", "10.0.0.1");
+    net.addNode<DummyNode>("Core", "10.0.0.2");
+    net.connect("Edge", "Core");
+    net.setLinkDelay("Edge", "Core", 10);
+    net.setBandwidth("Edge", "Core", 100);
+    net.setQueueSize("Edge", 2000);
+    for (int i = 0; i < SENDERS; i++) {
+        std::string host = "H" + std::to_string(i);
+        net.addNode<DummyNode>(host, "10.0.1.1");
+        net.connect(host, "Edge");
+        net.setLinkDelay(host, "Edge", 1);
+        net.setBandwidth(host, "Edge", 1000);
+        net.findByName(host)->setMaxQueueSize(512);
+    }
+    for (auto type : {QueueDisciplineType::DropTail, QueueDisciplineType::Red, QueueDisciplineType::CoDel}) {
+        QueueConfig config;
+        config.type = type;
+        config.redMinThreshold = 100;
+        config.redMaxThreshold = 300;
+        net.setQueueDiscipline("Edge", config);
+        TcpSimulator tcp(net);
+        for (int i = 0; i < SENDERS; i++) tcp.connect("H" + std::to_string(i), "Core", 4 * 1024 * 1024, i * Millisecond);
+        size_t events = 0;
+        double time = measureTime([&]() { events = tcp.run(); });
+
+        double srttMs = 0, goodput = 0;
+        size_t finished = 0;
+        for (ConnectionId id = 0; id < tcp.connectionCount(); id++) {
+            auto s = tcp.stats(id);
+            if (s.state != TcpState::Finished) continue;
+            finished++;
+            srttMs += s.srtt / 1e6;
+            goodput += s.goodputMbps();
+        }
+        auto uplink = tcp.packets().portQueue(tcp.packets().graph().findArc(net.getNodeId("Edge"), net.getNodeId("Core")));
+        double sojournMs = uplink ? uplink->totals().averageSojournNs() / 1e6 : 0.0;
+        std::cout << QueueConfig::typeName(type) << " uplink: " << time << "ms for " << events << " events, mean srtt "
+                  << srttMs / finished << "ms, mean goodput " << goodput / finished << " Mbps, mean sojourn "
+                  << sojournMs << "ms" << std::endl;
+        EXPECT_EQ(finished, static_cast<size_t>(SENDERS));
+        EXPECT_LT(time, 20000.0);
+    }
+}
+
+// Test 24: 10 Gbps of generated traffic in constant memory (lazy generators, recycled packet ids)
+TEST_F(PerformanceTest, TrafficGeneration) {
+    using namespace netsim::sim;
+    const int HOSTS = 20;
+    const SimTime DURATION = 2 * Second;
+    net.addNode<DummyNode>("Core", "10.0.0.1");
+    for (int i = 0; i < HOSTS; i++) {
+        std::string host = "H" + std::to_string(i);
+        net.addNode<DummyNode>(host, "10.0.1." + std::to_string(i + 1));
+        net.connect(host, "Core");
+        net.setLinkDelay(host, "Core", 1);
+        net.setBandwidth(host, "Core", 10000);
+    }
+
+    PacketSimOptions options;
+    options.recyclePacketIds = true;
+    PacketSimulator sim(net, options);
+    TrafficGenerator traffic(net, sim);
+    // 20 hostów x 500 Mbps = 10 Gbps: po równo CBR, Poisson i on/off (szczytowo 1 Gbps)
+    for (int i = 0; i < HOSTS; i++) {
+        TrafficOptions t;
+        t.rateMbps = 500;
+        t.stop = DURATION;
+        t.seed = i + 1;
+        TrafficPattern pattern = i % 3 == 0 ? TrafficPattern::ConstantBitRate
+                               : i % 3 == 1 ? TrafficPattern::Poisson : TrafficPattern::ParetoOnOff;
+        if (pattern == TrafficPattern::ParetoOnOff) {
+            t.rateMbps = 1000;
+            t.meanOn = t.meanOff = 20 * Millisecond;
+        }
+        traffic.add(pattern, "H" + std::to_string(i), "H" + std::to_string((i + 1) % HOSTS), t);
+    }
+
+    size_t events = 0;
+    double time = measureTime([&]() { events = sim.run(); });
+    uint64_t bytes = 0;
+    for (GeneratorId id = 0; id < traffic.generatorCount(); id++) bytes += traffic.stats(id).bytes;
+    double gbps = bytes * 8.0 / (DURATION / 1e9) / 1e9;
+    std::cout << "Generated " << sim.stats().injected << " packets (" << gbps << " Gbps over "
+              << DURATION / 1e9 << "s simulated) in " << time << "ms, " << events << " events, "
+              << sim.stats().injected / (time / 1000.0) / 1e6 << "M packets/s, peak packet table "
+              << sim.records().size() << " records" << std::endl;
+    EXPECT_GT(gbps, 9.0);
+    EXPECT_EQ(sim.stats().delivered + sim.stats().droppedQueue, sim.stats().injected);
+    // Tablica pakietów ograniczona przez pakiety w locie (~1 ms opóźnienia x 10 Gbps)
+    EXPECT_LT(sim.records().size(), 20000u);
+    EXPECT_LT(time, 30000.0);
+}
+
+// Test 25: Overhead of capture taps - disabled, everything filtered out, and all nodes written to pcapng
+TEST_F(PerformanceTest, PacketCaptureOverhead) {
+    using namespace netsim::sim;
+    const int NODES = 10;
+    const int PACKETS = 200000;
+    for (int i = 0; i < NODES; i++) {
+        net.addNode<DummyNode>("N" + std::to_string(i), "10.0.0." + std::to_string(i + 1));
+        if (i > 0) {
+            net.connect("N" + std::to_string(i - 1), "N" + std::to_string(i));
+            net.setLinkDelay("N" + std::to_string(i - 1), "N" + std::to_string(i), 1);
+        }
+    }
+    const NodeId first = net.findByName("N0")->getId(), last = net.findByName("N9")->getId();
+
+    auto simulate = [&](PacketCapture* capture) {
+        PacketSimOptions options;
+        options.defaultQueueSize = PACKETS;
+        PacketSimulator sim(net, options);
+        sim.setCapture(capture);
+        for (int i = 0; i < PACKETS; i++)
+            sim.setFlow(sim.inject(first, last, 1000, i * 10 * Microsecond), Protocol::Udp, 49152, 5001);
+        return measureTime([&]() { sim.run(); });
+    };
+
+    double disabled = simulate(nullptr);
+    std::string path = testing::TempDir() + "capture_perf.pcapng";
+    CaptureOptions rejectAll;
+    rejectAll.filter = "tcp and port 80";
+    PacketCapture filtered(net, path, rejectAll);
+    filtered.tapAllNodes();
+    double filteredTime = simulate(&filtered);
+    filtered.close();
+    PacketCapture full(net, path);
+    full.tapAllNodes();
+    double fullTime = simulate(&full);
+    full.close();
+    CaptureStats stats = full.stats();
+
+    std::cout << "Capture overhead: disabled " << disabled << "ms, filtered out " << filteredTime
+              << "ms, full capture " << fullTime << "ms (" << stats.captured << " packets, "
+              << stats.bytesWritten / 1e6 << " MB, " << stats.flushes << " buffer flushes, " << stats.dropped
+              << " dropped)" << std::endl;
+    EXPECT_EQ(filtered.stats().captured, 0u);
+    EXPECT_EQ(stats.seen, uint64_t(PACKETS) * NODES);
+    EXPECT_EQ(stats.captured + stats.dropped, stats.seen);
+    EXPECT_LT(filteredTime, disabled * 3 + 50);
+    EXPECT_LT(fullTime, 30000.0);
+    std::remove(path.c_str());
+}
+
+// Test 26: Checkpoint and fork of a 1M-event simulation, what-if branches in threads and processes
+TEST_F(PerformanceTest, SimulationFork) {
+    using namespace netsim::sim;
+    const int NODES = 100;
+    const int EVENTS = 1000000;
+    for (int i = 0; i < NODES; i++) {
+        net.addNode<DummyNode>("N" + std::to_string(i), "10.0." + std::to_string(i / 250) + "." + std::to_string(i % 250 + 1));
+        if (i > 0) {
+            net.connect("N" + std::to_string(i - 1), "N" + std::to_string(i));
+            net.setLinkDelay("N" + std::to_string(i - 1), "N" + std::to_string(i), 1);
+        }
+    }
+    double scheduleTime = measureTime([&]() {
+        for (int i = 0; i < EVENTS; i++) {
+            int a = i % (NODES - 1);
+            net.schedulePacketDelivery(Packet("N" + std::to_string(a), "N" + std::to_string(a + 1), "data", "udp", ""), i % 1000);
+        }
+    });
+    net.advanceTime(100);
+    const size_t pending = net.getScheduler().pending();
+
+    std::unique_ptr<Network> checkpoint;
+    double forkTime = measureTime([&]() { checkpoint = net.fork(); });
+
+    std::vector<Branch> branches;
+    for (int k = 0; k < 4; k++) {
+        branches.push_back({"fail N" + std::to_string(k * 20), [k](Network& n) {
+            n.failNode("N" + std::to_string(k * 20));
+            n.advanceTime(1000);
+            return std::to_string(n.getScheduler().pending());
+        }});
+    }
+    std::vector<BranchResult> threads, processes;
+    double threadTime = measureTime([&]() { threads = runBranches(*checkpoint, branches, BranchMode::Threads); });
+    double processTime = measureTime([&]() { processes = runBranches(*checkpoint, branches, BranchMode::Processes); });
+    double maxThreadFork = 0, maxProcessFork = 0;
+    for (const auto& r : threads) maxThreadFork = std::max(maxThreadFork, r.forkMs);
+    for (const auto& r : processes) maxProcessFork = std::max(maxProcessFork, r.forkMs);
+
+    std::cout << "Scheduled " << EVENTS << " deliveries in " << scheduleTime << "ms; fork with " << pending
+              << " pending events in " << forkTime << "ms; 4 branches: threads " << threadTime << "ms (fork "
+              << maxThreadFork << "ms each), processes " << processTime << "ms (fork " << maxProcessFork
+              << "ms each)" << std::endl;
+    for (size_t i = 0; i < branches.size(); i++) {
+        EXPECT_TRUE(threads[i].ok);
+        EXPECT_TRUE(processes[i].ok);
+        EXPECT_EQ(threads[i].output, "0");
+        EXPECT_EQ(processes[i].output, "0");
+    }
+    EXPECT_EQ(net.getScheduler().pending(), pending);
+    EXPECT_EQ(checkpoint->getScheduler().pending(), pending);
+    // Fork musi być o rząd szybszy niż odtworzenie stanu od początku
+    EXPECT_LT(forkTime * 10, scheduleTime);
+}
+
+// Test 27: LPM FIB with 100k IPv4 and 100k IPv6 prefixes - bulk install, single and batch lookups
+TEST_F(PerformanceTest, RouterFibLookup) {
+    const int PREFIXES = 100000;
+    const int LOOKUPS = 2000000;
+    auto r = net.addNode<Router>("R", "192.168.0.1");
+    std::vector<std::shared_ptr<Node>> hops;
+    for (int i = 0; i < 16; i++) hops.push_back(net.addNode<Router>("N" + std::to_string(i), "192.168.1." + std::to_string(i + 1)));
+    Router* router = dynamic_cast<Router*>(r.get());
+
+    // Rozkład długości jak w tablicach BGP: głównie /24, reszta /16-/23
+    std::mt19937 rng(42);
+    std::vector<std::pair<std::string, Node*>> routes;
+    std::vector<uint32_t> bases;
+    for (int i = 0; i < PREFIXES; i++) {
+        uint32_t address = rng();
+        int length = rng() % 10 < 6 ? 24 : 16 + rng() % 8;
+        IpPrefix prefix = IpPrefix::fromIpv4(address, static_cast<uint8_t>(length));
+        bases.push_back(prefix.ipv4());
+        routes.push_back({prefix.str(), hops[rng() % hops.size()].get()});
+        char v6[64];
+        std::snprintf(v6, sizeof(v6), "2001:%x:%x::/%d", static_cast<unsigned>(rng() & 0xFFFF),
+                      static_cast<unsigned>(rng() & 0xFFFF), 32 + static_cast<int>(rng() % 17));
+        routes.push_back({v6, hops[rng() % hops.size()].get()});
+    }
+    double installTime = measureTime([&]() {
+        router->addRoutes(routes);
+        router->getFib().compile();
+    });
+
+    std::vector<uint32_t> addresses(LOOKUPS);
+    for (int i = 0; i < LOOKUPS; i++) addresses[i] = bases[rng() % bases.size()] | (rng() & 0xFF);
+    const Fib& fib = router->getFib();
+    size_t found = 0;
+    double singleTime = measureTime([&]() {
+        for (int i = 0; i < LOOKUPS; i++) found += fib.lookup4(addresses[i]) != nullptr;
+    });
+    std::vector<Node*> out(LOOKUPS);
+    double batchTime = measureTime([&]() { fib.lookupBatch4(addresses.data(), addresses.size(), out.data()); });
+
+    // Adresy IPv6 wewnątrz losowych zainstalowanych prefiksów
+    std::vector<IpPrefix> v6(LOOKUPS / 4);
+    for (auto& a : v6) {
+        IpPrefix::parse(routes[(rng() % PREFIXES) * 2 + 1].first, a);
+        a.length = 128;
+        a.lo = rng();
+    }
+    std::vector<Node*> out6(v6.size());
+    double batch6Time = measureTime([&]() { fib.lookupBatch(v6.data(), v6.size(), out6.data()); });
+
+    // Przyrostowe zmiany /24 po kompilacji
+    const int UPDATES = 10000;
+    double updateTime = measureTime([&]() {
+        for (int i = 0; i < UPDATES; i++) {
+            router->addRoute(IpPrefix::fromIpv4(rng(), 24).str(), hops[i % hops.size()].get());
+            fib.lookup4(addresses[i]);
+        }
+    });
+
+    auto stats = fib.stats();
+    std::cout << "FIB with " << stats.routes << " routes installed in " << installTime << "ms ("
+              << stats.memoryBytes / 1024 << " KB compiled); IPv4 lookup " << singleTime * 1e6 / LOOKUPS
+              << "ns single, " << batchTime * 1e6 / LOOKUPS << "ns batched; IPv6 " << batch6Time * 1e6 / v6.size()
+              << "ns batched; " << updateTime * 1e3 / UPDATES << "us per update+lookup" << std::endl;
+    for (int i = 0; i < LOOKUPS; i += 997) EXPECT_EQ(out[i], fib.lookup4(addresses[i]));
+    EXPECT_EQ(found, static_cast<size_t>(LOOKUPS));
+    EXPECT_GE(stats.routes, static_cast<size_t>(PREFIXES));
+    EXPECT_LT(singleTime * 1e6 / LOOKUPS, 200.0);
+    EXPECT_LT(batchTime * 1e6 / LOOKUPS, 200.0);
+}
+
+// Test 28: SPF routing of a 5k-router topology into every FIB, then incremental updates after link changes
+TEST_F(PerformanceTest, SpfRouting5kRouters) {
+    using namespace netsim::routing;
+    const int ROUTERS = 5000;
+    std::mt19937 rng(11);
+    for (int i = 0; i < ROUTERS; i++)
+        net.addNode<Router>("R" + std::to_string(i), "10." + std::to_string(i / 65536) + "." + std::to_string(i / 256 % 256) + "." + std::to_string(i % 256));
+    std::vector<std::pair<std::string, std::string>> links;
+    auto link = [&](int a, int b) {
+        std::string x = "R" + std::to_string(a), y = "R" + std::to_string(b);
+        net.connect(x, y);
+        net.setLinkDelay(x, y, 1 + static_cast<int>(rng() % 20));
+        links.push_back({x, y});
+    };
+    // Pierścień z lokalnymi skrótami i kilkoma dalekimi łączami (jak szkielet WAN)
+    for (int i = 0; i < ROUTERS; i++) {
+        link(i, (i + 1) % ROUTERS);
+        if (i % 2 == 0) link(i, (i + 7) % ROUTERS);
+        if (i % 50 == 0) link(i, static_cast<int>(rng() % ROUTERS));
+    }
+
+    std::unique_ptr<SpfRouting> spf;
+    double fullTime = measureTime([&]() { spf = std::make_unique<SpfRouting>(net); });
+    auto* r0 = dynamic_cast<Router*>(net.findByName("R0").get());
+    size_t routesPerRouter = r0->getRouteCount();
+
+    const int CHANGES = 5;
+    uint64_t recomputed = 0;
+    double incrementalTime = measureTime([&]() {
+        for (int i = 0; i < CHANGES; i++) {
+            const auto& l = links[rng() % links.size()];
+            if (i % 2 == 0) net.disconnect(l.first, l.second);
+            else net.setLinkDelay(l.first, l.second, 1 + static_cast<int>(rng() % 20));
+            recomputed += spf->stats().lastRoutersComputed;
+        }
+    });
+
+    std::cout << "SPF for " << ROUTERS << " routers (" << links.size() << " links, " << routesPerRouter
+              << " routes each) in " << fullTime << "ms; " << CHANGES << " link changes in " << incrementalTime
+              << "ms recomputing " << recomputed / CHANGES << " routers per change on average" << std::endl;
+    EXPECT_EQ(routesPerRouter, static_cast<size_t>(ROUTERS - 1));
+    EXPECT_NE(r0->getNextHop("10.0.19.135"), nullptr);
+    EXPECT_LT(recomputed, static_cast<uint64_t>(CHANGES) * ROUTERS);
+    EXPECT_LT(fullTime, 60000.0);
+}
+
+// Test 29: DV and LS convergence of 2000 routers after a cold start, a link failure and a router failure
+TEST_F(PerformanceTest, RoutingConvergence2kRouters) {
+    using namespace netsim::routing;
+    using netsim::sim::Millisecond;
+    using netsim::sim::Second;
+    const int ROWS = 40, COLS = 50;
+    std::mt19937 rng(3);
+    auto name = [&](int r, int c) { return "R" + std::to_string(r * COLS + c); };
+    for (int i = 0; i < ROWS * COLS; i++)
+        net.addNode<Router>("R" + std::to_string(i), "10.1." + std::to_string(i / 256) + "." + std::to_string(i % 256));
+    // Siatka z losowymi opóźnieniami 1-5 ms
+    for (int r = 0; r < ROWS; r++) {
+        for (int c = 0; c < COLS; c++) {
+            if (c + 1 < COLS) { net.connect(name(r, c), name(r, c + 1)); net.setLinkDelay(name(r, c), name(r, c + 1), 1 + rng() % 5); }
+            if (r + 1 < ROWS) { net.connect(name(r, c), name(r + 1, c)); net.setLinkDelay(name(r, c), name(r + 1, c), 1 + rng() % 5); }
+        }
+    }
+
+    for (RoutingProtocol protocol : {RoutingProtocol::DistanceVector, RoutingProtocol::LinkState}) {
+        ConvergenceOptions options;
+        options.protocol = protocol;
+        std::unique_ptr<ConvergenceSimulator> sim;
+        ConvergenceReport start, link, node;
+        double startTime = measureTime([&]() {
+            sim = std::make_unique<ConvergenceSimulator>(net, options);
+            start = sim->run();
+        });
+        double failureTime = measureTime([&]() {
+            sim->failLink(name(20, 25), name(20, 26), sim->now() + Second);
+            link = sim->run();
+            sim->failNode(name(10, 10), sim->now() + Second);
+            node = sim->run();
+        });
+
+        const char* label = protocol == RoutingProtocol::DistanceVector ? "DV" : "LS";
+        std::cout << label << " " << ROWS * COLS << " routers: cold start converged in "
+                  << start.convergenceTime() / double(Millisecond) << "ms simulated (" << start.messages << " messages, "
+                  << start.entries << " entries) in " << startTime << "ms" << std::endl;
+        std::cout << label << " link failure: " << link.convergenceTime() / double(Millisecond) << "ms, "
+                  << link.messages << " messages, " << link.loopsFormed << " loops (longest "
+                  << link.longestLoop / double(Millisecond) << "ms); router failure: "
+                  << node.convergenceTime() / double(Millisecond) << "ms, " << node.messages << " messages, "
+                  << node.loopsFormed << " loops; both in " << failureTime << "ms" << std::endl;
+        EXPECT_EQ(start.unreachable, 0u);
+        EXPECT_EQ(link.unreachable, 0u);
+        EXPECT_EQ(node.unreachable, 0u);
+        EXPECT_EQ(node.loopsOpen, 0u);
+        EXPECT_EQ(sim->nextHop(name(10, 9), name(10, 11)) == nullptr, false);
+        EXPECT_LT(startTime + failureTime, 120000.0);
+    }
+}
+
+// Test 30: ECMP/WCMP forwarding - flow-hashed member choice on a 50k-route FIB and a resilient group change
+TEST_F(PerformanceTest, EcmpFlowForwarding) {
+    const int PREFIXES = 50000, GROUPS = 1000, MEMBERS = 8, HOPS = 64, PACKETS = 1000000;
+    std::mt19937 rng(21);
+    auto r0 = net.addNode<Router>("R0", "192.168.0.1");
+    std::vector<Node*> hops;
+    for (int i = 0; i < HOPS; i++) hops.push_back(net.addNode<Router>("N" + std::to_string(i), "").get());
+    Fib& fib = dynamic_cast<Router*>(r0.get())->getFib();
+
+    std::vector<Fib::GroupId> groups;
+    for (int g = 0; g < GROUPS; g++) {
+        std::vector<Fib::GroupMember> members;
+        for (int m = 0; m < MEMBERS; m++) members.push_back({hops[(g + m * 7) % HOPS], 1 + static_cast<uint32_t>(m % 2)});
+        groups.push_back(fib.addGroup(members));
+    }
+    std::vector<IpPrefix> addresses;
+    for (int i = 0; i < PREFIXES; i++) {
+        uint32_t base = (10u << 24) | (static_cast<uint32_t>(i) << 8);
+        fib.insertGroup(IpPrefix::fromIpv4(base, 24), groups[i % GROUPS]);
+        addresses.push_back(IpPrefix::fromIpv4(base | (rng() & 0xff)));
+    }
+    fib.compile();
+
+    std::vector<FlowKey> flows(PACKETS);
+    std::vector<uint32_t> targets(PACKETS);
+    for (int i = 0; i < PACKETS; i++) {
+        targets[i] = rng() % PREFIXES;
+        flows[i] = FlowKey{rng(), addresses[targets[i]].ipv4(), static_cast<uint16_t>(rng()), 443, 6};
+    }
+    // Hash przepływu liczony przy każdym pakiecie, jak w Router::nextHopFor
+    Node* sink = nullptr;
+    double forwardTime = measureTime([&]() {
+        for (int i = 0; i < PACKETS; i++) sink = fib.forward(addresses[targets[i]], flowHash(flows[i], 17), 1500);
+    });
+    std::vector<uint32_t> hashes(PACKETS);
+    for (int i = 0; i < PACKETS; i++) hashes[i] = flowHash(flows[i], 17);
+    EXPECT_NE(sink, nullptr);
+
+    // Rozkład w jednej grupie: członkowie o wadze 2 dostają dwa razy więcej ruchu
+    auto stats = fib.groupStats(groups[0]);
+    uint64_t light = 0, heavy = 0;
+    for (const auto& m : stats) (m.weight == 1 ? light : heavy) += m.packets;
+    // Awaria jednego next hopu: zmieniają się tylko jego przepływy
+    std::vector<Node*> before(PACKETS);
+    for (int i = 0; i < PACKETS; i++) before[i] = fib.lookup(addresses[targets[i]], hashes[i]);
+    double changeTime = measureTime([&]() {
+        for (Fib::GroupId g : groups) {
+            std::vector<Fib::GroupMember> members;
+            for (const auto& m : fib.groupStats(g))
+                if (m.nextHop != hops[5]) members.push_back({m.nextHop, m.weight});
+            fib.setGroupMembers(g, members);
+        }
+    });
+    int moved = 0, unrelated = 0;
+    for (int i = 0; i < PACKETS; i++) {
+        Node* now = fib.lookup(addresses[targets[i]], hashes[i]);
+        moved += now != before[i];
+        unrelated += now != before[i] && before[i] != hops[5];
+    }
+
+    std::cout << "ECMP: flow hash + LPM + group member " << forwardTime * 1e6 / PACKETS
+              << "ns per packet (" << PREFIXES << " routes, " << GROUPS << " groups of " << MEMBERS << "); weight 2:1 traffic ratio "
+              << double(heavy) / double(light) << "; removing one next hop from all groups took " << changeTime << "ms and moved "
+              << 100.0 * moved / PACKETS << "% of flows" << std::endl;
+    EXPECT_EQ(unrelated, 0);
+    EXPECT_NEAR(double(heavy) / double(light), 2.0, 0.3);
+    EXPECT_LT(moved, PACKETS / 4);
+}
+
+// Test 31: Batch forwarding pipeline - packets per second per core over a 100-router chain with a 10k-route FIB per router
+TEST_F(PerformanceTest, BatchForwardingPipeline) {
+    const int ROUTERS = 100, ROUTES = 10000, DESTS = 256, PACKETS = 20000;
+    std::vector<Router*> routers;
+    for (int i = 0; i < ROUTERS; i++) routers.push_back(net.addNode<Router>("R" + std::to_string(i), "").get());
+    std::vector<Node*> hosts;
+    for (int d = 0; d < DESTS; d++) {
+        std::string ip = "10.200." + std::to_string(d / 256) + "." + std::to_string(d % 256);
+        hosts.push_back(net.addNode<Host>("D" + std::to_string(d), ip, 80).get());
+        net.connect(routers.back()->getName(), hosts.back()->getName());
+    }
+    auto src = net.addNode<Host>("S", "10.100.0.1", 1000);
+    net.connect("S", "R0");
+    for (int i = 0; i < ROUTERS; i++) {
+        // Tło: ROUTES prefiksów /24 donikąd, ruch idzie po /16 do następnego routera
+        std::vector<Fib::Route> routes;
+        for (int r = 0; r < ROUTES; r++) routes.push_back({IpPrefix::fromIpv4((11u << 24) | (static_cast<uint32_t>(r) << 8), 24), routers[i]});
+        if (i + 1 < ROUTERS) {
+            net.connect(routers[i]->getName(), routers[i + 1]->getName());
+            routes.push_back({IpPrefix::fromIpv4(0x0ac80000u, 16), routers[i + 1]});
+        } else {
+            for (int d = 0; d < DESTS; d++) routes.push_back({IpPrefix::fromIpv4(0x0ac80000u | d), hosts[d]});
+        }
+        routers[i]->getFib().insertBulk(routes);
+        routers[i]->getFib().compile();
+    }
+
+    std::vector<Packet> packets;
+    for (int i = 0; i < PACKETS; i++) {
+        Packet p("S", hosts[i % DESTS]->getIp(), "data", "udp", "payload");
+        p.ttl = 255;
+        packets.push_back(p);
+    }
+
+    // Dotychczasowa ścieżka: pakiet po pakiecie, next hop routera po routerze (Router::receivePacket bez wypisywania)
+    uint64_t perPacketHops = 0;
+    double perPacketTime = measureTime([&]() {
+        for (Packet p : packets) {
+            Node* at = routers[0];
+            while (Router* r = dynamic_cast<Router*>(at)) {
+                p.ttl--;
+                at = r->nextHopFor(p);
+                r->incrementPacketCount();
+                perPacketHops++;
+            }
+        }
+    });
+
+    ForwardingPipeline pipeline(net);
+    double batchTime = measureTime([&]() {
+        for (const Packet& p : packets) pipeline.inject(p);
+        pipeline.run();
+    });
+    const PipelineStats& s = pipeline.stats();
+    uint64_t routerHops = s.forwarded - PACKETS;   // bez pierwszego skoku hosta S
+
+    std::cout << "Forwarding pipeline: " << PACKETS << " packets x " << ROUTERS << " routers (" << ROUTES
+              << " routes each): batched " << routerHops / (batchTime / 1000.0) / 1e6 << " Mpps per core ("
+              << batchTime * 1e6 / routerHops << "ns per hop, " << s.batches << " frames), per-packet "
+              << perPacketHops / (perPacketTime / 1000.0) / 1e6 << " Mpps per core" << std::endl;
+    EXPECT_EQ(s.delivered, static_cast<uint64_t>(PACKETS));
+    EXPECT_EQ(s.dropped(), 0u);
+    EXPECT_EQ(routerHops, perPacketHops);
+    EXPECT_LT(batchTime, 10000.0);
+}
+
+// Test 32: IPAM index - IP to node lookups, prefix queries and address allocation over 100k nodes
+TEST_F(PerformanceTest, IpamIndex100kNodes) {
+    const int NODES = 100000, LOOKUPS = 1000000;
+    std::mt19937 rng(32);
+    std::vector<std::string> ips;
+    double addTime = measureTime([&]() {
+        for (int i = 0; i < NODES; i++) {
+            // 10.x.y.z z lukami co 7 adresów - jest co przydzielać
+            uint32_t address = 0x0a000000u + static_cast<uint32_t>(i) + static_cast<uint32_t>(i) / 6 + 1;
+            ips.push_back(IpAddress::fromIpv4(address).str());
+            net.addNode<Host>("H" + std::to_string(i), ips.back(), 80);
+        }
+    });
+    std::vector<IpAddress> queries(LOOKUPS);
+    for (auto& q : queries) IpAddress::parse(ips[rng() % NODES], q);
+    size_t found = 0;
+    double lookupTime = measureTime([&]() {
+        for (const auto& q : queries) found += net.findByIp(q) != nullptr;
+    });
+    // Dotychczas: przegląd wszystkich węzłów z porównaniem napisu ip
+    const int SCANS = 200;
+    size_t scanned = 0;
+    double scanTime = measureTime([&]() {
+        for (int i = 0; i < SCANS; i++) {
+            const std::string& ip = ips[rng() % NODES];
+            for (const auto& name : net.getAllNodes())
+                if (net.findByName(name)->getIp() == ip) { scanned++; break; }
+        }
+    });
+    IpPrefix slash16;
+    IpPrefix::parse("10.1.0.0/16", slash16);
+    size_t inPrefix = 0;
+    double prefixTime = measureTime([&]() { inPrefix = net.findInPrefix(slash16).size(); });
+    IpAddress free;
+    double allocateTime = measureTime([&]() {
+        for (int i = 0; i < 1000; i++) {
+            free = net.allocateAddress(slash16);
+            net.addNode<Host>("A" + std::to_string(i), free.str(), 80);
+        }
+    });
+
+    std::cout << "IPAM: " << NODES << " nodes indexed in " << addTime << "ms, IP lookup "
+              << lookupTime * 1e6 / LOOKUPS << "ns (node scan " << scanTime * 1e6 / SCANS << "ns), "
+              << inPrefix << " nodes in /16 listed in " << prefixTime << "ms, 1000 allocations in " << allocateTime << "ms" << std::endl;
+    EXPECT_EQ(found, static_cast<size_t>(LOOKUPS));
+    EXPECT_EQ(scanned, static_cast<size_t>(SCANS));
+    size_t expected = 0;
+    for (const auto& ip : ips) {
+        IpAddress address;
+        expected += IpAddress::parse(ip, address) && address.in(slash16);
+    }
+    EXPECT_EQ(inPrefix, expected);
+    EXPECT_TRUE(net.getAddressConflicts().empty());
+    EXPECT_LT(lookupTime * 1e6 / LOOKUPS, 2000.0);
+}
+
+// Test 33: Range-based wireless links for 100k IoT sensors - spatial grid vs all-pairs check
+TEST_F(PerformanceTest, WirelessGrid100kSensors) {
+    const int SENSORS = 100000;
+    const double RANGE = 30.0;
+    // Gęstość ~10 sąsiadów w zasięgu: pi * 30^2 * n / side^2 = 10
+    const double side = std::sqrt(3.14159 * RANGE * RANGE * SENSORS / 10.0);
+    std::mt19937 rng(33);
+    std::uniform_real_distribution<double> coord(0.0, side);
+    std::vector<Position> points(SENSORS);
+    for (auto& p : points) p = {coord(rng), coord(rng)};
+    std::vector<uint8_t> active(SENSORS, 1);
+
+    SpatialGrid grid;
+    size_t gridPairs = 0;
+    double gridTime = measureTime([&]() {
+        grid.build(points, active, RANGE);
+        grid.forEachPair([&](uint32_t, uint32_t, double) { gridPairs++; });
+    });
+    // Dotychczas: każda para węzłów - na 5k czujnikach, ekstrapolowane kwadratowo
+    const int SUBSET = 5000;
+    size_t bruteSubsetPairs = 0, gridSubsetPairs = 0;
+    double bruteTime = measureTime([&]() {
+        for (int a = 0; a < SUBSET; a++)
+            for (int b = a + 1; b < SUBSET; b++) {
+                double dx = points[a].x - points[b].x, dy = points[a].y - points[b].y;
+                bruteSubsetPairs += dx * dx + dy * dy <= RANGE * RANGE;
+            }
+    });
+    std::vector<uint8_t> subset(SENSORS, 0);
+    std::fill(subset.begin(), subset.begin() + SUBSET, 1);
+    SpatialGrid small;
+    small.build(points, subset, RANGE);
+    small.forEachPair([&](uint32_t, uint32_t, double) { gridSubsetPairs++; });
+
+    for (int i = 0; i < SENSORS; i++) {
+        std::string name = "S" + std::to_string(i);
+        net.addIoTDevice(name, "");
+        net.setPosition(name, points[i].x, points[i].y);
+        net.setWirelessRange(name, static_cast<int>(RANGE));
+    }
+    WirelessUpdate first, idle, moved;
+    double firstTime = measureTime([&]() { first = net.updateWirelessLinks(); });
+    double idleTime = measureTime([&]() { idle = net.updateWirelessLinks(); });
+    // 1% czujników przesuwa się o kilka metrów
+    std::uniform_real_distribution<double> step(-10.0, 10.0);
+    for (int k = 0; k < SENSORS / 100; k++) {
+        int i = rng() % SENSORS;
+        net.setPosition(net.findByName("S" + std::to_string(i))->getId(), Position{points[i].x + step(rng), points[i].y + step(rng)});
+    }
+    double movedTime = measureTime([&]() { moved = net.updateWirelessLinks(); });
+
+    double extrapolated = bruteTime * (static_cast<double>(SENSORS) / SUBSET) * (static_cast<double>(SENSORS) / SUBSET);
+    std::cout << "Wireless grid: " << SENSORS << " sensors, " << gridPairs << " pairs in range found in " << gridTime
+              << "ms (all pairs ~" << extrapolated << "ms), links built in " << firstTime << "ms, idle update "
+              << idleTime << "ms, after moving 1%: +" << moved.added << "/-" << moved.removed << " in " << movedTime << "ms" << std::endl;
+    EXPECT_EQ(gridSubsetPairs, bruteSubsetPairs);
+    EXPECT_EQ(first.inRange, gridPairs);
+    EXPECT_EQ(first.added, gridPairs);
+    EXPECT_EQ(idle.added + idle.removed, 0u);
+    EXPECT_GT(moved.added + moved.removed, 0u);
+    EXPECT_LT(gridTime, 1000.0);
+}
+
+// Test 34: Mobility - 1000 random-waypoint nodes among 100k static sensors, incremental link updates per tick
+TEST_F(PerformanceTest, MobilityIncrementalTicks100k) {
+    using namespace netsim::sim;
+    const int SENSORS = 100000, MOBILE = 1000;
+    const double RANGE = 30.0;
+    const double side = std::sqrt(3.14159 * RANGE * RANGE * SENSORS / 10.0);
+    std::mt19937 rng(34);
+    std::uniform_real_distribution<double> coord(0.0, side);
+    for (int i = 0; i < SENSORS; i++) {
+        std::string name = "S" + std::to_string(i);
+        net.addIoTDevice(name, "");
+        net.setPosition(name, coord(rng), coord(rng));
+        net.setWirelessRange(name, static_cast<int>(RANGE));
+    }
+    WirelessUpdate initial = net.updateWirelessLinks();
+    // Dotychczas: pełne przeliczenie łączy po każdym ruchu
+    double fullTime = measureTime([&]() { net.updateWirelessLinks(); });
+
+    MobilityOptions options;
+    options.maxX = options.maxY = side;
+    options.tick = 100 * Millisecond;
+    MobilitySimulator mobility(net, options);
+    for (int i = 0; i < MOBILE; i++)
+        mobility.addNode("S" + std::to_string(i * (SENSORS / MOBILE)), MobilityModel::RandomWaypoint);
+    size_t changes = 0;
+    mobility.setCallback([&](SimTime, const std::vector<TopologyChange>& tick) { changes += tick.size(); });
+    double runTime = measureTime([&]() { net.advanceTime(10000); });
+    double perTick = runTime / mobility.stats().ticks;
+
+    WirelessUpdate check = net.updateWirelessLinks();
+    std::cout << "Mobility: " << MOBILE << " moving of " << SENSORS << " sensors (" << initial.links << " links), "
+              << mobility.stats().ticks << " ticks, " << changes << " link changes, " << perTick
+              << "ms per tick (full recompute " << fullTime << "ms)" << std::endl;
+    EXPECT_EQ(check.added + check.removed, 0u);
+    EXPECT_EQ(mobility.stats().ticks, 100u);
+    EXPECT_GT(changes, 0u);
+    EXPECT_LT(perTick, fullTime);
+}
+
 // Main function
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,589 @@
+#include "ConvergenceSimulator.hpp"
+#include "../core/Fib.hpp"
+#include "../core/Router.hpp"
+#include "../utils/Parallel.hpp"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace netsim {
+namespace routing {
+
+namespace {
+
+constexpr uint32_t Unreachable = UINT32_MAX;
+
+using HeapEntry = std::pair<uint32_t, NodeId>;
+
+inline void heapPush(std::vector<HeapEntry>& heap, HeapEntry entry) {
+    heap.push_back(entry);
+    std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+}
+
+inline HeapEntry heapPop(std::vector<HeapEntry>& heap) {
+    std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+    HeapEntry top = heap.back();
+    heap.pop_back();
+    return top;
+}
+
+} // namespace
+
+ConvergenceSimulator::ConvergenceSimulator(const Network& net, const ConvergenceOptions& options)
+    : m_options(options), m_graph(GraphSnapshot::fromNetwork(net)) {
+    m_nodeCount = m_graph.nodeCount();
+    const size_t n = m_nodeCount;
+    m_nodes.assign(n, nullptr);
+    m_routerIndex.assign(n, NoRouter);
+    m_nodeUp.assign(n, 0);
+    for (NodeId u = 0; u < n; ++u) {
+        if (!m_graph.present[u]) continue;
+        m_nodes[u] = net.findById(u).get();
+        m_nodeUp[u] = m_graph.isUsable(u);
+        if (dynamic_cast<Router*>(m_nodes[u])) {
+            m_routerIndex[u] = static_cast<uint32_t>(m_routers.size());
+            m_routers.push_back(u);
+        }
+    }
+
+    m_arcSource.resize(m_graph.arcCount());
+    m_arcCost.resize(m_graph.arcCount());
+    m_arcUp.resize(m_graph.arcCount());
+    for (NodeId u = 0; u < n; ++u) {
+        for (uint32_t a = m_graph.offsets[u]; a < m_graph.offsets[u + 1]; ++a) {
+            m_arcSource[a] = u;
+            m_arcCost[a] = static_cast<uint32_t>(std::max(m_graph.delayMs[a], 0)) + 1;
+            m_arcUp[a] = m_nodeUp[u] && m_nodeUp[m_graph.targets[a]];
+        }
+    }
+
+    const size_t routers = m_routers.size();
+    const bool dv = m_options.protocol == RoutingProtocol::DistanceVector;
+    if (dv) {
+        computeInfinity();
+        m_dist.assign(routers * n, m_infinity);
+    } else {
+        m_lsas.resize(routers);
+        m_lsdb.assign(routers * routers, 0);
+        m_spfPending.assign(routers, 0);
+    }
+    m_via.assign(routers * n, NoArc);
+    m_dirty.resize(routers);
+    m_dirtyWords = ((dv ? n : routers) + 63) / 64;
+    m_dirtyBits.assign(routers * m_dirtyWords, 0);
+    m_flushPending.assign(routers, 0);
+    m_openLoops.resize(n);
+    m_walkMark.assign(n, 0);
+
+    m_startEvent = m_scheduler.registerHandler([this](const sim::Event& ev) { coldStart(static_cast<uint32_t>(ev.arg0)); });
+    m_flushEvent = m_scheduler.registerHandler([this](const sim::Event& ev) { onFlush(static_cast<uint32_t>(ev.arg0)); });
+    m_deliverEvent = m_scheduler.registerHandler([this](const sim::Event& ev) {
+        onDeliver(static_cast<uint32_t>(ev.arg0), static_cast<uint32_t>(ev.arg1));
+    });
+    m_detectEvent = m_scheduler.registerHandler([this](const sim::Event& ev) { onDetect(static_cast<uint32_t>(ev.arg0), ev.arg1 != 0); });
+    m_linkEvent = m_scheduler.registerHandler([this](const sim::Event& ev) { onLinkChange(static_cast<uint32_t>(ev.arg0), ev.arg1 != 0); });
+    m_nodeEvent = m_scheduler.registerHandler([this](const sim::Event& ev) { onNodeFailed(static_cast<NodeId>(ev.arg0)); });
+    m_spfEvent = m_scheduler.registerHandler([this](const sim::Event& ev) { onSpf(ev.time); });
+
+    for (uint32_t r = 0; r < routers; ++r)
+        if (m_nodeUp[m_routers[r]]) m_scheduler.schedule(0, m_startEvent, r);
+}
+
+void ConvergenceSimulator::computeInfinity() {
+    if (m_options.infinity) {
+        m_infinity = m_options.infinity;
+        return;
+    }
+    // Ekscentryczność e jednego routera: średnica <= 2e, zapas na ścieżki wydłużone awariami
+    uint64_t eccentricity = 0;
+    auto first = std::find_if(m_routers.begin(), m_routers.end(), [this](NodeId r) { return m_nodeUp[r] != 0; });
+    if (first != m_routers.end()) {
+        std::vector<uint32_t> dist(m_nodeCount, Unreachable);
+        std::vector<HeapEntry> heap;
+        dist[*first] = 0;
+        heapPush(heap, {0, *first});
+        while (!heap.empty()) {
+            auto [d, u] = heapPop(heap);
+            if (d != dist[u]) continue;
+            eccentricity = std::max<uint64_t>(eccentricity, d);
+            if (u != *first && !isRouter(u)) continue;
+            for (uint32_t a = m_graph.offsets[u]; a < m_graph.offsets[u + 1]; ++a) {
+                NodeId v = m_graph.targets[a];
+                if (m_arcUp[a] && d + m_arcCost[a] < dist[v]) {
+                    dist[v] = d + m_arcCost[a];
+                    heapPush(heap, {dist[v], v});
+                }
+            }
+        }
+    }
+    m_infinity = static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(16, 4 * eccentricity + 1), UINT32_MAX / 2));
+}
+
+uint32_t ConvergenceSimulator::findLink(const std::string& a, const std::string& b) const {
+    uint32_t arc = m_graph.findArc(m_graph.idOf(a), m_graph.idOf(b));
+    if (arc == NoArc) throw std::runtime_error("No link between " + a + " and " + b);
+    return arc;
+}
+
+void ConvergenceSimulator::failLink(const std::string& a, const std::string& b, SimTime at) {
+    m_scheduler.schedule(at, m_linkEvent, findLink(a, b), 0);
+}
+
+void ConvergenceSimulator::restoreLink(const std::string& a, const std::string& b, SimTime at) {
+    m_scheduler.schedule(at, m_linkEvent, findLink(a, b), 1);
+}
+
+void ConvergenceSimulator::failNode(const std::string& name, SimTime at) {
+    m_scheduler.schedule(at, m_nodeEvent, m_graph.idOf(name));
+}
+
+ConvergenceReport ConvergenceSimulator::run() {
+    m_report = ConvergenceReport();
+    SimTime first = m_scheduler.now();
+    m_scheduler.nextEventTime(first);
+    m_report.startedAt = m_report.convergedAt = first;
+    m_scheduler.run();
+    m_report.quiescentAt = std::max(first, m_scheduler.now());
+
+    m_report.loopsOpen = m_openLoopCount;
+    for (uint32_t r = 0; r < m_routers.size(); ++r) {
+        NodeId self = m_routers[r];
+        if (!m_nodeUp[self]) continue;
+        const uint32_t* row = &m_via[r * m_nodeCount];
+        for (NodeId d = 0; d < m_nodeCount; ++d)
+            if (d != self && m_nodeUp[d] && row[d] == NoArc) m_report.unreachable++;
+    }
+    return m_report;
+}
+
+Node* ConvergenceSimulator::nextHop(const std::string& router, const std::string& destination) const {
+    uint32_t r = m_routerIndex[m_graph.idOf(router)];
+    if (r == NoRouter) throw std::runtime_error("Node is not a router: " + router);
+    uint32_t arc = m_via[r * m_nodeCount + m_graph.idOf(destination)];
+    return arc == NoArc ? nullptr : m_nodes[m_graph.targets[arc]];
+}
+
+uint32_t ConvergenceSimulator::metric(const std::string& router, const std::string& destination) const {
+    if (m_options.protocol != RoutingProtocol::DistanceVector)
+        throw std::runtime_error("Metrics are kept only by the distance vector protocol");
+    uint32_t r = m_routerIndex[m_graph.idOf(router)];
+    if (r == NoRouter) throw std::runtime_error("Node is not a router: " + router);
+    return m_dist[r * m_nodeCount + m_graph.idOf(destination)];
+}
+
+void ConvergenceSimulator::install() {
+    std::vector<IpPrefix> prefixes(m_nodeCount);
+    std::vector<uint8_t> hasPrefix(m_nodeCount, 0);
+    for (NodeId d = 0; d < m_nodeCount; ++d)
+        if (m_nodes[d] && !m_nodes[d]->getIpAddress().empty()) {
+            hasPrefix[d] = 1;
+            prefixes[d] = m_nodes[d]->getIpAddress().prefix();
+        }
+
+    unsigned workers = m_options.workers ? m_options.workers : utils::defaultWorkerCount();
+    std::vector<std::vector<Fib::Route>> scratch(workers);
+    utils::parallelFor(m_routers.size(), workers, [&](unsigned worker, size_t r) {
+        NodeId self = m_routers[r];
+        if (!m_nodeUp[self]) return;
+        Router* router = static_cast<Router*>(m_nodes[self]);
+        Fib& fib = router->getFib();
+        auto& routes = scratch[worker];
+        routes.clear();
+        const uint32_t* row = &m_via[r * m_nodeCount];
+        for (NodeId d = 0; d < m_nodeCount; ++d) {
+            if (d == self || !m_nodes[d]) continue;
+            if (row[d] != NoArc) {
+                Node* hop = m_nodes[m_graph.targets[row[d]]];
+                if (hasPrefix[d]) routes.push_back({prefixes[d], hop});
+                else router->addRoute(m_nodes[d]->getName(), hop);
+            } else if (hasPrefix[d]) {
+                fib.remove(prefixes[d]);
+            } else {
+                router->removeRoute(m_nodes[d]->getName());
+            }
+        }
+        fib.insertBulk(routes);
+        fib.compile();
+    });
+}
+
+// --- Wiadomości -------------------------------------------------------------
+
+uint32_t ConvergenceSimulator::allocateMessage() {
+    if (!m_freeMessages.empty()) {
+        uint32_t id = m_freeMessages.back();
+        m_freeMessages.pop_back();
+        return id;
+    }
+    m_messages.emplace_back();
+    return static_cast<uint32_t>(m_messages.size() - 1);
+}
+
+void ConvergenceSimulator::releaseMessage(uint32_t id) {
+    m_messages[id].entries.clear();   // bufor zostaje do ponownego użycia
+    m_messages[id].refs = 0;
+    m_freeMessages.push_back(id);
+}
+
+void ConvergenceSimulator::send(uint32_t router, uint32_t message, uint32_t arc) {
+    NodeId self = m_routers[router];
+    uint32_t begin = arc == NoArc ? m_graph.offsets[self] : arc;
+    uint32_t end = arc == NoArc ? m_graph.offsets[self + 1] : arc + 1;
+    for (uint32_t a = begin; a < end; ++a) {
+        NodeId to = m_graph.targets[a];
+        if (!m_arcUp[a] || !isRouter(to)) continue;
+        m_messages[message].refs++;
+        SimTime delay = static_cast<SimTime>(std::max(m_graph.delayMs[a], 0)) * sim::Millisecond + m_options.processingDelay;
+        // Odbiorca widzi wiadomość na swoim łuku do nadawcy
+        m_scheduler.scheduleAfter(delay, m_deliverEvent, message, m_graph.reverse[a]);
+    }
+    if (m_messages[message].refs == 0) releaseMessage(message);
+}
+
+void ConvergenceSimulator::markDirty(uint32_t router, uint32_t key, NodeId from) {
+    uint64_t& word = m_dirtyBits[router * m_dirtyWords + key / 64];
+    uint64_t bit = uint64_t(1) << (key % 64);
+    if (!(word & bit)) {
+        word |= bit;
+        m_dirty[router].push_back({key, from});
+    }
+    if (!m_flushPending[router]) {
+        m_flushPending[router] = 1;
+        m_scheduler.scheduleAfter(m_options.updateDelay, m_flushEvent, router);
+    }
+}
+
+void ConvergenceSimulator::onFlush(uint32_t router) {
+    m_flushPending[router] = 0;
+    auto& dirty = m_dirty[router];
+    uint64_t* bits = &m_dirtyBits[router * m_dirtyWords];
+    for (const auto& item : dirty) bits[item.first / 64] &= ~(uint64_t(1) << (item.first % 64));
+    if (!m_nodeUp[m_routers[router]] || dirty.empty()) {
+        dirty.clear();
+        return;
+    }
+
+    // Jedna wiadomość ze wszystkimi zebranymi zmianami, wspólna dla sąsiadów
+    uint32_t message = allocateMessage();
+    auto& entries = m_messages[message].entries;
+    entries.reserve(dirty.size());
+    if (m_options.protocol == RoutingProtocol::DistanceVector) {
+        size_t row = router * m_nodeCount;
+        for (const auto& item : dirty) {
+            uint32_t via = m_via[row + item.first];
+            entries.push_back({item.first, m_dist[row + item.first], via == NoArc ? GraphSnapshot::InvalidNode : m_graph.targets[via]});
+        }
+    } else {
+        size_t row = router * m_routers.size();
+        for (const auto& item : dirty) entries.push_back({item.first, m_lsdb[row + item.first], item.second});
+    }
+    dirty.clear();
+    send(router, message);
+}
+
+void ConvergenceSimulator::sendDump(uint32_t router, uint32_t arc) {
+    uint32_t message = allocateMessage();
+    auto& entries = m_messages[message].entries;
+    if (m_options.protocol == RoutingProtocol::DistanceVector) {
+        size_t row = router * m_nodeCount;
+        for (NodeId d = 0; d < m_nodeCount; ++d) {
+            if (m_dist[row + d] >= m_infinity) continue;
+            uint32_t via = m_via[row + d];
+            entries.push_back({d, m_dist[row + d], via == NoArc ? GraphSnapshot::InvalidNode : m_graph.targets[via]});
+        }
+    } else {
+        size_t row = router * m_routers.size();
+        for (uint32_t o = 0; o < m_routers.size(); ++o)
+            if (m_lsdb[row + o]) entries.push_back({o, m_lsdb[row + o], GraphSnapshot::InvalidNode});
+    }
+    send(router, message, arc);
+}
+
+void ConvergenceSimulator::onDeliver(uint32_t message, uint32_t arc) {
+    NodeId receiver = m_arcSource[arc];
+    if (m_arcUp[arc] && m_nodeUp[receiver]) {
+        m_report.messages++;
+        uint32_t router = m_routerIndex[receiver];
+        if (m_options.protocol == RoutingProtocol::DistanceVector) dvReceive(router, arc, m_messages[message]);
+        else lsReceive(router, arc, m_messages[message]);
+    }
+    if (--m_messages[message].refs == 0) releaseMessage(message);
+}
+
+// --- Zmiany topologii -------------------------------------------------------
+
+void ConvergenceSimulator::coldStart(uint32_t router) {
+    NodeId self = m_routers[router];
+    if (!m_nodeUp[self]) return;
+    if (m_options.protocol == RoutingProtocol::LinkState) {
+        lsOriginate(router);
+        return;
+    }
+    m_dist[router * m_nodeCount + self] = 0;
+    markDirty(router, self, GraphSnapshot::InvalidNode);
+    for (uint32_t a = m_graph.offsets[self]; a < m_graph.offsets[self + 1]; ++a) {
+        NodeId to = m_graph.targets[a];
+        if (m_arcUp[a] && !isRouter(to)) dvSetRoute(router, to, m_arcCost[a], a);
+    }
+}
+
+void ConvergenceSimulator::onLinkChange(uint32_t arc, bool up) {
+    uint32_t back = m_graph.reverse[arc];
+    NodeId a = m_arcSource[arc], b = m_graph.targets[arc];
+    if (up && (!m_nodeUp[a] || !m_nodeUp[b])) return;
+    if (m_arcUp[arc] == up) return;
+    m_arcUp[arc] = m_arcUp[back] = up;
+    if (!up) closeBrokenLoops();
+    for (uint32_t side : {arc, back})
+        if (isRouter(m_arcSource[side])) m_scheduler.scheduleAfter(m_options.detectionDelay, m_detectEvent, side, up);
+}
+
+void ConvergenceSimulator::onNodeFailed(NodeId node) {
+    if (!m_nodeUp[node]) return;
+    m_nodeUp[node] = 0;
+    for (uint32_t a = m_graph.offsets[node]; a < m_graph.offsets[node + 1]; ++a) {
+        if (!m_arcUp[a]) continue;
+        uint32_t back = m_graph.reverse[a];
+        m_arcUp[a] = m_arcUp[back] = 0;
+        if (isRouter(m_graph.targets[a])) m_scheduler.scheduleAfter(m_options.detectionDelay, m_detectEvent, back, 0);
+    }
+    closeBrokenLoops();
+}
+
+void ConvergenceSimulator::onDetect(uint32_t arc, bool up) {
+    NodeId self = m_arcSource[arc];
+    uint32_t router = m_routerIndex[self];
+    // Łącze zdążyło zmienić stan ponownie - zdecyduje późniejsze wykrycie
+    if (!m_nodeUp[self] || m_arcUp[arc] != up) return;
+    NodeId neighbour = m_graph.targets[arc];
+
+    if (m_options.protocol == RoutingProtocol::LinkState) {
+        lsOriginate(router);
+        if (up && isRouter(neighbour)) sendDump(router, arc);
+        return;
+    }
+    size_t row = router * m_nodeCount;
+    if (!up) {
+        for (NodeId d = 0; d < m_nodeCount; ++d)
+            if (m_via[row + d] == arc) dvSetRoute(router, d, m_infinity, NoArc);
+    } else if (isRouter(neighbour)) {
+        sendDump(router, arc);
+    } else if (m_arcCost[arc] < m_dist[row + neighbour]) {
+        dvSetRoute(router, neighbour, m_arcCost[arc], arc);
+    }
+}
+
+// --- Distance vector --------------------------------------------------------
+
+void ConvergenceSimulator::dvSetRoute(uint32_t router, NodeId dest, uint32_t metric, uint32_t arc) {
+    size_t cell = router * m_nodeCount + dest;
+    bool nextHopChanged = m_via[cell] != arc;
+    m_dist[cell] = metric;
+    m_via[cell] = arc;
+    markDirty(router, dest, GraphSnapshot::InvalidNode);
+    routeChanged(router, dest, nextHopChanged);
+}
+
+void ConvergenceSimulator::dvReceive(uint32_t router, uint32_t arc, const Message& message) {
+    const NodeId self = m_routers[router];
+    const size_t row = router * m_nodeCount;
+    const uint64_t cost = m_arcCost[arc];
+    for (const Entry& e : message.entries) {
+        if (e.key == self) continue;
+        uint64_t advertised = e.value;
+        // Trasa sąsiada prowadzi przez nas
+        if (e.from == self) {
+            if (m_options.poisonReverse) advertised = m_infinity;
+            else if (m_options.splitHorizon) continue;
+        }
+        m_report.entries++;
+        uint32_t metric = static_cast<uint32_t>(std::min<uint64_t>(advertised + cost, m_infinity));
+        if (m_via[row + e.key] == arc) {
+            // Aktualizacja od obecnego next hopu obowiązuje także, gdy jest gorsza
+            if (metric != m_dist[row + e.key]) dvSetRoute(router, e.key, metric, metric >= m_infinity ? NoArc : arc);
+        } else if (metric < m_dist[row + e.key]) {
+            dvSetRoute(router, e.key, metric, arc);
+        } else if (e.from != self && advertised > m_dist[row + e.key] + cost) {
+            // Sąsiad nie zna naszej lepszej trasy (zastępuje okresowe aktualizacje RIP)
+            markDirty(router, e.key, GraphSnapshot::InvalidNode);
+        }
+    }
+}
+
+// --- Link state -------------------------------------------------------------
+
+void ConvergenceSimulator::lsOriginate(uint32_t router) {
+    NodeId self = m_routers[router];
+    Lsa lsa{static_cast<uint32_t>(m_lsaLinks.size()), 0};
+    for (uint32_t a = m_graph.offsets[self]; a < m_graph.offsets[self + 1]; ++a) {
+        if (!m_arcUp[a]) continue;
+        m_lsaLinks.push_back({m_graph.targets[a], m_arcCost[a], a});
+        lsa.count++;
+    }
+    m_lsas[router].push_back(lsa);
+    m_lsdb[router * m_routers.size() + router] = static_cast<uint32_t>(m_lsas[router].size());
+    markDirty(router, router, GraphSnapshot::InvalidNode);
+    requestSpf(router);
+}
+
+void ConvergenceSimulator::lsReceive(uint32_t router, uint32_t arc, const Message& message) {
+    const NodeId self = m_routers[router];
+    const NodeId sender = m_graph.targets[arc];
+    uint32_t* lsdb = &m_lsdb[router * m_routers.size()];
+    bool changed = false;
+    for (const Entry& e : message.entries) {
+        if (e.from == self) continue;   // nie odsyłamy LSA temu, od kogo przyszło
+        m_report.entries++;
+        if (e.value <= lsdb[e.key]) continue;
+        lsdb[e.key] = e.value;
+        markDirty(router, e.key, sender);
+        changed = true;
+    }
+    if (changed) requestSpf(router);
+}
+
+void ConvergenceSimulator::requestSpf(uint32_t router) {
+    if (m_spfPending[router]) return;
+    m_spfPending[router] = 1;
+    SimTime due = m_scheduler.now() + m_options.spfDelay;
+    auto& batch = m_spfDue[due];
+    if (batch.empty()) m_scheduler.schedule(due, m_spfEvent);
+    batch.push_back(router);
+}
+
+const ConvergenceSimulator::LsaLink* ConvergenceSimulator::lsaFind(uint32_t origin, uint32_t seq, NodeId to) const {
+    const Lsa& lsa = m_lsas[origin][seq - 1];
+    const LsaLink* begin = m_lsaLinks.data() + lsa.begin;
+    const LsaLink* end = begin + lsa.count;
+    const LsaLink* it = std::lower_bound(begin, end, to, [](const LsaLink& l, NodeId id) { return l.to < id; });
+    return it != end && it->to == to ? it : nullptr;
+}
+
+void ConvergenceSimulator::onSpf(SimTime due) {
+    auto node = m_spfDue.extract(due);
+    std::vector<uint32_t> batch;
+    for (uint32_t r : node.mapped()) {
+        m_spfPending[r] = 0;
+        if (m_nodeUp[m_routers[r]]) batch.push_back(r);
+    }
+
+    struct Scratch {
+        std::vector<uint32_t> dist;
+        std::vector<uint32_t> first;
+        std::vector<HeapEntry> heap;
+    };
+    const size_t n = m_nodeCount, routers = m_routers.size();
+    unsigned workers = m_options.workers ? m_options.workers : utils::defaultWorkerCount();
+    std::vector<Scratch> scratch(std::min<size_t>(workers, std::max<size_t>(batch.size(), 1)));
+    std::vector<std::vector<NodeId>> changes(batch.size());
+
+    // SPF na widoku bazy danego routera; każdy wątek pisze tylko wiersze swoich routerów
+    utils::parallelFor(batch.size(), static_cast<unsigned>(scratch.size()), [&](unsigned worker, size_t index) {
+        Scratch& s = scratch[worker];
+        const uint32_t router = batch[index];
+        const NodeId source = m_routers[router];
+        const uint32_t* lsdb = &m_lsdb[router * routers];
+        s.dist.assign(n, Unreachable);
+        s.first.assign(n, NoArc);
+        s.dist[source] = 0;
+        heapPush(s.heap, {0, source});
+        while (!s.heap.empty()) {
+            auto [d, u] = heapPop(s.heap);
+            if (d != s.dist[u] || (u != source && !isRouter(u))) continue;
+            uint32_t seq = lsdb[m_routerIndex[u]];
+            if (!seq) continue;
+            const Lsa& lsa = m_lsas[m_routerIndex[u]][seq - 1];
+            for (uint32_t k = lsa.begin; k < lsa.begin + lsa.count; ++k) {
+                const LsaLink& link = m_lsaLinks[k];
+                NodeId v = link.to;
+                if (isRouter(v)) {
+                    // Łącze dwukierunkowe tylko gdy drugi koniec też je ogłasza
+                    uint32_t other = lsdb[m_routerIndex[v]];
+                    if (!other || !lsaFind(m_routerIndex[v], other, u)) continue;
+                }
+                uint32_t nd = d + link.cost;
+                if (nd < s.dist[v]) {
+                    s.dist[v] = nd;
+                    s.first[v] = u == source ? link.arc : s.first[u];
+                    heapPush(s.heap, {nd, v});
+                }
+            }
+        }
+        uint32_t* row = &m_via[router * n];
+        for (NodeId d = 0; d < n; ++d) {
+            if (d == source || row[d] == s.first[d]) continue;
+            row[d] = s.first[d];
+            changes[index].push_back(d);
+        }
+    });
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        m_report.spfRuns++;
+        for (NodeId d : changes[i]) routeChanged(batch[i], d, true);
+    }
+}
+
+// --- Pętle ------------------------------------------------------------------
+
+bool ConvergenceSimulator::cycleThrough(NodeId start, NodeId dest) {
+    if (++m_walkEpoch == 0) {
+        std::fill(m_walkMark.begin(), m_walkMark.end(), 0);
+        m_walkEpoch = 1;
+    }
+    NodeId u = start;
+    while (true) {
+        uint32_t router = m_routerIndex[u];
+        if (router == NoRouter || !m_nodeUp[u]) return false;
+        uint32_t arc = m_via[router * m_nodeCount + dest];
+        if (arc == NoArc || !m_arcUp[arc]) return false;
+        NodeId v = m_graph.targets[arc];
+        if (v == dest) return false;
+        if (v == start) return true;
+        if (m_walkMark[v] == m_walkEpoch) return false;   // pętla, ale bez start
+        m_walkMark[v] = m_walkEpoch;
+        u = v;
+    }
+}
+
+void ConvergenceSimulator::routeChanged(uint32_t router, NodeId dest, bool nextHopChanged) {
+    const SimTime now = m_scheduler.now();
+    m_report.routeChanges++;
+    m_report.convergedAt = now;
+    if (!nextHopChanged || !m_options.detectLoops) return;
+
+    // Nowa pętla musi przechodzić przez zmieniony router; stare sprawdzamy ponownie
+    closeBrokenLoops(dest);
+    auto& open = m_openLoops[dest];
+    NodeId self = m_routers[router];
+    if (!cycleThrough(self, dest)) return;
+    for (const OpenLoop& loop : open)
+        if (loop.member == self || m_walkMark[loop.member] == m_walkEpoch) return;
+    open.push_back({self, now});
+    m_openLoopCount++;
+    m_report.loopsFormed++;
+}
+
+void ConvergenceSimulator::closeBrokenLoops(NodeId dest) {
+    auto& open = m_openLoops[dest];
+    for (size_t i = 0; i < open.size();) {
+        if (cycleThrough(open[i].member, dest)) {
+            ++i;
+            continue;
+        }
+        SimTime length = m_scheduler.now() - open[i].since;
+        m_report.loopTime += length;
+        m_report.longestLoop = std::max(m_report.longestLoop, length);
+        open[i] = open.back();
+        open.pop_back();
+        m_openLoopCount--;
+    }
+}
+
+void ConvergenceSimulator::closeBrokenLoops() {
+    // Awaria łącza lub węzła przerywa pętlę bez zmiany tras
+    for (NodeId d = 0; d < m_nodeCount && m_openLoopCount; ++d)
+        if (!m_openLoops[d].empty()) closeBrokenLoops(d);
+}
+
+} // namespace routing
+} // namespace netsim
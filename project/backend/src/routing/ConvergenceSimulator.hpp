@@ -0,0 +1,215 @@
+#pragma once
+
+#include "../core/GraphSnapshot.hpp"
+#include "../core/Network.hpp"
+#include "../sim/EventScheduler.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace netsim {
+namespace routing {
+
+using sim::SimTime;
+
+enum class RoutingProtocol { DistanceVector, LinkState };
+
+struct ConvergenceOptions {
+    RoutingProtocol protocol = RoutingProtocol::DistanceVector;
+    SimTime processingDelay = 100 * sim::Microsecond;   // obsługa wiadomości, doliczana do opóźnienia łącza
+    SimTime updateDelay = 10 * sim::Millisecond;        // zbieranie zmian w jedną aktualizację / flooding
+    SimTime spfDelay = 50 * sim::Millisecond;           // LS: SPF po nowym LSA (throttling)
+    SimTime detectionDelay = 0;                         // wykrycie awarii łącza przez sąsiadów
+    bool splitHorizon = true;                           // DV: nie ogłaszaj trasy sąsiadowi, od którego pochodzi
+    bool poisonReverse = true;                          // DV: ... tylko ogłaszaj ją z metryką nieskończoność
+    uint32_t infinity = 0;                              // DV: 0 = 4x ekscentryczność pierwszego routera
+    bool detectLoops = true;
+    unsigned workers = 0;                               // LS: równoległe SPF o tym samym czasie, 0 = rdzenie
+};
+
+/**
+ * @brief Counters of one ConvergenceSimulator::run(), times in simulated ns
+ */
+struct ConvergenceReport {
+    SimTime startedAt = 0;          // pierwsze zdarzenie przebiegu (zimny start, awaria)
+    SimTime convergedAt = 0;        // ostatnia zmiana tablicy routingu
+    SimTime quiescentAt = 0;        // ostatnia wiadomość / SPF
+    uint64_t messages = 0;          // wiadomości doręczone sąsiadom
+    uint64_t entries = 0;           // trasy (DV) albo LSA (LS) w tych wiadomościach
+    uint64_t routeChanges = 0;      // zmiany next hopu lub metryki
+    uint64_t spfRuns = 0;
+    uint64_t loopsFormed = 0;       // przejściowe pętle przekazywania
+    uint64_t loopsOpen = 0;         // pętle trwające po zakończeniu (brak zbieżności)
+    SimTime loopTime = 0;           // suma czasu trwania pętli
+    SimTime longestLoop = 0;
+    uint64_t unreachable = 0;       // pary router-cel bez trasy na koniec
+
+    SimTime convergenceTime() const { return convergedAt > startedAt ? convergedAt - startedAt : 0; }
+};
+
+/**
+ * @brief Event-driven simulation of routing protocol convergence between Routers
+ *
+ * Every Router runs a protocol instance exchanging messages over its links on
+ * an EventScheduler; a message arrives after the link delay plus
+ * processingDelay and is lost when the link or the receiver fails meanwhile.
+ * Other nodes are stub destinations announced by the routers they connect
+ * to. Link cost is the delay in ms plus one.
+ *
+ *  - DistanceVector: RIP-like tables of (metric, next hop) per destination
+ *    with triggered updates only; a router hearing a neighbour advertise a
+ *    worse metric than it could offer re-advertises its route, in place of
+ *    the periodic updates a run to quiescence cannot have. Changed routes are collected for
+ *    updateDelay and sent as one message to every neighbour; split horizon
+ *    (or poison reverse) is applied per neighbour by the receiver from the
+ *    entry's next hop, so the message body is shared. Metrics saturate at
+ *    `infinity`, which bounds counting to infinity. Plain split horizon
+ *    can leave two routers pointing at each other after crossing updates,
+ *    which RIP clears only by route timeout; such loops stay in loopsOpen.
+ *  - LinkState: routers originate versioned LSAs of their up links, flood
+ *    them (batched like DV updates) and run SPF spfDelay after a new LSA,
+ *    using a link only when both ends report it. LSA bodies are stored once;
+ *    a router's database is a sequence number per originator. SPFs due at
+ *    the same time run in parallel.
+ *
+ * Per-router state is flat: 8 bytes per destination for DV, 4 bytes per
+ * destination and per router for LS. After each next-hop change the walk
+ * along the new next hops tells whether a forwarding loop formed; open
+ * loops of the destination are re-checked on its later changes, which gives
+ * their duration. Topology changes are scenario events of the simulation and
+ * do not modify the Network; install() writes the resulting routes into the
+ * Routers' FIBs.
+ */
+class ConvergenceSimulator {
+public:
+    // Zimny start w chwili 0: routery znają tylko siebie i sąsiednie węzły końcowe
+    explicit ConvergenceSimulator(const Network& net, const ConvergenceOptions& options = ConvergenceOptions());
+    ConvergenceSimulator(const ConvergenceSimulator&) = delete;
+    ConvergenceSimulator& operator=(const ConvergenceSimulator&) = delete;
+
+    // Zdarzenia scenariusza; rzucają std::runtime_error dla nieznanego węzła/łącza lub czasu z przeszłości
+    void failLink(const std::string& a, const std::string& b, SimTime at);
+    void restoreLink(const std::string& a, const std::string& b, SimTime at);
+    void failNode(const std::string& name, SimTime at);
+
+    // Wykonuje zdarzenia do wygaśnięcia protokołu; raport obejmuje tylko ten przebieg
+    ConvergenceReport run();
+    SimTime now() const { return m_scheduler.now(); }
+
+    // Aktualny next hop routera (nullptr = brak trasy); rzuca std::runtime_error gdy to nie router
+    Node* nextHop(const std::string& router, const std::string& destination) const;
+    uint32_t metric(const std::string& router, const std::string& destination) const;   // tylko DV
+    uint32_t infinity() const { return m_infinity; }
+
+    // Wpisuje trasy do FIB routerów (nadpisuje trasy do tych samych celów)
+    void install();
+
+private:
+    static constexpr uint32_t NoArc = GraphSnapshot::InvalidArc;
+    static constexpr uint32_t NoRouter = UINT32_MAX;
+
+    struct Entry {
+        uint32_t key;       // DV: cel (NodeId), LS: indeks routera-autora
+        uint32_t value;     // DV: metryka, LS: numer sekwencyjny
+        NodeId from;        // DV: next hop trasy, LS: sąsiad, od którego przyszło LSA
+    };
+
+    struct Message {
+        std::vector<Entry> entries;
+        uint32_t refs = 0;
+    };
+
+    struct LsaLink {
+        NodeId to;
+        uint32_t cost;
+        uint32_t arc;       // łuk autora do sąsiada
+    };
+
+    struct Lsa {
+        uint32_t begin;     // zakres w m_lsaLinks, posortowany po to
+        uint32_t count;
+    };
+
+    struct OpenLoop {
+        NodeId member;
+        SimTime since;
+    };
+
+    ConvergenceOptions m_options;
+    GraphSnapshot m_graph;
+    sim::EventScheduler m_scheduler;
+    sim::EventType m_startEvent, m_flushEvent, m_deliverEvent, m_detectEvent;
+    sim::EventType m_linkEvent, m_nodeEvent, m_spfEvent;
+
+    size_t m_nodeCount = 0;
+    uint32_t m_infinity = 0;
+    std::vector<Node*> m_nodes;
+    std::vector<NodeId> m_routers;            // indeks routera -> NodeId
+    std::vector<uint32_t> m_routerIndex;      // NodeId -> indeks albo NoRouter
+    std::vector<NodeId> m_arcSource;
+    std::vector<uint32_t> m_arcCost;
+    std::vector<uint8_t> m_arcUp;
+    std::vector<uint8_t> m_nodeUp;
+
+    // Tablice routingu: wiersz routera po m_nodeCount celów
+    std::vector<uint32_t> m_via;              // łuk pierwszego skoku albo NoArc
+    std::vector<uint32_t> m_dist;             // tylko DV
+    // Zmiany czekające na wysłanie: bitmapa + lista (klucz, od kogo)
+    std::vector<std::vector<std::pair<uint32_t, NodeId>>> m_dirty;
+    std::vector<uint64_t> m_dirtyBits;
+    size_t m_dirtyWords = 0;
+    std::vector<uint8_t> m_flushPending;
+
+    // LS: wersje LSA każdego autora i bazy routerów (wiersz po liczbie routerów)
+    std::vector<std::vector<Lsa>> m_lsas;
+    std::vector<LsaLink> m_lsaLinks;
+    std::vector<uint32_t> m_lsdb;
+    std::vector<uint8_t> m_spfPending;
+    std::map<SimTime, std::vector<uint32_t>> m_spfDue;
+
+    std::vector<Message> m_messages;
+    std::vector<uint32_t> m_freeMessages;
+
+    std::vector<std::vector<OpenLoop>> m_openLoops;   // cel -> pętle
+    size_t m_openLoopCount = 0;
+    std::vector<uint32_t> m_walkMark;
+    uint32_t m_walkEpoch = 0;
+
+    ConvergenceReport m_report;
+
+    bool isRouter(NodeId node) const { return m_routerIndex[node] != NoRouter; }
+    uint32_t findLink(const std::string& a, const std::string& b) const;
+    void computeInfinity();
+    void coldStart(uint32_t router);
+
+    uint32_t allocateMessage();
+    void releaseMessage(uint32_t id);
+    // Wysyła wiadomość przez łuk (albo wszystkimi łukami do działających routerów, gdy arc == NoArc)
+    void send(uint32_t router, uint32_t message, uint32_t arc = NoArc);
+    void markDirty(uint32_t router, uint32_t key, NodeId from);
+    void onFlush(uint32_t router);
+    void onDeliver(uint32_t message, uint32_t arc);
+    void onLinkChange(uint32_t arc, bool up);
+    void onNodeFailed(NodeId node);
+    void onDetect(uint32_t arc, bool up);
+    void sendDump(uint32_t router, uint32_t arc);
+
+    void dvReceive(uint32_t router, uint32_t arc, const Message& message);
+    void dvSetRoute(uint32_t router, NodeId dest, uint32_t metric, uint32_t arc);
+
+    void lsOriginate(uint32_t router);
+    void lsReceive(uint32_t router, uint32_t arc, const Message& message);
+    void requestSpf(uint32_t router);
+    void onSpf(SimTime due);
+    const LsaLink* lsaFind(uint32_t origin, uint32_t seq, NodeId to) const;
+
+    void routeChanged(uint32_t router, NodeId dest, bool nextHopChanged);
+    bool cycleThrough(NodeId start, NodeId dest);
+    void closeBrokenLoops(NodeId dest);
+    void closeBrokenLoops();
+};
+
+} // namespace routing
+} // namespace netsim
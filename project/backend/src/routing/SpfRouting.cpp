@@ -0,0 +1,301 @@
+#include "SpfRouting.hpp"
+#include "../core/GraphSnapshot.hpp"
+#include "../utils/Parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace netsim {
+namespace routing {
+
+namespace {
+
+constexpr uint64_t Unreachable = std::numeric_limits<uint64_t>::max();
+constexpr uint64_t HopScale = 1ull << 20;   // opóźnienie ważniejsze niż liczba skoków
+
+inline uint64_t linkCost(int delayMs) {
+    return static_cast<uint64_t>(std::max(delayMs, 0)) * HopScale + 1;
+}
+
+using HeapEntry = std::pair<uint64_t, NodeId>;
+using Heap = std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>>;
+
+// Kopiec min na buforze wielokrotnego użytku (priority_queue nie oddaje pamięci między routerami)
+inline void heapPush(std::vector<HeapEntry>& heap, HeapEntry entry) {
+    heap.push_back(entry);
+    std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+}
+
+inline HeapEntry heapPop(std::vector<HeapEntry>& heap) {
+    std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+    HeapEntry top = heap.back();
+    heap.pop_back();
+    return top;
+}
+
+} // namespace
+
+SpfRouting::SpfRouting(Network& net, const SpfOptions& options) : m_net(net), m_options(options) {
+    computeAll();
+    m_listenerId = m_net.addTopologyListener([this](const TopologyChange& change) {
+        m_changes.push_back(change);
+        if (m_options.autoUpdate) update();
+    });
+}
+
+SpfRouting::~SpfRouting() {
+    if (m_listenerId >= 0) m_net.removeTopologyListener(m_listenerId);
+}
+
+void SpfRouting::loadGraph() {
+    GraphSnapshot g = GraphSnapshot::fromNetwork(m_net);
+    size_t n = g.nodeCount();
+    m_adj.assign(n, {});
+    m_usable.assign(n, 0);
+    m_transit.assign(n, 0);
+    m_nodes.assign(n, nullptr);
+    m_routers.assign(n, nullptr);
+    m_prefix.assign(n, IpPrefix());
+    m_hasPrefix.assign(n, 0);
+    m_names.assign(n, std::string());
+    for (NodeId u = 0; u < n; ++u) {
+        if (!g.present[u]) continue;
+        Node* node = m_net.findById(u).get();
+        m_nodes[u] = node;
+        m_routers[u] = dynamic_cast<Router*>(node);
+        m_usable[u] = g.isUsable(u);
+        m_transit[u] = m_usable[u] && (m_options.transitHosts || node->getType() != "host");
+        m_hasPrefix[u] = !node->getIpAddress().empty();
+        m_prefix[u] = node->getIpAddress().prefix();
+        if (!m_hasPrefix[u]) m_names[u] = node->getName();
+        for (uint32_t a = g.offsets[u]; a < g.offsets[u + 1]; ++a)
+            m_adj[u].push_back({g.targets[a], g.delayMs[a]});
+    }
+    refreshArcs();
+}
+
+void SpfRouting::refreshArcs() {
+    m_offsets.assign(m_adj.size() + 1, 0);
+    m_targets.clear();
+    m_costs.clear();
+    for (NodeId u = 0; u < m_adj.size(); ++u) {
+        for (const Edge& e : m_adj[u]) {
+            m_targets.push_back(e.to);
+            m_costs.push_back(linkCost(e.delayMs));
+        }
+        m_offsets[u + 1] = static_cast<uint32_t>(m_targets.size());
+    }
+}
+
+void SpfRouting::distances(NodeId source, std::vector<uint64_t>& dist) const {
+    dist.assign(m_adj.size(), Unreachable);
+    if (source >= m_adj.size() || !m_usable[source]) return;
+    Heap heap;
+    dist[source] = 0;
+    heap.push({0, source});
+    while (!heap.empty()) {
+        auto [d, u] = heap.top();
+        heap.pop();
+        if (d != dist[u] || (u != source && !m_transit[u])) continue;
+        for (uint32_t a = m_offsets[u]; a < m_offsets[u + 1]; ++a) {
+            NodeId v = m_targets[a];
+            uint64_t nd = d + m_costs[a];
+            if (nd < dist[v] && m_usable[v]) {
+                dist[v] = nd;
+                heap.push({nd, v});
+            }
+        }
+    }
+}
+
+void SpfRouting::markCrossing(NodeId a, NodeId b, int delayMs, std::vector<uint8_t>& affected) const {
+    if (!m_usable[a] || !m_usable[b]) return;
+    std::vector<uint64_t> fromA, fromB;
+    distances(a, fromA);
+    distances(b, fromB);
+    uint64_t cost = linkCost(delayMs);
+    for (NodeId r = 0; r < m_routers.size(); ++r) {
+        if (!m_routers[r] || !m_usable[r] || fromA[r] == Unreachable || fromB[r] == Unreachable) continue;
+        // r..a->b albo r..b->a leży na najkrótszej ścieżce (a musi przekazywać, chyba że to r)
+        if (((r == a || m_transit[a]) && fromA[r] + cost == fromB[r]) ||
+            ((r == b || m_transit[b]) && fromB[r] + cost == fromA[r]))
+            affected[r] = 1;
+    }
+}
+
+const SpfRouting::Edge* SpfRouting::findEdge(NodeId a, NodeId b) const {
+    if (a >= m_adj.size()) return nullptr;
+    for (const Edge& e : m_adj[a])
+        if (e.to == b) return &e;
+    return nullptr;
+}
+
+void SpfRouting::setEdge(NodeId a, NodeId b, int delayMs) {
+    for (auto [from, to] : {std::make_pair(a, b), std::make_pair(b, a)}) {
+        auto it = std::find_if(m_adj[from].begin(), m_adj[from].end(), [to](const Edge& e) { return e.to == to; });
+        if (it != m_adj[from].end()) it->delayMs = delayMs;
+        else m_adj[from].push_back({to, delayMs});
+    }
+    refreshArcs();
+}
+
+void SpfRouting::removeEdge(NodeId a, NodeId b) {
+    for (auto [from, to] : {std::make_pair(a, b), std::make_pair(b, a)}) {
+        auto& edges = m_adj[from];
+        edges.erase(std::remove_if(edges.begin(), edges.end(), [to](const Edge& e) { return e.to == to; }), edges.end());
+    }
+    refreshArcs();
+}
+
+void SpfRouting::withdraw(NodeId destination) {
+    for (Router* router : m_routers) {
+        if (!router) continue;
+        bool removed = m_hasPrefix[destination] ? router->getFib().remove(m_prefix[destination])
+                                                : router->removeRoute(m_names[destination]);
+        m_stats.routesWithdrawn += removed;
+    }
+}
+
+void SpfRouting::recompute(const std::vector<NodeId>& routers) {
+    struct Scratch {
+        std::vector<uint64_t> dist;
+        std::vector<NodeId> first;
+        std::vector<HeapEntry> heap;
+        std::vector<Fib::Route> routes;
+        uint64_t installed = 0;
+        uint64_t withdrawn = 0;
+    };
+    unsigned workers = m_options.workers ? m_options.workers : utils::defaultWorkerCount();
+    std::vector<Scratch> scratch(workers);
+    const size_t n = m_adj.size();
+
+    utils::parallelFor(routers.size(), workers, [&](unsigned worker, size_t index) {
+        Scratch& s = scratch[worker];
+        const NodeId source = routers[index];
+        Router* router = m_routers[source];
+
+        // Dijkstra z zapamiętaniem pierwszego skoku ścieżki
+        s.dist.assign(n, Unreachable);
+        s.first.assign(n, GraphSnapshot::InvalidNode);
+        s.dist[source] = 0;
+        heapPush(s.heap, {0, source});
+        while (!s.heap.empty()) {
+            auto [d, u] = heapPop(s.heap);
+            if (d != s.dist[u] || (u != source && !m_transit[u])) continue;
+            for (uint32_t a = m_offsets[u]; a < m_offsets[u + 1]; ++a) {
+                NodeId v = m_targets[a];
+                uint64_t nd = d + m_costs[a];
+                if (nd < s.dist[v] && m_usable[v]) {
+                    s.dist[v] = nd;
+                    s.first[v] = u == source ? v : s.first[u];
+                    heapPush(s.heap, {nd, v});
+                }
+            }
+        }
+
+        Fib& fib = router->getFib();
+        s.routes.clear();
+        for (NodeId d = 0; d < n; ++d) {
+            if (d == source || !m_nodes[d]) continue;
+            if (s.dist[d] != Unreachable) {
+                Node* hop = m_nodes[s.first[d]];
+                if (m_hasPrefix[d]) s.routes.push_back({m_prefix[d], hop});
+                else router->addRoute(m_names[d], hop);
+                s.installed++;
+            } else {
+                s.withdrawn += m_hasPrefix[d] ? fib.remove(m_prefix[d]) : router->removeRoute(m_names[d]);
+            }
+        }
+        fib.insertBulk(s.routes);
+        fib.compile();   // kompilacja w wątku roboczym, nie przy pierwszym pakiecie
+    });
+
+    for (const Scratch& s : scratch) {
+        m_stats.routesInstalled += s.installed;
+        m_stats.routesWithdrawn += s.withdrawn;
+    }
+    m_stats.routersComputed += routers.size();
+    m_stats.lastRoutersComputed = routers.size();
+}
+
+void SpfRouting::computeAll() {
+    auto start = std::chrono::steady_clock::now();
+    loadGraph();
+    m_changes.clear();
+    std::vector<NodeId> routers;
+    for (NodeId u = 0; u < m_routers.size(); ++u)
+        if (m_routers[u] && m_usable[u]) routers.push_back(u);
+    recompute(routers);
+    m_stats.fullRuns++;
+    m_stats.lastRunMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+size_t SpfRouting::update() {
+    if (m_changes.empty()) return 0;
+    auto start = std::chrono::steady_clock::now();
+    using Kind = TopologyChange::Kind;
+    std::vector<uint8_t> affected(m_adj.size(), 0);
+    bool full = false;
+
+    // Każda zmiana: routery z najkrótszą ścieżką przez łącze przed zmianą i po niej
+    for (const TopologyChange& change : m_changes) {
+        NodeId a = change.a, b = change.b;
+        switch (change.kind) {
+        case Kind::LinkUp:
+        case Kind::LinkDelay: {
+            if (std::max(a, b) >= m_nodes.size() || !m_nodes[a] || !m_nodes[b]) {
+                full = true;   // nowy węzeł
+                break;
+            }
+            if (const Edge* old = findEdge(a, b)) markCrossing(a, b, old->delayMs, affected);
+            setEdge(a, b, change.delayMs);
+            markCrossing(a, b, change.delayMs, affected);
+            break;
+        }
+        case Kind::LinkDown:
+            if (const Edge* old = findEdge(a, b)) {
+                markCrossing(a, b, old->delayMs, affected);
+                removeEdge(a, b);
+            }
+            break;
+        case Kind::NodeFailed:
+        case Kind::NodeRemoved: {
+            if (a >= m_nodes.size() || !m_nodes[a]) break;
+            if (m_usable[a])
+                for (const Edge& e : m_adj[a]) markCrossing(a, e.to, e.delayMs, affected);
+            m_usable[a] = 0;
+            m_transit[a] = 0;
+            affected[a] = 0;
+            withdraw(a);
+            if (change.kind == Kind::NodeRemoved) {
+                for (const Edge& e : std::vector<Edge>(m_adj[a])) removeEdge(a, e.to);
+                m_nodes[a] = nullptr;
+                m_routers[a] = nullptr;
+            }
+            break;
+        }
+        case Kind::Reset:
+            full = true;
+            break;
+        }
+        if (full) break;
+    }
+
+    if (full) {
+        computeAll();
+        return static_cast<size_t>(m_stats.lastRoutersComputed);
+    }
+    m_changes.clear();
+    std::vector<NodeId> routers;
+    for (NodeId r = 0; r < affected.size(); ++r)
+        if (affected[r] && m_routers[r] && m_usable[r]) routers.push_back(r);
+    recompute(routers);
+    m_stats.incrementalRuns++;
+    m_stats.lastRunMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<size_t>(m_stats.lastRoutersComputed);
+}
+
+} // namespace routing
+} // namespace netsim
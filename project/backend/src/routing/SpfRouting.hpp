@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../core/Fib.hpp"
+#include "../core/Network.hpp"
+#include "../core/Router.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace netsim {
+namespace routing {
+
+struct SpfOptions {
+    unsigned workers = 0;           // 0 = liczba rdzeni
+    bool autoUpdate = true;         // przeliczaj od razu po każdej zmianie topologii
+    bool transitHosts = false;      // hosty tylko jako cele, nie przekazują ruchu
+};
+
+struct SpfStats {
+    uint64_t fullRuns = 0;
+    uint64_t incrementalRuns = 0;
+    uint64_t routersComputed = 0;   // suma wszystkich przeliczeń SPF
+    uint64_t lastRoutersComputed = 0;
+    uint64_t routesInstalled = 0;
+    uint64_t routesWithdrawn = 0;
+    double lastRunMs = 0.0;
+};
+
+/**
+ * @brief Control plane computing shortest-path routes for every router
+ *
+ * Like OSPF SPF: each usable Router runs Dijkstra over link delays (ties
+ * broken by hop count) and gets a route to every reachable node - the
+ * node's IP as a /32 or /128 prefix in its FIB, or its name when the IP
+ * does not parse - through the first hop of the path. Routers are
+ * computed in parallel, each worker installing into its own routers'
+ * FIBs. Routes from SPF overwrite static routes to the same destination.
+ *
+ * The component listens to topology changes. For a link change it finds
+ * the routers that have (or get) a shortest path across the link by
+ * comparing distances from both endpoints before and after the change,
+ * and recomputes only those; a failed node is handled as the loss of all
+ * its links, and every router withdraws the route to it. New nodes and
+ * Reset recompute everything.
+ */
+class SpfRouting {
+public:
+    explicit SpfRouting(Network& net, const SpfOptions& options = SpfOptions());
+    ~SpfRouting();
+    SpfRouting(const SpfRouting&) = delete;
+    SpfRouting& operator=(const SpfRouting&) = delete;
+
+    // Pełne przeliczenie wszystkich routerów (wczytuje graf od nowa)
+    void computeAll();
+    // Przetwarza zmiany zebrane od ostatniego wywołania; zwraca liczbę przeliczonych routerów
+    size_t update();
+    size_t pendingChanges() const { return m_changes.size(); }
+
+    const SpfStats& stats() const { return m_stats; }
+
+private:
+    struct Edge {
+        NodeId to;
+        int delayMs;
+    };
+
+    Network& m_net;
+    SpfOptions m_options;
+    int m_listenerId = -1;
+    SpfStats m_stats;
+    std::vector<TopologyChange> m_changes;
+
+    // Graf kontrolny (aktualizowany zmianami) i dane celów tras
+    std::vector<std::vector<Edge>> m_adj;
+    std::vector<uint8_t> m_usable;
+    std::vector<uint8_t> m_transit;
+    std::vector<Node*> m_nodes;
+    std::vector<Router*> m_routers;       // NodeId -> router albo nullptr
+    std::vector<IpPrefix> m_prefix;
+    std::vector<uint8_t> m_hasPrefix;
+    std::vector<std::string> m_names;     // cel trasy gdy IP się nie parsuje
+    // Płaska kopia m_adj dla Dijkstry (koszt łuku policzony z góry), odświeżana po każdej zmianie
+    std::vector<uint32_t> m_offsets;
+    std::vector<NodeId> m_targets;
+    std::vector<uint64_t> m_costs;
+
+    void loadGraph();
+    void refreshArcs();
+    // Odległości od source (koszt: opóźnienie, potem liczba skoków); UINT64_MAX = brak
+    void distances(NodeId source, std::vector<uint64_t>& dist) const;
+    // Routery, których najkrótsze ścieżki mogą iść łączem a-b o danym opóźnieniu
+    void markCrossing(NodeId a, NodeId b, int delayMs, std::vector<uint8_t>& affected) const;
+    void withdraw(NodeId destination);
+    void recompute(const std::vector<NodeId>& routers);
+    void setEdge(NodeId a, NodeId b, int delayMs);
+    void removeEdge(NodeId a, NodeId b);
+    const Edge* findEdge(NodeId a, NodeId b) const;
+};
+
+} // namespace routing
+} // namespace netsim
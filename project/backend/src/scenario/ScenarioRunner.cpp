@@ -1,6 +1,11 @@
 #include "ScenarioRunner.hpp"
 #include "../core/Host.hpp"
 #include "../core/Router.hpp"
+#include "../core/GraphSnapshot.hpp"
+#include "../analysis/MaxFlow.hpp"
+#include "../analysis/DeliveryEstimator.hpp"
+#include "../sim/TrafficGenerator.hpp"
+#include "../utils/SandboxPath.hpp"
 #include <iostream>
 #include <thread>
 
@@ -21,6 +26,7 @@ ScenarioResult ScenarioRunner::runScenario(const Scenario& scenario) {
     std::cout << "[Scenario] Description: " << scenario.description << std::endl;
     
     auto start_time = std::chrono::high_resolution_clock::now();
+    m_scenarioPacing = scenario.realtime_pacing;
     
     // Setup phase
     if (!setupNetwork(scenario)) {
@@ -89,6 +95,11 @@ bool ScenarioRunner::setupNetwork(const Scenario& scenario) {
             if (node_setup.vlan != 0) {
                 m_network.assignVLAN(node_setup.name, node_setup.vlan);
             }
+
+            if (node_setup.config.is_object()) {
+                json applied;
+                applyQueueConfig(node_setup.name, node_setup.config, applied);
+            }
         }
         
         // Add links
@@ -130,6 +141,8 @@ StepResult ScenarioRunner::executeStep(const ScenarioStep& step) {
             result = handleSend(step.params, step.expect);
         } else if (step.action == "configure") {
             result = handleConfigure(step.params, step.expect);
+        } else if (step.action == "traffic") {
+            result = handleTraffic(step.params, step.expect);
         } else if (step.action == "wait") {
             result = handleWait(step.params, step.expect);
         } else if (step.action == "validate") {
@@ -192,11 +205,23 @@ StepResult ScenarioRunner::handleWait(const json& params, const json& expect) {
     result.execution_time_ms = 0.0;
     
     int duration_ms = params.value("duration_ms", 100);
+    bool realtime = params.value("realtime", m_realTimePacing || m_scenarioPacing);
+    if (duration_ms < 0) {
+        result.success = false;
+        result.message = "Negative wait duration";
+        return result;
+    }
     
-    std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+    // Czas wirtualny: zaplanowane dostarczenia wykonują się od razu, bez czekania
+    m_network.advanceTime(duration_ms);
+    if (realtime) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+    }
     
-    result.message = "Waited " + std::to_string(duration_ms) + "ms";
+    result.message = "Waited " + std::to_string(duration_ms) + "ms" + (realtime ? "" : " (virtual time)");
     result.actual_values["duration_ms"] = duration_ms;
+    result.actual_values["realtime"] = realtime;
+    result.actual_values["sim_time_ms"] = m_network.getSimTime() / 1e6;
     
     return result;
 }
@@ -258,27 +283,36 @@ StepResult ScenarioRunner::handleSend(const json& params, const json& expect) {
             return result;
         }
         
-        int delivered = 0;
-        int failed = 0;
-        
-        // Send packets
-        for (int i = 0; i < count; ++i) {
-            // Create packet with dummy data (5 params: src, dest, type, protocol, payload)
-            std::string data(size_bytes, 'X');
-            Packet pkt(from, to, "DATA", "TCP", data);
-            
-            // Send packet via Network (not Engine)
-            m_network.sendPacket(pkt);
-            delivered++;  // Assume success for now (no return value from sendPacket)
+        if (count < 0) {
+            result.message = "Negative packet count";
+            return result;
         }
         
-        // Calculate delivery rate
-        double delivery_rate = static_cast<double>(delivered) / count;
+        // Jeden rzeczywisty pakiet sprawdza firewall i awarie węzłów (rzuca wyjątek),
+        // dostarczenie count pakietów jest szacowane statystycznie z packetLoss na ścieżce
+        Packet pkt(from, to, "DATA", "TCP", std::string(size_bytes, 'X'));
+        m_network.sendPacket(pkt);
+        
+        analysis::DeliveryEstimateOptions options;
+        options.seed = params.value("seed", uint64_t(1));
+        options.confidence = params.value("confidence", 0.95);
+        auto snapshot = GraphSnapshot::fromNetwork(m_network);
+        auto estimate = analysis::DeliveryEstimator(snapshot).estimate(
+            snapshot.idOf(from), snapshot.idOf(to), static_cast<uint64_t>(count), options);
+        
+        uint64_t delivered = estimate.delivered;
+        uint64_t failed = count - delivered;
+        double delivery_rate = estimate.deliveryRate;
         
         result.actual_values["sent"] = count;
         result.actual_values["delivered"] = delivered;
         result.actual_values["failed"] = failed;
         result.actual_values["delivery_rate"] = delivery_rate;
+        result.actual_values["delivery_rate_ci"] = {estimate.confidenceLow, estimate.confidenceHigh};
+        result.actual_values["confidence"] = options.confidence;
+        result.actual_values["path_survival"] = estimate.pathSurvival;
+        result.actual_values["hops"] = estimate.reachable ? estimate.path.size() - 1 : 0;
+        result.actual_values["method"] = estimate.perPacket ? "per_packet" : "binomial";
         
         // Check expectations
         if (expect.contains("min_delivery_rate")) {
@@ -286,7 +320,9 @@ StepResult ScenarioRunner::handleSend(const json& params, const json& expect) {
             if (delivery_rate < min_rate) {
                 result.success = false;
                 result.message = "Delivery rate " + std::to_string(delivery_rate) + 
-                                " below minimum " + std::to_string(min_rate);
+                                " below minimum " + std::to_string(min_rate) +
+                                " (" + std::to_string(static_cast<int>(options.confidence * 100)) + "% CI " +
+                                std::to_string(estimate.confidenceLow) + "-" + std::to_string(estimate.confidenceHigh) + ")";
                 return result;
             }
         }
@@ -315,6 +351,81 @@ StepResult ScenarioRunner::handleSend(const json& params, const json& expect) {
     return result;
 }
 
+StepResult ScenarioRunner::handleTraffic(const json& params, const json& expect) {
+    StepResult result;
+    result.success = false;
+    result.execution_time_ms = 0.0;
+
+    try {
+        using namespace netsim::sim;
+        // Wartości z YAML, które nie są int, przychodzą jako napisy
+        auto number = [&params](const char* key, double fallback) {
+            if (!params.contains(key)) return fallback;
+            const json& v = params[key];
+            return v.is_string() ? std::stod(v.get<std::string>()) : v.get<double>();
+        };
+        auto pattern = TrafficGenerator::parsePattern(params.value("pattern", std::string("cbr")));
+        std::string from = params.value("from", "");
+        std::string to = params.value("to", "");
+        if (pattern != TrafficPattern::Trace && (from.empty() || to.empty())) {
+            result.message = "Missing 'from' or 'to' parameter";
+            return result;
+        }
+
+        TrafficOptions options;
+        options.rateMbps = number("rate_mbps", options.rateMbps);
+        options.sizeBytes = static_cast<uint32_t>(number("size_bytes", options.sizeBytes));
+        options.priority = static_cast<uint8_t>(number("priority", 0));
+        options.stop = static_cast<SimTime>(number("duration_ms", 1000) * Millisecond);
+        options.meanOn = static_cast<SimTime>(number("mean_on_ms", 500) * Millisecond);
+        options.meanOff = static_cast<SimTime>(number("mean_off_ms", 500) * Millisecond);
+        options.shape = number("shape", options.shape);
+        options.seed = static_cast<uint64_t>(number("seed", 1));
+
+        PacketSimOptions simOptions;
+        simOptions.seed = options.seed;
+        simOptions.recyclePacketIds = true;
+        PacketSimulator sim(m_network, simOptions);
+        TrafficGenerator traffic(m_network, sim);
+        GeneratorId id = pattern == TrafficPattern::Trace
+            ? traffic.addTrace(m_sandboxTraces ? utils::sandboxedPath(m_traceDirectory, params.value("path", ""))
+                                               : params.value("path", ""), options)
+            : traffic.add(pattern, from, to, options);
+        sim.run();
+
+        const auto& stats = traffic.stats(id);
+        double delivery_rate = stats.packets ? static_cast<double>(stats.delivered) / stats.packets : 0.0;
+        double latency_ms = stats.averageLatencyNs() / 1e6;
+        result.actual_values["sent"] = stats.packets;
+        result.actual_values["delivered"] = stats.delivered;
+        result.actual_values["dropped"] = stats.dropped;
+        result.actual_values["delivery_rate"] = delivery_rate;
+        result.actual_values["offered_mbps"] = stats.offeredMbps();
+        result.actual_values["average_latency_ms"] = latency_ms;
+        if (stats.skipped) result.actual_values["skipped"] = stats.skipped;
+
+        if (expect.contains("min_delivery_rate") && delivery_rate < expect["min_delivery_rate"].get<double>()) {
+            result.message = "Delivery rate " + std::to_string(delivery_rate) + " below minimum";
+            return result;
+        }
+        if (expect.contains("max_latency_ms") && latency_ms > expect["max_latency_ms"].get<double>()) {
+            result.message = "Average latency " + std::to_string(latency_ms) + "ms above maximum";
+            return result;
+        }
+
+        result.success = true;
+        result.message = "Generated " + std::to_string(stats.packets) + " packets, " +
+                        std::to_string(stats.delivered) + " delivered (" +
+                        std::to_string(static_cast<int>(delivery_rate * 100)) + "%)";
+
+    } catch (const std::exception& e) {
+        result.success = false;
+        result.message = std::string("Traffic failed: ") + e.what();
+    }
+
+    return result;
+}
+
 StepResult ScenarioRunner::handleConfigure(const json& params, const json& expect) {
     StepResult result;
     result.success = false;
@@ -349,13 +460,8 @@ StepResult ScenarioRunner::handleConfigure(const json& params, const json& expec
                 changes++;
             }
             
-            // Queue size (use Network method)
-            if (config.contains("queue_size")) {
-                int queue_size = config["queue_size"];
-                m_network.setQueueSize(node_name, queue_size);
-                result.actual_values["queue_size"] = queue_size;
-                changes++;
-            }
+            // Queue size and discipline (use Network methods)
+            changes += applyQueueConfig(node_name, config, result.actual_values);
             
             // VLAN (use Network method)
             if (config.contains("vlan")) {
@@ -574,16 +680,23 @@ ValidationResult ScenarioRunner::validateThroughput(const json& params, const js
             return result;
         }
         
-        // Get throughput from network (in Mbps or similar)
-        int throughput = m_network.getThroughput(nodeA, nodeB);
+        // Achievable throughput = max-flow over link bandwidths (Mbps)
+        auto snapshot = GraphSnapshot::fromNetwork(m_network);
+        auto flow = analysis::MaxFlow(snapshot).compute(nodeA, nodeB);
+        int64_t throughput = flow.maxFlow;
         
         result.details["nodeA"] = nodeA;
         result.details["nodeB"] = nodeB;
         result.details["throughput_mbps"] = throughput;
+        result.details["bottleneck_links"] = json::array();
+        for (const auto& link : flow.minCut) {
+            result.details["bottleneck_links"].push_back(
+                {{"from", link.from}, {"to", link.to}, {"capacity_mbps", link.capacity}});
+        }
         
         // Check against threshold
         if (threshold.contains("min_mbps")) {
-            int min_throughput = threshold["min_mbps"];
+            int64_t min_throughput = threshold["min_mbps"];
             result.passed = (throughput >= min_throughput);
             result.message = result.passed ?
                 "Throughput " + std::to_string(throughput) + "Mbps >= " + std::to_string(min_throughput) + "Mbps" :
@@ -655,6 +768,36 @@ ValidationResult ScenarioRunner::validateVLAN(const json& params, const json& th
     return result;
 }
 
+int ScenarioRunner::applyQueueConfig(const std::string& node, const json& config, json& applied) {
+    // Wartości z YAML, które nie są int, przychodzą jako napisy
+    auto number = [](const json& v) { return v.is_string() ? std::stod(v.get<std::string>()) : v.get<double>(); };
+    int changes = 0;
+
+    if (config.contains("queue_size")) {
+        int queue_size = static_cast<int>(number(config["queue_size"]));
+        m_network.setQueueSize(node, queue_size);
+        applied["queue_size"] = queue_size;
+        changes++;
+    }
+    if (!config.contains("queue_discipline")) return changes;
+
+    QueueConfig queue;
+    queue.type = QueueConfig::parseType(config["queue_discipline"].get<std::string>());
+    if (config.contains("queue_bands")) queue.bands = static_cast<uint32_t>(number(config["queue_bands"]));
+    if (config.contains("drr_quantum")) queue.quantumBytes = static_cast<uint32_t>(number(config["drr_quantum"]));
+    if (config.contains("red_min_threshold")) queue.redMinThreshold = number(config["red_min_threshold"]);
+    if (config.contains("red_max_threshold")) queue.redMaxThreshold = number(config["red_max_threshold"]);
+    if (config.contains("red_max_probability")) queue.redMaxProbability = number(config["red_max_probability"]);
+    if (config.contains("red_weight")) queue.redWeight = number(config["red_weight"]);
+    if (config.contains("codel_target_ms"))
+        queue.codelTarget = static_cast<netsim::sim::SimTime>(number(config["codel_target_ms"]) * netsim::sim::Millisecond);
+    if (config.contains("codel_interval_ms"))
+        queue.codelInterval = static_cast<netsim::sim::SimTime>(number(config["codel_interval_ms"]) * netsim::sim::Millisecond);
+    m_network.setQueueDiscipline(node, queue);
+    applied["queue_discipline"] = QueueConfig::typeName(queue.type);
+    return changes + 1;
+}
+
 void ScenarioRunner::cleanup() {
     // Clear network state if needed
     std::cout << "[Scenario] Cleanup complete" << std::endl;
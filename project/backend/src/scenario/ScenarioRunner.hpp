@@ -5,6 +5,7 @@
 #include "../core/Engine.hpp"
 #include <memory>
 #include <chrono>
+#include <string>
 
 namespace netsim {
 namespace scenario {
@@ -58,14 +59,38 @@ public:
      */
     void cleanup();
     
+    /**
+     * @brief Pace wait steps in real time
+     * 
+     * Waits always advance the network's virtual clock instantly; with
+     * pacing enabled they also sleep for the real duration (demos).
+     * A scenario can request pacing itself with realtime_pacing.
+     */
+    void setRealTimePacing(bool enabled) { m_realTimePacing = enabled; }
+    bool realTimePacing() const { return m_realTimePacing; }
+    
+    /**
+     * @brief Confine traffic trace files to a directory
+     * 
+     * For scenarios from untrusted sources (REST): once set, the "path" of
+     * a trace traffic step must be relative and without ".." and is read
+     * from this directory. Without it paths are used as given.
+     */
+    void setTraceDirectory(const std::string& dir) { m_traceDirectory = dir; m_sandboxTraces = true; }
+    
 private:
     Network& m_network;
     Engine& m_engine;
+    bool m_realTimePacing = false;
+    bool m_scenarioPacing = false;  // realtime_pacing bieżącego scenariusza
+    bool m_sandboxTraces = false;
+    std::string m_traceDirectory;
     
     // Action handlers
     StepResult handlePing(const json& params, const json& expect);
     StepResult handleSend(const json& params, const json& expect);
     StepResult handleConfigure(const json& params, const json& expect);
+    StepResult handleTraffic(const json& params, const json& expect);
     StepResult handleWait(const json& params, const json& expect);
     StepResult handleValidate(const json& params, const json& expect);
     
@@ -79,6 +104,8 @@ private:
     ValidationResult validateVLAN(const json& params, const json& threshold);
     
     // Helper methods
+    // queue_size i queue_* z config węzła; zwraca liczbę zastosowanych kluczy
+    int applyQueueConfig(const std::string& node, const json& config, json& applied);
     bool checkExpectations(const json& expect, const json& actual);
     std::string formatDuration(double ms) const;
 };
@@ -51,7 +51,11 @@ Scenario Scenario::fromYAML(const std::string& yaml_content) {
                             try {
                                 node_j["config"][key] = kv.second.as<int>();
                             } catch (...) {
-                                node_j["config"][key] = kv.second.as<std::string>();
+                                try {
+                                    node_j["config"][key] = kv.second.as<double>();
+                                } catch (...) {
+                                    node_j["config"][key] = kv.second.as<std::string>();
+                                }
                             }
                         }
                     }
@@ -96,6 +100,22 @@ Scenario Scenario::fromYAML(const std::string& yaml_content) {
                                     step_j["params"][key] = kv.second.as<std::string>();
                                 }
                             }
+                        } else if (kv.second.IsMap()) {
+                            // Zagnieżdżone mapy skalarów, np. config kroku configure
+                            step_j["params"][key] = json::object();
+                            for (const auto& inner : kv.second) {
+                                if (!inner.second.IsScalar()) continue;
+                                std::string innerKey = inner.first.as<std::string>();
+                                try {
+                                    step_j["params"][key][innerKey] = inner.second.as<int>();
+                                } catch (...) {
+                                    try {
+                                        step_j["params"][key][innerKey] = inner.second.as<double>();
+                                    } catch (...) {
+                                        step_j["params"][key][innerKey] = inner.second.as<std::string>();
+                                    }
+                                }
+                            }
                         }
                     }
                 }
@@ -157,6 +177,10 @@ Scenario Scenario::fromYAML(const std::string& yaml_content) {
             j["expected_outcome"] = root["expected_outcome"].as<std::string>();
         }
         
+        if (root["realtime_pacing"]) {
+            j["realtime_pacing"] = root["realtime_pacing"].as<bool>();
+        }
+        
         // Now use the JSON parser
         return fromJSON(j);
         
@@ -252,6 +276,7 @@ Scenario Scenario::fromJSON(const json& j) {
     }
     
     scenario.expected_outcome = j.value("expected_outcome", "");
+    scenario.realtime_pacing = j.value("realtime_pacing", false);
     
     return scenario;
 }
@@ -321,6 +346,7 @@ json Scenario::toJSON() const {
     j["validation"] = val_array;
     
     j["expected_outcome"] = expected_outcome;
+    j["realtime_pacing"] = realtime_pacing;
     
     return j;
 }
@@ -71,6 +71,7 @@ struct Scenario {
     // Validation
     std::vector<ValidationRule> validations;
     std::string expected_outcome;
+    bool realtime_pacing = false;  // wait śpi także w czasie rzeczywistym (dema)
     
     /**
      * @brief Load scenario from YAML file
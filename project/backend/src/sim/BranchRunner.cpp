@@ -0,0 +1,142 @@
+#include "BranchRunner.hpp"
+#include "../utils/Parallel.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace netsim {
+namespace sim {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+void runOne(const Branch& branch, Network& net, BranchResult& result) {
+    auto start = Clock::now();
+    try {
+        result.output = branch.run(net);
+        result.ok = true;
+    } catch (const std::exception& e) {
+        result.output = e.what();
+    }
+    result.runMs = elapsedMs(start);
+}
+
+void writeAll(int fd, const void* data, size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, p, bytes);
+        if (n <= 0) return;
+        p += n;
+        bytes -= static_cast<size_t>(n);
+    }
+}
+
+// Dziecko: nagłówek {ok, runMs} + wynik, potem koniec strumienia
+struct ChildHeader {
+    uint8_t ok;
+    double runMs;
+};
+
+struct Child {
+    pid_t pid = -1;
+    int fd = -1;
+    size_t branch = 0;
+};
+
+void collect(const Child& child, BranchResult& result) {
+    std::string data;
+    char buffer[65536];
+    ssize_t n;
+    while ((n = ::read(child.fd, buffer, sizeof(buffer))) > 0) data.append(buffer, static_cast<size_t>(n));
+    ::close(child.fd);
+    int status = 0;
+    ::waitpid(child.pid, &status, 0);
+    if (data.size() < sizeof(ChildHeader)) {
+        result.ok = false;
+        result.output = "Branch process terminated without a result";
+        return;
+    }
+    ChildHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    result.ok = header.ok != 0;
+    result.runMs = header.runMs;
+    result.output = data.substr(sizeof(header));
+}
+
+std::vector<BranchResult> runProcesses(Network& base, const std::vector<Branch>& branches, unsigned workers) {
+    std::vector<BranchResult> results(branches.size());
+    std::vector<Child> running;
+    for (size_t i = 0; i < branches.size(); ++i) {
+        results[i].name = branches[i].name;
+        if (running.size() >= workers) {
+            collect(running.front(), results[running.front().branch]);
+            running.erase(running.begin());
+        }
+        int fds[2];
+        if (::pipe(fds) != 0) throw std::runtime_error("Cannot create pipe for branch " + branches[i].name);
+        auto start = Clock::now();
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            for (const Child& child : running) collect(child, results[child.branch]);
+            throw std::runtime_error("Cannot fork branch process: " + std::string(std::strerror(errno)));
+        }
+        if (pid == 0) {
+            // Proces gałęzi ma własną (leniwie kopiowaną) pamięć - działa wprost na base
+            ::close(fds[0]);
+            BranchResult result;
+            runOne(branches[i], base, result);
+            ChildHeader header{static_cast<uint8_t>(result.ok), result.runMs};
+            writeAll(fds[1], &header, sizeof(header));
+            writeAll(fds[1], result.output.data(), result.output.size());
+            ::close(fds[1]);
+            ::_exit(0); // bez destruktorów i flush buforów rodzica
+        }
+        results[i].forkMs = elapsedMs(start);
+        ::close(fds[1]);
+        running.push_back({pid, fds[0], i});
+    }
+    for (const Child& child : running) collect(child, results[child.branch]);
+    return results;
+}
+
+} // namespace
+
+BranchMode parseBranchMode(const std::string& name) {
+    if (name == "threads") return BranchMode::Threads;
+    if (name == "processes") return BranchMode::Processes;
+    throw std::runtime_error("Unknown branch mode: " + name);
+}
+
+std::vector<BranchResult> runBranches(Network& base, const std::vector<Branch>& branches, BranchMode mode, unsigned workers) {
+    if (workers == 0) workers = utils::defaultWorkerCount();
+    if (mode == BranchMode::Processes) return runProcesses(base, branches, workers);
+
+    std::vector<BranchResult> results(branches.size());
+    std::vector<std::unique_ptr<Network>> forks;
+    forks.reserve(branches.size());
+    for (size_t i = 0; i < branches.size(); ++i) {
+        auto start = Clock::now();
+        forks.push_back(base.fork());
+        results[i].name = branches[i].name;
+        results[i].forkMs = elapsedMs(start);
+    }
+    utils::parallelFor(branches.size(), workers, [&](unsigned, size_t i) {
+        runOne(branches[i], *forks[i], results[i]);
+        forks[i].reset(); // gałąź zwalniana w swoim wątku
+    });
+    return results;
+}
+
+} // namespace sim
+} // namespace netsim
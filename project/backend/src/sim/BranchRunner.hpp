@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../core/Network.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace netsim {
+namespace sim {
+
+enum class BranchMode : uint8_t {
+    Threads,    // każda gałąź to Network::fork, uruchamiane w puli wątków
+    Processes   // fork() procesu: stan kopiowany leniwie przez copy-on-write stron (POSIX)
+};
+
+/**
+ * @brief One what-if branch: modifies its copy of the network and simulates it
+ *
+ * run() gets a private Network (all tables, queues and pending events of the
+ * base at the moment of branching) and returns a result string, e.g. JSON.
+ */
+struct Branch {
+    std::string name;
+    std::function<std::string(Network&)> run;
+};
+
+struct BranchResult {
+    std::string name;
+    bool ok = false;
+    std::string output;         // wynik run() albo komunikat wyjątku
+    double forkMs = 0.0;        // Threads: Network::fork, Processes: fork() procesu
+    double runMs = 0.0;
+};
+
+/**
+ * @brief Runs what-if branches of one network state in parallel
+ *
+ * Threads: all branches are forked from base up front (forking shares the
+ * in-flight packets copy-on-write) and run on `workers` threads; base is
+ * left untouched. Processes: every branch runs in a child process that
+ * shares the parent's memory pages copy-on-write, so branching costs only
+ * page tables regardless of the simulation size, and results come back
+ * through a pipe; at most `workers` children run at once. A branch that
+ * throws (or a child that dies) yields ok == false instead of failing the
+ * others.
+ *
+ * Processes is meant for single-threaded callers (command-line tools,
+ * batch runs): the child of fork() inherits only the calling thread, so
+ * locks held by other threads of a server stay locked in it, and results
+ * are awaited without a timeout. The REST API offers Threads only.
+ */
+// Rzuca std::runtime_error gdy nie da się utworzyć procesu (Processes)
+std::vector<BranchResult> runBranches(Network& base, const std::vector<Branch>& branches,
+                                      BranchMode mode = BranchMode::Threads, unsigned workers = 0);
+
+// "threads", "processes"; rzuca std::runtime_error dla nieznanego
+BranchMode parseBranchMode(const std::string& name);
+
+} // namespace sim
+} // namespace netsim
@@ -0,0 +1,291 @@
+#include "EventScheduler.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace netsim {
+namespace sim {
+
+EventScheduler::EventScheduler() {
+    m_records.reserve(1024);
+}
+
+EventScheduler EventScheduler::fork() const {
+    if (m_running) throw std::runtime_error("Cannot fork a running event scheduler");
+    return *this;
+}
+
+void EventScheduler::setHandler(EventType type, EventHandler handler) {
+    if (type >= m_handlers.size() || !m_handlers[type])
+        throw std::runtime_error("Unknown event type: " + std::to_string(type));
+    m_handlers[type] = std::move(handler);
+}
+
+EventType EventScheduler::registerHandler(EventHandler handler) {
+    if (!handler) throw std::runtime_error("Event handler must not be empty");
+    if (!m_freeTypes.empty()) {
+        EventType type = m_freeTypes.back();
+        m_freeTypes.pop_back();
+        m_handlers[type] = std::move(handler);
+        return type;
+    }
+    if (m_handlers.size() > UINT16_MAX) throw std::runtime_error("Too many event handlers");
+    m_handlers.push_back(std::move(handler));
+    return static_cast<EventType>(m_handlers.size() - 1);
+}
+
+void EventScheduler::unregisterHandler(EventType type) {
+    if (type >= m_handlers.size() || !m_handlers[type])
+        throw std::runtime_error("Unknown event type: " + std::to_string(type));
+    // Zdarzenia zwolnionego typu trafiłyby do następnego właściciela typu
+    for (uint32_t index = 0; index < m_records.size(); ++index)
+        if (m_records[index].type == type) cancelRecord(index);
+    m_handlers[type] = nullptr;
+    m_freeTypes.push_back(type);
+}
+
+uint32_t EventScheduler::allocate() {
+    if (m_freeList != Nil) {
+        uint32_t index = m_freeList;
+        m_freeList = m_records[index].next;
+        return index;
+    }
+    m_records.emplace_back();
+    return static_cast<uint32_t>(m_records.size() - 1);
+}
+
+void EventScheduler::release(uint32_t index) {
+    Record& r = m_records[index];
+    r.state = State::Free;
+    r.generation++;   // unieważnia stare EventId
+    r.next = m_freeList;
+    m_freeList = index;
+}
+
+void EventScheduler::insert(uint32_t index) {
+    Record& r = m_records[index];
+    // Poziom = najstarszy bit, którym czas zdarzenia różni się od pozycji koła
+    SimTime masked = (m_elapsed ^ r.time) | (Slots - 1);
+    unsigned significant = 63 - __builtin_clzll(masked);
+    unsigned level = significant / SlotBits;
+    unsigned slot = static_cast<unsigned>(r.time >> (level * SlotBits)) & (Slots - 1);
+
+    r.level = static_cast<uint8_t>(level);
+    r.next = Nil;
+    Slot& s = m_wheel[level][slot];
+    r.prev = s.tail;
+    if (s.tail != Nil) m_records[s.tail].next = index;
+    else s.head = index;
+    s.tail = index;
+    m_occupied[level][slot >> 6] |= uint64_t(1) << (slot & 63);
+}
+
+void EventScheduler::unlink(uint32_t index) {
+    Record& r = m_records[index];
+    unsigned slot = static_cast<unsigned>(r.time >> (r.level * SlotBits)) & (Slots - 1);
+    Slot& s = m_wheel[r.level][slot];
+    if (r.prev != Nil) m_records[r.prev].next = r.next;
+    else s.head = r.next;
+    if (r.next != Nil) m_records[r.next].prev = r.prev;
+    else s.tail = r.prev;
+    if (s.head == Nil) m_occupied[r.level][slot >> 6] &= ~(uint64_t(1) << (slot & 63));
+}
+
+EventId EventScheduler::schedule(SimTime at, EventType type, uint64_t arg0, uint64_t arg1) {
+    return scheduleOrdered(at, m_seq++, type, arg0, arg1);
+}
+
+EventId EventScheduler::scheduleOrdered(SimTime at, uint64_t order, EventType type, uint64_t arg0, uint64_t arg1) {
+    if (at < m_now) throw std::runtime_error("Cannot schedule event in the past");
+    if (type >= m_handlers.size() || !m_handlers[type])
+        throw std::runtime_error("Unknown event type: " + std::to_string(type));
+
+    uint32_t index = allocate();
+    Record& r = m_records[index];
+    r.time = at;
+    r.seq = order;
+    r.type = type;
+    r.arg0 = arg0;
+    r.arg1 = arg1;
+    r.state = State::Queued;
+    insert(index);
+    m_pending++;
+    return (static_cast<EventId>(r.generation) << 32) | (index + 1);
+}
+
+uint32_t EventScheduler::pendingIndex(EventId id) const {
+    if (id == InvalidEvent) return Nil;
+    uint32_t index = static_cast<uint32_t>(id & 0xffffffffu) - 1;
+    if (index >= m_records.size()) return Nil;
+    const Record& r = m_records[index];
+    if (r.generation != static_cast<uint32_t>(id >> 32)) return Nil;
+    return r.state == State::Queued || r.state == State::Firing ? index : Nil;
+}
+
+bool EventScheduler::peek(EventId id, Event& event) const {
+    uint32_t index = pendingIndex(id);
+    if (index == Nil) return false;
+    const Record& r = m_records[index];
+    event = Event{r.time, r.type, r.arg0, r.arg1};
+    return true;
+}
+
+bool EventScheduler::cancel(EventId id, Event* cancelled) {
+    uint32_t index = pendingIndex(id);
+    if (index == Nil) return false;
+    const Record& r = m_records[index];
+    if (cancelled) *cancelled = Event{r.time, r.type, r.arg0, r.arg1};
+    return cancelRecord(index);
+}
+
+bool EventScheduler::cancelRecord(uint32_t index) {
+    Record& r = m_records[index];
+    if (r.state == State::Queued) {
+        unlink(index);
+        release(index);
+        m_pending--;
+        return true;
+    }
+    if (r.state == State::Firing) {
+        // Zdarzenie z bieżącej partii, które jeszcze nie zostało wywołane
+        r.state = State::Cancelled;
+        return true;
+    }
+    return false;
+}
+
+bool EventScheduler::nextExpiration(Expiration& exp) const {
+    for (unsigned level = 0; level < Levels; ++level) {
+        unsigned word = 0;
+        while (word < Words && !m_occupied[level][word]) ++word;
+        if (word == Words) continue;
+        unsigned slot = word * 64 + __builtin_ctzll(m_occupied[level][word]);
+        unsigned shift = (level + 1) * SlotBits;
+        SimTime base = shift >= 64 ? 0 : (m_elapsed >> shift) << shift;
+        exp = {level, slot, base + (static_cast<SimTime>(slot) << (level * SlotBits))};
+        return true;
+    }
+    return false;
+}
+
+bool EventScheduler::nextEventTime(SimTime& at) const {
+    Expiration exp;
+    if (!nextExpiration(exp)) return false;
+    if (exp.level == 0) {
+        at = exp.deadline;
+        return true;
+    }
+    at = UINT64_MAX;
+    for (uint32_t i = m_wheel[exp.level][exp.slot].head; i != Nil; i = m_records[i].next)
+        at = std::min(at, m_records[i].time);
+    return true;
+}
+
+void EventScheduler::fireOne(uint32_t index) {
+    Record& r = m_records[index];
+    Event ev{r.time, r.type, r.arg0, r.arg1};
+    r.state = State::Cancelled; // wywołane - cancel() już nic nie zmieni
+    m_pending--;
+    m_executed++;
+    try {
+        m_handlers[ev.type](ev);
+    } catch (...) {
+        release(index);
+        throw;
+    }
+    release(index);
+}
+
+size_t EventScheduler::fire(const Expiration& exp, SimTime limit) {
+    Slot& s = m_wheel[exp.level][exp.slot];
+    uint32_t head = s.head;
+    s.head = s.tail = Nil;
+    m_occupied[exp.level][exp.slot >> 6] &= ~(uint64_t(1) << (exp.slot & 63));
+
+    if (m_records[head].next == Nil && m_records[head].time <= limit) {
+        // Jedyne zdarzenie najwcześniejszego slotu jest najbliższym zdarzeniem w ogóle:
+        // wykonaj je od razu, bez kaskady przez niższe poziomy
+        m_elapsed = m_now = m_records[head].time;
+        fireOne(head);
+        return 1;
+    }
+
+    m_elapsed = exp.deadline;
+    if (exp.level > 0) {
+        // Kaskada: rozłóż slot na niższe poziomy względem nowej pozycji koła
+        for (uint32_t i = head; i != Nil;) {
+            uint32_t next = m_records[i].next;
+            insert(i);
+            i = next;
+        }
+        return 0;
+    }
+
+    m_now = exp.deadline;
+    m_batch.clear();
+    for (uint32_t i = head; i != Nil; i = m_records[i].next) {
+        m_records[i].state = State::Firing;
+        m_batch.push_back(i);
+    }
+    m_pending -= m_batch.size();
+    // Zdarzenia przeniesione kaskadą mogą wyprzedzić nowsze - przywróć kolejność (seq/order)
+    auto bySeq = [this](uint32_t a, uint32_t b) { return m_records[a].seq < m_records[b].seq; };
+    if (!std::is_sorted(m_batch.begin(), m_batch.end(), bySeq))
+        std::sort(m_batch.begin(), m_batch.end(), bySeq);
+
+    size_t fired = 0;
+    for (size_t i = 0; i < m_batch.size(); ++i) {
+        uint32_t index = m_batch[i];
+        if (m_records[index].state == State::Firing) {
+            const Record& r = m_records[index];
+            Event ev{r.time, r.type, r.arg0, r.arg1};
+            m_records[index].state = State::Cancelled; // wywołane - cancel() już nic nie zmieni
+            try {
+                m_handlers[ev.type](ev);
+            } catch (...) {
+                // Niewywołane zdarzenia partii przepadają razem z wyjątkiem
+                for (size_t j = i; j < m_batch.size(); ++j) release(m_batch[j]);
+                m_executed += fired + 1;
+                throw;
+            }
+            fired++;
+        }
+        release(index);
+    }
+    m_executed += fired;
+    return fired;
+}
+
+size_t EventScheduler::advance(SimTime until, bool bounded) {
+    if (m_running) throw std::runtime_error("Event scheduler is already running");
+    m_running = true;
+    size_t fired = 0;
+    Expiration exp;
+    while (nextExpiration(exp)) {
+        if (bounded && exp.deadline > until) break;
+        try {
+            fired += fire(exp, bounded ? until : UINT64_MAX);
+        } catch (...) {
+            m_running = false;
+            throw;
+        }
+    }
+    m_running = false;
+    if (bounded) {
+        // Bezpieczne: wszystkie pozostałe zdarzenia leżą w slotach za until
+        if (until > m_elapsed) m_elapsed = until;
+        if (until > m_now) m_now = until;
+    }
+    return fired;
+}
+
+size_t EventScheduler::runUntil(SimTime until) {
+    return advance(until, true);
+}
+
+size_t EventScheduler::run() {
+    return advance(0, false);
+}
+
+} // namespace sim
+} // namespace netsim
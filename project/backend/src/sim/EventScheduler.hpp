@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace netsim {
+namespace sim {
+
+// Czas wirtualny w nanosekundach
+using SimTime = uint64_t;
+using EventId = uint64_t;
+using EventType = uint16_t;
+
+constexpr SimTime Nanosecond = 1;
+constexpr SimTime Microsecond = 1000 * Nanosecond;
+constexpr SimTime Millisecond = 1000 * Microsecond;
+constexpr SimTime Second = 1000 * Millisecond;
+
+constexpr EventId InvalidEvent = 0;
+
+/**
+ * @brief Event passed to a handler; the two arguments are handler-defined
+ */
+struct Event {
+    SimTime time = 0;
+    EventType type = 0;
+    uint64_t arg0 = 0;
+    uint64_t arg1 = 0;
+};
+
+using EventHandler = std::function<void(const Event&)>;
+
+/**
+ * @brief Discrete-event scheduler built on a hierarchical timing wheel
+ *
+ * Eight levels of 256 slots cover the whole 64-bit nanosecond range; level k
+ * slots span 256^k ns, so level 0 slots hold events of one exact time. An
+ * event is filed at the level of the highest bit in which its time differs
+ * from the wheel position, and is cascaded down when the wheel reaches its
+ * slot; a slot holding a single event fires it directly instead of
+ * cascading. Per-level occupancy bitmaps locate the next non-empty slot with
+ * count-trailing-zeros, so schedule, cancel and advance are O(1) regardless
+ * of the gaps between events.
+ *
+ * Events at the same time fire in scheduling order. Event records live in a
+ * pooled array linked into per-slot lists, which makes cancel an unlink.
+ * Records are trivially copyable, so fork() of a scheduler with a million
+ * pending events is a single ~48 MB copy of the pool.
+ */
+class EventScheduler {
+public:
+    EventScheduler();
+
+    // Kopia stanu (zdarzenia, czas, handlery); handlery trzymające wskaźniki na właściciela
+    // trzeba podmienić przez setHandler. Rzuca std::runtime_error w trakcie run()
+    EventScheduler fork() const;
+
+    // Rejestruje handler i zwraca typ zdarzenia, którym jest wywoływany (typy zwolnione wracają do użytku)
+    EventType registerHandler(EventHandler handler);
+    // Zwalnia typ: anuluje jego oczekujące zdarzenia (przegląd puli rekordów) i oddaje typ do ponownego
+    // użycia. Obiekty rejestrujące handlery na cudzym schedulerze wołają to w destruktorze. Nie wolno
+    // wołać z handlera tego samego typu; rzuca std::runtime_error dla nieznanego typu
+    void unregisterHandler(EventType type);
+    // Podmienia handler zarejestrowanego typu; rzuca std::runtime_error dla nieznanego
+    void setHandler(EventType type, EventHandler handler);
+
+    // Rzuca std::runtime_error dla czasu z przeszłości lub nieznanego typu
+    EventId schedule(SimTime at, EventType type, uint64_t arg0 = 0, uint64_t arg1 = 0);
+    EventId scheduleAfter(SimTime delay, EventType type, uint64_t arg0 = 0, uint64_t arg1 = 0) {
+        return schedule(m_now + delay, type, arg0, arg1);
+    }
+    // Jak schedule(), ale zdarzenia o równym czasie wykonują się wg rosnącego order zamiast
+    // kolejności planowania - kolejność nie zależy wtedy od tego, kto i kiedy je zaplanował
+    // (symulacja równoległa). Nie należy mieszać obu wariantów w jednym schedulerze.
+    EventId scheduleOrdered(SimTime at, uint64_t order, EventType type, uint64_t arg0 = 0, uint64_t arg1 = 0);
+    // false gdy zdarzenie już się wykonało lub zostało anulowane; cancelled dostaje jego dane
+    bool cancel(EventId id, Event* cancelled = nullptr);
+    // Dane oczekującego zdarzenia bez anulowania (np. sprawdzenie typu przed cancel); false jak w cancel
+    bool peek(EventId id, Event& event) const;
+
+    // Wykonuje zdarzenia z czasem <= until i ustawia now() = until
+    size_t runUntil(SimTime until);
+    // Wykonuje wszystkie zaplanowane zdarzenia
+    size_t run();
+
+    SimTime now() const { return m_now; }
+    size_t pending() const { return m_pending; }
+    uint64_t executed() const { return m_executed; }
+
+    // Czas najbliższego zdarzenia (false gdy kolejka pusta)
+    bool nextEventTime(SimTime& at) const;
+
+private:
+    static constexpr unsigned SlotBits = 8;
+    static constexpr unsigned Slots = 1u << SlotBits;
+    static constexpr unsigned Words = Slots / 64;
+    static constexpr unsigned Levels = 8;    // 8 * 8 bitów = 64
+    static constexpr uint32_t Nil = UINT32_MAX;
+
+    enum class State : uint8_t { Free, Queued, Firing, Cancelled };
+
+    struct Record {
+        SimTime time = 0;
+        uint64_t seq = 0;        // kolejność przy równym czasie
+        uint64_t arg0 = 0;
+        uint64_t arg1 = 0;
+        uint32_t next = Nil;
+        uint32_t prev = Nil;
+        uint32_t generation = 0;
+        EventType type = 0;
+        uint8_t level = 0;
+        State state = State::Free;
+    };
+
+    struct Slot {
+        uint32_t head = Nil;
+        uint32_t tail = Nil;
+    };
+
+    struct Expiration {
+        unsigned level;
+        unsigned slot;
+        SimTime deadline;
+    };
+
+    std::vector<Record> m_records;
+    uint32_t m_freeList = Nil;
+    std::array<std::array<Slot, Slots>, Levels> m_wheel;
+    std::array<std::array<uint64_t, Words>, Levels> m_occupied{};  // bitmapy zajętych slotów
+    std::vector<EventHandler> m_handlers;   // pusty handler = typ wolny
+    std::vector<EventType> m_freeTypes;
+    std::vector<uint32_t> m_batch;
+
+    SimTime m_elapsed = 0;  // pozycja koła
+    SimTime m_now = 0;
+    uint64_t m_seq = 0;
+    size_t m_pending = 0;
+    uint64_t m_executed = 0;
+    bool m_running = false;
+
+    uint32_t allocate();
+    void release(uint32_t index);
+    void insert(uint32_t index);
+    void unlink(uint32_t index);
+    bool cancelRecord(uint32_t index);
+    uint32_t pendingIndex(EventId id) const;   // Nil gdy zdarzenie nie czeka
+    bool nextExpiration(Expiration& exp) const;
+    void fireOne(uint32_t index);
+    size_t fire(const Expiration& exp, SimTime limit);
+    size_t advance(SimTime until, bool bounded);
+};
+
+} // namespace sim
+} // namespace netsim
@@ -0,0 +1,363 @@
+#include "FluidSimulator.hpp"
+#include "../core/Engine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace netsim {
+namespace sim {
+
+namespace {
+
+// Mbps -> bity na ns
+constexpr double BitsPerNsPerMbps = 1e-3;
+// Łącze z obciążeniem >= (1 - tolerancja) * przepustowość jest nasycone
+constexpr double SaturationTolerance = 1e-9;
+
+
+} // namespace
+
+double FluidFlow::averageRateMbps() const {
+    if (status != FlowStatus::Completed || finish - propagation <= start) return 0.0;
+    return bytes * 8.0 / static_cast<double>(finish - propagation - start) / BitsPerNsPerMbps;
+}
+
+FluidSimulator::FluidSimulator(Network& net, Engine& engine, const FluidOptions& options)
+    : m_engine(engine), m_options(options), m_graph(GraphSnapshot::fromNetwork(net)) {
+    const size_t arcs = m_graph.arcCount();
+    m_capacity.resize(arcs);
+    for (size_t a = 0; a < arcs; ++a) {
+        int mbps = m_graph.bandwidth[a] > 0 ? m_graph.bandwidth[a] : m_options.defaultBandwidthMbps;
+        m_capacity[a] = std::max(mbps, 0) * BitsPerNsPerMbps;
+    }
+    m_arcFlows.resize(arcs);
+    m_load.assign(arcs, 0.0);
+    m_loadIntegral.assign(arcs, 0.0);
+    m_loadSince.assign(arcs, 0);
+    m_peakLoad.assign(arcs, 0.0);
+    m_touched.assign(arcs, 0);
+    m_arcEpoch.assign(arcs, 0);
+    m_residual.assign(arcs, 0.0);
+    m_unfrozen.assign(arcs, 0);
+
+    m_arriveEvent = m_scheduler.registerHandler([this](const Event& e) { onArrive(static_cast<FlowId>(e.arg0)); });
+    m_completeEvent = m_scheduler.registerHandler([this](const Event& e) { onComplete(static_cast<FlowId>(e.arg0)); });
+    m_reallocateEvent = m_scheduler.registerHandler([this](const Event&) { reallocate(); });
+}
+
+FlowId FluidSimulator::addFlow(const std::string& src, const std::string& dst, uint64_t bytes,
+                               SimTime start, double rateCapMbps) {
+    return addFlow(m_graph.idOf(src), m_graph.idOf(dst), bytes, start, rateCapMbps);
+}
+
+FlowId FluidSimulator::addFlow(NodeId src, NodeId dst, uint64_t bytes, SimTime start, double rateCapMbps) {
+    const size_t n = m_graph.nodeCount();
+    if (src >= n || dst >= n || !m_graph.present[src] || !m_graph.present[dst])
+        throw std::runtime_error("Unknown node id");
+    if (start < now()) throw std::runtime_error("Flow start is in the past");
+    if (rateCapMbps < 0.0) throw std::runtime_error("Rate cap must be non-negative");
+
+    FlowId id = static_cast<FlowId>(m_flows.size());
+    FluidFlow flow;
+    flow.src = src;
+    flow.dst = dst;
+    flow.bytes = bytes;
+    flow.rateCapMbps = rateCapMbps;
+    flow.start = start;
+    FlowState state;
+    state.remaining = bytes * 8.0;
+    state.cap = rateCapMbps * BitsPerNsPerMbps;
+    state.linkBegin = state.linkEnd = static_cast<uint32_t>(m_flowLinks.size());
+
+    std::vector<NodeId> path;
+    if (m_graph.isUsable(src) && m_graph.isUsable(dst))
+        path = src == dst ? std::vector<NodeId>{src} : m_engine.shortestPathIds(src, dst);
+    bool routed = !path.empty();
+    for (size_t h = 0; routed && h + 1 < path.size(); ++h) {
+        uint32_t arc = m_graph.findArc(path[h], path[h + 1]);
+        // Trasa Engine sprzed zmian topologii, których nie ma w migawce
+        if (arc == NoArc || !m_graph.isUsable(path[h + 1])) {
+            routed = false;
+            break;
+        }
+        flow.propagation += static_cast<SimTime>(std::max(m_graph.delayMs[arc], 0)) * Millisecond;
+        if (m_capacity[arc] > 0.0) {
+            m_flowLinks.push_back(arc);
+            m_flowLinkSlot.push_back(0);
+        }
+    }
+    if (routed) {
+        flow.hops = static_cast<uint16_t>(std::min<size_t>(path.size() - 1, UINT16_MAX));
+        state.linkEnd = static_cast<uint32_t>(m_flowLinks.size());
+    } else {
+        m_flowLinks.resize(state.linkBegin);
+        m_flowLinkSlot.resize(state.linkBegin);
+        flow.status = FlowStatus::NoRoute;
+        flow.propagation = 0;
+    }
+
+    m_flows.push_back(flow);
+    m_state.push_back(state);
+    m_flowEpoch.push_back(0);
+    m_newRate.push_back(0.0);
+    if (routed) m_scheduler.schedule(start, m_arriveEvent, id);
+    return id;
+}
+
+size_t FluidSimulator::runUntil(SimTime until) {
+    return m_scheduler.runUntil(until);
+}
+
+size_t FluidSimulator::run() {
+    return m_scheduler.run();
+}
+
+double FluidSimulator::currentRateMbps(FlowId id) const {
+    return m_state.at(id).rate / BitsPerNsPerMbps;
+}
+
+std::vector<FluidLinkStats> FluidSimulator::linkStats() const {
+    std::vector<FluidLinkStats> result;
+    const SimTime t = now();
+    for (uint32_t a = 0; a < m_graph.arcCount(); ++a) {
+        if (!m_touched[a]) continue;
+        FluidLinkStats link;
+        link.from = m_graph.targets[m_graph.reverse[a]];
+        link.to = m_graph.targets[a];
+        link.capacityMbps = m_capacity[a] / BitsPerNsPerMbps;
+        double carried = m_loadIntegral[a] + m_load[a] * static_cast<double>(t - m_loadSince[a]);
+        link.utilization = t ? carried / (m_capacity[a] * static_cast<double>(t)) : 0.0;
+        link.peakUtilization = m_peakLoad[a] / m_capacity[a];
+        link.activeFlows = static_cast<uint32_t>(m_arcFlows[a].size());
+        result.push_back(link);
+    }
+    return result;
+}
+
+void FluidSimulator::onArrive(FlowId id) {
+    FluidFlow& flow = m_flows[id];
+    FlowState& state = m_state[id];
+    flow.status = FlowStatus::Active;
+    state.updatedAt = now();
+    // Bez ograniczonych łączy i limitu źródła przepływ kończy się od razu
+    if (state.remaining <= 0.0 || (state.linkBegin == state.linkEnd && state.cap <= 0.0)) {
+        state.remaining = 0.0;
+        flow.status = FlowStatus::Completed;
+        flow.finish = now() + flow.propagation;
+        return;
+    }
+    m_active++;
+    if (!m_reallocateQueued && admitWithoutReallocation(id)) return;
+    attach(id);
+    m_dirtyFlows.push_back(id);
+    requestReallocation();
+}
+
+bool FluidSimulator::admitWithoutReallocation(FlowId id) {
+    // Nowy przepływ dostaje najmniejszą wolną przepustowość na ścieżce. Łącza z wolną
+    // przepustowością nie są niczyim wąskim gardłem, więc alokacja pozostaje max-min
+    // fair, jeśli na łączach, które przez to się nasycą, nikt nie ma większego tempa
+    FlowState& state = m_state[id];
+    double rate = state.cap > 0.0 ? state.cap : std::numeric_limits<double>::infinity();
+    for (uint32_t k = state.linkBegin; k < state.linkEnd; ++k) {
+        uint32_t arc = m_flowLinks[k];
+        rate = std::min(rate, m_capacity[arc] - m_load[arc]);
+    }
+    if (!(rate > 0.0) || std::isinf(rate)) return false;
+    for (uint32_t k = state.linkBegin; k < state.linkEnd; ++k) {
+        uint32_t arc = m_flowLinks[k];
+        if (m_load[arc] + rate < m_capacity[arc] * (1 - SaturationTolerance)) continue;
+        for (FlowId other : m_arcFlows[arc])
+            if (m_state[other].rate > rate * (1 + SaturationTolerance)) return false;
+    }
+    attach(id);
+    setRate(id, rate);
+    scheduleCompletion(id);
+    return true;
+}
+
+void FluidSimulator::onComplete(FlowId id) {
+    FluidFlow& flow = m_flows[id];
+    FlowState& state = m_state[id];
+    state.completion = InvalidEvent;
+    state.remaining = 0.0;
+    state.updatedAt = now();
+    // Zwolnienie nienasyconych łączy nie zmienia niczyjego wąskiego gardła
+    bool saturates = m_reallocateQueued;
+    for (uint32_t k = state.linkBegin; k < state.linkEnd && !saturates; ++k) {
+        uint32_t arc = m_flowLinks[k];
+        saturates = m_load[arc] >= m_capacity[arc] * (1 - SaturationTolerance);
+    }
+    setRate(id, 0.0);
+    detach(id);
+    if (saturates)
+        for (uint32_t k = state.linkBegin; k < state.linkEnd; ++k) m_dirtyArcs.push_back(m_flowLinks[k]);
+    flow.status = FlowStatus::Completed;
+    flow.finish = now() + flow.propagation;
+    m_active--;
+    if (saturates) requestReallocation();
+}
+
+void FluidSimulator::requestReallocation() {
+    if (m_reallocateQueued) return;
+    SimTime at = now();
+    if (m_options.recomputeQuantum > 0)
+        at = (at + m_options.recomputeQuantum - 1) / m_options.recomputeQuantum * m_options.recomputeQuantum;
+    // Zaplanowane po zdarzeniach z tego samego czasu - obsłuży je wszystkie naraz
+    m_scheduler.schedule(at, m_reallocateEvent);
+    m_reallocateQueued = true;
+}
+
+void FluidSimulator::reallocate() {
+    m_reallocateQueued = false;
+    m_reallocations++;
+    if (++m_epoch == 0) {
+        std::fill(m_arcEpoch.begin(), m_arcEpoch.end(), 0);
+        std::fill(m_flowEpoch.begin(), m_flowEpoch.end(), 0);
+        m_epoch = 1;
+    }
+
+    // Składowa spójna grafu przepływ-łącze osiągalna ze zmienionych przepływów i łączy
+    m_componentFlows.clear();
+    m_componentArcs.clear();
+    auto visitArc = [this](uint32_t arc) {
+        if (m_arcEpoch[arc] == m_epoch) return;
+        m_arcEpoch[arc] = m_epoch;
+        m_componentArcs.push_back(arc);
+        for (FlowId f : m_arcFlows[arc]) {
+            if (m_flowEpoch[f] == m_epoch) continue;
+            m_flowEpoch[f] = m_epoch;
+            m_componentFlows.push_back(f);
+        }
+    };
+    for (FlowId f : m_dirtyFlows) {
+        if (m_flows[f].status != FlowStatus::Active || m_flowEpoch[f] == m_epoch) continue;
+        m_flowEpoch[f] = m_epoch;
+        m_componentFlows.push_back(f);
+    }
+    for (uint32_t arc : m_dirtyArcs) visitArc(arc);
+    m_dirtyFlows.clear();
+    m_dirtyArcs.clear();
+    for (size_t i = 0; i < m_componentFlows.size(); ++i) {
+        const FlowState& state = m_state[m_componentFlows[i]];
+        for (uint32_t k = state.linkBegin; k < state.linkEnd; ++k) visitArc(m_flowLinks[k]);
+    }
+    if (m_componentFlows.empty()) return;
+
+    // Progressive filling. Zamrożenie przepływu na bieżącym minimum nie zmniejsza udziału
+    // żadnego łącza, więc wpisy w kopcu są tylko zaniżone: zdjęty wpis z nieaktualnym
+    // udziałem wraca z nowym zamiast aktualizować kopiec przy każdym zamrożeniu
+    m_heap.clear();
+    for (uint32_t arc : m_componentArcs) {
+        m_residual[arc] = m_capacity[arc];
+        m_unfrozen[arc] = static_cast<uint32_t>(m_arcFlows[arc].size());
+        if (m_unfrozen[arc]) m_heap.push_back({m_capacity[arc] / m_unfrozen[arc], arc, false});
+    }
+    for (FlowId f : m_componentFlows) {
+        m_newRate[f] = -1.0;
+        if (m_state[f].cap > 0.0) m_heap.push_back({m_state[f].cap, f, true});
+    }
+    auto later = [](const Share& a, const Share& b) { return a.level > b.level; };
+    std::make_heap(m_heap.begin(), m_heap.end(), later);
+    auto freeze = [&](FlowId f, double rate) {
+        m_newRate[f] = rate;
+        const FlowState& state = m_state[f];
+        for (uint32_t k = state.linkBegin; k < state.linkEnd; ++k) {
+            uint32_t arc = m_flowLinks[k];
+            m_residual[arc] -= rate;
+            m_unfrozen[arc]--;
+        }
+    };
+    while (!m_heap.empty()) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), later);
+        Share top = m_heap.back();
+        m_heap.pop_back();
+        if (top.isFlow) {
+            if (m_newRate[top.key] < 0.0) freeze(top.key, top.level);
+            continue;
+        }
+        const uint32_t arc = top.key;
+        if (m_unfrozen[arc] == 0) continue;
+        double level = std::max(m_residual[arc], 0.0) / m_unfrozen[arc];
+        if (level > top.level && !m_heap.empty() && m_heap.front().level < level) {
+            m_heap.push_back({level, arc, false});
+            std::push_heap(m_heap.begin(), m_heap.end(), later);
+            continue;
+        }
+        for (FlowId f : m_arcFlows[arc])
+            if (m_newRate[f] < 0.0) freeze(f, level);
+    }
+
+    // Nowe tempa: dokończenie postępu i przeplanowanie końca tylko przy zmianie.
+    // Najpierw spadki, potem wzrosty - obciążenie łącza nigdy chwilowo nie przekracza przepustowości
+    const SimTime t = now();
+    for (int pass = 0; pass < 2; ++pass) {
+        for (FlowId f : m_componentFlows) {
+            FlowState& state = m_state[f];
+            double rate = m_newRate[f];
+            if ((pass == 0) != (rate < state.rate)) continue;
+            if (rate == state.rate && state.completion != InvalidEvent) continue;
+            state.remaining = std::max(0.0, state.remaining - state.rate * static_cast<double>(t - state.updatedAt));
+            state.updatedAt = t;
+            setRate(f, rate);
+            scheduleCompletion(f);
+        }
+    }
+}
+
+void FluidSimulator::scheduleCompletion(FlowId id) {
+    FlowState& state = m_state[id];
+    if (state.completion != InvalidEvent) m_scheduler.cancel(state.completion);
+    state.completion = InvalidEvent;
+    if (state.rate <= 0.0) return;
+    double ns = std::ceil(state.remaining / state.rate);
+    SimTime delay = ns < 1e18 ? static_cast<SimTime>(ns) : static_cast<SimTime>(1e18);
+    state.completion = m_scheduler.schedule(now() + delay, m_completeEvent, id);
+}
+
+void FluidSimulator::setRate(FlowId id, double rate) {
+    FlowState& state = m_state[id];
+    double delta = rate - state.rate;
+    if (delta == 0.0) return;
+    for (uint32_t k = state.linkBegin; k < state.linkEnd; ++k) addLoad(m_flowLinks[k], delta);
+    state.rate = rate;
+}
+
+void FluidSimulator::addLoad(uint32_t arc, double delta) {
+    const SimTime t = now();
+    m_loadIntegral[arc] += m_load[arc] * static_cast<double>(t - m_loadSince[arc]);
+    m_loadSince[arc] = t;
+    m_load[arc] = std::max(0.0, m_load[arc] + delta);
+    m_peakLoad[arc] = std::max(m_peakLoad[arc], m_load[arc]);
+}
+
+void FluidSimulator::attach(FlowId id) {
+    const FlowState& state = m_state[id];
+    for (uint32_t k = state.linkBegin; k < state.linkEnd; ++k) {
+        uint32_t arc = m_flowLinks[k];
+        m_flowLinkSlot[k] = static_cast<uint32_t>(m_arcFlows[arc].size());
+        m_arcFlows[arc].push_back(id);
+        m_touched[arc] = 1;
+    }
+}
+
+void FluidSimulator::detach(FlowId id) {
+    const FlowState& state = m_state[id];
+    for (uint32_t k = state.linkBegin; k < state.linkEnd; ++k) {
+        uint32_t arc = m_flowLinks[k];
+        auto& flows = m_arcFlows[arc];
+        uint32_t slot = m_flowLinkSlot[k];
+        FlowId moved = flows.back();
+        flows[slot] = moved;
+        flows.pop_back();
+        if (moved == id) continue;
+        // Przeniesiony przepływ: popraw jego pozycję na tym łączu
+        const FlowState& other = m_state[moved];
+        for (uint32_t j = other.linkBegin; j < other.linkEnd; ++j)
+            if (m_flowLinks[j] == arc) m_flowLinkSlot[j] = slot;
+    }
+}
+
+} // namespace sim
+} // namespace netsim
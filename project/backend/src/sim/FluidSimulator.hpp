@@ -0,0 +1,177 @@
+#pragma once
+
+#include "EventScheduler.hpp"
+#include "../core/GraphSnapshot.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Engine;
+
+namespace netsim {
+namespace sim {
+
+using FlowId = uint32_t;
+
+enum class FlowStatus : uint8_t {
+    Pending,        // przed czasem startu
+    Active,
+    Completed,
+    NoRoute
+};
+
+/**
+ * @brief Per-flow result of the fluid model
+ */
+struct FluidFlow {
+    NodeId src = 0;
+    NodeId dst = 0;
+    uint64_t bytes = 0;
+    double rateCapMbps = 0.0;     // 0 = bez limitu źródła
+    FlowStatus status = FlowStatus::Pending;
+    SimTime start = 0;
+    SimTime finish = 0;           // koniec transmisji + opóźnienie propagacji ścieżki
+    SimTime propagation = 0;
+    uint16_t hops = 0;
+
+    SimTime completionTime() const { return finish - start; }
+    double averageRateMbps() const;
+};
+
+/**
+ * @brief Time-averaged load of one link direction
+ */
+struct FluidLinkStats {
+    NodeId from = 0;
+    NodeId to = 0;
+    double capacityMbps = 0.0;
+    double utilization = 0.0;     // średnia w [0, now()]
+    double peakUtilization = 0.0;
+    uint32_t activeFlows = 0;
+};
+
+struct FluidOptions {
+    int defaultBandwidthMbps = 0;   // łącza bez setBandwidth (0 = bez ograniczenia)
+    SimTime recomputeQuantum = 0;   // > 0: zdarzenia z jednego kwantu dzielą jedno przeliczenie
+};
+
+/**
+ * @brief Flow-level (fluid) simulation with max-min fair bandwidth sharing
+ *
+ * Flows are routed on the Engine's shortest-delay paths and every link
+ * direction is a capacity (setBandwidth, Mbps) shared by the flows crossing
+ * it. Rates are the max-min fair allocation, found by progressive filling:
+ * the link with the smallest fair share (remaining capacity / unfrozen
+ * flows) is the next bottleneck, its flows freeze at that share and their
+ * rate is taken off every other link they cross. Freezing at the current
+ * minimum only raises the shares of other links, so heap entries are lazily
+ * refreshed when popped instead of on every freeze; one allocation costs
+ * O(P + L log L) for P flow-link incidences over L links in the common case.
+ *
+ * Flow arrivals and completions run on an EventScheduler. Events at one
+ * time (or one recomputeQuantum) are batched into a single reallocation, and
+ * a reallocation only touches the connected component of links and flows
+ * reachable from the changed flows - rates outside it cannot change. Flows
+ * keep their remaining volume as of their last rate change, so untouched
+ * flows cost nothing; completions are rescheduled only for flows whose rate
+ * changed. Changes that provably keep the allocation fair skip the
+ * reallocation: a flow finishing on unsaturated links only, or a flow
+ * arriving on links with spare capacity that it can take without exceeding
+ * the rate of flows it saturates a link with.
+ */
+class FluidSimulator {
+public:
+    FluidSimulator(Network& net, Engine& engine, const FluidOptions& options = FluidOptions());
+
+    // Rzuca std::runtime_error dla nieznanego węzła lub startu z przeszłości
+    FlowId addFlow(NodeId src, NodeId dst, uint64_t bytes, SimTime start = 0, double rateCapMbps = 0.0);
+    FlowId addFlow(const std::string& src, const std::string& dst, uint64_t bytes,
+                   SimTime start = 0, double rateCapMbps = 0.0);
+
+    // Zwraca liczbę wykonanych zdarzeń
+    size_t runUntil(SimTime until);
+    size_t run();
+    SimTime now() const { return m_scheduler.now(); }
+
+    const FluidFlow& flow(FlowId id) const { return m_flows.at(id); }
+    const std::vector<FluidFlow>& flows() const { return m_flows; }
+    double currentRateMbps(FlowId id) const;
+    size_t activeFlows() const { return m_active; }
+    uint64_t reallocations() const { return m_reallocations; }
+    const GraphSnapshot& graph() const { return m_graph; }
+
+    // Łącza z ograniczoną przepustowością, przez które przeszedł jakiś przepływ
+    std::vector<FluidLinkStats> linkStats() const;
+
+private:
+    static constexpr uint32_t NoArc = GraphSnapshot::InvalidArc;
+
+    // Stan przepływu w trakcie symulacji; przepustowości w bitach na ns
+    struct FlowState {
+        double remaining = 0.0;     // bity na chwilę updatedAt
+        double rate = 0.0;
+        double cap = 0.0;           // 0 = brak
+        SimTime updatedAt = 0;
+        EventId completion = InvalidEvent;
+        uint32_t linkBegin = 0;     // łącza w m_flowLinks[linkBegin, linkEnd)
+        uint32_t linkEnd = 0;
+    };
+
+    struct Share {
+        double level;               // udział łącza albo limit źródła
+        uint32_t key;               // arc albo FlowId (isFlow)
+        bool isFlow;
+    };
+
+    Engine& m_engine;
+    FluidOptions m_options;
+    GraphSnapshot m_graph;
+    EventScheduler m_scheduler;
+    EventType m_arriveEvent = 0;
+    EventType m_completeEvent = 0;
+    EventType m_reallocateEvent = 0;
+
+    std::vector<FluidFlow> m_flows;
+    std::vector<FlowState> m_state;
+    std::vector<uint32_t> m_flowLinks;       // łącza ograniczone przepływów
+    std::vector<uint32_t> m_flowLinkSlot;    // pozycja przepływu w m_arcFlows[łącze]
+
+    std::vector<double> m_capacity;          // arc -> bity/ns (0 = bez ograniczenia)
+    std::vector<std::vector<FlowId>> m_arcFlows;
+    std::vector<double> m_load;              // arc -> suma rate aktywnych przepływów
+    std::vector<double> m_loadIntegral;      // arc -> przesłane bity do m_loadSince
+    std::vector<SimTime> m_loadSince;
+    std::vector<double> m_peakLoad;
+    std::vector<uint8_t> m_touched;          // arc -> czy niósł jakiś przepływ
+
+    // Przeliczenie: łącza/przepływy zmienione od ostatniej alokacji
+    std::vector<uint32_t> m_dirtyArcs;
+    std::vector<FlowId> m_dirtyFlows;
+    bool m_reallocateQueued = false;
+    std::vector<uint32_t> m_arcEpoch;
+    std::vector<uint32_t> m_flowEpoch;
+    uint32_t m_epoch = 0;
+    std::vector<double> m_residual;          // arc -> pozostała przepustowość
+    std::vector<uint32_t> m_unfrozen;        // arc -> przepływy bez ustalonego rate
+    std::vector<double> m_newRate;           // FlowId -> wynik alokacji (< 0 = jeszcze nieustalony)
+    std::vector<FlowId> m_componentFlows;
+    std::vector<Share> m_heap;
+    std::vector<uint32_t> m_componentArcs;
+
+    size_t m_active = 0;
+    uint64_t m_reallocations = 0;
+
+    void onArrive(FlowId id);
+    void onComplete(FlowId id);
+    void reallocate();
+    void requestReallocation();
+    bool admitWithoutReallocation(FlowId id);
+    void scheduleCompletion(FlowId id);
+    void setRate(FlowId id, double rate);
+    void attach(FlowId id);
+    void detach(FlowId id);
+    void addLoad(uint32_t arc, double delta);
+};
+
+} // namespace sim
+} // namespace netsim
@@ -0,0 +1,370 @@
+#include "MobilitySimulator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace netsim {
+namespace sim {
+
+namespace {
+
+constexpr size_t ReadBufferBytes = 1 << 16;
+constexpr double Pi = 3.14159265358979323846;
+
+double seconds(SimTime t) { return static_cast<double>(t) / Second; }
+
+} // namespace
+
+MobilitySimulator::MobilitySimulator(Network& net, const MobilityOptions& options)
+    : m_net(net), m_options(options), m_rng(options.seed)
+{
+    if (options.tick == 0) throw std::runtime_error("Mobility tick must be positive");
+    if (!(options.maxX > options.minX) || !(options.maxY > options.minY))
+        throw std::runtime_error("Invalid mobility area");
+    if (!(options.minSpeed > 0) || options.maxSpeed < options.minSpeed)
+        throw std::runtime_error("Invalid speed range");
+    if (options.alpha < 0 || options.alpha > 1) throw std::runtime_error("Gauss-Markov alpha must be in [0, 1]");
+
+    EventScheduler& scheduler = net.getScheduler();
+    m_tickEvent = scheduler.registerHandler([this](const Event&) { onTick(); });
+    m_wakeEvent = scheduler.registerHandler([this](const Event& ev) {
+        onWake(static_cast<NodeId>(ev.arg0), static_cast<uint32_t>(ev.arg1));
+    });
+    m_waypointEvent = scheduler.registerHandler([this](const Event& ev) {
+        auto index = static_cast<uint32_t>(ev.arg0);
+        Waypoint waypoint = m_waypoints[index];
+        m_freeWaypoints.push_back(index);
+        applyWaypoint(waypoint);
+    });
+    m_traceEvent = scheduler.registerHandler([this](const Event& ev) { readTrace(static_cast<uint32_t>(ev.arg0)); });
+}
+
+MobilitySimulator::~MobilitySimulator()
+{
+    // Zwalnia typy zdarzeń razem z czekającymi jeszcze w kolejce sieci krokami, pobudkami i rekordami śladu
+    EventScheduler& scheduler = m_net.getScheduler();
+    for (EventType type : {m_tickEvent, m_wakeEvent, m_waypointEvent, m_traceEvent})
+        scheduler.unregisterHandler(type);
+}
+
+MobilityModel MobilitySimulator::parseModel(const std::string& name)
+{
+    if (name == "waypoint") return MobilityModel::RandomWaypoint;
+    if (name == "gaussmarkov") return MobilityModel::GaussMarkov;
+    if (name == "trace") return MobilityModel::Trace;
+    throw std::runtime_error("Unknown mobility model: " + name);
+}
+
+MobilitySimulator::Mover& MobilitySimulator::mover(NodeId node)
+{
+    if (node >= m_movers.size()) m_movers.resize(node + 1);
+    return m_movers[node];
+}
+
+void MobilitySimulator::addNode(const std::string& name, MobilityModel model)
+{
+    NodeId node = m_net.findByName(name)->getId();
+    Mover& m = mover(node);
+    if (m.present) throw std::runtime_error("Node already in mobility simulation: " + name);
+    m.present = true;
+    m.model = model;
+    m_nodeCount++;
+    if (!m_net.hasPosition(node)) {
+        std::uniform_real_distribution<double> x(m_options.minX, m_options.maxX), y(m_options.minY, m_options.maxY);
+        m_net.setPosition(node, Position{x(m_rng), y(m_rng)});
+        armTick();
+    }
+    switch (model) {
+    case MobilityModel::RandomWaypoint:
+        pickWaypoint(m);
+        startMoving(node);
+        break;
+    case MobilityModel::GaussMarkov:
+        m.speed = m_options.meanSpeed;
+        m.direction = m.meanDirection = std::uniform_real_distribution<double>(0, 2 * Pi)(m_rng);
+        startMoving(node);
+        break;
+    case MobilityModel::Trace:
+        break;
+    }
+}
+
+void MobilitySimulator::removeNode(const std::string& name)
+{
+    NodeId node = m_net.findByName(name)->getId();
+    if (node >= m_movers.size() || !m_movers[node].present)
+        throw std::runtime_error("Node not in mobility simulation: " + name);
+    stopMoving(node);
+    Mover& m = m_movers[node];
+    m.present = false;
+    m.epoch++;
+    m_nodeCount--;
+}
+
+void MobilitySimulator::addWaypoint(const std::string& name, SimTime at, const Position& target, double speed)
+{
+    NodeId node = m_net.findByName(name)->getId();
+    if (!std::isfinite(target.x) || !std::isfinite(target.y) || !(speed >= 0))
+        throw std::runtime_error("Invalid waypoint");
+    EventScheduler& scheduler = m_net.getScheduler();
+    if (at < scheduler.now()) throw std::runtime_error("Waypoint time is in the past");
+    uint32_t index;
+    if (!m_freeWaypoints.empty()) {
+        index = m_freeWaypoints.back();
+        m_freeWaypoints.pop_back();
+        m_waypoints[index] = Waypoint{node, target, speed};
+    } else {
+        index = static_cast<uint32_t>(m_waypoints.size());
+        m_waypoints.push_back(Waypoint{node, target, speed});
+    }
+    scheduler.schedule(at, m_waypointEvent, index);
+}
+
+void MobilitySimulator::loadTrace(const std::string& path)
+{
+    auto trace = std::make_unique<TraceFile>();
+    trace->buffer.resize(ReadBufferBytes);
+    trace->in.rdbuf()->pubsetbuf(trace->buffer.data(), trace->buffer.size());
+    trace->in.open(path, std::ios::binary);
+    if (!trace->in) throw std::runtime_error("Cannot open trace file: " + path);
+    trace->base = trace->last = m_net.getScheduler().now();
+    auto index = static_cast<uint32_t>(m_traces.size());
+    m_traces.push_back(std::move(trace));
+    TraceFile& t = *m_traces.back();
+    if (parseTraceLine(t)) m_net.getScheduler().schedule(t.pendingAt, m_traceEvent, index);
+}
+
+bool MobilitySimulator::parseTraceLine(TraceFile& t)
+{
+    while (std::getline(t.in, t.line)) {
+        if (t.line.empty() || t.line[0] < '0' || t.line[0] > '9') continue;
+        const char* p = t.line.c_str();
+        char* end;
+        double at = std::strtod(p, &end);
+        const char* comma = *end == ',' ? std::strchr(end + 1, ',') : nullptr;
+        if (!comma || !(at >= 0)) {
+            m_stats.skipped++;
+            continue;
+        }
+        std::string name(static_cast<const char*>(end) + 1, comma);
+        double values[3] = {0, 0, 0};
+        int count = 0;
+        p = comma;
+        while (count < 3 && *p == ',') {
+            double value = std::strtod(p + 1, &end);
+            if (end == p + 1) break;
+            values[count++] = value;
+            p = end;
+        }
+        NodeId node;
+        try {
+            node = m_net.findNode(name)->getId();
+        } catch (const std::runtime_error&) {
+            m_stats.skipped++;
+            continue;
+        }
+        if (count < 2 || !std::isfinite(values[0]) || !std::isfinite(values[1]) || values[2] < 0) {
+            m_stats.skipped++;
+            continue;
+        }
+        // Czasy nie maleją: rekord z przeszłości wykonuje się od razu
+        t.last = std::max(t.last, t.base + static_cast<SimTime>(at * Second));
+        t.pendingAt = t.last;
+        t.record = Waypoint{node, Position{values[0], values[1]}, values[2]};
+        return true;
+    }
+    return false;
+}
+
+void MobilitySimulator::readTrace(uint32_t index)
+{
+    TraceFile& t = *m_traces[index];
+    SimTime now = m_net.getScheduler().now();
+    // Wszystkie rekordy tej samej chwili, potem jedno zdarzenie na następny
+    do {
+        applyWaypoint(t.record);
+        if (!parseTraceLine(t)) {
+            t.in.close();
+            return;
+        }
+    } while (t.pendingAt <= now);
+    m_net.getScheduler().schedule(t.pendingAt, m_traceEvent, index);
+}
+
+void MobilitySimulator::applyWaypoint(const Waypoint& waypoint)
+{
+    NodeId node = waypoint.node;
+    Mover& m = mover(node);
+    if (m.present && m.model != MobilityModel::Trace) {
+        m_stats.skipped++;
+        return;
+    }
+    if (!m.present) {
+        // Węzły ze śladu dołączają przy pierwszym rekordzie
+        m.present = true;
+        m.model = MobilityModel::Trace;
+        m_nodeCount++;
+    }
+    m_stats.waypoints++;
+    if (waypoint.speed <= 0 || !m_net.hasPosition(node)) {
+        stopMoving(node);
+        m_net.setPosition(node, waypoint.target);
+        armTick();
+        return;
+    }
+    // Węzeł w ruchu dojeżdża do chwili rekordu i dopiero zmienia cel
+    if (m.slot != NotMoving) step(node, m, seconds(m_net.getScheduler().now() - m.since));
+    m.target = waypoint.target;
+    m.speed = waypoint.speed;
+    if (m.slot == NotMoving) startMoving(node);
+    m.since = m_net.getScheduler().now();
+}
+
+void MobilitySimulator::startMoving(NodeId node)
+{
+    Mover& m = m_movers[node];
+    m.since = m_net.getScheduler().now();
+    if (m.slot != NotMoving) return;
+    m.slot = static_cast<uint32_t>(m_moving.size());
+    m_moving.push_back(node);
+    armTick();
+}
+
+void MobilitySimulator::stopMoving(NodeId node)
+{
+    Mover& m = m_movers[node];
+    if (m.slot == NotMoving) return;
+    NodeId last = m_moving.back();
+    m_moving[m.slot] = last;
+    m_movers[last].slot = m.slot;
+    m_moving.pop_back();
+    m.slot = NotMoving;
+}
+
+void MobilitySimulator::armTick()
+{
+    if (m_tickId == InvalidEvent)
+        m_tickId = m_net.getScheduler().scheduleAfter(m_options.tick, m_tickEvent);
+}
+
+void MobilitySimulator::onTick()
+{
+    m_tickId = InvalidEvent;
+    m_stats.ticks++;
+    SimTime now = m_net.getScheduler().now();
+    // Od końca: zatrzymany węzeł zamienia się z ostatnim, już przesuniętym
+    for (size_t k = m_moving.size(); k-- > 0;) {
+        NodeId node = m_moving[k];
+        Mover& m = m_movers[node];
+        double dt = seconds(now - m.since);
+        m.since = now;
+        m_stats.moves++;
+        step(node, m, dt);
+    }
+
+    m_changes.clear();
+    m_net.updateMovedWirelessLinks(&m_changes);
+    for (const auto& change : m_changes)
+        (change.kind == TopologyChange::Kind::LinkUp ? m_stats.linksUp : m_stats.linksDown)++;
+    if (m_options.interferencePerNeighbor > 0) updateInterference();
+    if (m_callback && !m_changes.empty()) m_callback(now, m_changes);
+    if (!m_moving.empty()) armTick();
+}
+
+void MobilitySimulator::onWake(NodeId node, uint32_t epoch)
+{
+    if (node >= m_movers.size()) return;
+    Mover& m = m_movers[node];
+    if (!m.present || m.epoch != epoch || m.model != MobilityModel::RandomWaypoint || m.slot != NotMoving) return;
+    pickWaypoint(m);
+    startMoving(node);
+}
+
+bool MobilitySimulator::step(NodeId node, Mover& m, double dt)
+{
+    Position p = m_net.getPosition(node);
+    if (m.model == MobilityModel::GaussMarkov) {
+        std::normal_distribution<double> noise(0.0, 1.0);
+        double a = m_options.alpha, spread = std::sqrt(1 - a * a);
+        m.speed = std::max(0.0, a * m.speed + (1 - a) * m_options.meanSpeed + spread * m_options.speedDeviation * noise(m_rng));
+        m.direction = a * m.direction + (1 - a) * m.meanDirection + spread * m_options.directionDeviation * noise(m_rng);
+        p.x += m.speed * std::cos(m.direction) * dt;
+        p.y += m.speed * std::sin(m.direction) * dt;
+        // Odbicie od brzegu obszaru razem z kierunkiem średnim
+        if (p.x < m_options.minX || p.x > m_options.maxX) {
+            p.x = p.x < m_options.minX ? 2 * m_options.minX - p.x : 2 * m_options.maxX - p.x;
+            m.direction = Pi - m.direction;
+            m.meanDirection = Pi - m.meanDirection;
+        }
+        if (p.y < m_options.minY || p.y > m_options.maxY) {
+            p.y = p.y < m_options.minY ? 2 * m_options.minY - p.y : 2 * m_options.maxY - p.y;
+            m.direction = -m.direction;
+            m.meanDirection = -m.meanDirection;
+        }
+        p.x = std::clamp(p.x, m_options.minX, m_options.maxX);
+        p.y = std::clamp(p.y, m_options.minY, m_options.maxY);
+        m_net.setPosition(node, p);
+        return true;
+    }
+
+    double dx = m.target.x - p.x, dy = m.target.y - p.y;
+    double distance = std::sqrt(dx * dx + dy * dy);
+    double travel = m.speed * dt;
+    if (travel >= distance) {
+        m_net.setPosition(node, m.target);
+        SimTime late = static_cast<SimTime>((travel - distance) / m.speed * Second);
+        SimTime now = m_net.getScheduler().now();
+        if (m.model == MobilityModel::RandomWaypoint)
+            pauseOrContinue(node, m, now - std::min(late, now));
+        else
+            stopMoving(node);
+        return false;
+    }
+    p.x += dx / distance * travel;
+    p.y += dy / distance * travel;
+    m_net.setPosition(node, p);
+    return true;
+}
+
+void MobilitySimulator::pickWaypoint(Mover& m)
+{
+    std::uniform_real_distribution<double> x(m_options.minX, m_options.maxX), y(m_options.minY, m_options.maxY);
+    std::uniform_real_distribution<double> speed(m_options.minSpeed, m_options.maxSpeed);
+    m.target = Position{x(m_rng), y(m_rng)};
+    m.speed = speed(m_rng);
+}
+
+void MobilitySimulator::pauseOrContinue(NodeId node, Mover& m, SimTime arrivedAt)
+{
+    SimTime pause = m_options.maxPause
+        ? std::uniform_int_distribution<SimTime>(0, m_options.maxPause)(m_rng) : 0;
+    SimTime now = m_net.getScheduler().now();
+    if (arrivedAt + pause <= now) {
+        pickWaypoint(m);
+        return;
+    }
+    // Postój poza zbiorem ruchomych: do pobudki węzeł nic nie kosztuje
+    stopMoving(node);
+    m_net.getScheduler().schedule(arrivedAt + pause, m_wakeEvent, node, m.epoch);
+}
+
+void MobilitySimulator::updateInterference()
+{
+    m_touched.clear();
+    for (const auto& change : m_changes) {
+        m_touched.push_back(change.a);
+        m_touched.push_back(change.b);
+    }
+    std::sort(m_touched.begin(), m_touched.end());
+    m_touched.erase(std::unique(m_touched.begin(), m_touched.end()), m_touched.end());
+    for (NodeId node : m_touched) {
+        double loss = std::min(1.0, m_options.interferencePerNeighbor * m_net.getWirelessDegree(node));
+        m_net.simulateInterference(m_net.findById(node)->getName(), loss);
+        m_stats.interferenceUpdates++;
+    }
+}
+
+} // namespace sim
+} // namespace netsim
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "EventScheduler.hpp"
+#include "../core/Network.hpp"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace netsim {
+namespace sim {
+
+enum class MobilityModel : uint8_t {
+    RandomWaypoint,     // losowy cel w obszarze, losowa prędkość, postój po dotarciu
+    GaussMarkov,        // prędkość i kierunek skorelowane w czasie (alpha), odbicie od brzegu
+    Trace               // cele z pliku lub addWaypoint (jak setdest w ns-2)
+};
+
+struct MobilityOptions {
+    SimTime tick = 100 * Millisecond;           // krok ruchu i aktualizacji łączy radiowych
+    double minX = 0, minY = 0;                  // obszar ruchu w metrach
+    double maxX = 1000, maxY = 1000;
+    double minSpeed = 1.0;                      // RandomWaypoint: m/s
+    double maxSpeed = 10.0;
+    SimTime maxPause = 2 * Second;              // RandomWaypoint: postój losowany z [0, maxPause]
+    double meanSpeed = 5.0;                     // GaussMarkov: m/s
+    double alpha = 0.75;                        // GaussMarkov: 0 = błądzenie losowe, 1 = ruch jednostajny
+    double speedDeviation = 1.0;                // GaussMarkov: m/s
+    double directionDeviation = 0.5;            // GaussMarkov: radiany
+    double interferencePerNeighbor = 0.0;       // > 0: interferencje = min(1, k * sąsiedzi radiowi)
+    uint64_t seed = 1;
+};
+
+/**
+ * @brief Counters of a MobilitySimulator
+ */
+struct MobilityStats {
+    uint64_t ticks = 0;
+    uint64_t moves = 0;                         // przesunięcia węzłów (węzeł x krok)
+    uint64_t linksUp = 0;
+    uint64_t linksDown = 0;
+    uint64_t interferenceUpdates = 0;
+    uint64_t waypoints = 0;                     // wykonane rekordy śladu
+    uint64_t skipped = 0;                       // błędne linie śladu, nieznane węzły
+};
+
+// Zmiany łączy radiowych jednego kroku (LinkUp / LinkDown, a < b)
+using MobilityCallback = std::function<void(SimTime, const std::vector<TopologyChange>&)>;
+
+/**
+ * @brief Node movement on the Network's simulation clock
+ *
+ * Moving nodes advance on a tick event of Network::getScheduler(), so they
+ * move while advanceTime() runs. After each tick the wireless links of the
+ * nodes that moved are updated through Network::updateMovedWirelessLinks(),
+ * which keeps a hashed grid current in place; the link changes are passed
+ * to the callback. Only moving nodes are visited: a random-waypoint node
+ * leaves the moving set for its pause and is woken by a one-off event, a
+ * trace node moves only between a record and reaching its target, and the
+ * tick is not armed while nothing moves. Per-tick cost therefore follows
+ * the number of moving nodes and their neighbourhoods, not the network size.
+ *
+ * Trace files are CSV lines "time_s,node,x,y[,speed]" (node by name or IP)
+ * and join the simulation as Trace nodes: at time_s the node
+ * heads for (x, y) at speed m/s, or jumps there when the speed is missing
+ * or 0. Lines not starting with a digit are skipped as headers/comments and
+ * times must not decrease; a file is read one record ahead, like traffic
+ * traces. With interferencePerNeighbor > 0, simulateInterference is
+ * recomputed only for the endpoints of changed links.
+ *
+ * The destructor unregisters its handlers from the Network's scheduler,
+ * dropping its pending events, so simulators can be created per request
+ * without using up event types. Network::fork() does not carry the simulator.
+ * Nodes must be removed from it before they are removed from the Network.
+ */
+class MobilitySimulator {
+public:
+    explicit MobilitySimulator(Network& net, const MobilityOptions& options = MobilityOptions());
+    ~MobilitySimulator();
+    MobilitySimulator(const MobilitySimulator&) = delete;
+    MobilitySimulator& operator=(const MobilitySimulator&) = delete;
+
+    // Węzeł bez pozycji dostaje losową w obszarze; rzuca std::runtime_error dla nieznanego węzła
+    // albo węzła, który już jest w symulacji
+    void addNode(const std::string& name, MobilityModel model);
+    // Ślad: w chwili at węzeł rusza do target z prędkością speed m/s (0 = skok)
+    void addWaypoint(const std::string& name, SimTime at, const Position& target, double speed);
+    // Plik śladu, czasy względem chwili wczytania; rzuca std::runtime_error gdy nie da się otworzyć
+    void loadTrace(const std::string& path);
+    // Zatrzymuje węzeł i wyłącza go z symulacji (pozycja zostaje)
+    void removeNode(const std::string& name);
+
+    // "waypoint", "gaussmarkov", "trace"; rzuca std::runtime_error dla nieznanego
+    static MobilityModel parseModel(const std::string& name);
+
+    void setCallback(MobilityCallback callback) { m_callback = std::move(callback); }
+    const MobilityStats& stats() const { return m_stats; }
+    size_t nodeCount() const { return m_nodeCount; }
+    size_t movingCount() const { return m_moving.size(); }
+
+private:
+    static constexpr uint32_t NotMoving = UINT32_MAX;
+
+    struct Mover {
+        bool present = false;
+        MobilityModel model = MobilityModel::RandomWaypoint;
+        uint32_t slot = NotMoving;          // indeks w m_moving
+        uint32_t epoch = 0;                 // unieważnia zaplanowane pobudki po removeNode
+        SimTime since = 0;                  // ostatnia aktualizacja pozycji
+        Position target;                    // RandomWaypoint, Trace
+        double speed = 0;                   // m/s
+        double direction = 0;               // GaussMarkov: radiany
+        double meanDirection = 0;
+    };
+
+    struct Waypoint {
+        NodeId node;
+        Position target;
+        double speed;
+    };
+
+    struct TraceFile {
+        std::ifstream in;
+        std::vector<char> buffer;
+        std::string line;
+        SimTime base = 0;
+        SimTime last = 0;
+        SimTime pendingAt = 0;
+        Waypoint record{0, Position{}, 0};
+    };
+
+    Network& m_net;
+    MobilityOptions m_options;
+    std::mt19937_64 m_rng;
+    EventType m_tickEvent = 0, m_wakeEvent = 0, m_waypointEvent = 0, m_traceEvent = 0;
+    EventId m_tickId = InvalidEvent;
+
+    std::vector<Mover> m_movers;            // NodeId -> stan
+    std::vector<NodeId> m_moving;
+    size_t m_nodeCount = 0;
+    std::vector<Waypoint> m_waypoints;
+    std::vector<uint32_t> m_freeWaypoints;
+    std::vector<std::unique_ptr<TraceFile>> m_traces;
+    std::vector<TopologyChange> m_changes;
+    std::vector<NodeId> m_touched;
+    MobilityStats m_stats;
+    MobilityCallback m_callback;
+
+    Mover& mover(NodeId node);
+    void startMoving(NodeId node);
+    void stopMoving(NodeId node);
+    void armTick();
+    void onTick();
+    void onWake(NodeId node, uint32_t epoch);
+    void applyWaypoint(const Waypoint& waypoint);
+    void readTrace(uint32_t trace);
+    bool parseTraceLine(TraceFile& trace);
+
+    // Przesuwa węzeł o dt; false gdy się zatrzymał (dotarł do celu)
+    bool step(NodeId node, Mover& m, double dt);
+    void pickWaypoint(Mover& m);
+    void pauseOrContinue(NodeId node, Mover& m, SimTime arrivedAt);
+    void updateInterference();
+};
+
+} // namespace sim
+} // namespace netsim
@@ -0,0 +1,464 @@
+#include "PacketCapture.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace netsim {
+namespace sim {
+
+namespace {
+
+constexpr uint32_t BlockShb = 0x0A0D0D0A;
+constexpr uint32_t BlockIdb = 0x00000001;
+constexpr uint32_t BlockEpb = 0x00000006;
+constexpr uint16_t LinkTypeEthernet = 1;
+constexpr size_t MaxFilterDepth = 64;
+constexpr size_t MaxHeaderBytes = 18 + 20 + 20;  // Ethernet + 802.1Q, IPv4, TCP
+
+size_t pad4(size_t n) { return (n + 3) & ~size_t(3); }
+
+// Bloki pcapng w porządku hosta (czytnik rozpoznaje go po magic w SHB), nagłówki ramki w sieciowym
+template<typename T>
+void put(char*& p, T value) {
+    std::memcpy(p, &value, sizeof(value));
+    p += sizeof(value);
+}
+
+void put16be(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void put32be(uint8_t* p, uint32_t v) {
+    put16be(p, static_cast<uint16_t>(v >> 16));
+    put16be(p + 2, static_cast<uint16_t>(v));
+}
+
+bool parseIpv4(const std::string& text, uint32_t& out) {
+    unsigned a, b, c, d;
+    char extra;
+    if (std::sscanf(text.c_str(), "%u.%u.%u.%u%c", &a, &b, &c, &d, &extra) != 4) return false;
+    if (a > 255 || b > 255 || c > 255 || d > 255) return false;
+    out = (a << 24) | (b << 16) | (c << 8) | d;
+    return true;
+}
+
+uint8_t ipProtocol(Protocol protocol) {
+    switch (protocol) {
+    case Protocol::Tcp: return 6;
+    case Protocol::Udp: return 17;
+    case Protocol::Icmp: return 1;
+    default: return 253;  // RFC 3692: do eksperymentów
+    }
+}
+
+uint16_t ipChecksum(const uint8_t* header) {
+    uint32_t sum = 0;
+    for (int i = 0; i < 20; i += 2) sum += (header[i] << 8) | header[i + 1];
+    while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+} // namespace
+
+// ---- CaptureFilter ----
+
+struct CaptureFilter::Parser {
+    const Network& net;
+    std::vector<std::string> tokens;
+    size_t pos = 0;
+    std::vector<Instr> program;
+    size_t depth = 0;
+
+    Parser(const Network& network, const std::string& text) : net(network) {
+        for (size_t i = 0; i < text.size();) {
+            char c = text[i];
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                ++i;
+            } else if (c == '(' || c == ')' || c == '!') {
+                tokens.emplace_back(1, c);
+                ++i;
+            } else if ((c == '&' || c == '|') && i + 1 < text.size() && text[i + 1] == c) {
+                tokens.emplace_back(2, c);
+                i += 2;
+            } else {
+                size_t start = i;
+                while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])) &&
+                       text[i] != '(' && text[i] != ')')
+                    ++i;
+                tokens.push_back(text.substr(start, i - start));
+            }
+        }
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        std::string at = pos < tokens.size() ? "'" + tokens[pos] + "'" : "end of expression";
+        throw std::runtime_error("Capture filter: " + what + " at " + at);
+    }
+
+    bool accept(const char* a, const char* b = nullptr) {
+        if (pos < tokens.size() && (tokens[pos] == a || (b && tokens[pos] == b))) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    const std::string& next(const std::string& what) {
+        if (pos >= tokens.size()) fail("expected " + what);
+        return tokens[pos++];
+    }
+
+    void emit(Op op, uint32_t arg = 0) {
+        program.push_back({op, arg});
+        if (op == Op::And || op == Op::Or) {
+            depth--;
+        } else if (op != Op::Not && ++depth > MaxFilterDepth) {
+            fail("expression too deep");
+        }
+    }
+
+    uint32_t number(const std::string& what, uint32_t max) {
+        const std::string& token = next(what);
+        char* end = nullptr;
+        unsigned long value = std::strtoul(token.c_str(), &end, 10);
+        if (token.empty() || *end != '\0' || value > max) {
+            --pos;
+            fail("expected " + what);
+        }
+        return static_cast<uint32_t>(value);
+    }
+
+    uint32_t host() {
+        const std::string& token = next("host name or address");
+        for (const auto& name : net.getAllNodes())
+            if (name == token) return net.findByName(name)->getId();
+        IpAddress address;
+        if (IpAddress::parse(token, address))
+            if (auto node = net.findByIp(address)) return node->getId();
+        --pos;
+        fail("unknown host");
+    }
+
+    void expression() {
+        conjunction();
+        while (accept("or", "||")) {
+            conjunction();
+            emit(Op::Or);
+        }
+    }
+
+    void conjunction() {
+        factor();
+        while (accept("and", "&&")) {
+            factor();
+            emit(Op::And);
+        }
+    }
+
+    void factor() {
+        if (accept("not", "!")) {
+            factor();
+            emit(Op::Not);
+        } else if (accept("(")) {
+            expression();
+            if (!accept(")")) fail("expected ')'");
+        } else {
+            primitive();
+        }
+    }
+
+    void primitive() {
+        int direction = accept("src") ? 1 : accept("dst") ? 2 : 0;
+        if (accept("host")) {
+            uint32_t id = host();
+            emit(direction == 1 ? Op::SrcHost : direction == 2 ? Op::DstHost : Op::Host, id);
+        } else if (accept("port")) {
+            uint32_t port = number("port number", 65535);
+            emit(direction == 1 ? Op::SrcPort : direction == 2 ? Op::DstPort : Op::Port, port);
+        } else if (direction != 0) {
+            fail("expected 'host' or 'port'");
+        } else if (accept("vlan")) {
+            emit(Op::Vlan, number("VLAN id", 4095));
+        } else if (accept("tcp")) {
+            emit(Op::Proto, static_cast<uint32_t>(Protocol::Tcp));
+        } else if (accept("udp")) {
+            emit(Op::Proto, static_cast<uint32_t>(Protocol::Udp));
+        } else if (accept("icmp")) {
+            emit(Op::Proto, static_cast<uint32_t>(Protocol::Icmp));
+        } else if (accept("ip")) {
+            emit(Op::True);
+        } else {
+            fail("expected filter primitive");
+        }
+    }
+};
+
+CaptureFilter CaptureFilter::compile(const std::string& expression, const Network& net) {
+    Parser parser(net, expression);
+    CaptureFilter filter;
+    if (parser.tokens.empty()) return filter;
+    parser.expression();
+    if (parser.pos != parser.tokens.size()) parser.fail("unexpected token");
+    filter.m_program = std::move(parser.program);
+    return filter;
+}
+
+bool CaptureFilter::matches(const PacketRecord& rec, uint16_t vlan) const {
+    bool stack[MaxFilterDepth];
+    size_t top = 0;
+    for (const Instr& in : m_program) {
+        switch (in.op) {
+        case Op::Host: stack[top++] = rec.src == in.arg || rec.dst == in.arg; break;
+        case Op::SrcHost: stack[top++] = rec.src == in.arg; break;
+        case Op::DstHost: stack[top++] = rec.dst == in.arg; break;
+        case Op::Port: stack[top++] = rec.srcPort == in.arg || rec.dstPort == in.arg; break;
+        case Op::SrcPort: stack[top++] = rec.srcPort == in.arg; break;
+        case Op::DstPort: stack[top++] = rec.dstPort == in.arg; break;
+        case Op::Vlan: stack[top++] = vlan == in.arg; break;
+        case Op::Proto: stack[top++] = static_cast<uint32_t>(rec.protocol) == in.arg; break;
+        case Op::True: stack[top++] = true; break;
+        case Op::And: top--; stack[top - 1] = stack[top - 1] && stack[top]; break;
+        case Op::Or: top--; stack[top - 1] = stack[top - 1] || stack[top]; break;
+        case Op::Not: stack[top - 1] = !stack[top - 1]; break;
+        }
+    }
+    return top == 0 || stack[0];
+}
+
+// ---- PacketCapture ----
+
+PacketCapture::PacketCapture(const Network& net, const std::string& path, const CaptureOptions& options)
+    : m_net(net), m_path(path), m_options(options) {
+    if (m_options.snapLength == 0 || m_options.snapLength > 65535)
+        throw std::runtime_error("Capture snap length must be in 1..65535");
+    if (m_options.bufferBytes < 32 + pad4(m_options.snapLength) + 4096)
+        throw std::runtime_error("Capture buffer too small for snap length");
+    m_filter = CaptureFilter::compile(m_options.filter, net);
+
+    m_ipOf.assign(net.getNodeIdBound(), 0);
+    m_vlanOf.assign(net.getNodeIdBound(), 0);
+    for (const auto& name : net.getAllNodes()) {
+        auto node = net.findByName(name);
+        NodeId id = node->getId();
+        // Węzły bez poprawnego IPv4 dostają 10.x.y.z z NodeId
+        if (!parseIpv4(node->getIp(), m_ipOf[id])) m_ipOf[id] = 0x0a000000u | ((id + 1) & 0xffffff);
+        m_vlanOf[id] = static_cast<uint16_t>(net.getVLAN(name) & 0xfff);
+    }
+
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) throw std::runtime_error("Cannot open capture file: " + path);
+    m_buffers[0].resize(m_options.bufferBytes);
+    m_buffers[1].resize(m_options.bufferBytes);
+
+    char* p = reserve(28, true);
+    put<uint32_t>(p, BlockShb);
+    put<uint32_t>(p, 28);
+    put<uint32_t>(p, 0x1A2B3C4D);
+    put<uint16_t>(p, 1);
+    put<uint16_t>(p, 0);
+    put<int64_t>(p, -1);  // długość sekcji nieznana
+    put<uint32_t>(p, 28);
+
+    m_writer = std::thread(&PacketCapture::writerLoop, this);
+}
+
+PacketCapture::~PacketCapture() {
+    close();
+}
+
+NodeId PacketCapture::nodeId(const std::string& name) const {
+    return m_net.findByName(name)->getId();  // rzuca dla nieznanego węzła
+}
+
+uint32_t PacketCapture::tapNode(const std::string& node) {
+    return addTap(nodeId(node), GraphSnapshot::InvalidNode, "node " + node);
+}
+
+uint32_t PacketCapture::tapLink(const std::string& from, const std::string& to) {
+    return addTap(nodeId(from), nodeId(to), "link " + from + "->" + to);
+}
+
+void PacketCapture::tapAllNodes() {
+    for (const auto& name : m_net.getAllNodes()) tapNode(name);
+}
+
+uint32_t PacketCapture::addTap(NodeId from, NodeId to, const std::string& name) {
+    for (size_t i = 0; i < m_taps.size(); ++i)
+        if (m_taps[i].from == from && m_taps[i].to == to) return static_cast<uint32_t>(i);
+    if (m_started || m_closed) throw std::runtime_error("Capture taps must be added before the first packet");
+
+    // IDB: if_name, if_tsresol = 9 (znaczniki czasu w ns jak SimTime), opt_endofopt
+    const size_t length = 16 + 4 + pad4(name.size()) + 8 + 4 + 4;
+    char* p = reserve(length, true);
+    put<uint32_t>(p, BlockIdb);
+    put<uint32_t>(p, static_cast<uint32_t>(length));
+    put<uint16_t>(p, LinkTypeEthernet);
+    put<uint16_t>(p, 0);
+    put<uint32_t>(p, m_options.snapLength);
+    put<uint16_t>(p, 2);
+    put<uint16_t>(p, static_cast<uint16_t>(name.size()));
+    std::memset(p, 0, pad4(name.size()));
+    std::memcpy(p, name.data(), name.size());
+    p += pad4(name.size());
+    put<uint16_t>(p, 9);
+    put<uint16_t>(p, 1);
+    put<uint32_t>(p, 0);
+    p[-4] = 9;
+    put<uint32_t>(p, 0);
+    put<uint32_t>(p, static_cast<uint32_t>(length));
+
+    m_taps.push_back({from, to});
+    return static_cast<uint32_t>(m_taps.size() - 1);
+}
+
+void PacketCapture::capture(uint32_t tap, SimTime time, const PacketRecord& rec) {
+    if (m_closed) return;
+    m_started = true;
+    m_stats.seen++;
+    const uint16_t vlan = rec.src < m_vlanOf.size() ? m_vlanOf[rec.src] : 0;
+    if (!m_filter.matches(rec, vlan)) {
+        m_stats.filtered++;
+        return;
+    }
+
+    // Ramka: Ethernet [802.1Q] + IPv4 + nagłówek L4; payload to zera
+    uint8_t header[MaxHeaderBytes] = {};
+    header[0] = 0x02;  // MAC lokalnie administrowany: 02:00:00 + NodeId
+    put16be(header + 2, static_cast<uint16_t>(rec.dst >> 16));
+    put16be(header + 4, static_cast<uint16_t>(rec.dst));
+    header[6] = 0x02;
+    put16be(header + 8, static_cast<uint16_t>(rec.src >> 16));
+    put16be(header + 10, static_cast<uint16_t>(rec.src));
+    size_t l2 = 12;
+    if (vlan != 0) {
+        put16be(header + l2, 0x8100);
+        put16be(header + l2 + 2, static_cast<uint16_t>((std::min<uint8_t>(rec.priority, 7) << 13) | vlan));
+        l2 += 4;
+    }
+    put16be(header + l2, 0x0800);
+    l2 += 2;
+
+    const uint8_t proto = ipProtocol(rec.protocol);
+    const size_t l4 = proto == 6 ? 20 : proto == 253 ? 0 : 8;
+    const uint32_t ipLength = std::min<uint32_t>(std::max<uint32_t>(rec.sizeBytes, 20 + l4), 65535);
+    uint8_t* ip = header + l2;
+    ip[0] = 0x45;
+    ip[1] = static_cast<uint8_t>(std::min<uint8_t>(rec.priority, 7) << 5);  // pierwszeństwo IP
+    put16be(ip + 2, static_cast<uint16_t>(ipLength));
+    put16be(ip + 6, 0x4000);  // DF
+    ip[8] = static_cast<uint8_t>(rec.ttl > rec.hops ? rec.ttl - rec.hops : 0);
+    ip[9] = proto;
+    put32be(ip + 12, rec.src < m_ipOf.size() ? m_ipOf[rec.src] : 0);
+    put32be(ip + 16, rec.dst < m_ipOf.size() ? m_ipOf[rec.dst] : 0);
+    put16be(ip + 10, ipChecksum(ip));
+    uint8_t* l4h = ip + 20;
+    if (proto == 6) {
+        put16be(l4h, rec.srcPort);
+        put16be(l4h + 2, rec.dstPort);
+        l4h[12] = 5 << 4;
+        l4h[13] = 0x18;  // PSH, ACK
+        put16be(l4h + 14, 65535);
+    } else if (proto == 17) {
+        put16be(l4h, rec.srcPort);
+        put16be(l4h + 2, rec.dstPort);
+        put16be(l4h + 4, static_cast<uint16_t>(ipLength - 20));
+    } else if (proto == 1) {
+        l4h[0] = 8;  // echo request
+    }
+    const size_t headerBytes = l2 + 20 + l4;
+
+    const uint32_t original = static_cast<uint32_t>(l2 + ipLength);
+    const uint32_t captured = std::min(original, m_options.snapLength);
+    const size_t length = 32 + pad4(captured);
+    char* p = reserve(length, false);
+    if (!p) {
+        m_stats.dropped++;
+        return;
+    }
+    put<uint32_t>(p, BlockEpb);
+    put<uint32_t>(p, static_cast<uint32_t>(length));
+    put<uint32_t>(p, tap);
+    put<uint32_t>(p, static_cast<uint32_t>(static_cast<uint64_t>(time) >> 32));
+    put<uint32_t>(p, static_cast<uint32_t>(time));
+    put<uint32_t>(p, captured);
+    put<uint32_t>(p, original);
+    const size_t copied = std::min<size_t>(headerBytes, captured);
+    std::memcpy(p, header, copied);
+    std::memset(p + copied, 0, pad4(captured) - copied);
+    p += pad4(captured);
+    put<uint32_t>(p, static_cast<uint32_t>(length));
+    m_stats.captured++;
+}
+
+char* PacketCapture::reserve(size_t bytes, bool wait) {
+    if (m_used[m_active] + bytes > m_buffers[m_active].size()) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_pending >= 0) {
+            if (!wait) return nullptr;
+            m_done.wait(lock, [this] { return m_pending < 0; });
+        }
+        handOff(lock);
+    }
+    char* p = m_buffers[m_active].data() + m_used[m_active];
+    m_used[m_active] += bytes;
+    return p;
+}
+
+void PacketCapture::handOff(std::unique_lock<std::mutex>&) {
+    // Wywoływane z blokadą i wolnym wątkiem zapisu; drugi bufor jest już opróżniony
+    m_pending = m_active;
+    m_active ^= 1;
+    m_stats.flushes++;
+    m_ready.notify_one();
+}
+
+void PacketCapture::writerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_ready.wait(lock, [this] { return m_pending >= 0 || m_stop; });
+        if (m_pending < 0) return;
+        const int index = m_pending;
+        const size_t bytes = m_used[index];
+        lock.unlock();
+        size_t written = std::fwrite(m_buffers[index].data(), 1, bytes, m_file);
+        m_bytesWritten += written;
+        lock.lock();
+        m_used[index] = 0;
+        m_pending = -1;
+        m_done.notify_all();
+    }
+}
+
+void PacketCapture::close() {
+    if (m_closed) return;
+    m_closed = true;
+    if (m_writer.joinable()) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock, [this] { return m_pending < 0; });
+            if (m_used[m_active] > 0) {
+                handOff(lock);
+                m_done.wait(lock, [this] { return m_pending < 0; });
+            }
+            m_stop = true;
+        }
+        m_ready.notify_one();
+        m_writer.join();
+    }
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+CaptureStats PacketCapture::stats() const {
+    CaptureStats stats = m_stats;
+    stats.bytesWritten = m_bytesWritten.load();
+    return stats;
+}
+
+} // namespace sim
+} // namespace netsim
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "PacketSimulator.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace netsim {
+namespace sim {
+
+/**
+ * @brief Capture filter compiled once into a postfix predicate program
+ *
+ * Grammar (tcpdump-like): primitives joined with and/or/not (&&, ||, !)
+ * and parentheses; "and" binds tighter than "or":
+ *   [src|dst] host NAME|IP    - node name or Node::getIp address
+ *   [src|dst] port N
+ *   vlan N                    - VLAN of the sending node (Network::assignVLAN)
+ *   tcp | udp | icmp | ip     - "ip" matches every packet
+ * Hosts are resolved to NodeIds at compile time, so matching is a short
+ * loop over integer comparisons on a bit stack without allocations.
+ */
+class CaptureFilter {
+public:
+    CaptureFilter() = default;                  // pusty filtr przepuszcza wszystko
+
+    // Rzuca std::runtime_error dla błędu składni lub nieznanego hosta
+    static CaptureFilter compile(const std::string& expression, const Network& net);
+
+    bool matches(const PacketRecord& rec, uint16_t vlan) const;
+    bool empty() const { return m_program.empty(); }
+
+private:
+    enum class Op : uint8_t { Host, SrcHost, DstHost, Port, SrcPort, DstPort, Vlan, Proto, True, And, Or, Not };
+    struct Instr {
+        Op op;
+        uint32_t arg;
+    };
+
+    struct Parser;
+    std::vector<Instr> m_program;
+};
+
+struct CaptureOptions {
+    std::string filter;                         // pusty = wszystkie pakiety
+    size_t bufferBytes = 4 << 20;               // rozmiar każdego z dwóch buforów
+    uint32_t snapLength = 128;                  // bajty ramki zapisywane na pakiet
+};
+
+struct CaptureStats {
+    uint64_t seen = 0;                          // pakiety w punktach przechwytywania
+    uint64_t filtered = 0;                      // odrzucone przez filtr
+    uint64_t captured = 0;                      // zapisane bloki EPB
+    uint64_t dropped = 0;                       // oba bufory zajęte - dysk nie nadąża
+    uint64_t bytesWritten = 0;
+    uint64_t flushes = 0;                       // bufory przekazane wątkowi zapisu
+};
+
+/**
+ * @brief pcapng writer fed by PacketSimulator taps on nodes and links
+ *
+ * Every tap is one pcapng interface ("node A", "link A->B") with nanosecond
+ * timestamps. A captured packet becomes an Enhanced Packet Block holding a
+ * synthesized frame: Ethernet (802.1Q tag when the sender is in a VLAN),
+ * IPv4 with the node addresses and TTL, and a TCP/UDP/ICMP header with the
+ * record's ports, cut to snapLength; the original length is the packet size
+ * plus the Ethernet header.
+ *
+ * Blocks are appended to the active of two preallocated buffers. A full
+ * buffer is handed to a writer thread and the simulation continues in the
+ * other one; when both are taken the packet is dropped and counted instead
+ * of blocking or growing, so memory stays at 2 * bufferBytes.
+ */
+class PacketCapture {
+public:
+    static constexpr uint32_t NoTap = UINT32_MAX;
+
+    // Rzuca std::runtime_error gdy pliku nie da się utworzyć lub filtr jest błędny
+    PacketCapture(const Network& net, const std::string& path, const CaptureOptions& options = CaptureOptions());
+    ~PacketCapture();
+    PacketCapture(const PacketCapture&) = delete;
+    PacketCapture& operator=(const PacketCapture&) = delete;
+
+    // Taps dodawane przed pierwszym pakietem; zwracają numer interfejsu pcapng
+    uint32_t tapNode(const std::string& node);
+    uint32_t tapLink(const std::string& from, const std::string& to);  // jeden kierunek
+    void tapAllNodes();
+
+    struct Tap {
+        NodeId from = 0;
+        NodeId to = GraphSnapshot::InvalidNode;  // InvalidNode = tap węzła
+    };
+    const std::vector<Tap>& taps() const { return m_taps; }
+
+    // Wywoływane przez PacketSimulator
+    void capture(uint32_t tap, SimTime time, const PacketRecord& rec);
+
+    // Zapisuje resztę bufora i kończy wątek; kolejne pakiety są ignorowane
+    void close();
+    CaptureStats stats() const;
+    const std::string& path() const { return m_path; }
+
+private:
+    const Network& m_net;
+    std::string m_path;
+    CaptureOptions m_options;
+    CaptureFilter m_filter;
+    std::vector<Tap> m_taps;
+    std::vector<uint32_t> m_ipOf;               // NodeId -> IPv4 (host order)
+    std::vector<uint16_t> m_vlanOf;             // NodeId -> VLAN (0 = brak)
+    CaptureStats m_stats;
+    bool m_started = false;
+    bool m_closed = false;
+
+    // Podwójne buforowanie: m_active należy do symulacji, drugi może być u wątku zapisu
+    std::vector<char> m_buffers[2];
+    size_t m_used[2] = {0, 0};
+    int m_active = 0;
+    int m_pending = -1;                         // bufor czekający na zapis lub zapisywany
+    bool m_stop = false;
+    std::FILE* m_file = nullptr;
+    std::atomic<uint64_t> m_bytesWritten{0};
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::condition_variable m_done;
+    std::thread m_writer;
+
+    uint32_t addTap(NodeId from, NodeId to, const std::string& name);
+    NodeId nodeId(const std::string& name) const;
+    // wait = true tylko przy konfiguracji (SHB, IDB); w trakcie symulacji brak miejsca = drop
+    char* reserve(size_t bytes, bool wait);
+    void handOff(std::unique_lock<std::mutex>& lock);
+    void writerLoop();
+};
+
+} // namespace sim
+} // namespace netsim
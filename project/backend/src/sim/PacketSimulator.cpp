@@ -0,0 +1,553 @@
+#include "PacketSimulator.hpp"
+#include "PacketCapture.hpp"
+#include "../utils/Parallel.hpp"
+#include "../utils/SpscChannel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace netsim {
+namespace sim {
+
+namespace {
+
+constexpr SimTime MaxTime = std::numeric_limits<SimTime>::max();
+
+// Pakiet przekazywany do innej partycji (przybycie do węzła w chwili time)
+struct CrossEvent {
+    SimTime time = 0;
+    PacketId id = 0;
+    NodeId node = 0;
+};
+
+// Klucz kolejności zdarzeń o równym czasie - niezależny od podziału na partycje
+inline uint64_t arriveOrder(PacketId id) { return static_cast<uint64_t>(id) << 1; }
+inline uint64_t txDoneOrder(PacketId id) { return (static_cast<uint64_t>(id) << 1) | 1; }
+// Timery po wszystkich zdarzeniach pakietów o tym samym czasie
+inline uint64_t timerOrder(uint64_t seq) { return (uint64_t(1) << 63) | seq; }
+
+} // namespace
+
+struct PacketSimulator::Partition {
+    uint32_t index = 0;
+    EventScheduler scheduler;
+    EventType arriveEvent = 0;
+    EventType txDoneEvent = 0;
+    std::vector<QueueItem> aqmDropped;      // bufor na odrzucenia CoDel przy wyjmowaniu
+    SimTime lastEventTime = 0;
+    PacketSimStats stats;
+    std::unordered_map<NodeId, std::vector<uint32_t>> routes; // dst -> (węzeł -> arc)
+    std::vector<std::unique_ptr<utils::SpscChannel<CrossEvent>>> inbox; // od każdej partycji
+};
+
+PacketSimulator::PacketSimulator(const Network& net, const PacketSimOptions& options)
+    : m_graph(GraphSnapshot::fromNetwork(net)), m_options(options) {
+    const size_t n = m_graph.nodeCount();
+    const size_t arcs = m_graph.arcCount();
+
+    m_queueCapacity.assign(n, 0);
+    for (NodeId u = 0; u < n; ++u) {
+        if (!m_graph.present[u]) continue;
+        int capacity = options.defaultQueueSize >= 0 ? options.defaultQueueSize
+                                                     : net.findById(u)->getMaxQueueSize();
+        m_queueCapacity[u] = static_cast<uint32_t>(std::max(capacity, 0));
+    }
+    m_nodeQueued.assign(n, 0);
+
+    m_txBusy.assign(arcs, 0);
+    m_queueHead.assign(arcs, NoPacket);
+    m_queueTail.assign(arcs, NoPacket);
+    m_portQueues.resize(arcs);
+    for (NodeId u = 0; u < n; ++u) {
+        if (!m_graph.present[u]) continue;
+        QueueConfig config = net.findById(u)->getQueueConfig();
+        if (config.type == QueueDisciplineType::DropTail) continue;
+        config.capacity = m_queueCapacity[u];
+        for (uint32_t a = m_graph.offsets[u]; a < m_graph.offsets[u + 1]; ++a) {
+            config.seed = options.seed ^ (static_cast<uint64_t>(a) * 0x9e3779b97f4a7c15ull);
+            m_portQueues[a] = QueueDiscipline::create(config);
+        }
+    }
+    m_bandwidthMbps.resize(arcs);
+    m_propagation.resize(arcs);
+    for (uint32_t a = 0; a < arcs; ++a) {
+        int bw = m_graph.bandwidth[a] > 0 ? m_graph.bandwidth[a] : options.defaultBandwidthMbps;
+        m_bandwidthMbps[a] = static_cast<uint32_t>(std::max(bw, 0));
+        m_propagation[a] = static_cast<SimTime>(std::max(m_graph.delayMs[a], 0)) * Millisecond;
+    }
+
+    const unsigned count = std::max(1u, options.partitions);
+    if (options.recyclePacketIds && count > 1) throw std::runtime_error("Packet id recycling requires partitions == 1");
+    for (unsigned p = 0; p < count; ++p) {
+        auto part = std::make_unique<Partition>();
+        Partition* raw = part.get();
+        part->index = p;
+        part->arriveEvent = part->scheduler.registerHandler([this, raw](const Event& ev) {
+            raw->lastEventTime = ev.time;
+            onArrive(*raw, static_cast<PacketId>(ev.arg0), static_cast<NodeId>(ev.arg1));
+        });
+        part->txDoneEvent = part->scheduler.registerHandler([this, raw](const Event& ev) {
+            raw->lastEventTime = ev.time;
+            onTxDone(*raw, static_cast<PacketId>(ev.arg0), static_cast<uint32_t>(ev.arg1));
+        });
+        for (unsigned q = 0; q < count; ++q)
+            part->inbox.push_back(std::make_unique<utils::SpscChannel<CrossEvent>>());
+        m_partitions.push_back(std::move(part));
+    }
+    assignPartitions();
+}
+
+PacketSimulator::~PacketSimulator() = default;
+
+void PacketSimulator::assignPartitions() {
+    const size_t n = m_graph.nodeCount();
+    const uint32_t count = static_cast<uint32_t>(m_partitions.size());
+
+    if (!m_options.partitionOf.empty()) {
+        if (m_options.partitionOf.size() != n) throw std::runtime_error("partitionOf must cover every NodeId");
+        for (uint32_t p : m_options.partitionOf)
+            if (p >= count) throw std::runtime_error("Partition index out of range");
+        m_partitionOf = m_options.partitionOf;
+    } else {
+        // Grupy węzłów połączonych łączami o zerowym opóźnieniu muszą trafić do jednej partycji
+        std::vector<NodeId> group(n);
+        std::iota(group.begin(), group.end(), 0);
+        auto find = [&](NodeId x) {
+            while (group[x] != x) x = group[x] = group[group[x]];
+            return x;
+        };
+        for (NodeId u = 0; u < n; ++u)
+            for (uint32_t a = m_graph.offsets[u]; a < m_graph.offsets[u + 1]; ++a)
+                if (m_propagation[a] == 0) group[find(u)] = find(m_graph.targets[a]);
+
+        // Spójne kawałki w kolejności BFS, po ~n/count węzłów
+        size_t present = 0;
+        for (NodeId u = 0; u < n; ++u) present += m_graph.present[u];
+        const size_t target = std::max<size_t>(1, (present + count - 1) / count);
+        std::vector<uint32_t> groupPartition(n, UINT32_MAX);
+        std::vector<uint8_t> seen(n, 0);
+        std::vector<NodeId> order;
+        m_partitionOf.assign(n, 0);
+        uint32_t current = 0;
+        size_t filled = 0;
+        for (NodeId root = 0; root < n; ++root) {
+            if (seen[root] || !m_graph.present[root]) continue;
+            seen[root] = 1;
+            order.assign(1, root);
+            for (size_t head = 0; head < order.size(); ++head) {
+                NodeId u = order[head];
+                NodeId g = find(u);
+                if (groupPartition[g] == UINT32_MAX) {
+                    if (filled >= target * (current + 1) && current + 1 < count) current++;
+                    groupPartition[g] = current;
+                }
+                m_partitionOf[u] = groupPartition[g];
+                filled++;
+                for (uint32_t a = m_graph.offsets[u]; a < m_graph.offsets[u + 1]; ++a) {
+                    NodeId v = m_graph.targets[a];
+                    if (!seen[v]) { seen[v] = 1; order.push_back(v); }
+                }
+            }
+        }
+    }
+
+    // Lookahead = najmniejsze opóźnienie propagacji łącza między partycjami
+    m_lookahead = MaxTime;
+    for (NodeId u = 0; u < n; ++u) {
+        for (uint32_t a = m_graph.offsets[u]; a < m_graph.offsets[u + 1]; ++a) {
+            if (m_partitionOf[u] == m_partitionOf[m_graph.targets[a]]) continue;
+            if (m_propagation[a] == 0)
+                throw std::runtime_error("Zero-delay link crosses partitions: " + m_graph.nameOf(u) +
+                                         " - " + m_graph.nameOf(m_graph.targets[a]));
+            m_lookahead = std::min(m_lookahead, m_propagation[a]);
+        }
+    }
+}
+
+PacketId PacketSimulator::inject(NodeId src, NodeId dst, uint32_t sizeBytes, SimTime at, uint8_t ttl, uint8_t priority) {
+    if (src >= m_graph.nodeCount() || !m_graph.present[src] ||
+        dst >= m_graph.nodeCount() || !m_graph.present[dst])
+        throw std::runtime_error("Unknown packet endpoint");
+    if (m_freeIds.empty() && m_packets.size() >= NoPacket) throw std::runtime_error("Too many packets");
+
+    PacketId id = static_cast<PacketId>(m_packets.size());
+    if (!m_freeIds.empty()) {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    }
+    Partition& part = *m_partitions[m_partitionOf[src]];
+    part.scheduler.scheduleOrdered(at, arriveOrder(id), part.arriveEvent, id, src);
+
+    PacketRecord rec;
+    rec.src = src;
+    rec.dst = dst;
+    rec.location = src;
+    rec.sizeBytes = sizeBytes;
+    rec.ttl = ttl;
+    rec.priority = priority;
+    rec.sentAt = at;
+    rec.serial = m_injected;
+    if (id < m_packets.size()) {
+        m_packets[id] = rec;
+    } else {
+        m_packets.push_back(rec);
+        m_nextInQueue.push_back(NoPacket);
+        m_enqueuedAt.push_back(0);
+    }
+    m_injected++;
+    m_stats.injected = m_injected;
+    return id;
+}
+
+PacketId PacketSimulator::inject(const Packet& pkt, SimTime at) {
+    uint8_t ttl = static_cast<uint8_t>(std::min(std::max(pkt.ttl, 0), 255));
+    uint8_t priority = static_cast<uint8_t>(std::min(std::max(pkt.priority, 0), 255));
+    PacketId id = inject(m_graph.idOf(pkt.src), m_graph.idOf(pkt.dest),
+                         static_cast<uint32_t>(40 + pkt.payload.size()), at, ttl, priority);
+    m_packets[id].protocol = pkt.protocol.kind();
+    return id;
+}
+
+void PacketSimulator::setFlow(PacketId id, Protocol protocol, uint16_t srcPort, uint16_t dstPort) {
+    PacketRecord& rec = m_packets.at(id);
+    rec.protocol = protocol;
+    rec.srcPort = srcPort;
+    rec.dstPort = dstPort;
+}
+
+size_t PacketSimulator::runUntil(SimTime until) {
+    size_t fired;
+    if (m_partitions.size() == 1) {
+        fired = m_partitions[0]->scheduler.runUntil(until);
+    } else {
+        fired = runParallel(until);
+        for (auto& part : m_partitions) part->scheduler.runUntil(until); // wyrównaj zegary
+    }
+    m_now = std::max(m_now, until);
+    collectStats();
+    return fired;
+}
+
+size_t PacketSimulator::run() {
+    size_t fired;
+    if (m_partitions.size() == 1) {
+        fired = m_partitions[0]->scheduler.run();
+        m_now = m_partitions[0]->scheduler.now();
+    } else {
+        fired = runParallel(MaxTime);
+        for (auto& part : m_partitions) m_now = std::max(m_now, part->lastEventTime);
+    }
+    collectStats();
+    return fired;
+}
+
+SimTime PacketSimulator::now() const {
+    // W trakcie run() (callbacki, timery) zegar schedulera jest aktualny, m_now dopiero po
+    return m_partitions.size() == 1 ? std::max(m_now, m_partitions[0]->scheduler.now()) : m_now;
+}
+
+EventScheduler& PacketSimulator::sequentialScheduler() {
+    if (m_partitions.size() != 1) throw std::runtime_error("Callbacks and timers require partitions == 1");
+    return m_partitions[0]->scheduler;
+}
+
+void PacketSimulator::setPacketCallback(PacketCallback callback) {
+    sequentialScheduler();
+    m_packetCallback = std::move(callback);
+}
+
+void PacketSimulator::setCapture(PacketCapture* capture) {
+    sequentialScheduler();
+    if (!capture) {
+        m_capture = nullptr;
+        return;
+    }
+    std::vector<uint32_t> nodes(m_graph.nodeCount(), PacketCapture::NoTap);
+    std::vector<uint32_t> arcs(m_graph.targets.size(), PacketCapture::NoTap);
+    const auto& taps = capture->taps();
+    for (uint32_t tap = 0; tap < taps.size(); ++tap) {
+        if (taps[tap].from >= m_graph.nodeCount()) throw std::runtime_error("Capture tap on unknown node");
+        if (taps[tap].to == GraphSnapshot::InvalidNode) {
+            nodes[taps[tap].from] = tap;
+            continue;
+        }
+        uint32_t arc = taps[tap].to < m_graph.nodeCount() ? m_graph.findArc(taps[tap].from, taps[tap].to) : NoArc;
+        if (arc == NoArc) throw std::runtime_error("Capture tap on missing link");
+        arcs[arc] = tap;
+    }
+    m_captureNode = std::move(nodes);
+    m_captureArc = std::move(arcs);
+    m_capture = capture;
+}
+
+EventType PacketSimulator::registerTimer(EventHandler handler) {
+    Partition* part = m_partitions[0].get();
+    return sequentialScheduler().registerHandler([part, handler = std::move(handler)](const Event& ev) {
+        part->lastEventTime = ev.time;
+        handler(ev);
+    });
+}
+
+EventId PacketSimulator::scheduleTimer(SimTime at, EventType type, uint64_t arg0, uint64_t arg1) {
+    return sequentialScheduler().scheduleOrdered(at, timerOrder(m_timerSeq++), type, arg0, arg1);
+}
+
+bool PacketSimulator::cancelTimer(EventId id) {
+    return sequentialScheduler().cancel(id);
+}
+
+size_t PacketSimulator::runParallel(SimTime until) {
+    const size_t count = m_partitions.size();
+    std::vector<SimTime> next(count, MaxTime);
+    std::vector<size_t> fired(count, 0);
+    utils::Barrier barrier(static_cast<unsigned>(count));
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    // Zapisywane tylko przed pierwszą barierą okna, czytane tylko po niej - wszystkie wątki
+    // widzą te same błędy i razem kończą pętlę (inaczej ktoś czekałby sam na drugiej barierze)
+    std::atomic<bool> failed{false};
+    auto fail = [&]() {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = std::current_exception();
+    };
+
+    auto worker = [&](unsigned p) {
+        Partition& part = *m_partitions[p];
+        bool failedHere = false;
+        while (true) {
+            // Pakiety z innych partycji wysłane w poprzednim oknie
+            try {
+                CrossEvent ev;
+                for (auto& channel : part.inbox)
+                    while (channel->pop(ev))
+                        part.scheduler.scheduleOrdered(ev.time, arriveOrder(ev.id), part.arriveEvent, ev.id, ev.node);
+            } catch (...) {
+                fail();
+                failedHere = true;
+            }
+            SimTime t;
+            next[p] = part.scheduler.nextEventTime(t) ? t : MaxTime;
+            if (failedHere) failed.store(true, std::memory_order_relaxed);
+            barrier.wait();
+
+            SimTime windowStart = *std::min_element(next.begin(), next.end());
+            if (failed.load(std::memory_order_relaxed) || windowStart == MaxTime || windowStart > until) break;
+            // Okno [T, T + L): zdarzenia innych partycji nie mogą do niego trafić
+            SimTime windowEnd = until - windowStart < m_lookahead ? until : windowStart + m_lookahead - 1;
+            try {
+                fired[p] += part.scheduler.runUntil(windowEnd);
+            } catch (...) {
+                fail();
+                failedHere = true;     // ogłaszane przed pierwszą barierą następnego okna
+            }
+            barrier.wait();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned p = 1; p < count; ++p) threads.emplace_back(worker, p);
+    worker(0);
+    for (auto& t : threads) t.join();
+    if (error) std::rethrow_exception(error);
+    return std::accumulate(fired.begin(), fired.end(), size_t(0));
+}
+
+void PacketSimulator::collectStats() {
+    m_stats = PacketSimStats();
+    m_stats.injected = m_injected;
+    for (const auto& part : m_partitions) {
+        m_stats.delivered += part->stats.delivered;
+        m_stats.droppedQueue += part->stats.droppedQueue;
+        m_stats.droppedLoss += part->stats.droppedLoss;
+        m_stats.droppedTtl += part->stats.droppedTtl;
+        m_stats.droppedAqm += part->stats.droppedAqm;
+        m_stats.noRoute += part->stats.noRoute;
+        m_stats.hops += part->stats.hops;
+        m_stats.totalLatency += part->stats.totalLatency;
+    }
+}
+
+const std::vector<uint32_t>& PacketSimulator::routesTo(Partition& part, NodeId dst) {
+    auto it = part.routes.find(dst);
+    if (it != part.routes.end()) return it->second;
+
+    // Dijkstra od celu: klucz = (opóźnienie, liczba hopów), łącza są symetryczne
+    const size_t n = m_graph.nodeCount();
+    std::vector<uint32_t> next(n, NoArc);
+    std::vector<uint64_t> dist(n, UINT64_MAX);
+    using Entry = std::pair<uint64_t, NodeId>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    if (m_graph.isUsable(dst)) {
+        dist[dst] = 0;
+        heap.push({0, dst});
+    }
+    while (!heap.empty()) {
+        auto [d, u] = heap.top();
+        heap.pop();
+        if (d > dist[u]) continue;
+        for (uint32_t a = m_graph.offsets[u]; a < m_graph.offsets[u + 1]; ++a) {
+            NodeId v = m_graph.targets[a];
+            if (!m_graph.isUsable(v)) continue;
+            uint64_t nd = d + (static_cast<uint64_t>(std::max(m_graph.delayMs[a], 0)) << 20) + 1;
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                next[v] = m_graph.reverse[a];
+                heap.push({nd, v});
+            }
+        }
+    }
+    return part.routes.emplace(dst, std::move(next)).first->second;
+}
+
+void PacketSimulator::onArrive(Partition& part, PacketId id, NodeId node) {
+    PacketRecord& rec = m_packets[id];
+    rec.location = node;
+    if (m_capture && m_captureNode[node] != PacketCapture::NoTap)
+        m_capture->capture(m_captureNode[node], part.scheduler.now(), rec);
+    if (!m_graph.isUsable(node)) {
+        finish(part, id, PacketStatus::NoRoute);
+        return;
+    }
+    if (node == rec.dst) {
+        finish(part, id, PacketStatus::Delivered);
+        return;
+    }
+    if (rec.hops >= rec.ttl) {
+        finish(part, id, PacketStatus::DroppedTtl);
+        return;
+    }
+    uint32_t arc = routesTo(part, rec.dst)[node];
+    if (arc == NoArc) {
+        finish(part, id, PacketStatus::NoRoute);
+        return;
+    }
+
+    if (!m_txBusy[arc]) {
+        startTx(part, id, arc);
+    } else if (QueueDiscipline* queue = m_portQueues[arc].get()) {
+        QueueItem item;
+        item.handle = id;
+        item.sizeBytes = rec.sizeBytes;
+        item.flow = rec.src * 0x9e3779b1u ^ rec.dst;
+        item.priority = rec.priority;
+        switch (queue->enqueue(item, part.scheduler.now())) {
+        case EnqueueResult::Queued: m_nodeQueued[node]++; break;
+        case EnqueueResult::DroppedOverflow: finish(part, id, PacketStatus::DroppedQueue); break;
+        case EnqueueResult::DroppedEarly: finish(part, id, PacketStatus::DroppedAqm); break;
+        }
+    } else if (m_nodeQueued[node] < m_queueCapacity[node]) {
+        m_nodeQueued[node]++;
+        m_enqueuedAt[id] = part.scheduler.now();
+        m_nextInQueue[id] = NoPacket;
+        if (m_queueTail[arc] != NoPacket) m_nextInQueue[m_queueTail[arc]] = id;
+        else m_queueHead[arc] = id;
+        m_queueTail[arc] = id;
+    } else {
+        finish(part, id, PacketStatus::DroppedQueue);
+    }
+}
+
+void PacketSimulator::startTx(Partition& part, PacketId id, uint32_t arc) {
+    m_txBusy[arc] = 1;
+    if (m_capture && m_captureArc[arc] != PacketCapture::NoTap)
+        m_capture->capture(m_captureArc[arc], part.scheduler.now(), m_packets[id]);
+    SimTime serialization = 0;
+    if (m_bandwidthMbps[arc] > 0)
+        serialization = static_cast<SimTime>(m_packets[id].sizeBytes) * 8000 / m_bandwidthMbps[arc];
+    part.scheduler.scheduleOrdered(part.scheduler.now() + serialization, txDoneOrder(id), part.txDoneEvent, id, arc);
+}
+
+void PacketSimulator::onTxDone(Partition& part, PacketId id, uint32_t arc) {
+    PacketRecord& rec = m_packets[id];
+    rec.hops++;
+    part.stats.hops++;
+    if (lossDraw(rec.serial, rec.hops, m_graph.loss[arc])) {
+        finish(part, id, PacketStatus::DroppedLoss);
+    } else {
+        NodeId target = m_graph.targets[arc];
+        SimTime arrival = part.scheduler.now() + m_propagation[arc];
+        uint32_t owner = m_partitionOf[target];
+        if (owner == part.index)
+            part.scheduler.scheduleOrdered(arrival, arriveOrder(id), part.arriveEvent, id, target);
+        else
+            m_partitions[owner]->inbox[part.index]->push({arrival, id, target});
+    }
+
+    if (m_portQueues[arc]) {
+        dequeuePort(part, arc);
+        return;
+    }
+
+    // Nadajnik bierze kolejny pakiet z FIFO łącza
+    PacketId waiting = m_queueHead[arc];
+    if (waiting == NoPacket) {
+        m_txBusy[arc] = 0;
+        return;
+    }
+    m_queueHead[arc] = m_nextInQueue[waiting];
+    if (m_queueHead[arc] == NoPacket) m_queueTail[arc] = NoPacket;
+    NodeId node = m_packets[waiting].location;
+    m_nodeQueued[node]--;
+    m_packets[waiting].queueingDelay += part.scheduler.now() - m_enqueuedAt[waiting];
+    startTx(part, waiting, arc);
+}
+
+void PacketSimulator::dequeuePort(Partition& part, uint32_t arc) {
+    const SimTime now = part.scheduler.now();
+    QueueItem item;
+    part.aqmDropped.clear();
+    bool found = m_portQueues[arc]->dequeue(now, item, &part.aqmDropped);
+    for (const QueueItem& dropped : part.aqmDropped) {
+        m_nodeQueued[m_packets[dropped.handle].location]--;
+        m_packets[dropped.handle].queueingDelay += now - dropped.enqueuedAt;
+        finish(part, dropped.handle, PacketStatus::DroppedAqm);
+    }
+    if (!found) {
+        m_txBusy[arc] = 0;
+        return;
+    }
+    m_nodeQueued[m_packets[item.handle].location]--;
+    m_packets[item.handle].queueingDelay += now - item.enqueuedAt;
+    startTx(part, item.handle, arc);
+}
+
+void PacketSimulator::finish(Partition& part, PacketId id, PacketStatus status) {
+    PacketRecord& rec = m_packets[id];
+    rec.status = status;
+    rec.finishedAt = part.scheduler.now();
+    switch (status) {
+    case PacketStatus::Delivered:
+        part.stats.delivered++;
+        part.stats.totalLatency += rec.latency();
+        break;
+    case PacketStatus::DroppedQueue: part.stats.droppedQueue++; break;
+    case PacketStatus::DroppedLoss: part.stats.droppedLoss++; break;
+    case PacketStatus::DroppedTtl: part.stats.droppedTtl++; break;
+    case PacketStatus::DroppedAqm: part.stats.droppedAqm++; break;
+    case PacketStatus::NoRoute: part.stats.noRoute++; break;
+    case PacketStatus::InFlight: break;
+    }
+    if (m_packetCallback) m_packetCallback(id);
+    if (m_options.recyclePacketIds) m_freeIds.push_back(id);
+}
+
+bool PacketSimulator::lossDraw(uint64_t serial, uint16_t hop, double loss) const {
+    if (loss <= 0.0) return false;
+    // Losowanie haszowane z (seed, numer wstrzyknięcia, hop) - ten sam wynik w każdej partycji
+    // i kolejności; numer, a nie id, bo id wraca do puli przy recyclePacketIds
+    uint64_t z = m_options.seed ^ (serial * 0x9e3779b97f4a7c15ull) ^
+                 (static_cast<uint64_t>(hop) << 48);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z ^= z >> 31;
+    return (z >> 11) * 0x1.0p-53 < loss;
+}
+
+} // namespace sim
+} // namespace netsim
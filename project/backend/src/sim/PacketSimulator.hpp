@@ -0,0 +1,200 @@
+#pragma once
+
+#include "EventScheduler.hpp"
+#include "../core/GraphSnapshot.hpp"
+#include "../core/QueueDiscipline.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace netsim {
+namespace sim {
+
+using PacketId = uint32_t;
+
+enum class PacketStatus : uint8_t {
+    InFlight,
+    Delivered,
+    DroppedQueue,   // pełna kolejka węzła
+    DroppedLoss,    // packetLoss na łączu
+    DroppedTtl,
+    DroppedAqm,     // odrzucony przez RED / CoDel
+    NoRoute         // brak trasy lub węzeł failed
+};
+
+/**
+ * @brief Per-packet latency record
+ */
+struct PacketRecord {
+    NodeId src = 0;
+    NodeId dst = 0;
+    NodeId location = 0;          // ostatni węzeł, do którego dotarł pakiet
+    uint32_t sizeBytes = 0;
+    uint16_t hops = 0;
+    uint8_t ttl = 64;
+    uint8_t priority = 0;         // pasmo dyscypliny StrictPriority
+    PacketStatus status = PacketStatus::InFlight;
+    Protocol protocol = Protocol::Other;  // tylko dla przechwytywania i filtrów
+    uint16_t srcPort = 0;
+    uint16_t dstPort = 0;
+    SimTime sentAt = 0;
+    SimTime finishedAt = 0;       // dostarczenie albo utrata
+    SimTime queueingDelay = 0;    // suma czasu oczekiwania w kolejkach
+    uint64_t serial = 0;          // numer wstrzyknięcia; w przeciwieństwie do id nie wraca przy recyklingu
+
+    SimTime latency() const { return finishedAt - sentAt; }
+};
+
+struct PacketSimStats {
+    uint64_t injected = 0;
+    uint64_t delivered = 0;
+    uint64_t droppedQueue = 0;
+    uint64_t droppedLoss = 0;
+    uint64_t droppedTtl = 0;
+    uint64_t droppedAqm = 0;
+    uint64_t noRoute = 0;
+    uint64_t hops = 0;             // przejścia pakietów przez łącza
+    SimTime totalLatency = 0;      // suma opóźnień dostarczonych pakietów
+
+    double averageLatencyNs() const { return delivered ? double(totalLatency) / delivered : 0.0; }
+};
+
+using PacketCallback = std::function<void(PacketId)>;
+
+class PacketCapture;
+
+struct PacketSimOptions {
+    uint64_t seed = 1;                  // ziarno losowania packetLoss
+    int defaultBandwidthMbps = 0;       // łącza bez setBandwidth (0 = bez opóźnienia serializacji)
+    int defaultQueueSize = -1;          // -1 = Node::getMaxQueueSize() każdego węzła
+    unsigned partitions = 1;            // > 1 = równoległa symulacja, jeden wątek na partycję
+    std::vector<uint32_t> partitionOf;  // opcjonalny podział NodeId -> partycja
+    // Tylko partitions == 1: id zakończonego pakietu wraca do puli po callbacku, więc pamięć
+    // zależy od liczby pakietów w locie, nie od liczby wysłanych (rekord żyje do ponownego użycia)
+    bool recyclePacketIds = false;
+};
+
+/**
+ * @brief Hop-by-hop packet-level simulation over a GraphSnapshot
+ *
+ * Packets follow shortest-delay routes (next-hop tables are built lazily per
+ * destination) and at every hop pay:
+ *  - serialization: size / link bandwidth, one transmitter per link direction;
+ *  - queueing: packets waiting for a busy transmitter occupy the sending
+ *    node's shared buffer of Node::maxQueueSize packets, overflow is dropped;
+ *    a node configured with another queue discipline (Node::setQueueDiscipline)
+ *    gets one instance of it per outgoing link instead, each holding
+ *    maxQueueSize packets, which decides the transmission order and drops;
+ *  - propagation: the link delay;
+ *  - loss: a Bernoulli draw with the link's packetLoss.
+ * Events run on an EventScheduler; packets are plain records indexed by
+ * PacketId and link FIFOs are intrusive lists through those records, so a
+ * hop does not allocate.
+ *
+ * With partitions > 1 the nodes are split into partitions, each with its own
+ * scheduler and worker thread (conservative, window-based synchronization):
+ * the lookahead L is the smallest propagation delay of a link crossing
+ * partitions, so all events in [T, T + L) - T being the global next event
+ * time - are independent and every partition runs them in parallel. Packets
+ * crossing partitions travel through lock-free SPSC channels and are
+ * scheduled after the window barrier. Equal-time events are ordered by
+ * packet id and loss draws are hashed from (seed, packet, hop), so results
+ * do not depend on the partitioning and match the sequential run exactly.
+ * Zero-delay links are never cut.
+ *
+ * A PacketCapture attached with setCapture sees packets arriving at tapped
+ * nodes and starting transmission on tapped link directions; without one the
+ * hot path pays a single null-pointer test.
+ */
+class PacketSimulator {
+public:
+    PacketSimulator(const Network& net, const PacketSimOptions& options = PacketSimOptions());
+    ~PacketSimulator();
+    PacketSimulator(const PacketSimulator&) = delete;
+    PacketSimulator& operator=(const PacketSimulator&) = delete;
+
+    PacketId inject(NodeId src, NodeId dst, uint32_t sizeBytes, SimTime at, uint8_t ttl = 64, uint8_t priority = 0);
+    // Rozmiar = nagłówek 40 B + payload, TTL, priorytet i protokół z pakietu
+    PacketId inject(const Packet& pkt, SimTime at);
+    // Protokół i porty widoczne w przechwytywaniu (PacketCapture) i filtrach
+    void setFlow(PacketId id, Protocol protocol, uint16_t srcPort, uint16_t dstPort);
+
+    // Zwraca liczbę wykonanych zdarzeń
+    size_t runUntil(SimTime until);
+    size_t run();
+    SimTime now() const;
+
+    // Protokoły nad symulacją (tylko partitions == 1): callback przy dostarczeniu lub utracie
+    // pakietu oraz timery na tej samej kolejce zdarzeń. Timery o równym czasie wykonują się
+    // po zdarzeniach pakietów, w kolejności planowania.
+    void setPacketCallback(PacketCallback callback);
+    EventType registerTimer(EventHandler handler);
+    EventId scheduleTimer(SimTime at, EventType type, uint64_t arg0 = 0, uint64_t arg1 = 0);
+    bool cancelTimer(EventId id);
+    // Tylko partitions == 1; nullptr wyłącza. Rzuca std::runtime_error gdy tap łącza nie istnieje
+    void setCapture(PacketCapture* capture);
+
+    const PacketRecord& record(PacketId id) const { return m_packets.at(id); }
+    const std::vector<PacketRecord>& records() const { return m_packets; }
+    const PacketSimStats& stats() const { return m_stats; }
+    const GraphSnapshot& graph() const { return m_graph; }
+    size_t partitionCount() const { return m_partitions.size(); }
+    uint32_t partitionOf(NodeId node) const { return m_partitionOf.at(node); }
+    SimTime lookahead() const { return m_lookahead; }
+    // Pakiety aktualnie czekające w buforze węzła
+    uint32_t queuedAt(NodeId node) const { return m_nodeQueued.at(node); }
+    // Dyscyplina portu (arc); nullptr gdy łącze używa wspólnego bufora FIFO węzła
+    const QueueDiscipline* portQueue(uint32_t arc) const { return m_portQueues.at(arc).get(); }
+
+private:
+    static constexpr uint32_t NoArc = GraphSnapshot::InvalidArc;
+    static constexpr PacketId NoPacket = UINT32_MAX;
+
+    struct Partition;
+
+    GraphSnapshot m_graph;
+    PacketSimOptions m_options;
+    std::vector<std::unique_ptr<Partition>> m_partitions;
+    std::vector<uint32_t> m_partitionOf;     // NodeId -> partycja
+    SimTime m_lookahead = 0;
+    SimTime m_now = 0;
+
+    std::vector<PacketRecord> m_packets;
+    std::vector<PacketId> m_nextInQueue;     // intruzywna lista FIFO łącza
+    std::vector<SimTime> m_enqueuedAt;
+
+    std::vector<uint32_t> m_queueCapacity;   // NodeId -> pojemność bufora
+    std::vector<uint32_t> m_nodeQueued;      // NodeId -> pakiety w buforze
+    std::vector<uint8_t> m_txBusy;           // arc -> nadajnik zajęty
+    std::vector<PacketId> m_queueHead;       // arc -> FIFO
+    std::vector<PacketId> m_queueTail;
+    std::vector<std::unique_ptr<QueueDiscipline>> m_portQueues; // arc -> dyscyplina (nullptr = FIFO)
+    std::vector<uint32_t> m_bandwidthMbps;   // arc -> Mbps (0 = bez opóźnienia serializacji)
+    std::vector<SimTime> m_propagation;      // arc -> ns
+
+    uint64_t m_injected = 0;
+    PacketSimStats m_stats;
+    PacketCallback m_packetCallback;
+    uint64_t m_timerSeq = 0;
+    std::vector<PacketId> m_freeIds;         // recyclePacketIds: zakończone pakiety
+    PacketCapture* m_capture = nullptr;
+    std::vector<uint32_t> m_captureNode;     // NodeId -> tap (PacketCapture::NoTap = brak)
+    std::vector<uint32_t> m_captureArc;      // arc -> tap
+
+    void assignPartitions();
+    EventScheduler& sequentialScheduler();
+    size_t runParallel(SimTime until);
+    void collectStats();
+
+    const std::vector<uint32_t>& routesTo(Partition& part, NodeId dst);
+    void onArrive(Partition& part, PacketId id, NodeId node);
+    void onTxDone(Partition& part, PacketId id, uint32_t arc);
+    void startTx(Partition& part, PacketId id, uint32_t arc);
+    void dequeuePort(Partition& part, uint32_t arc);
+    void finish(Partition& part, PacketId id, PacketStatus status);
+    bool lossDraw(uint64_t serial, uint16_t hop, double loss) const;
+};
+
+} // namespace sim
+} // namespace netsim
@@ -0,0 +1,327 @@
+#include "TcpSimulator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace netsim {
+namespace sim {
+
+namespace {
+
+constexpr uint32_t HeaderBytes = 40;
+constexpr double CubicC = 0.4;
+constexpr double CubicBeta = 0.7;
+constexpr SimTime ClockGranularity = Millisecond;
+
+inline double seconds(SimTime t) { return static_cast<double>(t) / Second; }
+
+} // namespace
+
+double TcpConnectionStats::goodputMbps() const {
+    if (state != TcpState::Finished || finishedAt <= startedAt) return 0.0;
+    return bytes * 8.0 * 1e3 / static_cast<double>(finishedAt - startedAt);
+}
+
+TcpSimulator::TcpSimulator(const Network& net, const TcpOptions& options, const PacketSimOptions& packetOptions)
+    : m_options(options), m_packets(net, packetOptions) {
+    if (m_options.mss == 0) throw std::runtime_error("MSS must be positive");
+    m_packets.setPacketCallback([this](PacketId packet) { onPacket(packet); });
+    m_openEvent = m_packets.registerTimer([this](const Event& ev) { onOpen(static_cast<ConnectionId>(ev.arg0)); });
+    m_timerEvent = m_packets.registerTimer([this](const Event& ev) { onTimeout(static_cast<ConnectionId>(ev.arg0)); });
+}
+
+ConnectionId TcpSimulator::connect(const std::string& client, const std::string& server, uint64_t bytes, SimTime at) {
+    return connect(m_packets.graph().idOf(client), m_packets.graph().idOf(server), bytes, at);
+}
+
+ConnectionId TcpSimulator::connect(NodeId client, NodeId server, uint64_t bytes, SimTime at) {
+    const GraphSnapshot& graph = m_packets.graph();
+    if (client >= graph.nodeCount() || !graph.present[client] || server >= graph.nodeCount() || !graph.present[server])
+        throw std::runtime_error("Unknown connection endpoint");
+    uint64_t segments = (bytes + m_options.mss - 1) / m_options.mss;
+    if (segments >= UINT32_MAX) throw std::runtime_error("Transfer too large");
+
+    ConnectionId id = static_cast<ConnectionId>(m_connections.size());
+    Connection c;
+    c.client = client;
+    c.server = server;
+    c.bytes = bytes;
+    c.segments = static_cast<uint32_t>(segments);
+    c.startedAt = at;
+    m_connections.push_back(c);
+    m_packets.scheduleTimer(at, m_openEvent, id);
+    return id;
+}
+
+TcpConnectionStats TcpSimulator::stats(ConnectionId id) const {
+    const Connection& c = m_connections.at(id);
+    TcpConnectionStats s;
+    s.client = c.client;
+    s.server = c.server;
+    s.state = c.state;
+    s.bytes = c.bytes;
+    s.bytesAcked = std::min<uint64_t>(static_cast<uint64_t>(c.sndUna) * m_options.mss, c.bytes);
+    s.startedAt = c.startedAt;
+    s.establishedAt = c.establishedAt;
+    s.finishedAt = c.finishedAt;
+    s.segmentsSent = c.segmentsSent;
+    s.retransmissions = c.retransmissions;
+    s.timeouts = c.timeouts;
+    s.fastRetransmits = c.fastRetransmits;
+    s.cwnd = c.cwnd;
+    s.srtt = c.srtt;
+    return s;
+}
+
+void TcpSimulator::send(ConnectionId id, Segment kind, uint32_t seq, bool toServer, uint32_t payload) {
+    const Connection& c = m_connections[id];
+    PacketId packet = toServer ? m_packets.inject(c.client, c.server, HeaderBytes + payload, now())
+                               : m_packets.inject(c.server, c.client, HeaderBytes + payload, now());
+    const uint16_t clientPort = static_cast<uint16_t>(EphemeralPortBase + id % 16384);
+    if (toServer) m_packets.setFlow(packet, Protocol::Tcp, clientPort, ServerPort);
+    else m_packets.setFlow(packet, Protocol::Tcp, ServerPort, clientPort);
+    if (packet >= m_tags.size()) m_tags.resize(packet + 1);
+    m_tags[packet] = PacketTag{id, seq, kind};
+}
+
+void TcpSimulator::onPacket(PacketId packet) {
+    if (m_packets.record(packet).status != PacketStatus::Delivered) return; // strata - wykryje ją nadawca
+    const PacketTag tag = m_tags[packet];
+    switch (tag.kind) {
+    case Segment::Syn: send(tag.connection, Segment::SynAck, 0, false, 0); break;
+    case Segment::SynAck: onSynAck(tag.connection); break;
+    case Segment::HandshakeAck: break;
+    case Segment::Data: onData(tag.connection, tag.seq); break;
+    case Segment::Ack: onAck(tag.connection, tag.seq); break;
+    }
+}
+
+void TcpSimulator::onOpen(ConnectionId id) {
+    Connection& c = m_connections[id];
+    c.state = TcpState::SynSent;
+    c.rto = m_options.initialRto;
+    send(id, Segment::Syn, 0, true, 0);
+    armTimer(id);
+}
+
+void TcpSimulator::onSynAck(ConnectionId id) {
+    Connection& c = m_connections[id];
+    if (c.state != TcpState::SynSent) return; // duplikat po retransmisji SYN
+    c.state = TcpState::Established;
+    c.establishedAt = now();
+    if (c.retries == 0) sampleRtt(c, c.establishedAt - c.startedAt); // Karn: bez retransmitowanych SYN
+    c.retries = 0;
+    c.cwnd = std::max<uint32_t>(m_options.initialWindow, 1);
+    c.ssthresh = std::numeric_limits<double>::infinity();
+    send(id, Segment::HandshakeAck, 0, true, 0);
+
+    if (c.segments == 0) {
+        c.state = TcpState::Finished;
+        c.finishedAt = now();
+        m_packets.cancelTimer(c.timer);
+        c.timer = InvalidEvent;
+        return;
+    }
+    armTimer(id);
+    transmit(id);
+}
+
+void TcpSimulator::onData(ConnectionId id, uint32_t seq) {
+    Connection& c = m_connections[id];
+    if (seq >= c.rcvNxt && seq - c.rcvNxt < ReceiveWindow) {
+        uint32_t offset = seq - c.rcvNxt;
+        c.outOfOrder[offset / 64] |= uint64_t(1) << (offset % 64);
+        // Przesuń okno o ciągły prefiks odebranych segmentów
+        uint32_t prefix = 0;
+        for (uint32_t w = 0; w < BitmapWords; ++w) {
+            if (c.outOfOrder[w] == ~uint64_t(0)) {
+                prefix += 64;
+                continue;
+            }
+            prefix += static_cast<uint32_t>(__builtin_ctzll(~c.outOfOrder[w]));
+            break;
+        }
+        if (prefix > 0) {
+            const uint32_t words = prefix / 64, bits = prefix % 64;
+            for (uint32_t w = 0; w < BitmapWords; ++w) {
+                uint64_t lo = w + words < BitmapWords ? c.outOfOrder[w + words] : 0;
+                uint64_t hi = w + words + 1 < BitmapWords ? c.outOfOrder[w + words + 1] : 0;
+                c.outOfOrder[w] = bits ? (lo >> bits) | (hi << (64 - bits)) : lo;
+            }
+            c.rcvNxt += prefix;
+        }
+    }
+    // Skumulowany ACK na każdy segment (duplikat przy luce)
+    send(id, Segment::Ack, c.rcvNxt, false, 0);
+}
+
+void TcpSimulator::onAck(ConnectionId id, uint32_t ack) {
+    Connection& c = m_connections[id];
+    if (c.state != TcpState::Established) return;
+
+    if (ack > c.sndUna) {
+        const uint32_t acked = ack - c.sndUna;
+        if (c.timing && ack > c.rttSeq) {
+            sampleRtt(c, now() - c.rttSentAt);
+            c.timing = false;
+        }
+        c.retries = 0;
+        c.dupAcks = 0;
+        c.sndUna = ack;
+        c.sndNxt = std::max(c.sndNxt, c.sndUna);
+        if (c.sndUna >= c.segments) {
+            c.state = TcpState::Finished;
+            c.finishedAt = now();
+            m_packets.cancelTimer(c.timer);
+            c.timer = InvalidEvent;
+            return;
+        }
+        if (c.inRecovery) {
+            if (ack >= c.recover) {
+                c.inRecovery = false;
+                c.cwnd = c.ssthresh;
+            } else {
+                // NewReno: częściowy ACK - następna luka, okno zmniejszone o potwierdzone
+                sendSegment(id, c.sndUna);
+                c.cwnd = std::max(c.cwnd - acked + 1, 1.0);
+            }
+        } else {
+            growWindow(c, acked);
+        }
+        armTimer(id);
+        transmit(id);
+        return;
+    }
+
+    if (ack != c.sndUna || c.sndNxt == c.sndUna) return;
+    if (c.dupAcks < UINT8_MAX) c.dupAcks++;
+    if (!c.inRecovery && c.dupAcks == 3 && c.sndUna >= c.recover) {
+        c.fastRetransmits++;
+        onLoss(c, false);
+        c.inRecovery = true;
+        c.recover = c.highSent;
+        c.cwnd = c.ssthresh + 3;
+        sendSegment(id, c.sndUna);
+    } else if (c.inRecovery) {
+        c.cwnd += 1; // każdy duplikat to segment, który opuścił sieć
+    }
+    transmit(id);
+}
+
+void TcpSimulator::onTimeout(ConnectionId id) {
+    Connection& c = m_connections[id];
+    c.timer = InvalidEvent;
+    if (++c.retries > m_options.maxRetries) {
+        c.state = TcpState::Failed;
+        c.finishedAt = now();
+        return;
+    }
+    c.rto = std::min(c.rto * 2, m_options.maxRto);
+    if (c.state == TcpState::SynSent) {
+        send(id, Segment::Syn, 0, true, 0);
+        armTimer(id);
+        return;
+    }
+    if (c.state != TcpState::Established) return;
+
+    // Go-back-N od pierwszego niepotwierdzonego segmentu
+    c.timeouts++;
+    onLoss(c, true);
+    c.cwnd = 1;
+    c.inRecovery = false;
+    c.dupAcks = 0;
+    c.recover = c.highSent;
+    c.timing = false;
+    c.sndNxt = c.sndUna;
+    armTimer(id);
+    transmit(id);
+}
+
+void TcpSimulator::transmit(ConnectionId id) {
+    Connection& c = m_connections[id];
+    const uint32_t window = static_cast<uint32_t>(std::max(1.0, std::min(c.cwnd, double(ReceiveWindow))));
+    while (c.sndNxt < c.segments && c.sndNxt - c.sndUna < window) sendSegment(id, c.sndNxt++);
+    if (c.timer == InvalidEvent && c.sndUna < c.sndNxt) armTimer(id);
+}
+
+void TcpSimulator::sendSegment(ConnectionId id, uint32_t seq) {
+    Connection& c = m_connections[id];
+    if (seq < c.highSent) {
+        c.retransmissions++;
+        if (c.timing && seq <= c.rttSeq) c.timing = false; // Karn
+    } else {
+        c.highSent = seq + 1;
+        if (!c.timing) {
+            c.timing = true;
+            c.rttSeq = seq;
+            c.rttSentAt = now();
+        }
+    }
+    c.segmentsSent++;
+    send(id, Segment::Data, seq, true, segmentPayload(c, seq));
+}
+
+void TcpSimulator::armTimer(ConnectionId id) {
+    Connection& c = m_connections[id];
+    if (c.timer != InvalidEvent) m_packets.cancelTimer(c.timer);
+    c.timer = m_packets.scheduleTimer(now() + c.rto, m_timerEvent, id);
+}
+
+void TcpSimulator::sampleRtt(Connection& c, SimTime rtt) {
+    // RFC 6298
+    if (c.srtt == 0) {
+        c.srtt = std::max<SimTime>(rtt, 1);
+        c.rttvar = rtt / 2;
+    } else {
+        SimTime delta = c.srtt > rtt ? c.srtt - rtt : rtt - c.srtt;
+        c.rttvar = (3 * c.rttvar + delta) / 4;
+        c.srtt = (7 * c.srtt + rtt) / 8;
+    }
+    c.rto = std::min(std::max(c.srtt + std::max(ClockGranularity, 4 * c.rttvar), m_options.minRto), m_options.maxRto);
+}
+
+void TcpSimulator::onLoss(Connection& c, bool timeout) {
+    if (m_options.congestionControl == TcpCongestionControl::Cubic) {
+        // Szybka zbieżność: kolejna strata poniżej wMax oddaje część pasma
+        c.wMax = c.cwnd < c.wMax ? c.cwnd * (1 + CubicBeta) / 2 : c.cwnd;
+        c.ssthresh = std::max(c.cwnd * CubicBeta, 2.0);
+        c.epochStart = 0;
+    } else {
+        double flight = static_cast<double>(c.highSent - c.sndUna);
+        c.ssthresh = std::max(std::min(c.cwnd, flight) / 2, 2.0);
+    }
+    if (!timeout) c.cwnd = c.ssthresh;
+}
+
+void TcpSimulator::growWindow(Connection& c, uint32_t acked) {
+    if (c.cwnd < c.ssthresh) {
+        c.cwnd += acked; // slow start
+    } else if (m_options.congestionControl == TcpCongestionControl::Reno) {
+        c.cwnd += static_cast<double>(acked) / c.cwnd;
+    } else {
+        // RFC 8312: W(t) = C (t - K)^3 + wMax, nie wolniej niż Reno
+        if (c.epochStart == 0) {
+            c.epochStart = std::max<SimTime>(now(), 1);
+            c.cubicK = c.wMax > c.cwnd ? std::cbrt((c.wMax - c.cwnd) / CubicC) : 0.0;
+            c.cubicOrigin = std::max(c.wMax, c.cwnd);
+            c.renoWindow = c.cwnd;
+        }
+        double t = seconds(now() - c.epochStart + c.srtt) - c.cubicK;
+        double target = c.cubicOrigin + CubicC * t * t * t;
+        if (target > c.cwnd) c.cwnd += (target - c.cwnd) / c.cwnd * acked;
+        else c.cwnd += 0.01 * acked / c.cwnd;
+        c.renoWindow += 3 * (1 - CubicBeta) / (1 + CubicBeta) * acked / c.cwnd;
+        c.cwnd = std::max(c.cwnd, c.renoWindow);
+    }
+    // Okno ponad okno odbiorcy nie jest wykorzystywane - nie rośnie w nieskończoność
+    c.cwnd = std::min(c.cwnd, 2.0 * ReceiveWindow);
+}
+
+uint32_t TcpSimulator::segmentPayload(const Connection& c, uint32_t seq) const {
+    uint64_t offset = static_cast<uint64_t>(seq) * m_options.mss;
+    return static_cast<uint32_t>(std::min<uint64_t>(m_options.mss, c.bytes - offset));
+}
+
+} // namespace sim
+} // namespace netsim
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "PacketSimulator.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace netsim {
+namespace sim {
+
+using ConnectionId = uint32_t;
+
+enum class TcpCongestionControl : uint8_t {
+    Reno,       // NewReno: slow start, AIMD, fast retransmit / fast recovery
+    Cubic
+};
+
+enum class TcpState : uint8_t {
+    Closed,         // przed czasem connect
+    SynSent,
+    Established,
+    Finished,       // wszystkie dane potwierdzone
+    Failed          // wyczerpane retransmisje
+};
+
+struct TcpOptions {
+    TcpCongestionControl congestionControl = TcpCongestionControl::Reno;
+    uint32_t mss = 1460;                        // bajty danych w segmencie (+ 40 B nagłówka)
+    uint32_t initialWindow = 10;                // segmenty (RFC 6928)
+    SimTime initialRto = 1 * Second;
+    SimTime minRto = 200 * Millisecond;
+    SimTime maxRto = 60 * Second;
+    uint32_t maxRetries = 8;                    // kolejne RTO bez postępu -> Failed
+};
+
+/**
+ * @brief Outcome of one connection
+ */
+struct TcpConnectionStats {
+    NodeId client = 0;
+    NodeId server = 0;
+    TcpState state = TcpState::Closed;
+    uint64_t bytes = 0;
+    uint64_t bytesAcked = 0;
+    SimTime startedAt = 0;
+    SimTime establishedAt = 0;
+    SimTime finishedAt = 0;
+    uint32_t segmentsSent = 0;
+    uint32_t retransmissions = 0;
+    uint32_t timeouts = 0;
+    uint32_t fastRetransmits = 0;
+    double cwnd = 0.0;                          // segmenty, na koniec
+    SimTime srtt = 0;
+
+    SimTime handshakeLatency() const { return establishedAt - startedAt; }
+    SimTime transferTime() const { return finishedAt - establishedAt; }
+    double goodputMbps() const;
+};
+
+/**
+ * @brief Per-flow TCP model over the packet-level simulation
+ *
+ * Connections run the three-way handshake, then stream bytes client ->
+ * server in mss-sized segments; every segment and ACK is a packet in the
+ * PacketSimulator, so it pays serialization, queueing, propagation and can
+ * be lost or tail-dropped. The sender keeps sequence state in segments:
+ * cumulative ACKs, RFC 6298 RTT estimation with Karn's rule, a single RTO
+ * timer with exponential backoff (go-back-N on expiry), fast retransmit on
+ * three duplicate ACKs and NewReno recovery. The window grows as Reno
+ * (AIMD) or CUBIC (RFC 8312, with the TCP-friendly region).
+ *
+ * Connection state is one fixed-size record in a flat table; the receiver
+ * keeps rcvNxt plus an inline out-of-order bitmap of ReceiveWindow
+ * segments, which is also the advertised window, so a connection never
+ * allocates. Packets map back to (connection, kind, sequence) through a
+ * table indexed by PacketId.
+ */
+class TcpSimulator {
+public:
+    static constexpr uint32_t ReceiveWindow = 256;  // segmenty
+    static constexpr uint16_t ServerPort = 80;      // porty widoczne w PacketCapture
+    static constexpr uint16_t EphemeralPortBase = 49152;
+
+    TcpSimulator(const Network& net, const TcpOptions& options = TcpOptions(),
+                 const PacketSimOptions& packetOptions = PacketSimOptions());
+    TcpSimulator(const TcpSimulator&) = delete;
+    TcpSimulator& operator=(const TcpSimulator&) = delete;
+
+    // bytes == 0: tylko handshake
+    ConnectionId connect(NodeId client, NodeId server, uint64_t bytes, SimTime at = 0);
+    ConnectionId connect(const std::string& client, const std::string& server, uint64_t bytes, SimTime at = 0);
+
+    size_t runUntil(SimTime until) { return m_packets.runUntil(until); }
+    size_t run() { return m_packets.run(); }
+    SimTime now() const { return m_packets.now(); }
+
+    TcpConnectionStats stats(ConnectionId id) const;
+    TcpState state(ConnectionId id) const { return m_connections.at(id).state; }
+    size_t connectionCount() const { return m_connections.size(); }
+    const PacketSimulator& packets() const { return m_packets; }
+
+private:
+    static constexpr uint32_t BitmapWords = ReceiveWindow / 64;
+
+    enum class Segment : uint8_t { Syn, SynAck, HandshakeAck, Data, Ack };
+
+    // Pakiet -> połączenie; seq = numer segmentu (Data) albo skumulowany ACK (Ack)
+    struct PacketTag {
+        ConnectionId connection;
+        uint32_t seq;
+        Segment kind;
+    };
+
+    struct Connection {
+        NodeId client = 0;
+        NodeId server = 0;
+        uint64_t bytes = 0;
+        SimTime startedAt = 0;
+        SimTime establishedAt = 0;
+        SimTime finishedAt = 0;
+        SimTime srtt = 0;
+        SimTime rttvar = 0;
+        SimTime rto = 0;
+        SimTime rttSentAt = 0;
+        SimTime epochStart = 0;                 // CUBIC: początek epoki po stracie
+        EventId timer = InvalidEvent;
+        double cwnd = 0.0;                      // segmenty
+        double ssthresh = 0.0;
+        double wMax = 0.0;                      // CUBIC: okno przed ostatnią stratą
+        double cubicK = 0.0;                    // CUBIC: s do powrotu do wMax
+        double cubicOrigin = 0.0;
+        double renoWindow = 0.0;                // CUBIC: okno Reno w regionie TCP-friendly
+        uint32_t segments = 0;
+        uint32_t sndUna = 0;
+        uint32_t sndNxt = 0;
+        uint32_t highSent = 0;                  // najwyższy wysłany segment + 1
+        uint32_t recover = 0;                   // NewReno: koniec odzyskiwania
+        uint32_t rttSeq = 0;                    // mierzony segment
+        uint32_t rcvNxt = 0;                    // odbiorca: następny oczekiwany segment
+        uint32_t segmentsSent = 0;
+        uint32_t retransmissions = 0;
+        uint32_t timeouts = 0;
+        uint32_t fastRetransmits = 0;
+        uint64_t outOfOrder[BitmapWords] = {};  // odbiorca: bit i = segment rcvNxt + i
+        uint16_t retries = 0;
+        uint8_t dupAcks = 0;
+        TcpState state = TcpState::Closed;
+        bool inRecovery = false;
+        bool timing = false;                    // rttSeq w locie i nie retransmitowany
+    };
+
+    TcpOptions m_options;
+    PacketSimulator m_packets;
+    EventType m_openEvent = 0;
+    EventType m_timerEvent = 0;
+    std::vector<Connection> m_connections;
+    std::vector<PacketTag> m_tags;              // PacketId -> tag
+
+    void send(ConnectionId id, Segment kind, uint32_t seq, bool toServer, uint32_t payload);
+    void onPacket(PacketId packet);
+    void onOpen(ConnectionId id);
+    void onTimeout(ConnectionId id);
+    void onSynAck(ConnectionId id);
+    void onData(ConnectionId id, uint32_t seq);
+    void onAck(ConnectionId id, uint32_t ack);
+    void transmit(ConnectionId id);
+    void sendSegment(ConnectionId id, uint32_t seq);
+    void armTimer(ConnectionId id);
+    void sampleRtt(Connection& c, SimTime rtt);
+    void onLoss(Connection& c, bool timeout);
+    void growWindow(Connection& c, uint32_t acked);
+    uint32_t segmentPayload(const Connection& c, uint32_t seq) const;
+};
+
+} // namespace sim
+} // namespace netsim
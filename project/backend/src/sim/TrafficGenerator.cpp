@@ -0,0 +1,397 @@
+#include "TrafficGenerator.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace netsim {
+namespace sim {
+
+namespace {
+
+using Emission = TrafficGenerator::Emission;
+using Source = TrafficGenerator::Source;
+
+constexpr size_t ReadBufferBytes = 1 << 20;
+
+// Odstęp między pakietami size bajtów przy rateMbps, w ns (double - bez dryfu przy sumowaniu)
+double gapNs(uint32_t sizeBytes, double rateMbps) { return sizeBytes * 8000.0 / rateMbps; }
+
+class ModelSource : public Source {
+public:
+    ModelSource(TrafficPattern pattern, NodeId src, NodeId dst, const TrafficOptions& options)
+        : m_pattern(pattern), m_gap(gapNs(options.sizeBytes, options.rateMbps)), m_gen(options.seed),
+          m_time(static_cast<double>(options.start)) {
+        m_template.src = src;
+        m_template.dst = dst;
+        m_template.sizeBytes = options.sizeBytes;
+        m_template.priority = options.priority;
+        if (pattern == TrafficPattern::ParetoOnOff) {
+            // Pareto(xm, alfa) ma średnią xm * alfa / (alfa - 1)
+            m_onScale = options.meanOn * (options.shape - 1.0) / options.shape;
+            m_offScale = options.meanOff * (options.shape - 1.0) / options.shape;
+            m_shape = options.shape;
+            m_onEnd = m_time + pareto(m_onScale);
+        }
+    }
+
+    bool next(Emission& out, uint64_t&) override {
+        out = m_template;
+        out.at = static_cast<SimTime>(m_time);
+        switch (m_pattern) {
+        case TrafficPattern::Poisson:
+            m_time += std::exponential_distribution<double>(1.0 / m_gap)(m_gen);
+            break;
+        case TrafficPattern::ParetoOnOff:
+            m_time += m_gap;
+            // Koniec okresu on: przerwa off, potem nowy okres on
+            while (m_time >= m_onEnd) {
+                double off = pareto(m_offScale);
+                m_time = m_onEnd + off;
+                m_onEnd = m_time + pareto(m_onScale);
+            }
+            break;
+        default:
+            m_time += m_gap;
+            break;
+        }
+        return true;
+    }
+
+private:
+    TrafficPattern m_pattern;
+    double m_gap;
+    std::mt19937_64 m_gen;
+    double m_time;
+    Emission m_template;
+    double m_onScale = 0.0;
+    double m_offScale = 0.0;
+    double m_shape = 0.0;
+    double m_onEnd = 0.0;
+
+    double pareto(double scale) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(m_gen);
+        return scale / std::pow(1.0 - u, 1.0 / m_shape);
+    }
+};
+
+// Wspólne dla plików śladu: duży bufor odczytu i przesunięcie czasu do startu
+class TraceFile {
+public:
+    explicit TraceFile(const std::string& path) : m_buffer(ReadBufferBytes) {
+        m_in.rdbuf()->pubsetbuf(m_buffer.data(), m_buffer.size());
+        m_in.open(path, std::ios::binary);
+        if (!m_in) throw std::runtime_error("Cannot open trace file: " + path);
+    }
+
+protected:
+    std::vector<char> m_buffer;
+    std::ifstream m_in;
+};
+
+class CsvTraceSource : public Source, private TraceFile {
+public:
+    CsvTraceSource(const std::string& path, const GraphSnapshot& graph, SimTime start)
+        : TraceFile(path), m_graph(graph), m_start(start) {}
+
+    bool next(Emission& out, uint64_t& skipped) override {
+        while (std::getline(m_in, m_line)) {
+            if (m_line.empty() || m_line[0] < '0' || m_line[0] > '9') continue;
+            if (parse(out)) return true;
+            skipped++;
+        }
+        return false;
+    }
+
+private:
+    const GraphSnapshot& m_graph;
+    SimTime m_start;
+    SimTime m_last = 0;
+    std::string m_line;
+    std::string m_field;
+
+    bool parse(Emission& out) {
+        const char* p = m_line.c_str();
+        char* end;
+        double us = std::strtod(p, &end);
+        if (*end != ',' || us < 0) return false;
+        NodeId ids[2];
+        p = end + 1;
+        for (NodeId& id : ids) {
+            const char* comma = std::strchr(p, ',');
+            if (!comma) return false;
+            m_field.assign(p, comma);
+            try {
+                id = m_graph.idOf(m_field);
+            } catch (const std::runtime_error&) {
+                return false;
+            }
+            p = comma + 1;
+        }
+        unsigned long size = std::strtoul(p, &end, 10);
+        if (end == p || size == 0) return false;
+        unsigned long priority = 0;
+        if (*end == ',') priority = std::strtoul(end + 1, &end, 10);
+
+        // Rekordy nie w kolejności przesuwane na czas poprzedniego
+        out.at = std::max(m_start + static_cast<SimTime>(us * Microsecond), m_last);
+        m_last = out.at;
+        out.src = ids[0];
+        out.dst = ids[1];
+        out.sizeBytes = static_cast<uint32_t>(size);
+        out.priority = static_cast<uint8_t>(std::min(priority, 255ul));
+        return true;
+    }
+};
+
+// Klasyczny format libpcap (nie pcapng)
+class PcapTraceSource : public Source, private TraceFile {
+public:
+    PcapTraceSource(const std::string& path, const Network& net, SimTime start)
+        : TraceFile(path), m_start(start) {
+        unsigned char header[24];
+        if (!m_in.read(reinterpret_cast<char*>(header), sizeof(header)))
+            throw std::runtime_error("Truncated pcap header: " + path);
+        uint32_t magic = le32(header);
+        if (magic == 0xa1b2c3d4 || magic == 0xa1b23c4d) {
+            m_swapped = false;
+        } else if (magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1) {
+            m_swapped = true;
+        } else {
+            throw std::runtime_error("Not a pcap file: " + path);
+        }
+        m_nanoseconds = magic == 0xa1b23c4d || magic == 0x4d3cb2a1;
+        m_snapLength = read32(header + 16);
+        if (m_snapLength == 0 || m_snapLength > MaxSnapLength) m_snapLength = MaxSnapLength;
+        m_linkType = read32(header + 20);
+        if (m_linkType != LinkEthernet && m_linkType != LinkRaw && m_linkType != LinkIpv4 && m_linkType != LinkSll)
+            throw std::runtime_error("Unsupported pcap link type " + std::to_string(m_linkType));
+
+        for (const auto& name : net.getAllNodes()) {
+            auto node = net.findByName(name);
+            m_nodeByIp[node->getIp()] = node->getId();
+        }
+    }
+
+    bool next(Emission& out, uint64_t& skipped) override {
+        unsigned char record[16];
+        while (m_in.read(reinterpret_cast<char*>(record), sizeof(record))) {
+            uint64_t seconds = read32(record);
+            uint64_t fraction = read32(record + 4);
+            uint32_t captured = read32(record + 8);
+            uint32_t length = read32(record + 12);
+            if (captured > m_snapLength) {
+                // Nagłówek rekordu niezgodny z plikiem - dalszym przesunięciom nie da się ufać
+                skipped++;
+                return false;
+            }
+            m_frame.resize(captured);
+            if (captured > 0 && !m_in.read(reinterpret_cast<char*>(m_frame.data()), captured)) return false;
+
+            SimTime stamp = seconds * Second + fraction * (m_nanoseconds ? Nanosecond : Microsecond);
+            if (!m_haveBase) {
+                m_base = stamp;
+                m_haveBase = true;
+            }
+            if (!parse(out)) {
+                skipped++;
+                continue;
+            }
+            out.at = std::max(m_start + (stamp > m_base ? stamp - m_base : 0), m_last);
+            m_last = out.at;
+            out.sizeBytes = length;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    static constexpr uint32_t LinkEthernet = 1;
+    static constexpr uint32_t LinkRaw = 101;
+    static constexpr uint32_t LinkSll = 113;
+    static constexpr uint32_t LinkIpv4 = 228;
+    static constexpr uint32_t MaxSnapLength = 262144;   // jak w libpcap
+
+    SimTime m_start;
+    SimTime m_base = 0;
+    SimTime m_last = 0;
+    bool m_haveBase = false;
+    bool m_swapped = false;
+    bool m_nanoseconds = false;
+    uint32_t m_linkType = 0;
+    uint32_t m_snapLength = MaxSnapLength;
+    std::vector<unsigned char> m_frame;
+    std::unordered_map<std::string, NodeId> m_nodeByIp;
+    std::string m_ip;
+
+    static uint32_t le32(const unsigned char* p) { return p[0] | p[1] << 8 | p[2] << 16 | uint32_t(p[3]) << 24; }
+    static uint32_t be32(const unsigned char* p) { return uint32_t(p[0]) << 24 | p[1] << 16 | p[2] << 8 | p[3]; }
+    uint32_t read32(const unsigned char* p) const { return m_swapped ? be32(p) : le32(p); }
+
+    bool parse(Emission& out) {
+        size_t ip = 0;
+        const size_t size = m_frame.size();
+        if (m_linkType == LinkEthernet || m_linkType == LinkSll) {
+            size_t typeAt = m_linkType == LinkEthernet ? 12 : 14;
+            if (size < typeAt + 2) return false;
+            uint16_t etherType = m_frame[typeAt] << 8 | m_frame[typeAt + 1];
+            ip = typeAt + 2;
+            if (etherType == 0x8100 && size >= ip + 4) { // znacznik VLAN
+                etherType = m_frame[ip + 2] << 8 | m_frame[ip + 3];
+                ip += 4;
+            }
+            if (etherType != 0x0800) return false;
+        }
+        if (size < ip + 20 || (m_frame[ip] >> 4) != 4) return false;
+        NodeId ids[2];
+        for (int k = 0; k < 2; ++k) {
+            const unsigned char* addr = &m_frame[ip + 12 + 4 * k];
+            m_ip = std::to_string(addr[0]) + '.' + std::to_string(addr[1]) + '.' +
+                   std::to_string(addr[2]) + '.' + std::to_string(addr[3]);
+            auto it = m_nodeByIp.find(m_ip);
+            if (it == m_nodeByIp.end()) return false;
+            ids[k] = it->second;
+        }
+        out.src = ids[0];
+        out.dst = ids[1];
+        out.priority = m_frame[ip + 1] >> 5;        // IP precedence z pola TOS
+        return true;
+    }
+};
+
+} // namespace
+
+TrafficGenerator::TrafficGenerator(const Network& net, PacketSimulator& sim) : m_net(net), m_sim(sim) {
+    m_emitEvent = m_sim.registerTimer([this](const Event& ev) { onEmit(static_cast<GeneratorId>(ev.arg0)); });
+    m_sim.setPacketCallback([this](PacketId packet) { onPacket(packet); });
+}
+
+TrafficGenerator::~TrafficGenerator() {
+    m_sim.setPacketCallback(PacketCallback());
+}
+
+GeneratorId TrafficGenerator::addConstantBitRate(NodeId src, NodeId dst, const TrafficOptions& options) {
+    checkEndpoints(src, dst);
+    if (options.rateMbps <= 0.0 || options.sizeBytes == 0) throw std::runtime_error("Rate and packet size must be positive");
+    return attach(TrafficPattern::ConstantBitRate,
+                  std::make_unique<ModelSource>(TrafficPattern::ConstantBitRate, src, dst, options), options);
+}
+
+GeneratorId TrafficGenerator::addPoisson(NodeId src, NodeId dst, const TrafficOptions& options) {
+    checkEndpoints(src, dst);
+    if (options.rateMbps <= 0.0 || options.sizeBytes == 0) throw std::runtime_error("Rate and packet size must be positive");
+    return attach(TrafficPattern::Poisson, std::make_unique<ModelSource>(TrafficPattern::Poisson, src, dst, options), options);
+}
+
+GeneratorId TrafficGenerator::addParetoOnOff(NodeId src, NodeId dst, const TrafficOptions& options) {
+    checkEndpoints(src, dst);
+    if (options.rateMbps <= 0.0 || options.sizeBytes == 0) throw std::runtime_error("Rate and packet size must be positive");
+    if (options.shape <= 1.0 || options.meanOn == 0 || options.meanOff == 0)
+        throw std::runtime_error("On/off traffic needs shape > 1 and positive mean periods");
+    return attach(TrafficPattern::ParetoOnOff,
+                  std::make_unique<ModelSource>(TrafficPattern::ParetoOnOff, src, dst, options), options);
+}
+
+GeneratorId TrafficGenerator::add(TrafficPattern pattern, const std::string& src, const std::string& dst,
+                                  const TrafficOptions& options) {
+    NodeId s = m_sim.graph().idOf(src), d = m_sim.graph().idOf(dst);
+    switch (pattern) {
+    case TrafficPattern::ConstantBitRate: return addConstantBitRate(s, d, options);
+    case TrafficPattern::Poisson: return addPoisson(s, d, options);
+    case TrafficPattern::ParetoOnOff: return addParetoOnOff(s, d, options);
+    case TrafficPattern::Trace: break;
+    }
+    throw std::runtime_error("Trace generators are added with addTrace");
+}
+
+GeneratorId TrafficGenerator::addTrace(const std::string& path, const TrafficOptions& options) {
+    char magic[4] = {};
+    {
+        std::ifstream probe(path, std::ios::binary);
+        if (!probe) throw std::runtime_error("Cannot open trace file: " + path);
+        probe.read(magic, sizeof(magic));
+    }
+    uint32_t m;
+    std::memcpy(&m, magic, sizeof(m));
+    bool pcap = m == 0xa1b2c3d4 || m == 0xd4c3b2a1 || m == 0xa1b23c4d || m == 0x4d3cb2a1;
+    std::unique_ptr<Source> source;
+    if (pcap) source = std::make_unique<PcapTraceSource>(path, m_net, options.start);
+    else source = std::make_unique<CsvTraceSource>(path, m_sim.graph(), options.start);
+    return attach(TrafficPattern::Trace, std::move(source), options);
+}
+
+TrafficPattern TrafficGenerator::parsePattern(const std::string& name) {
+    if (name == "cbr") return TrafficPattern::ConstantBitRate;
+    if (name == "poisson") return TrafficPattern::Poisson;
+    if (name == "onoff" || name == "pareto") return TrafficPattern::ParetoOnOff;
+    if (name == "trace") return TrafficPattern::Trace;
+    throw std::runtime_error("Unknown traffic pattern: " + name);
+}
+
+void TrafficGenerator::checkEndpoints(NodeId src, NodeId dst) const {
+    const GraphSnapshot& graph = m_sim.graph();
+    if (src >= graph.nodeCount() || !graph.present[src] || dst >= graph.nodeCount() || !graph.present[dst])
+        throw std::runtime_error("Unknown traffic endpoint");
+}
+
+GeneratorId TrafficGenerator::attach(TrafficPattern pattern, std::unique_ptr<Source> source, const TrafficOptions& options) {
+    if (options.start < m_sim.now()) throw std::runtime_error("Generator start is in the past");
+    GeneratorId id = static_cast<GeneratorId>(m_generators.size());
+    m_generators.push_back({std::move(source), Emission(), options});
+    TrafficGeneratorStats stats;
+    stats.pattern = pattern;
+    m_stats.push_back(stats);
+    if (advance(id)) m_sim.scheduleTimer(m_generators[id].pending.at, m_emitEvent, id);
+    return id;
+}
+
+bool TrafficGenerator::advance(GeneratorId id) {
+    Generator& gen = m_generators[id];
+    TrafficGeneratorStats& stats = m_stats[id];
+    bool more = gen.source->next(gen.pending, stats.skipped) &&
+                (gen.options.stop == 0 || gen.pending.at < gen.options.stop) &&
+                (gen.options.maxPackets == 0 || stats.packets < gen.options.maxPackets);
+    if (!more) {
+        stats.finished = true;
+        gen.source.reset(); // zamyka plik śladu
+    }
+    return more;
+}
+
+void TrafficGenerator::onEmit(GeneratorId id) {
+    Generator& gen = m_generators[id];
+    TrafficGeneratorStats& stats = m_stats[id];
+    for (uint32_t k = 0; k < BatchPackets; ++k) {
+        const Emission& e = gen.pending;
+        PacketId packet = m_sim.inject(e.src, e.dst, e.sizeBytes, e.at, 64, e.priority);
+        m_sim.setFlow(packet, Protocol::Udp, static_cast<uint16_t>(49152 + id % 16384), DestinationPort);
+        if (packet >= m_owner.size()) m_owner.resize(packet + 1, NoGenerator);
+        m_owner[packet] = id;
+        if (stats.packets == 0) stats.firstAt = e.at;
+        stats.lastAt = e.at;
+        stats.packets++;
+        stats.bytes += e.sizeBytes;
+        if (!advance(id)) return;
+    }
+    // Następna partia dopiero w chwili jej pierwszego pakietu
+    m_sim.scheduleTimer(gen.pending.at, m_emitEvent, id);
+}
+
+void TrafficGenerator::onPacket(PacketId packet) {
+    if (packet >= m_owner.size() || m_owner[packet] == NoGenerator) return;
+    const PacketRecord& rec = m_sim.record(packet);
+    TrafficGeneratorStats& stats = m_stats[m_owner[packet]];
+    if (rec.status == PacketStatus::Delivered) {
+        stats.delivered++;
+        stats.totalLatency += rec.latency();
+    } else {
+        stats.dropped++;
+    }
+    m_owner[packet] = NoGenerator;
+}
+
+} // namespace sim
+} // namespace netsim
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "PacketSimulator.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace netsim {
+namespace sim {
+
+using GeneratorId = uint32_t;
+
+enum class TrafficPattern : uint8_t {
+    ConstantBitRate,
+    Poisson,            // wykładnicze odstępy, średnio rateMbps
+    ParetoOnOff,        // okresy on/off z rozkładu Pareto, w stanie on CBR z rateMbps
+    Trace               // CSV albo pcap czytany strumieniowo z dysku
+};
+
+struct TrafficOptions {
+    double rateMbps = 1.0;
+    uint32_t sizeBytes = 1500;
+    uint8_t priority = 0;
+    SimTime start = 0;
+    SimTime stop = 0;                           // 0 = bez końca (symulacja przez runUntil)
+    uint64_t maxPackets = 0;                    // 0 = bez limitu
+    SimTime meanOn = 500 * Millisecond;         // ParetoOnOff
+    SimTime meanOff = 500 * Millisecond;
+    double shape = 1.5;                         // ParetoOnOff: alfa > 1
+    uint64_t seed = 1;
+};
+
+/**
+ * @brief Emitted packets of one generator and what happened to them
+ */
+struct TrafficGeneratorStats {
+    TrafficPattern pattern = TrafficPattern::ConstantBitRate;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;                       // kolejka, AQM, packetLoss, TTL, brak trasy
+    uint64_t skipped = 0;                       // Trace: błędne linie, nieznane węzły lub adresy
+    SimTime totalLatency = 0;                   // dostarczone pakiety
+    SimTime firstAt = 0;
+    SimTime lastAt = 0;
+    bool finished = false;                      // źródło wyczerpane
+
+    double averageLatencyNs() const { return delivered ? double(totalLatency) / delivered : 0.0; }
+    double offeredMbps() const { return lastAt > firstAt ? bytes * 8000.0 / (lastAt - firstAt) : 0.0; }
+};
+
+/**
+ * @brief Traffic sources attached to hosts of a PacketSimulator
+ *
+ * Every generator is a lazy source: an emission timer injects the next
+ * BatchPackets packets and re-arms itself at the time of the following one,
+ * so only one batch per generator is ever materialized. Model sources draw
+ * their gaps on the fly (CBR, exponential, Pareto on/off periods) and trace
+ * sources read their file through a fixed buffer record by record:
+ *  - CSV lines "time_us,src,dst,size_bytes[,priority]" with node names
+ *    (lines not starting with a digit are skipped as headers/comments);
+ *  - libpcap files (Ethernet, Linux SLL or raw IPv4), IPv4 addresses mapped
+ *    to nodes by Node::getIp, the original length as the size and the IP
+ *    precedence bits as the priority; times are relative to the first record.
+ * With PacketSimOptions::recyclePacketIds the simulation memory is bounded
+ * by packets in flight, so long high-rate runs take constant memory.
+ *
+ * The generator installs the PacketSimulator's packet callback to attribute
+ * deliveries and drops, and like timers it needs partitions == 1.
+ */
+class TrafficGenerator {
+public:
+    static constexpr uint32_t BatchPackets = 64;
+    // Pakiety oznaczane jako UDP z portu 49152 + id generatora na port iperf
+    static constexpr uint16_t DestinationPort = 5001;
+
+    TrafficGenerator(const Network& net, PacketSimulator& sim);
+    ~TrafficGenerator();
+    TrafficGenerator(const TrafficGenerator&) = delete;
+    TrafficGenerator& operator=(const TrafficGenerator&) = delete;
+
+    // Rzucają std::runtime_error dla nieznanego węzła lub błędnych parametrów
+    GeneratorId addConstantBitRate(NodeId src, NodeId dst, const TrafficOptions& options);
+    GeneratorId addPoisson(NodeId src, NodeId dst, const TrafficOptions& options);
+    GeneratorId addParetoOnOff(NodeId src, NodeId dst, const TrafficOptions& options);
+    GeneratorId add(TrafficPattern pattern, const std::string& src, const std::string& dst, const TrafficOptions& options);
+    // Format rozpoznawany po nagłówku pliku; rekordy przesunięte o start, ucięte na stop / maxPackets
+    GeneratorId addTrace(const std::string& path, const TrafficOptions& options = TrafficOptions());
+
+    // "cbr", "poisson", "onoff", "trace"; rzuca std::runtime_error dla nieznanego
+    static TrafficPattern parsePattern(const std::string& name);
+
+    const TrafficGeneratorStats& stats(GeneratorId id) const { return m_stats.at(id); }
+    size_t generatorCount() const { return m_stats.size(); }
+
+    struct Emission {
+        SimTime at = 0;
+        NodeId src = 0;
+        NodeId dst = 0;
+        uint32_t sizeBytes = 0;
+        uint8_t priority = 0;
+    };
+
+    class Source {
+    public:
+        virtual ~Source() = default;
+        // false gdy źródło się wyczerpało; czasy niemalejące
+        virtual bool next(Emission& out, uint64_t& skipped) = 0;
+    };
+
+private:
+    static constexpr GeneratorId NoGenerator = UINT32_MAX;
+
+    struct Generator {
+        std::unique_ptr<Source> source;
+        Emission pending;
+        TrafficOptions options;
+    };
+
+    const Network& m_net;
+    PacketSimulator& m_sim;
+    EventType m_emitEvent = 0;
+    std::vector<Generator> m_generators;
+    std::vector<TrafficGeneratorStats> m_stats;
+    std::vector<GeneratorId> m_owner;           // PacketId -> generator
+
+    GeneratorId attach(TrafficPattern pattern, std::unique_ptr<Source> source, const TrafficOptions& options);
+    bool advance(GeneratorId id);
+    void onEmit(GeneratorId id);
+    void onPacket(PacketId packet);
+    void checkEndpoints(NodeId src, NodeId dst) const;
+};
+
+} // namespace sim
+} // namespace netsim
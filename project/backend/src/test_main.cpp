@@ -1,10 +1,36 @@
 #include <gtest/gtest.h>
+#include <random>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include "core/Node.hpp"
 #include "core/Packet.hpp"
 #include "core/Network.hpp"
 #include "core/Engine.hpp"
 #include "core/Host.hpp"
 #include "core/Router.hpp"
+#include "core/GraphSnapshot.hpp"
+#include "analysis/MaxFlow.hpp"
+#include "analysis/DynamicShortestPaths.hpp"
+#include "analysis/Centrality.hpp"
+#include "analysis/Resilience.hpp"
+#include "sim/EventScheduler.hpp"
+#include "sim/PacketSimulator.hpp"
+#include "scenario/ScenarioRunner.hpp"
+#include "analysis/DeliveryEstimator.hpp"
+#include "sim/FluidSimulator.hpp"
+#include "sim/TcpSimulator.hpp"
+#include "core/QueueDiscipline.hpp"
+#include "sim/TrafficGenerator.hpp"
+#include "sim/PacketCapture.hpp"
+#include "sim/BranchRunner.hpp"
+#include "core/Fib.hpp"
+#include "routing/SpfRouting.hpp"
+#include "routing/ConvergenceSimulator.hpp"
+#include "core/ForwardingPipeline.hpp"
+#include "core/IpAddress.hpp"
+#include "sim/MobilitySimulator.hpp"
+#include "utils/SandboxPath.hpp"
 
 // DummyNode is defined in Network.hpp
 
@@ -455,7 +481,7 @@ TEST(NetworkTest, UDPSimulation) {
 //    - Metody: advanceTime(ms: int) - przesuwa czas symulacji o ms milisekund
 //    - schedulePacketDelivery(pkt: Packet, delay: int) - planuje pakiet do wysłania po dodatkowym delay ms
 //    - hasPacketArrived(node: string) - sprawdza, czy jakiś pakiet dotarł do węzła w bieżącym czasie
-//    - Używa kolejki zdarzeń czasowych (scheduledPackets: map<time, vector<Packet>> w Network)
+//    - Używa kolejki zdarzeń czasowych (netsim::sim::EventScheduler - hierarchiczne koło czasowe w Network)
 //    - Przy advanceTime, dostarcza pakiety, które osiągnęły zaplanowany czas (currentTime + delay + linkDelay)
 //    - Symuluje rzeczywisty czas podróży pakietów w sieci
 // Test sprawdza symulację czasową transmisji pakietów
@@ -534,6 +560,107 @@ TEST(PacketTest, PacketFragmentation) {
     EXPECT_EQ(reassembled.dest, "B");    // Cel powinien być zachowany
 }
 
+// Test sprawdza zwartą reprezentację pakietu: internowane endpointy, tagi i współdzielony payload
+TEST(PacketTest, CompactFieldsShareBuffers) {
+    Packet pkt("A", "B", "DATA", "TCP", std::string(1000, 'x'));
+    EXPECT_EQ(pkt.src, Endpoint("A"));
+    EXPECT_EQ(pkt.type.kind(), PacketType::Data);
+    EXPECT_EQ(pkt.protocol, Protocol::Tcp);
+    EXPECT_EQ(pkt.protocol.str(), "TCP");         // oryginalny napis zachowany
+    EXPECT_EQ(Packet("A", "B", "custom", "udp", "").type.kind(), PacketType::Other);
+
+    // Kopie i fragmenty nie kopiują danych
+    Packet copy = pkt;
+    EXPECT_TRUE(copy.payload.sharesBufferWith(pkt.payload));
+    auto fragments = pkt.fragmentPacket(300);
+    ASSERT_EQ(fragments.size(), 4);
+    EXPECT_TRUE(fragments[3].payload.sharesBufferWith(pkt.payload));
+    EXPECT_EQ(fragments[3].payload.size(), 100);
+
+    // Fragmenty w kolejności składają się bez kopiowania, pomieszane - z kopią
+    std::swap(fragments[0], fragments[2]);
+    Packet reassembled = Packet::reassemblePacket(fragments);
+    EXPECT_TRUE(reassembled.payload.sharesBufferWith(pkt.payload));
+    EXPECT_EQ(reassembled.payload, pkt.payload);
+    Payload mixed = Payload::concat({fragments[0].payload, fragments[1].payload});
+    EXPECT_FALSE(mixed.sharesBufferWith(pkt.payload));
+    EXPECT_EQ(mixed.size(), 600);
+    EXPECT_THROW(pkt.payload.slice(1001, 1), std::out_of_range);
+}
+
+// Test sprawdza tablicę składania fragmentów: kolejność, duplikaty, luki, timeout i budżet pamięci
+TEST(PacketTest, ReassemblyTable) {
+    using netsim::sim::Second;
+    Packet pkt("A", "B", "data", "udp", std::string(1000, 'x'));
+    auto first = pkt.fragmentPacket(300);
+    auto second = pkt.fragmentPacket(300);
+    EXPECT_NE(first[0].fragmentId, 0);
+    EXPECT_NE(first[0].fragmentId, second[0].fragmentId); // unikalne fragmentId
+
+    ReassemblyOptions options;
+    options.timeout = 5 * Second;
+    options.memoryBudgetBytes = 1400;
+    ReassemblyTable table(options);
+    Packet out;
+    EXPECT_EQ(table.insert(first[3], 0, out), ReassemblyStatus::Pending);
+    EXPECT_EQ(table.insert(first[1], 0, out), ReassemblyStatus::Pending);
+    EXPECT_EQ(table.insert(first[1], 0, out), ReassemblyStatus::Duplicate);
+    EXPECT_EQ(table.missingFragments("A", "B", first[0].fragmentId), (std::vector<uint32_t>{0, 2}));
+    EXPECT_EQ(table.bytesHeld(), 400);
+    EXPECT_EQ(table.insert(first[0], 0, out), ReassemblyStatus::Pending);
+    EXPECT_EQ(table.insert(first[2], 0, out), ReassemblyStatus::Complete);
+    EXPECT_EQ(out.payload, pkt.payload);
+    EXPECT_TRUE(out.payload.sharesBufferWith(pkt.payload));
+    EXPECT_EQ(out.fragmentId, 0);
+    EXPECT_EQ(table.pending(), 0);
+    EXPECT_EQ(table.bytesHeld(), 0);
+
+    // Budżet 1400 B: trzeci pakiet wypiera najstarszy niekompletny
+    Packet other("C", "B", "data", "udp", std::string(1000, 'y'));
+    auto third = other.fragmentPacket(300);
+    table.insert(second[0], 0, out);
+    table.insert(second[1], 0, out);
+    table.insert(third[0], 1 * Second, out);
+    table.insert(third[1], 1 * Second, out);
+    table.insert(third[2], 1 * Second, out);
+    EXPECT_EQ(table.stats().evicted, 1);
+    EXPECT_TRUE(table.missingFragments("A", "B", second[0].fragmentId).empty());
+    EXPECT_EQ(table.bytesHeld(), 900);
+
+    // Timeout liczony od pierwszego fragmentu
+    EXPECT_EQ(table.expire(5 * Second), 0);
+    EXPECT_EQ(table.expire(6 * Second), 1);
+    EXPECT_EQ(table.pending(), 0);
+    EXPECT_EQ(table.stats().timedOut, 1);
+}
+
+// Test sprawdza fragmentację wg MTU przy zaplanowanym dostarczeniu i składanie u odbiorcy
+TEST(NetworkTest, FragmentedDeliveryIsReassembled) {
+    Network net;
+    net.addNode<DummyNode>("A", "10.0.0.1");
+    net.addNode<DummyNode>("B", "10.0.0.2");
+    net.connect("A", "B");
+    net.findByName("B")->setMTU(100); // tunel o małym MTU
+
+    Packet jumbo("A", "B", "data", "udp", std::string(9000, 'j'));
+    EXPECT_EQ(net.scheduleFragmentedDelivery(jumbo, 0), 90);
+    net.advanceTime(20);
+    EXPECT_EQ(net.getDeliveredCount("B"), 1);
+    Packet received;
+    ASSERT_TRUE(net.receiveDeliveredPacket("B", received));
+    EXPECT_EQ(received.payload, jumbo.payload);
+
+    // Zgubiony fragment - reszta czeka, po timeout jest porzucana
+    auto fragments = jumbo.fragmentPacket(100);
+    for (size_t i = 1; i < fragments.size(); i++) net.schedulePacketDelivery(fragments[i], 0);
+    net.advanceTime(20);
+    EXPECT_FALSE(net.hasPacketArrived("B"));
+    EXPECT_EQ(net.getReassemblyTable().pending(), 1);
+    net.advanceTime(30 * 1000);
+    EXPECT_EQ(net.getReassemblyTable().pending(), 0);
+    EXPECT_EQ(net.getReassemblyTable().stats().timedOut, 1);
+}
+
 // 27. Wireless Networks: Dodaj symulację sieci bezprzewodowych (Wi-Fi)
 //    - Węzły łączą się bezprzewodowo z zasięgiem i interferencjami
 //    - Metody w Network: connectWireless(a: string, b: string) - łączy jeśli w zasięgu
@@ -978,6 +1105,1857 @@ TEST(NodeTest, ConfigUpdate) {
     EXPECT_EQ(h1->getMaxQueueSize(), 50);
 }
 
+// Test sprawdza przepustowość osiągalną (max-flow) po ustawionych bandwidth
+// Dwie równoległe ścieżki A-B-D (10 + 4) i A-C-D (5 + 8): przepływ 4 + 5 = 9
+TEST(MaxFlowTest, DiamondThroughputAndMinCut) {
+    Network net;
+    for (auto name : {"A", "B", "C", "D"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.connect("A", "B"); net.setBandwidth("A", "B", 10);
+    net.connect("B", "D"); net.setBandwidth("B", "D", 4);
+    net.connect("A", "C"); net.setBandwidth("A", "C", 5);
+    net.connect("C", "D"); net.setBandwidth("C", "D", 8);
+
+    auto snapshot = GraphSnapshot::fromNetwork(net);
+    auto flow = netsim::analysis::MaxFlow(snapshot).compute("A", "D");
+    EXPECT_EQ(flow.maxFlow, 9);
+
+    // Wąskie gardła: B-D (4) oraz A-C (5)
+    std::set<std::pair<std::string, std::string>> cut;
+    for (const auto& link : flow.minCut) cut.insert({link.from, link.to});
+    EXPECT_EQ(cut.size(), 2);
+    EXPECT_TRUE(cut.count({"B", "D"}));
+    EXPECT_TRUE(cut.count({"A", "C"}));
+}
+
+// Test sprawdza zapytania wiele źródeł / wiele ujść oraz pomijanie failed węzłów
+TEST(MaxFlowTest, MultiSourceSinkAndFailedNodes) {
+    Network net;
+    for (auto name : {"S1", "S2", "Core", "T1", "T2"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.connect("S1", "Core"); net.setBandwidth("S1", "Core", 3);
+    net.connect("S2", "Core"); net.setBandwidth("S2", "Core", 4);
+    net.connect("Core", "T1"); net.setBandwidth("Core", "T1", 5);
+    net.connect("Core", "T2"); net.setBandwidth("Core", "T2", 1);
+
+    auto snapshot = GraphSnapshot::fromNetwork(net);
+    netsim::analysis::MaxFlow maxFlow(snapshot);
+    EXPECT_EQ(maxFlow.compute(std::vector<std::string>{"S1", "S2"}, {"T1", "T2"}).maxFlow, 6);
+    EXPECT_EQ(maxFlow.compute("S1", "T1").maxFlow, 3);
+    EXPECT_THROW(maxFlow.compute("S1", "S1"), std::runtime_error);
+
+    net.failNode("Core");
+    auto failedSnapshot = GraphSnapshot::fromNetwork(net);
+    EXPECT_EQ(netsim::analysis::MaxFlow(failedSnapshot).compute(std::vector<std::string>{"S1", "S2"}, {"T1", "T2"}).maxFlow, 0);
+}
+
+// Test sprawdza przyrostową naprawę drzew SPT w Engine po zmianach łączy
+TEST(EngineTest, IncrementalShortestPathRepair) {
+    Network net;
+    for (auto name : {"A", "B", "C", "D"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.connect("A", "B"); net.setLinkDelay("A", "B", 1);
+    net.connect("B", "D"); net.setLinkDelay("B", "D", 1);
+    net.connect("A", "C"); net.setLinkDelay("A", "C", 5);
+    net.connect("C", "D"); net.setLinkDelay("C", "D", 5);
+    Engine engine(net);
+
+    std::vector<std::string> path;
+    EXPECT_TRUE(engine.shortestPath("A", "D", path));
+    EXPECT_EQ(path, (std::vector<std::string>{"A", "B", "D"}));
+    EXPECT_EQ(engine.getShortestDelay("A", "D"), 2);
+
+    net.setLinkDelay("B", "D", 20); // trasa przez C staje się krótsza
+    EXPECT_EQ(engine.getShortestDelay("A", "D"), 10);
+    net.setLinkDelay("C", "D", 1);
+    EXPECT_EQ(engine.getShortestDelay("A", "D"), 6);
+
+    net.failNode("C"); // jedyna krótka trasa znika
+    EXPECT_EQ(engine.getShortestDelay("A", "D"), 21);
+    net.disconnect("B", "D");
+    EXPECT_EQ(engine.getShortestDelay("A", "D"), -1);
+    EXPECT_FALSE(engine.shortestPath("A", "D", path));
+}
+
+// Test porównuje przyrostowe drzewa z pełnym przeliczeniem po losowych zmianach
+TEST(EngineTest, IncrementalShortestPathsMatchFullRecompute) {
+    Network net;
+    const int N = 60;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<> node(0, N - 1), delay(0, 20);
+    for (int i = 0; i < N; ++i) net.addNode<DummyNode>("N" + std::to_string(i), "10.0.0.1");
+    for (int i = 0; i < 3 * N; ++i) {
+        int a = node(gen), b = node(gen);
+        if (a == b) continue;
+        net.connect("N" + std::to_string(a), "N" + std::to_string(b));
+        net.setLinkDelay("N" + std::to_string(a), "N" + std::to_string(b), delay(gen));
+    }
+    Engine engine(net);
+    engine.trackSource("N0");
+    engine.trackSource("N1");
+
+    for (int step = 0; step < 300; ++step) {
+        std::string a = "N" + std::to_string(node(gen)), b = "N" + std::to_string(node(gen));
+        if (a == b) continue;
+        bool linked = net.getAdjacency().count(a) && net.getAdjacency().at(a).count(b);
+        int op = step % 7;
+        if (op == 6 && step % 5 == 0 && a != "N0" && a != "N1") net.failNode(a);
+        else if (linked && op < 3) net.setLinkDelay(a, b, delay(gen));
+        else if (linked && op == 3) net.disconnect(a, b);
+        else if (!linked) { net.connect(a, b); net.setLinkDelay(a, b, delay(gen)); }
+
+        netsim::analysis::DynamicShortestPaths full(GraphSnapshot::fromNetwork(net));
+        full.addSource(net.getNodeId("N0"));
+        full.addSource(net.getNodeId("N1"));
+        for (int t = 0; t < N; ++t) {
+            NodeId id = net.getNodeId("N" + std::to_string(t));
+            for (auto src : {"N0", "N1"})
+                ASSERT_EQ(engine.getShortestPathTrees()->distance(net.getNodeId(src), id),
+                          full.distance(net.getNodeId(src), id)) << "step " << step;
+        }
+    }
+}
+
+// Test sprawdza betweenness/closeness na ścieżce A-B-C-D-E oraz punkty artykulacji
+TEST(CentralityTest, PathGraphExactScores) {
+    Network net;
+    for (auto name : {"A", "B", "C", "D", "E"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.connect("A", "B"); net.connect("B", "C"); net.connect("C", "D"); net.connect("D", "E");
+
+    auto snapshot = GraphSnapshot::fromNetwork(net);
+    netsim::analysis::CentralityOptions options;
+    options.threads = 3;
+    auto report = netsim::analysis::Centrality(snapshot).compute(options);
+
+    // C leży na 4 z 6 par nie-sąsiadujących przez siebie, B na 3
+    EXPECT_NEAR(report.betweenness[snapshot.idOf("C")], 4.0 / 6.0, 1e-9);
+    EXPECT_NEAR(report.betweenness[snapshot.idOf("B")], 3.0 / 6.0, 1e-9);
+    EXPECT_NEAR(report.betweenness[snapshot.idOf("A")], 0.0, 1e-9);
+    EXPECT_NEAR(report.closeness[snapshot.idOf("C")], 4.0 / 6.0, 1e-9);
+    EXPECT_EQ(report.topByBetweenness(1)[0], snapshot.idOf("C"));
+    EXPECT_FALSE(report.approximate);
+
+    EXPECT_EQ(report.articulationPoints.size(), 3);
+    EXPECT_EQ(report.bridges.size(), 4);
+    EXPECT_EQ(report.degreeDistribution[1], 2);
+    EXPECT_EQ(report.degreeDistribution[2], 3);
+}
+
+// Test sprawdza pierścień z ogonem, pominięcie failed węzła i tryb próbkowany
+TEST(CentralityTest, RingBridgesAndSampling) {
+    Network net;
+    for (auto name : {"A", "B", "C", "D", "E", "F"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.connect("A", "B"); net.connect("B", "C"); net.connect("C", "D"); net.connect("D", "A");
+    net.connect("D", "E"); net.connect("E", "F");
+
+    auto snapshot = GraphSnapshot::fromNetwork(net);
+    netsim::analysis::Centrality centrality(snapshot);
+    auto exact = centrality.compute();
+    std::set<std::string> cut;
+    for (NodeId id : exact.articulationPoints) cut.insert(snapshot.nameOf(id));
+    EXPECT_EQ(cut, (std::set<std::string>{"D", "E"}));
+    EXPECT_EQ(exact.bridges.size(), 2);
+
+    // Próbka obejmująca wszystkie źródła daje wynik dokładny
+    netsim::analysis::CentralityOptions options;
+    options.sampleSources = 100;
+    auto full = centrality.compute(options);
+    for (NodeId id : exact.nodes) EXPECT_NEAR(full.betweenness[id], exact.betweenness[id], 1e-9);
+
+    options.sampleSources = 3;
+    auto sampled = centrality.compute(options);
+    EXPECT_TRUE(sampled.approximate);
+    EXPECT_EQ(sampled.sourcesUsed, 3);
+
+    net.failNode("D");
+    auto failed = GraphSnapshot::fromNetwork(net);
+    auto split = netsim::analysis::Centrality(failed).compute();
+    EXPECT_EQ(split.nodes.size(), 5);
+    EXPECT_NEAR(split.betweenness[failed.idOf("D")], 0.0, 1e-9);
+}
+
+// Test sprawdza analizę awarii: pojedyncze/podwójne awarie routerów i grupy SRG
+TEST(ResilienceTest, FailureSetsAndCombinations) {
+    Network net;
+    for (auto name : {"H1", "H2", "R1", "R2", "C1", "C2"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.connect("H1", "R1"); net.connect("H2", "R2");
+    net.connect("R1", "C1"); net.connect("R1", "C2");
+    net.connect("R2", "C1"); net.connect("R2", "C2");
+
+    auto snapshot = GraphSnapshot::fromNetwork(net);
+    auto id = [&](const std::string& n) { return snapshot.idOf(n); };
+    netsim::analysis::ResilienceAnalyzer analyzer(snapshot);
+    netsim::analysis::ResilienceQuery hosts;
+    hosts.sources = {id("H1"), id("H2")};
+
+    using netsim::analysis::ResilienceAnalyzer;
+    auto singles = ResilienceAnalyzer::nodeCombinations(snapshot, {id("R1"), id("R2"), id("C1"), id("C2")}, 1);
+    auto report = analyzer.evaluate(singles, hosts);
+    EXPECT_EQ(report.totalPairs, 1);
+    EXPECT_EQ(report.baselineConnectedPairs, 1);
+    std::map<std::string, uint64_t> affected;
+    for (const auto& impact : report.impacts) affected[impact.label] = impact.affectedPairs;
+    EXPECT_EQ(affected["R1"], 1);
+    EXPECT_EQ(affected["C1"], 0);
+    EXPECT_EQ(report.impacts[0].pairs.size(), 1);
+
+    // Podwójna awaria rdzenia rozłącza hosty
+    auto doubles = ResilienceAnalyzer::nodeCombinations(snapshot, {id("R1"), id("R2"), id("C1"), id("C2")}, 2);
+    EXPECT_EQ(doubles.size(), 6);
+    for (const auto& impact : analyzer.evaluate(doubles, hosts).impacts)
+        EXPECT_EQ(impact.affectedPairs, 1) << impact.label;
+
+    // SRG: oba uplinki R1 w jednym kanale kablowym
+    netsim::analysis::FailureSet conduit{"conduit", {}, {{id("R1"), id("C1")}, {id("R1"), id("C2")}}};
+    netsim::analysis::ResilienceQuery toCore;
+    toCore.sources = {id("H1"), id("H2")};
+    toCore.targets = {id("C1")};
+    auto srg = analyzer.evaluate({conduit}, toCore);
+    EXPECT_EQ(srg.baselineConnectedPairs, 2);
+    EXPECT_EQ(srg.impacts[0].affectedPairs, 1);
+    EXPECT_EQ(srg.impacts[0].failedEndpoints, 0);
+
+    // Snapshot nie jest modyfikowany, a zbyt duża enumeracja jest odrzucana
+    EXPECT_EQ(analyzer.evaluate(singles, hosts).impacts[1].affectedPairs, report.impacts[1].affectedPairs);
+    EXPECT_THROW(ResilienceAnalyzer::linkCombinations(snapshot, 3, 10), std::runtime_error);
+}
+
+// Test sprawdza koło czasowe: kolejność, FIFO dla równych czasów, kaskadę i anulowanie
+TEST(EventSchedulerTest, OrderingCascadeAndCancel) {
+    using namespace netsim::sim;
+    EventScheduler scheduler;
+    std::vector<std::pair<SimTime, uint64_t>> fired;
+    EventType record = scheduler.registerHandler([&](const Event& ev) { fired.push_back({ev.time, ev.arg0}); });
+
+    // Czasy z różnych poziomów koła (ns .. godziny) zaplanowane w losowej kolejności
+    std::vector<SimTime> times = {3600 * Second, 5, 70, 5, 4096 * Microsecond, 1, 70 * Millisecond, 5};
+    for (size_t i = 0; i < times.size(); ++i) scheduler.schedule(times[i], record, i);
+    EventId dropped = scheduler.schedule(2 * Second, record, 99);
+    EXPECT_TRUE(scheduler.cancel(dropped));
+    EXPECT_FALSE(scheduler.cancel(dropped));
+    EXPECT_EQ(scheduler.pending(), times.size());
+
+    EXPECT_EQ(scheduler.runUntil(70 * Millisecond), 7);
+    EXPECT_EQ(scheduler.now(), 70 * Millisecond);
+    std::vector<uint64_t> order;
+    for (auto& f : fired) order.push_back(f.second);
+    EXPECT_EQ(order, (std::vector<uint64_t>{5, 1, 3, 7, 2, 4, 6})); // równe czasy w kolejności planowania
+
+    // Zdarzenie zaplanowane wcześniej, ale na dalszy poziom, nadal poprzedza nowsze o tym samym czasie
+    scheduler.schedule(3600 * Second, record, 100);
+    SimTime next = 0;
+    ASSERT_TRUE(scheduler.nextEventTime(next));
+    EXPECT_EQ(next, 3600 * Second);
+    EXPECT_EQ(scheduler.run(), 2);
+    EXPECT_EQ(fired[7].second, 0);
+    EXPECT_EQ(fired[8].second, 100);
+    EXPECT_THROW(scheduler.schedule(1, record), std::runtime_error);
+}
+
+// Test sprawdza handlery planujące i anulujące zdarzenia w trakcie wykonywania
+TEST(EventSchedulerTest, HandlersScheduleAndCancel) {
+    using namespace netsim::sim;
+    EventScheduler scheduler;
+    int ticks = 0;
+    EventId victim = InvalidEvent;
+    EventType tick = 0;
+    tick = scheduler.registerHandler([&](const Event& ev) {
+        ticks++;
+        if (ev.arg0 > 0) scheduler.scheduleAfter(ev.arg0 == 1 ? 0 : Microsecond, tick, ev.arg0 - 1);
+    });
+    EventType killer = scheduler.registerHandler([&](const Event&) { EXPECT_TRUE(scheduler.cancel(victim)); });
+
+    scheduler.schedule(10, tick, 5);
+    scheduler.schedule(20, killer);
+    victim = scheduler.schedule(20, tick, 0); // ten sam czas, później w kolejce - zostanie anulowany
+    scheduler.run();
+    EXPECT_EQ(ticks, 6);
+    EXPECT_EQ(scheduler.pending(), 0);
+    EXPECT_EQ(scheduler.executed(), 7);
+}
+
+// Test sprawdza kolejki dostarczeń per węzeł (zamiast flagi arrivedPackets)
+TEST(NetworkTest, DeliveryQueuesKeepEveryPacket) {
+    Network net;
+    net.addNode<DummyNode>("A", "10.0.0.1");
+    net.addNode<DummyNode>("B", "10.0.0.2");
+    net.connect("A", "B");
+    net.setLinkDelay("A", "B", 5);
+
+    net.schedulePacketDelivery(Packet("A", "B", "data", "udp", "first"), 0);
+    net.schedulePacketDelivery(Packet("A", "B", "data", "udp", "second"), 0);
+    auto cancelled = net.schedulePacketDelivery(Packet("A", "B", "data", "udp", "never"), 1);
+    EXPECT_TRUE(net.cancelPacketDelivery(cancelled));
+    EXPECT_FALSE(net.cancelPacketDelivery(cancelled));
+
+    // Zdarzenie innego typu na schedulerze sieci nie jest dostarczeniem - zostaje w kolejce
+    bool timerFired = false;
+    auto timer = net.getScheduler().registerHandler([&](const netsim::sim::Event&) { timerFired = true; });
+    auto timerId = net.getScheduler().schedule(10 * netsim::sim::Millisecond, timer);
+    EXPECT_FALSE(net.cancelPacketDelivery(timerId));
+
+    net.advanceTime(20);
+    EXPECT_TRUE(timerFired);
+    EXPECT_EQ(net.getSimTime(), 20 * netsim::sim::Millisecond);
+    EXPECT_EQ(net.getDeliveredCount("B"), 2);
+    Packet pkt;
+    ASSERT_TRUE(net.receiveDeliveredPacket("B", pkt));
+    EXPECT_EQ(pkt.payload, "first");
+    ASSERT_TRUE(net.receiveDeliveredPacket("B", pkt));
+    EXPECT_EQ(pkt.payload, "second");
+    EXPECT_FALSE(net.hasPacketArrived("B"));
+}
+
+// Test porównuje kolejność wykonania z sortowaniem (czas, kolejność planowania) dla losowych zdarzeń
+TEST(EventSchedulerTest, RandomEventsMatchSortedOrder) {
+    using namespace netsim::sim;
+    EventScheduler scheduler;
+    std::vector<std::pair<SimTime, uint64_t>> fired, expected;
+    EventType record = scheduler.registerHandler([&](const Event& ev) { fired.push_back({ev.time, ev.arg0}); });
+
+    std::mt19937_64 gen(11);
+    std::vector<EventId> ids;
+    for (uint64_t i = 0; i < 5000; ++i) {
+        SimTime at = gen() % (1ull << (4 + gen() % 40)); // rozkład po wielu poziomach koła
+        ids.push_back(scheduler.schedule(at, record, i));
+        expected.push_back({at, i});
+    }
+    for (uint64_t i = 0; i < 5000; i += 7) scheduler.cancel(ids[i]);
+    expected.erase(std::remove_if(expected.begin(), expected.end(),
+        [](const std::pair<SimTime, uint64_t>& e) { return e.second % 7 == 0; }), expected.end());
+    std::stable_sort(expected.begin(), expected.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    // Przesuwanie czasu w krokach musi dać tę samą kolejność co jedno run()
+    for (SimTime t = 1; t < (1ull << 44); t *= 3) scheduler.runUntil(t);
+    scheduler.run();
+    EXPECT_EQ(fired, expected);
+}
+
+// Test sprawdza symulację hop-by-hop: serializacja + propagacja + kolejkowanie i przepełnienie bufora
+TEST(PacketSimulatorTest, SerializationQueueingAndDrops) {
+    using namespace netsim::sim;
+    Network net;
+    for (auto name : {"A", "B", "C"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.connect("A", "B"); net.setLinkDelay("A", "B", 1); net.setBandwidth("A", "B", 8);
+    net.connect("B", "C"); net.setLinkDelay("B", "C", 1); net.setBandwidth("B", "C", 8);
+    net.findByName("A")->setMaxQueueSize(1);
+
+    PacketSimulator sim(net);
+    NodeId a = net.getNodeId("A"), c = net.getNodeId("C");
+    // 1000 B przy 8 Mbps = 1 ms serializacji na każdym hopie
+    PacketId first = sim.inject(a, c, 1000, 0);
+    PacketId second = sim.inject(a, c, 1000, 0);
+    PacketId third = sim.inject(a, c, 1000, 0);
+    sim.runUntil(Microsecond);
+    EXPECT_EQ(sim.queuedAt(a), 1u);
+    sim.run();
+
+    EXPECT_EQ(sim.record(first).status, PacketStatus::Delivered);
+    EXPECT_EQ(sim.record(first).latency(), 4 * Millisecond);
+    EXPECT_EQ(sim.record(first).hops, 2);
+    EXPECT_EQ(sim.record(second).latency(), 5 * Millisecond);
+    EXPECT_EQ(sim.record(second).queueingDelay, 1 * Millisecond);
+    EXPECT_EQ(sim.record(third).status, PacketStatus::DroppedQueue);
+    EXPECT_EQ(sim.stats().delivered, 2);
+    EXPECT_EQ(sim.stats().hops, 4);
+}
+
+// Test sprawdza utratę pakietów na łączu, TTL i brak trasy przez failed węzeł
+TEST(PacketSimulatorTest, LossTtlAndFailedNodes) {
+    using namespace netsim::sim;
+    Network net;
+    for (auto name : {"A", "B", "C", "D"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.connect("A", "B"); net.connect("B", "C"); net.connect("C", "D");
+    net.setPacketLoss("C", "D", 1.0);
+
+    {
+        PacketSimulator sim(net);
+        Packet ttlLimited("A", "C", "data", "udp", "x");
+        ttlLimited.ttl = 1;
+        PacketId lost = sim.inject(Packet("A", "D", "data", "udp", "x"), 0);
+        PacketId expired = sim.inject(ttlLimited, 0);
+        PacketId ok = sim.inject(Packet("A", "C", "data", "udp", "x"), 0);
+        sim.run();
+        EXPECT_EQ(sim.record(lost).status, PacketStatus::DroppedLoss);
+        EXPECT_EQ(sim.record(expired).status, PacketStatus::DroppedTtl);
+        EXPECT_EQ(sim.record(ok).status, PacketStatus::Delivered);
+        EXPECT_EQ(sim.record(ok).sizeBytes, 41u);
+    }
+
+    net.failNode("B");
+    PacketSimulator sim(net);
+    PacketId blocked = sim.inject(Packet("A", "C", "data", "udp", "x"), 0);
+    sim.run();
+    EXPECT_EQ(sim.record(blocked).status, PacketStatus::NoRoute);
+}
+
+// Test sprawdza, że symulacja podzielona na partycje daje identyczne wyniki jak sekwencyjna
+TEST(PacketSimulatorTest, PartitionedRunMatchesSequential) {
+    using namespace netsim::sim;
+    const int SIDE = 8;
+    Network net;
+    auto name = [](int i) { return "N" + std::to_string(i); };
+    for (int i = 0; i < SIDE * SIDE; i++) {
+        net.addNode<DummyNode>(name(i), "10.0.0.1");
+        net.findByName(name(i))->setMaxQueueSize(2);
+    }
+    for (int r = 0; r < SIDE; r++) {
+        for (int c = 0; c < SIDE; c++) {
+            int i = r * SIDE + c;
+            if (c + 1 < SIDE) { net.connect(name(i), name(i + 1)); net.setLinkDelay(name(i), name(i + 1), 1 + i % 3); net.setBandwidth(name(i), name(i + 1), 100); }
+            if (r + 1 < SIDE) { net.connect(name(i), name(i + SIDE)); net.setLinkDelay(name(i), name(i + SIDE), 1 + i % 2); net.setPacketLoss(name(i), name(i + SIDE), 0.05); }
+        }
+    }
+
+    auto simulate = [&](unsigned partitions) {
+        PacketSimOptions options;
+        options.partitions = partitions;
+        auto sim = std::make_unique<PacketSimulator>(net, options);
+        std::mt19937 gen(3);
+        std::uniform_int_distribution<> node(0, SIDE * SIDE - 1);
+        for (int i = 0; i < 2000; i++) {
+            int src = node(gen), dst = node(gen);
+            if (src != dst) sim->inject(net.getNodeId(name(src)), net.getNodeId(name(dst)), 1500, (i / 10) * Millisecond);
+        }
+        sim->runUntil(50 * Millisecond);
+        sim->run();
+        return sim;
+    };
+    auto sequential = simulate(1);
+    auto parallel = simulate(4);
+
+    EXPECT_EQ(parallel->partitionCount(), 4);
+    EXPECT_EQ(parallel->lookahead(), Millisecond);
+    EXPECT_GT(sequential->stats().droppedLoss, 0u);
+    EXPECT_GT(sequential->stats().droppedQueue, 0u);
+    EXPECT_EQ(parallel->now(), sequential->now());
+    EXPECT_EQ(parallel->stats().delivered, sequential->stats().delivered);
+    EXPECT_EQ(parallel->stats().hops, sequential->stats().hops);
+    ASSERT_EQ(parallel->records().size(), sequential->records().size());
+    for (size_t i = 0; i < sequential->records().size(); i++) {
+        const PacketRecord& a = sequential->records()[i];
+        const PacketRecord& b = parallel->records()[i];
+        EXPECT_EQ(a.status, b.status) << "packet " << i;
+        EXPECT_EQ(a.finishedAt, b.finishedAt) << "packet " << i;
+        EXPECT_EQ(a.location, b.location) << "packet " << i;
+    }
+
+    // Łącze o zerowym opóźnieniu nie może łączyć partycji
+    net.setLinkDelay(name(0), name(1), 0);
+    PacketSimOptions options;
+    options.partitions = 2;
+    options.partitionOf.assign(SIDE * SIDE, 0);
+    options.partitionOf[net.getNodeId(name(1))] = 1;
+    EXPECT_THROW(PacketSimulator(net, options), std::runtime_error);
+    options.partitionOf.clear();
+    PacketSimulator split(net, options);
+    EXPECT_EQ(split.partitionOf(net.getNodeId(name(0))), split.partitionOf(net.getNodeId(name(1))));
+}
+
+// Test sprawdza, że krok wait przesuwa wirtualny zegar sieci zamiast spać
+TEST(ScenarioRunnerTest, WaitAdvancesVirtualTime) {
+    Network net;
+    Engine engine(net);
+    net.addNode<DummyNode>("A", "10.0.0.1");
+    net.addNode<DummyNode>("B", "10.0.0.2");
+    net.connect("A", "B");
+    net.schedulePacketDelivery(Packet("A", "B", "data", "udp", "x"), 60 * 1000);
+
+    netsim::scenario::ScenarioRunner runner(net, engine);
+    netsim::scenario::ScenarioStep wait;
+    wait.name = "Wait 30 minutes";
+    wait.action = "wait";
+    wait.params = {{"duration_ms", 30 * 60 * 1000}};
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = runner.executeStep(wait);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_TRUE(result.success);
+    EXPECT_FALSE(result.actual_values["realtime"].get<bool>());
+    EXPECT_EQ(net.getSimTime(), 30ull * 60 * netsim::sim::Second);
+    EXPECT_TRUE(net.hasPacketArrived("B"));
+    EXPECT_LT(std::chrono::duration<double>(elapsed).count(), 1.0);
+
+    wait.params = {{"duration_ms", -1}};
+    EXPECT_FALSE(runner.executeStep(wait).success);
+
+    auto scenario = netsim::scenario::Scenario::fromJSON({{"name", "demo"}, {"realtime_pacing", true}});
+    EXPECT_TRUE(scenario.realtime_pacing);
+    EXPECT_TRUE(scenario.toJSON()["realtime_pacing"].get<bool>());
+}
+
+// Test sprawdza statystyczne szacowanie dostarczenia: próbkowanie per pakiet, dwumianowe i przedział ufności
+TEST(DeliveryEstimatorTest, SampledRateMatchesPathSurvival) {
+    using namespace netsim::analysis;
+    Network net;
+    for (auto name : {"A", "B", "C", "D", "E"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.connect("A", "B"); net.connect("B", "C"); net.connect("C", "D");
+    net.setPacketLoss("A", "B", 0.1);
+    net.setPacketLoss("B", "C", 0.1);
+    net.setPacketLoss("C", "D", 0.1);
+    auto snapshot = GraphSnapshot::fromNetwork(net);
+    DeliveryEstimator estimator(snapshot);
+    NodeId a = snapshot.idOf("A"), d = snapshot.idOf("D");
+
+    auto sampled = estimator.estimate(a, d, 100000);
+    EXPECT_TRUE(sampled.perPacket);
+    EXPECT_EQ(sampled.path.size(), 4);
+    EXPECT_NEAR(sampled.pathSurvival, 0.729, 1e-12);
+    EXPECT_LT(sampled.confidenceLow, 0.729);
+    EXPECT_GT(sampled.confidenceHigh, 0.729);
+    EXPECT_EQ(sampled.delivered + sampled.droppedPerHop[0] + sampled.droppedPerHop[1] + sampled.droppedPerHop[2], 100000);
+    EXPECT_EQ(estimator.estimate(a, d, 100000).delivered, sampled.delivered); // deterministyczne dla seed
+
+    auto huge = estimator.estimate(a, d, 100000000);
+    EXPECT_FALSE(huge.perPacket);
+    EXPECT_NEAR(huge.deliveryRate, 0.729, 1e-3);
+    EXPECT_LT(huge.confidenceHigh - huge.confidenceLow, 1e-3);
+
+    net.setPacketLoss("B", "C", 1.0);
+    auto blackhole = DeliveryEstimator(GraphSnapshot::fromNetwork(net)).estimate(a, d, 1000);
+    EXPECT_EQ(blackhole.delivered, 0);
+    EXPECT_EQ(blackhole.droppedPerHop[1], blackhole.sent - blackhole.droppedPerHop[0]);
+    EXPECT_FALSE(estimator.estimate(a, snapshot.idOf("E"), 10).reachable);
+
+    auto [low, high] = DeliveryEstimator::wilsonInterval(50, 100, 0.95);
+    EXPECT_NEAR(low, 0.4038, 1e-3);
+    EXPECT_NEAR(high, 0.5962, 1e-3);
+}
+
+// Test sprawdza, że krok send uwzględnia packetLoss i szybko szacuje dostarczenie wielu pakietów
+TEST(ScenarioRunnerTest, SendEstimatesDeliveryWithLoss) {
+    Network net;
+    Engine engine(net);
+    net.addNode<DummyNode>("A", "10.0.0.1");
+    net.addNode<DummyNode>("B", "10.0.0.2");
+    net.connect("A", "B");
+    net.setPacketLoss("A", "B", 0.1);
+
+    netsim::scenario::ScenarioRunner runner(net, engine);
+    netsim::scenario::ScenarioStep send;
+    send.name = "Bulk send";
+    send.action = "send";
+    send.params = {{"from", "A"}, {"to", "B"}, {"count", 100000000}, {"size_bytes", 1500}};
+    send.expect = {{"min_delivery_rate", 0.85}};
+    auto result = runner.executeStep(send);
+    EXPECT_TRUE(result.success) << result.message;
+    EXPECT_NEAR(result.actual_values["delivery_rate"].get<double>(), 0.9, 1e-3);
+    EXPECT_EQ(result.actual_values["delivery_rate_ci"].size(), 2);
+
+    send.expect = {{"min_delivery_rate", 0.95}};
+    EXPECT_FALSE(runner.executeStep(send).success);
+}
+
+// Test sprawdza podział max-min fair i czasy zakończenia w modelu przepływowym
+TEST(FluidSimulatorTest, MaxMinFairSharingAndCompletionTimes) {
+    using namespace netsim::sim;
+    Network net;
+    for (auto name : {"A", "B", "C", "D"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.connect("A", "B"); net.setLinkDelay("A", "B", 1); net.setBandwidth("A", "B", 10);
+    net.connect("B", "C"); net.setLinkDelay("B", "C", 1); net.setBandwidth("B", "C", 4);
+    net.connect("C", "D"); net.setLinkDelay("C", "D", 1);
+    Engine engine(net);
+
+    FluidSimulator sim(net, engine);
+    // B-C jest wąskim gardłem (2 x 2 Mbps), A->B dostaje resztę łącza A-B
+    FlowId through = sim.addFlow("A", "C", 1000000);
+    FlowId local = sim.addFlow("A", "B", 10000000);
+    FlowId second = sim.addFlow("B", "C", 1000000);
+    FlowId capped = sim.addFlow("C", "D", 125000, 0, 0.5);
+    sim.runUntil(Millisecond);
+    EXPECT_NEAR(sim.currentRateMbps(through), 2.0, 1e-9);
+    EXPECT_NEAR(sim.currentRateMbps(local), 8.0, 1e-9);
+    EXPECT_NEAR(sim.currentRateMbps(second), 2.0, 1e-9);
+    EXPECT_NEAR(sim.currentRateMbps(capped), 0.5, 1e-9);
+    EXPECT_EQ(sim.activeFlows(), 4u);
+    sim.run();
+
+    // 8 Mb przy 2 Mbps = 4 s; potem A->B dostaje całe 10 Mbps na pozostałe 48 Mb
+    EXPECT_EQ(sim.flow(through).status, FlowStatus::Completed);
+    EXPECT_NEAR(double(sim.flow(through).completionTime()), 4.0 * Second + 2 * Millisecond, 10.0);
+    EXPECT_NEAR(double(sim.flow(second).completionTime()), 4.0 * Second + 1 * Millisecond, 10.0);
+    EXPECT_NEAR(double(sim.flow(local).completionTime()), 8.8 * Second + 1 * Millisecond, 10.0);
+    EXPECT_NEAR(double(sim.flow(capped).completionTime()), 2.0 * Second + 1 * Millisecond, 10.0);
+    EXPECT_NEAR(sim.flow(local).averageRateMbps(), 80.0 / 8.8, 1e-6);
+
+    bool sawBottleneck = false;
+    for (const auto& link : sim.linkStats()) {
+        if (link.from != net.getNodeId("B") || link.to != net.getNodeId("C")) continue;
+        sawBottleneck = true;
+        EXPECT_NEAR(link.peakUtilization, 1.0, 1e-9);
+        EXPECT_NEAR(link.utilization, 4.0 / 8.8, 1e-6);
+    }
+    EXPECT_TRUE(sawBottleneck);
+    EXPECT_EQ(sim.activeFlows(), 0u);
+
+    net.failNode("D");
+    FluidSimulator after(net, engine);
+    EXPECT_EQ(after.flow(after.addFlow("A", "D", 1000)).status, FlowStatus::NoRoute);
+    EXPECT_THROW(after.addFlow("A", "X", 1000), std::runtime_error);
+}
+
+// Test sprawdza handshake, transfer i reakcję Reno/CUBIC na straty i przepełnione kolejki
+TEST(TcpSimulatorTest, HandshakeTransferAndCongestionControl) {
+    using namespace netsim::sim;
+    Network net;
+    for (auto name : {"A", "B", "C"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.connect("A", "B"); net.setLinkDelay("A", "B", 5); net.setBandwidth("A", "B", 100);
+    net.connect("B", "C"); net.setLinkDelay("B", "C", 5); net.setBandwidth("B", "C", 10);
+    net.findByName("B")->setMaxQueueSize(20);
+
+    {
+        TcpSimulator tcp(net);
+        ConnectionId handshake = tcp.connect("A", "C", 0);
+        ConnectionId bulk = tcp.connect("A", "C", 500000, 100 * Millisecond);
+        tcp.run();
+        auto hs = tcp.stats(handshake);
+        EXPECT_EQ(hs.state, TcpState::Finished);
+        // SYN + SYN-ACK: 2 x 10 ms propagacji + serializacja 40 B na łączach
+        EXPECT_GE(hs.handshakeLatency(), 20 * Millisecond);
+        EXPECT_LT(hs.handshakeLatency(), 21 * Millisecond);
+
+        auto s = tcp.stats(bulk);
+        EXPECT_EQ(s.state, TcpState::Finished);
+        EXPECT_EQ(s.bytesAcked, 500000u);
+        EXPECT_GT(s.goodputMbps(), 3.0);
+        EXPECT_LT(s.goodputMbps(), 10.0);
+        // Bufor 20 pakietów na łączu 10 Mbps - slow start musi go przepełnić
+        EXPECT_GT(s.retransmissions, 0u);
+        EXPECT_GT(s.fastRetransmits + s.timeouts, 0u);
+        EXPECT_GT(tcp.packets().stats().droppedQueue, 0u);
+    }
+
+    net.setPacketLoss("A", "B", 0.02);
+    for (auto cc : {TcpCongestionControl::Reno, TcpCongestionControl::Cubic}) {
+        TcpOptions options;
+        options.congestionControl = cc;
+        TcpSimulator tcp(net, options);
+        std::vector<ConnectionId> ids;
+        for (int i = 0; i < 4; ++i) ids.push_back(tcp.connect("A", "C", 200000, i * Millisecond));
+        tcp.run();
+        for (ConnectionId id : ids) {
+            auto s = tcp.stats(id);
+            EXPECT_EQ(s.state, TcpState::Finished);
+            EXPECT_GT(s.srtt, 20 * Millisecond);
+            EXPECT_GE(s.segmentsSent, 137u);   // 200000 / 1460 segmentów
+        }
+    }
+
+    net.failNode("C");
+    TcpOptions quick;
+    quick.maxRetries = 2;
+    TcpSimulator unreachable(net, quick);
+    ConnectionId failed = unreachable.connect("A", "C", 1000);
+    unreachable.run();
+    EXPECT_EQ(unreachable.state(failed), TcpState::Failed);
+    EXPECT_EQ(unreachable.now(), 7 * Second); // SYN po 1 s, 2 s, 4 s
+    EXPECT_FALSE(net.initiateTCPConnection("A", "C"));
+    EXPECT_TRUE(net.initiateTCPConnection("A", "B"));
+}
+
+// Test sprawdza dyscypliny kolejek (priorytety, DRR, RED, CoDel), kolejkę węzła i kolejki portów w symulacji
+TEST(QueueDisciplineTest, DisciplinesNodeQueueAndPerPortSimulation) {
+    using namespace netsim::sim;
+    auto item = [](uint32_t handle, uint32_t size, uint32_t flow, uint8_t priority) {
+        QueueItem it;
+        it.handle = handle; it.sizeBytes = size; it.flow = flow; it.priority = priority;
+        return it;
+    };
+    QueueItem out;
+
+    QueueConfig config;
+    config.type = QueueDisciplineType::StrictPriority;
+    config.capacity = 5;
+    config.bands = 4;
+    auto prio = QueueDiscipline::create(config);
+    uint8_t priorities[] = {0, 3, 1, 9, 2};
+    for (uint32_t i = 0; i < 5; ++i) EXPECT_EQ(prio->enqueue(item(i, 100, 0, priorities[i]), 0), EnqueueResult::Queued);
+    EXPECT_EQ(prio->enqueue(item(5, 100, 0, 3), 0), EnqueueResult::DroppedOverflow);
+    std::vector<uint32_t> order;
+    while (prio->dequeue(10, out)) order.push_back(out.handle);
+    EXPECT_EQ(order, (std::vector<uint32_t>{1, 3, 4, 2, 0}));   // priorytet 9 obcięty do pasma 3
+    EXPECT_EQ(prio->bandStats()[3].droppedOverflow, 1u);
+    EXPECT_EQ(prio->totals().dequeued, 5u);
+    EXPECT_EQ(prio->totals().maxSojourn, 10u);
+
+    // DRR: przepływ dużych i przepływ małych pakietów dostają po równo bajtów
+    config.type = QueueDisciplineType::DeficitRoundRobin;
+    config.capacity = 100;
+    config.bands = 16;
+    auto drr = QueueDiscipline::create(config);
+    for (uint32_t i = 0; i < 20; ++i) drr->enqueue(item(i, 1500, 1, 0), 0);
+    for (uint32_t i = 0; i < 60; ++i) drr->enqueue(item(100 + i, 500, 2, 0), 0);
+    uint64_t bytes[2] = {0, 0};
+    for (int i = 0; i < 40; ++i) {
+        ASSERT_TRUE(drr->dequeue(0, out));
+        bytes[out.handle >= 100] += out.sizeBytes;
+    }
+    EXPECT_LE(std::max(bytes[0], bytes[1]) - std::min(bytes[0], bytes[1]), 1500u);
+
+    // RED: rosnąca kolejka bez obsługi - odrzucenia wczesne, zanim bufor się zapełni
+    config.type = QueueDisciplineType::Red;
+    config.redWeight = 0.2;
+    auto red = QueueDiscipline::create(config);
+    for (uint32_t i = 0; i < 100; ++i) red->enqueue(item(i, 1000, 0, 0), 0);
+    EXPECT_GT(red->totals().droppedEarly, 0u);
+    EXPECT_EQ(red->totals().droppedOverflow, 0u);
+    EXPECT_LT(red->size(), 20u);
+    EXPECT_EQ(red->size() + red->totals().droppedEarly, 100u);
+
+    // CoDel: stojąca kolejka (obsługa co 10 ms) - odrzucenia przy wyjmowaniu po interval
+    config.type = QueueDisciplineType::CoDel;
+    auto codel = QueueDiscipline::create(config);
+    for (uint32_t i = 0; i < 60; ++i) codel->enqueue(item(i, 1500, 0, 0), 0);
+    std::vector<QueueItem> dropped;
+    SimTime t = 0;
+    size_t served = 0;
+    while (codel->dequeue(t, out, &dropped)) {
+        served++;
+        t += 10 * Millisecond;
+    }
+    EXPECT_GT(dropped.size(), 0u);
+    EXPECT_EQ(served + dropped.size(), 60u);
+    EXPECT_EQ(codel->totals().droppedEarly, dropped.size());
+    EXPECT_THROW(QueueConfig::parseType("wfq"), std::runtime_error);
+
+    // Kolejka węzła: dyscyplina na slotach z puli, pojemność = maxQueueSize
+    Network net;
+    for (auto name : {"A", "B", "C"}) net.addNode<DummyNode>(name, "10.0.0.1");
+    net.setQueueSize("A", 3);
+    QueueConfig nodeQueue;
+    nodeQueue.type = QueueDisciplineType::StrictPriority;
+    net.setQueueDiscipline("A", nodeQueue);
+    for (int p : {1, 5, 2}) {
+        Packet pkt("A", "B", "data", "udp", "p" + std::to_string(p));
+        pkt.setPriority(p);
+        EXPECT_TRUE(net.enqueuePacket("A", pkt));
+    }
+    EXPECT_TRUE(net.isCongested("A"));
+    EXPECT_FALSE(net.enqueuePacket("A", Packet("A", "B", "data", "udp", "x")));
+    Packet first;
+    EXPECT_TRUE(net.findByName("A")->dequeuePacket(&first));
+    EXPECT_EQ(first.getPriority(), 5);
+    EXPECT_EQ(net.findByName("A")->getQueueStats()[0].droppedOverflow, 1u);
+
+    // Symulacja: priorytetowy ruch omija kolejkę na wąskim gardle B -> C
+    net.setQueueSize("A", 200);
+    net.setQueueDiscipline("A", QueueConfig());
+    net.connect("A", "B"); net.setBandwidth("A", "B", 100);
+    net.connect("B", "C"); net.setBandwidth("B", "C", 10);
+    net.setQueueSize("B", 200);
+    net.setQueueDiscipline("B", nodeQueue);
+    {
+        PacketSimulator sim(net);
+        std::vector<PacketId> low, high;
+        for (int i = 0; i < 150; ++i) low.push_back(sim.inject(0, 2, 1500, i * 120 * Microsecond));
+        for (int i = 0; i < 10; ++i) high.push_back(sim.inject(0, 2, 1500, 5 * Millisecond + i * 3 * Millisecond, 64, 7));
+        sim.run();
+        EXPECT_NE(sim.portQueue(sim.graph().findArc(1, 2)), nullptr);
+        EXPECT_EQ(sim.portQueue(sim.graph().findArc(0, 1)), nullptr);
+        SimTime lowDelay = 0, highDelay = 0;
+        for (PacketId id : low) lowDelay = std::max(lowDelay, sim.record(id).queueingDelay);
+        for (PacketId id : high) highDelay = std::max(highDelay, sim.record(id).queueingDelay);
+        EXPECT_EQ(sim.stats().delivered, 160u);
+        EXPECT_LT(highDelay, 2 * Millisecond);       // co najwyżej jeden pakiet w nadajniku przed nim
+        EXPECT_GT(lowDelay, 50 * Millisecond);
+    }
+
+    // Bufferbloat: TCP przez bufor 500 pakietów - CoDel trzyma RTT blisko bazowego
+    net.setLinkDelay("A", "B", 5);
+    net.setLinkDelay("B", "C", 5);
+    net.setQueueSize("B", 500);
+    SimTime srtt[2];
+    for (int i = 0; i < 2; ++i) {
+        QueueConfig bottleneck;
+        bottleneck.type = i == 0 ? QueueDisciplineType::DropTail : QueueDisciplineType::CoDel;
+        net.setQueueDiscipline("B", bottleneck);
+        TcpSimulator tcp(net);
+        ConnectionId id = tcp.connect("A", "C", 10000000);
+        tcp.run();
+        EXPECT_EQ(tcp.stats(id).state, TcpState::Finished);
+        srtt[i] = tcp.stats(id).srtt;
+    }
+    EXPECT_GT(srtt[0], 100 * Millisecond);
+    EXPECT_LT(srtt[1], 60 * Millisecond);
+}
+
+// Test sprawdza generatory CBR, Poisson, on/off i odtwarzanie śladów CSV/pcap oraz recykling id pakietów
+TEST(TrafficGeneratorTest, ModelSourcesTraceReplayAndBoundedMemory) {
+    using namespace netsim::sim;
+    Network net;
+    net.addNode<DummyNode>("A", "10.0.0.1");
+    net.addNode<DummyNode>("B", "10.0.0.2");
+    net.addNode<DummyNode>("C", "10.0.0.3");
+    net.connect("A", "B"); net.setLinkDelay("A", "B", 1);
+    net.connect("B", "C"); net.setLinkDelay("B", "C", 1);
+
+    PacketSimOptions simOptions;
+    simOptions.recyclePacketIds = true;
+    PacketSimulator sim(net, simOptions);
+    TrafficGenerator traffic(net, sim);
+
+    TrafficOptions cbr;
+    cbr.rateMbps = 12.0;                       // 1500 B co 1 ms
+    cbr.stop = 10 * Second;
+    GeneratorId constant = traffic.add(TrafficPattern::ConstantBitRate, "A", "C", cbr);
+    TrafficOptions poisson = cbr;
+    poisson.stop = 1 * Second;
+    GeneratorId random = traffic.add(TrafficPattern::Poisson, "C", "A", poisson);
+    TrafficOptions onoff = cbr;
+    onoff.stop = 4 * Second;
+    onoff.meanOn = 50 * Millisecond;
+    onoff.meanOff = 150 * Millisecond;
+    GeneratorId bursty = traffic.add(TrafficPattern::ParetoOnOff, "A", "B", onoff);
+
+    // Ślad CSV: nagłówek, trzy poprawne rekordy i jeden z nieznanym węzłem
+    std::string csvPath = testing::TempDir() + "traffic_trace.csv";
+    {
+        std::ofstream csv(csvPath);
+        csv << "time_us,src,dst,size_bytes,priority\n0,A,C,100\n250.5,C,B,200,3\n300,X,B,64\n1000,B,A,300\n";
+    }
+    TrafficOptions replay;
+    replay.start = 2 * Millisecond;
+    GeneratorId csvTrace = traffic.addTrace(csvPath, replay);
+
+    // Ślad pcap (Ethernet): dwa pakiety IPv4 między znanymi adresami, jedna ramka ARP i uszkodzony rekord
+    std::string pcapPath = testing::TempDir() + "traffic_trace.pcap";
+    {
+        std::ofstream pcap(pcapPath, std::ios::binary);
+        auto put32 = [&](uint32_t v) { pcap.write(reinterpret_cast<const char*>(&v), 4); };
+        put32(0xa1b2c3d4); put32(0x00040002); put32(0); put32(0); put32(65535); put32(1);
+        auto frame = [&](uint32_t sec, uint32_t usec, uint16_t etherType, uint8_t src, uint8_t dst, uint32_t length) {
+            std::vector<unsigned char> bytes(34, 0);
+            bytes[12] = etherType >> 8; bytes[13] = etherType & 0xff;
+            bytes[14] = 0x45; bytes[15] = 0xa0;      // IPv4, precedence 5
+            unsigned char s[] = {10, 0, 0, src}, d[] = {10, 0, 0, dst};
+            std::memcpy(&bytes[26], s, 4); std::memcpy(&bytes[30], d, 4);
+            put32(sec); put32(usec); put32(static_cast<uint32_t>(bytes.size())); put32(length);
+            pcap.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        };
+        frame(1700000000, 0, 0x0800, 1, 3, 1000);
+        frame(1700000000, 400, 0x0806, 1, 3, 60);
+        frame(1700000000, 500, 0x0800, 3, 2, 1500);
+        // Uszkodzony rekord: długość ponad snaplen - koniec śladu zamiast alokacji 2 GB
+        put32(1700000000); put32(600); put32(0x7fffffff); put32(0x7fffffff);
+    }
+    GeneratorId pcapTrace = traffic.addTrace(pcapPath);
+    EXPECT_THROW(traffic.addTrace(testing::TempDir() + "missing_trace.csv"), std::runtime_error);
+    EXPECT_THROW(traffic.add(TrafficPattern::Poisson, "A", "Z", cbr), std::runtime_error);
+
+    sim.run();
+
+    const auto& c = traffic.stats(constant);
+    EXPECT_EQ(c.packets, 10000u);
+    EXPECT_EQ(c.delivered, 10000u);
+    EXPECT_NEAR(c.offeredMbps(), 12.0, 0.01);
+    EXPECT_NEAR(c.averageLatencyNs(), 2.0 * Millisecond, 1.0);
+    EXPECT_TRUE(c.finished);
+
+    const auto& p = traffic.stats(random);
+    EXPECT_GT(p.packets, 900u);
+    EXPECT_LT(p.packets, 1100u);
+    const auto& o = traffic.stats(bursty);
+    EXPECT_GT(o.packets, 200u);                 // ~1/4 czasu w stanie on
+    EXPECT_LT(o.packets, 2500u);
+
+    const auto& t = traffic.stats(csvTrace);
+    EXPECT_EQ(t.packets, 3u);
+    EXPECT_EQ(t.skipped, 1u);
+    EXPECT_EQ(t.bytes, 600u);
+    EXPECT_EQ(t.firstAt, 2 * Millisecond);
+    EXPECT_EQ(t.lastAt, 3 * Millisecond);
+    EXPECT_EQ(t.delivered, 3u);
+    const auto& pc = traffic.stats(pcapTrace);
+    EXPECT_EQ(pc.packets, 2u);
+    EXPECT_EQ(pc.skipped, 2u);
+    EXPECT_EQ(pc.bytes, 2500u);
+    EXPECT_EQ(pc.lastAt, 500 * Microsecond);
+
+    // Pamięć rośnie z liczbą pakietów w locie, nie z liczbą wysłanych
+    EXPECT_GT(sim.stats().injected, 11000u);
+    EXPECT_LT(sim.records().size(), 200u);
+    std::remove(csvPath.c_str());
+    std::remove(pcapPath.c_str());
+}
+
+// Test sprawdza filtr przechwytywania oraz zapis pcapng z tapów węzła i łącza (bloki, VLAN, nagłówki IP)
+TEST(PacketCaptureTest, FilterAndPcapngTaps) {
+    using namespace netsim::sim;
+    Network net;
+    net.addNode<DummyNode>("A", "10.0.0.1");
+    net.addNode<DummyNode>("B", "10.0.0.2");
+    net.addNode<DummyNode>("C", "10.0.0.3");
+    net.connect("A", "B"); net.setLinkDelay("A", "B", 1);
+    net.connect("B", "C"); net.setLinkDelay("B", "C", 1);
+    net.assignVLAN("A", 10);
+    const NodeId a = net.findByName("A")->getId(), c = net.findByName("C")->getId();
+
+    EXPECT_THROW(CaptureFilter::compile("host Z", net), std::runtime_error);
+    EXPECT_THROW(CaptureFilter::compile("udp and", net), std::runtime_error);
+    EXPECT_THROW(CaptureFilter::compile("(udp or tcp", net), std::runtime_error);
+    EXPECT_THROW(CaptureFilter::compile("port 70000", net), std::runtime_error);
+    PacketRecord rec;
+    rec.src = a;
+    rec.dst = c;
+    rec.protocol = Protocol::Udp;
+    rec.srcPort = 49152;
+    rec.dstPort = 5001;
+    EXPECT_TRUE(CaptureFilter::compile("udp and dst port 5001 and not host 10.0.0.2", net).matches(rec, 10));
+    EXPECT_TRUE(CaptureFilter::compile("vlan 10 && (tcp || src host A)", net).matches(rec, 10));
+    EXPECT_FALSE(CaptureFilter::compile("vlan 10", net).matches(rec, 0));
+    EXPECT_FALSE(CaptureFilter::compile("src host C or tcp or src port 5001", net).matches(rec, 10));
+    EXPECT_TRUE(CaptureFilter().matches(rec, 0));
+
+    PacketSimulator sim(net);
+    CaptureOptions options;
+    options.filter = "udp or icmp";
+    std::string path = testing::TempDir() + "capture_test.pcapng";
+    PacketCapture capture(net, path, options);
+    EXPECT_EQ(capture.tapLink("A", "B"), 0u);
+    EXPECT_EQ(capture.tapNode("C"), 1u);
+    sim.setCapture(&capture);
+    for (int i = 0; i < 5; i++)
+        sim.setFlow(sim.inject(a, c, 1000, i * Millisecond), Protocol::Udp, 49152, 5001);
+    for (int i = 0; i < 3; i++)
+        sim.setFlow(sim.inject(a, c, 1000, i * Millisecond), Protocol::Tcp, 49153, 80);
+    sim.setFlow(sim.inject(c, a, 84, 0), Protocol::Icmp, 0, 0);
+    sim.run();
+    EXPECT_THROW(capture.tapNode("A"), std::runtime_error);
+    capture.close();
+
+    // UDP i TCP widziane na łączu A->B i w C, ICMP tylko w C (nadanie)
+    CaptureStats stats = capture.stats();
+    EXPECT_EQ(stats.seen, 17u);
+    EXPECT_EQ(stats.filtered, 6u);
+    EXPECT_EQ(stats.captured, 11u);
+    EXPECT_EQ(stats.dropped, 0u);
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(file.size(), stats.bytesWritten);
+    auto u32 = [&](size_t at) { uint32_t v; std::memcpy(&v, &file[at], 4); return v; };
+    ASSERT_GE(file.size(), 28u);
+    EXPECT_EQ(u32(0), 0x0A0D0D0Au);
+    EXPECT_EQ(u32(8), 0x1A2B3C4Du);
+    int interfaces = 0, packets = 0, tagged = 0;
+    for (size_t at = 0; at + 12 <= file.size();) {
+        uint32_t type = u32(at), length = u32(at + 4);
+        ASSERT_EQ(length % 4, 0u);
+        ASSERT_LE(at + length, file.size());
+        EXPECT_EQ(u32(at + length - 4), length);
+        if (type == 1) interfaces++;
+        if (type == 6) {
+            packets++;
+            uint32_t iface = u32(at + 8), captured = u32(at + 20), original = u32(at + 24);
+            EXPECT_LT(iface, 2u);
+            const uint8_t* frame = &file[at + 28];
+            bool vlan = frame[12] == 0x81 && frame[13] == 0x00;
+            size_t ip = vlan ? 18 : 14;
+            EXPECT_EQ(frame[ip - 2], 0x08);
+            EXPECT_EQ(frame[ip], 0x45);
+            if (frame[ip + 9] == 17) {
+                tagged += vlan;
+                EXPECT_EQ((frame[14] << 8 | frame[15]) & 0xfff, 10);
+                EXPECT_EQ(original, 18u + 1000u);
+                EXPECT_EQ(captured, options.snapLength);
+                EXPECT_EQ(frame[ip + 12], 10); EXPECT_EQ(frame[ip + 15], 1);   // 10.0.0.1
+                EXPECT_EQ(frame[ip + 22] << 8 | frame[ip + 23], 5001);          // port docelowy UDP
+            } else {
+                EXPECT_EQ(frame[ip + 9], 1);
+                EXPECT_FALSE(vlan);
+                EXPECT_EQ(original, 14u + 84u);
+                EXPECT_EQ(captured, original);
+            }
+        }
+        at += length;
+    }
+    EXPECT_EQ(interfaces, 2);
+    EXPECT_EQ(packets, 11);
+    EXPECT_EQ(tagged, 10);
+
+    // Tap na nieistniejącym łączu
+    PacketCapture missing(net, testing::TempDir() + "capture_missing.pcapng");
+    missing.tapLink("A", "C");
+    EXPECT_THROW(sim.setCapture(&missing), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+// Test sprawdza fork sieci (checkpoint): niezależne kopie tabel, kolejek, tras i zdarzeń oraz gałęzie w wątkach i procesach
+TEST(NetworkForkTest, CheckpointBranchesAreIndependent) {
+    using namespace netsim::sim;
+    Network net;
+    net.addNode<Host>("A", "10.0.0.1", 80);
+    auto b = net.addNode<DummyNode>("B", "10.0.0.2");
+    auto r = net.addNode<Router>("R", "10.0.0.254");
+    net.connect("A", "B"); net.setLinkDelay("A", "B", 10);
+    net.connect("B", "R"); net.setLinkDelay("B", "R", 5);
+    r->addRoute("10.0.0.2", b.get());
+    r->addNeighbor(b.get());
+    QueueConfig red;
+    red.type = QueueDisciplineType::Red;
+    net.setQueueDiscipline("A", red);
+    for (int i = 0; i < 4; i++) net.enqueuePacket("A", Packet("A", "B", "data", "udp", "q"));
+    for (int i = 0; i < 3000; i++) net.schedulePacketDelivery(Packet("A", "B", "data", "tcp", "msg"), i % 50);
+    net.advanceTime(20);
+    const size_t deliveredAtCheckpoint = net.getDeliveredCount("B");
+    const size_t pendingAtCheckpoint = net.getScheduler().pending();
+    EXPECT_GT(deliveredAtCheckpoint, 0u);
+    EXPECT_GT(pendingAtCheckpoint, 0u);
+
+    auto checkpoint = net.fork();
+    EXPECT_EQ(checkpoint->getSimTime(), net.getSimTime());
+    EXPECT_EQ(checkpoint->getScheduler().pending(), pendingAtCheckpoint);
+    EXPECT_EQ(checkpoint->getDeliveredCount("B"), deliveredAtCheckpoint);
+    EXPECT_EQ(checkpoint->getLinkDelay("A", "B"), 10);
+    EXPECT_EQ(checkpoint->findByName("A")->queuedPackets(), 4u);
+    EXPECT_EQ(checkpoint->findByName("A")->getQueueConfig().type, QueueDisciplineType::Red);
+    EXPECT_EQ(checkpoint->getNodeId("R"), net.getNodeId("R"));
+    // Wskaźniki na węzły w klonach wskazują węzły gałęzi, nie oryginału
+    auto branchRouter = std::dynamic_pointer_cast<Router>(checkpoint->findByName("R"));
+    ASSERT_TRUE(branchRouter);
+    EXPECT_EQ(branchRouter->getNextHop("10.0.0.2"), checkpoint->findByName("B").get());
+    EXPECT_NE(checkpoint->findByName("B").get(), b.get());
+
+    // Oryginał i gałąź dalej żyją osobno
+    net.advanceTime(100);
+    net.dequeuePacket("A");
+    EXPECT_EQ(net.getDeliveredCount("B"), 3000u);
+    EXPECT_EQ(checkpoint->getScheduler().pending(), pendingAtCheckpoint);
+    EXPECT_EQ(checkpoint->getDeliveredCount("B"), deliveredAtCheckpoint);
+    EXPECT_EQ(checkpoint->findByName("A")->queuedPackets(), 4u);
+    auto again = checkpoint->fork();
+    again->failNode("B");
+    again->setLinkDelay("A", "B", 99);
+    again->advanceTime(100);
+    EXPECT_EQ(again->getDeliveredCount("B"), 3000u);
+    EXPECT_FALSE(checkpoint->isFailed("B"));
+    EXPECT_EQ(checkpoint->getLinkDelay("A", "B"), 10);
+    EXPECT_EQ(checkpoint->getScheduler().pending(), pendingAtCheckpoint);
+
+    // Gałęzie równolegle: dodatkowy pakiet, anulowanie przez cancelPacketDelivery nie wpływa na inne
+    std::vector<Branch> branches;
+    branches.push_back({"baseline", [](Network& n) {
+        n.advanceTime(100);
+        return std::to_string(n.getDeliveredCount("B"));
+    }});
+    branches.push_back({"extra", [](Network& n) {
+        n.schedulePacketDelivery(Packet("R", "B", "data", "tcp", "x"), 0);
+        n.advanceTime(100);
+        return std::to_string(n.getDeliveredCount("B"));
+    }});
+    branches.push_back({"broken", [](Network& n) -> std::string {
+        n.findByName("missing");
+        return "";
+    }});
+    for (BranchMode mode : {BranchMode::Threads, BranchMode::Processes}) {
+        auto results = runBranches(*checkpoint, branches, mode, 2);
+        ASSERT_EQ(results.size(), 3u);
+        EXPECT_TRUE(results[0].ok);
+        EXPECT_EQ(results[0].output, "3000");
+        EXPECT_EQ(results[1].output, "3001");
+        EXPECT_FALSE(results[2].ok);
+        EXPECT_FALSE(results[2].output.empty());
+        EXPECT_EQ(checkpoint->getScheduler().pending(), pendingAtCheckpoint);
+    }
+    EXPECT_EQ(parseBranchMode("processes"), BranchMode::Processes);
+    EXPECT_THROW(parseBranchMode("cluster"), std::runtime_error);
+}
+
+// Test sprawdza FIB routera: longest prefix match IPv4/IPv6, trasy nazwane, wsadowe wyszukiwanie
+// oraz zgodność z naiwnym LPM po przyrostowych zmianach dużej tablicy (direct pointing)
+TEST(FibTest, LongestPrefixMatch) {
+    IpPrefix p;
+    ASSERT_TRUE(IpPrefix::parse("10.1.2.3/16", p));
+    EXPECT_EQ(p.str(), "10.1.0.0/16");
+    ASSERT_TRUE(IpPrefix::parse("2001:DB8:0:0:1::/64", p));
+    EXPECT_EQ(p.str(), "2001:db8::/64");
+    ASSERT_TRUE(IpPrefix::parse("::ffff:10.0.0.1", p));
+    EXPECT_EQ(p.str(), "::ffff:a00:1");
+    EXPECT_FALSE(IpPrefix::parse("R1", p));
+    EXPECT_FALSE(IpPrefix::parse("10.0.0.256", p));
+    EXPECT_FALSE(IpPrefix::parse("10.0.0.0/33", p));
+    EXPECT_FALSE(IpPrefix::parse("1:2:3", p));
+
+    Network net;
+    auto r1 = net.addNode<Router>("R1", "192.168.0.1");
+    auto r2 = net.addNode<Router>("R2", "192.168.0.2");
+    auto r3 = net.addNode<Router>("R3", "192.168.0.3");
+    auto r4 = net.addNode<Router>("R4", "192.168.0.4");
+    Router* router = dynamic_cast<Router*>(r1.get());
+    router->addRoute("0.0.0.0/0", r4.get());
+    router->addRoute("10.0.0.0/8", r2.get());
+    router->addRoute("10.1.0.0/16", r3.get());
+    router->addRoute("10.1.2.3", r4.get());
+    router->addRoute("2001:db8::/32", r2.get());
+    router->addRoute("2001:db8:1::/48", r3.get());
+    router->addRoute("R9", r2.get());
+    EXPECT_EQ(router->getNextHop("10.1.2.3"), r4.get());
+    EXPECT_EQ(router->getNextHop("10.1.2.4"), r3.get());
+    EXPECT_EQ(router->getNextHop("10.200.0.1"), r2.get());
+    EXPECT_EQ(router->getNextHop("11.0.0.1"), r4.get());
+    EXPECT_EQ(router->getNextHop("2001:db8:1::5"), r3.get());
+    EXPECT_EQ(router->getNextHop("2001:db8:2::5"), r2.get());
+    EXPECT_EQ(router->getNextHop("2001:db9::1"), nullptr);
+    EXPECT_EQ(router->getNextHop("R9"), r2.get());
+    EXPECT_EQ(router->getNextHop(0x0A010203u), r4.get());
+    EXPECT_TRUE(router->hasRouteTo("10.1.0.0/16"));
+    EXPECT_FALSE(router->hasRouteTo("10.1.0.0/17"));
+    EXPECT_EQ(router->getRouteCount(), 7u);
+
+    EXPECT_TRUE(router->removeRoute("10.1.0.0/16"));
+    EXPECT_FALSE(router->removeRoute("10.1.0.0/16"));
+    EXPECT_EQ(router->getNextHop("10.1.2.4"), r2.get());
+
+    // Fork sieci przepina next hopy FIB na klony
+    auto branch = net.fork();
+    auto* branchRouter = dynamic_cast<Router*>(branch->findByName("R1").get());
+    EXPECT_EQ(branchRouter->getNextHop("10.1.2.4"), branch->findByName("R2").get());
+
+    // Duża tablica: losowe prefiksy, LPM porównywany z przeszukaniem wszystkich tras
+    std::mt19937 rng(7);
+    std::vector<Node*> hops = {r2.get(), r3.get(), r4.get()};
+    std::map<std::pair<uint32_t, int>, Node*> reference;   // (adres, długość) -> next hop
+    std::vector<Fib::Route> routes;
+    for (int i = 0; i < 20000; i++) {
+        IpPrefix prefix = IpPrefix::fromIpv4(rng(), static_cast<uint8_t>(8 + rng() % 25));
+        Node* hop = hops[rng() % hops.size()];
+        routes.push_back({prefix, hop});
+        reference[{prefix.ipv4(), prefix.length}] = hop;
+    }
+    Fib fib;
+    fib.insertBulk(routes);
+    auto naive = [&](uint32_t address) {
+        Node* best = nullptr;
+        int bestLength = -1;
+        for (const auto& route : reference) {
+            if (IpPrefix::fromIpv4(address, route.first.second).ipv4() == route.first.first && route.first.second > bestLength) {
+                bestLength = route.first.second;
+                best = route.second;
+            }
+        }
+        return best;
+    };
+    // Przyrostowe zmiany po kompilacji: dłuższe prefiksy przebudowują tylko swój slot
+    fib.compile();
+    for (int i = 0; i < 200; i++) {
+        Fib::Route route{IpPrefix::fromIpv4(rng(), static_cast<uint8_t>(16 + rng() % 17)), hops[rng() % hops.size()]};
+        fib.insert(route.prefix, route.nextHop);
+        routes.push_back(route);
+        reference[{route.prefix.ipv4(), route.prefix.length}] = route.nextHop;
+        if (i % 10 == 0) {
+            const IpPrefix& removed = routes[rng() % routes.size()].prefix;
+            fib.remove(removed);
+            reference.erase({removed.ipv4(), removed.length});
+        }
+    }
+    std::vector<uint32_t> addresses;
+    for (int i = 0; i < 300; i++) addresses.push_back(routes[rng() % routes.size()].prefix.ipv4() | (rng() & 0xFF));
+    for (int i = 0; i < 100; i++) addresses.push_back(rng());
+    std::vector<Node*> batch(addresses.size());
+    fib.lookupBatch4(addresses.data(), addresses.size(), batch.data());
+    for (size_t i = 0; i < addresses.size(); i++) {
+        Node* expected = naive(addresses[i]);
+        EXPECT_EQ(fib.lookup4(addresses[i]), expected) << IpPrefix::fromIpv4(addresses[i]).str();
+        EXPECT_EQ(batch[i], expected);
+    }
+    EXPECT_GT(fib.stats().memoryBytes, 0u);
+}
+
+// Test sprawdza SPF: trasy do wszystkich węzłów w FIB routerów, hosty bez tranzytu, przeliczanie
+// tylko dotkniętych routerów po zmianach oraz zgodność przyrostowych tras z pełnym przeliczeniem
+TEST(SpfRoutingTest, ShortestPathRoutesFollowTopology) {
+    using namespace netsim::routing;
+    Network net;
+    for (int i = 1; i <= 5; i++) net.addNode<Router>("R" + std::to_string(i), "10.0.0." + std::to_string(i));
+    net.addNode<Host>("H1", "10.1.0.1", 80);
+    net.addNode<Host>("H4", "10.4.0.1", 80);
+    net.addNode<Router>("Z", "zone-z");   // bez IP - trasa po nazwie
+    auto link = [&](const std::string& a, const std::string& b, int ms) {
+        net.connect(a, b);
+        net.setLinkDelay(a, b, ms);
+    };
+    link("R1", "R2", 1); link("R2", "R3", 1); link("R3", "R4", 1);
+    link("R1", "R5", 5); link("R5", "R4", 5);
+    link("H1", "R1", 1); link("H4", "R4", 1); link("Z", "R5", 1);
+    link("H1", "R4", 1);   // host podłączony do dwóch routerów nie przenosi ruchu
+    link("R3", "R5", 50);  // łącze spoza wszystkich najkrótszych ścieżek
+
+    SpfRouting spf(net, SpfOptions{2});
+    auto r = [&](const std::string& name) { return dynamic_cast<Router*>(net.findByName(name).get()); };
+    EXPECT_EQ(r("R1")->getNextHop("10.4.0.1")->getName(), "R2");
+    EXPECT_EQ(r("R1")->getNextHop("10.1.0.1")->getName(), "H1");
+    EXPECT_EQ(r("R4")->getNextHop("10.1.0.1")->getName(), "H1");
+    EXPECT_EQ(r("R2")->getNextHop("10.0.0.5")->getName(), "R1");
+    EXPECT_EQ(r("R1")->getNextHop("Z")->getName(), "R5");
+    EXPECT_EQ(r("R1")->getRouteCount(), 7u);
+    EXPECT_EQ(spf.stats().lastRoutersComputed, 6u);
+
+    // Zmiana opóźnienia łącza, którym nie idzie żadna najkrótsza ścieżka, nie przelicza nikogo
+    net.setLinkDelay("R3", "R5", 60);
+    EXPECT_EQ(spf.stats().lastRoutersComputed, 0u);
+    net.setLinkDelay("R3", "R5", 2);
+    EXPECT_EQ(r("R5")->getNextHop("10.0.0.3")->getName(), "R3");
+    EXPECT_GT(spf.stats().lastRoutersComputed, 0u);
+
+    // Awaria R2: trasy ją omijają, trasa do niej znika
+    net.failNode("R2");
+    EXPECT_EQ(r("R1")->getNextHop("10.4.0.1")->getName(), "R5");
+    EXPECT_EQ(r("R3")->getNextHop("10.0.0.1")->getName(), "R5");
+    EXPECT_EQ(r("R1")->getNextHop("10.0.0.2"), nullptr);
+
+    // Losowa sieć: trasy po serii zmian takie same jak z pełnego przeliczenia od zera
+    Network mesh;
+    std::mt19937 rng(5);
+    const int N = 40;
+    for (int i = 0; i < N; i++) mesh.addNode<Router>("M" + std::to_string(i), "10.9.0." + std::to_string(i + 1));
+    auto connected = [&](const std::string& a, const std::string& b) {
+        auto neighbors = mesh.getNeighbors(a);
+        return std::find(neighbors.begin(), neighbors.end(), b) != neighbors.end();
+    };
+    std::vector<std::pair<std::string, std::string>> links;
+    for (int i = 0; i < N; i++) {
+        for (int k = 0; k < 2; k++) {
+            int j = (i + 1 + static_cast<int>(rng() % (N - 1))) % N;
+            std::string a = "M" + std::to_string(i), b = "M" + std::to_string(j);
+            if (connected(a, b)) continue;
+            mesh.connect(a, b);
+            mesh.setLinkDelay(a, b, 1 + static_cast<int>(rng() % 1000));
+            links.push_back({a, b});
+        }
+    }
+    SpfRouting incremental(mesh, SpfOptions{3});
+    uint64_t computed = 0;
+    for (int step = 0; step < 30; step++) {
+        const auto& l = links[rng() % links.size()];
+        if (step % 3 == 0 && connected(l.first, l.second)) mesh.disconnect(l.first, l.second);
+        else if (connected(l.first, l.second)) mesh.setLinkDelay(l.first, l.second, 1 + static_cast<int>(rng() % 1000));
+        else mesh.connect(l.first, l.second);
+        computed += incremental.stats().lastRoutersComputed;
+    }
+    mesh.failNode("M7");
+    auto fresh = mesh.fork();
+    SpfRouting full(*fresh);
+    for (int i = 0; i < N; i++) {
+        auto* a = dynamic_cast<Router*>(mesh.findByName("M" + std::to_string(i)).get());
+        auto* b = dynamic_cast<Router*>(fresh->findByName("M" + std::to_string(i)).get());
+        if (i == 7) continue;
+        for (int j = 0; j < N; j++) {
+            std::string ip = "10.9.0." + std::to_string(j + 1);
+            Node* x = a->getNextHop(ip);
+            Node* y = b->getNextHop(ip);
+            ASSERT_EQ(x == nullptr, y == nullptr) << "M" << i << " -> " << ip;
+            if (x) {
+                EXPECT_EQ(x->getName(), y->getName()) << "M" << i << " -> " << ip;
+            }
+        }
+    }
+    EXPECT_LT(computed, 30u * N);
+}
+
+// Test sprawdza zbieżność DV i LS po awariach, mikropętle LS i instalację tras w FIB
+TEST(ConvergenceTest, DistanceVectorAndLinkStateConverge) {
+    using namespace netsim::routing;
+    using netsim::sim::Millisecond;
+    using netsim::sim::Second;
+    Network net;
+    for (int i = 1; i <= 4; i++) net.addNode<Router>("R" + std::to_string(i), "10.0.0." + std::to_string(i));
+    net.addNode<Host>("H", "10.3.0.1", 80);
+    auto link = [&](const std::string& a, const std::string& b, int ms) {
+        net.connect(a, b);
+        net.setLinkDelay(a, b, ms);
+    };
+    link("R1", "R2", 1); link("R2", "R3", 1); link("R3", "R4", 5); link("R4", "R1", 5);
+    link("R3", "H", 0);
+
+    for (RoutingProtocol protocol : {RoutingProtocol::DistanceVector, RoutingProtocol::LinkState}) {
+        ConvergenceOptions options;
+        options.protocol = protocol;
+        options.workers = 2;
+        ConvergenceSimulator sim(net, options);
+        ConvergenceReport start = sim.run();
+        EXPECT_EQ(start.unreachable, 0u);
+        EXPECT_EQ(start.loopsOpen, 0u);
+        EXPECT_GT(start.messages, 0u);
+        EXPECT_EQ(sim.nextHop("R1", "H")->getName(), "R2");
+        EXPECT_EQ(sim.nextHop("R4", "R2")->getName(), "R1");
+
+        // Awaria R2-R3: ruch do H idzie przez R4, R2 przez R1
+        sim.failLink("R2", "R3", sim.now() + Second);
+        ConvergenceReport failure = sim.run();
+        EXPECT_EQ(failure.startedAt, start.quiescentAt + Second);
+        EXPECT_GT(failure.convergenceTime(), 0u);
+        EXPECT_EQ(failure.unreachable, 0u);
+        EXPECT_EQ(failure.loopsOpen, 0u);
+        EXPECT_EQ(sim.nextHop("R1", "H")->getName(), "R4");
+        EXPECT_EQ(sim.nextHop("R2", "H")->getName(), "R1");
+        EXPECT_EQ(sim.nextHop("R3", "R2")->getName(), "R4");
+        if (protocol == RoutingProtocol::LinkState) {
+            // R2 liczy SPF przed R1 (LSA dociera do R1 później): R2 -> R1 -> R2 do SPF w R1
+            EXPECT_GE(failure.loopsFormed, 1u);
+            EXPECT_GE(failure.longestLoop, 10 * Millisecond);
+            EXPECT_GT(failure.spfRuns, 0u);
+        } else {
+            EXPECT_EQ(sim.metric("R2", "H"), 2u + 6u + 6u + 1u);
+        }
+
+        // Odcięcie H: wszystkie routery tracą trasę
+        sim.failNode("H", sim.now() + Second);
+        ConvergenceReport lost = sim.run();
+        EXPECT_EQ(lost.unreachable, 0u);   // H nie działa, więc nie jest liczony
+        EXPECT_EQ(sim.nextHop("R1", "H"), nullptr);
+        EXPECT_EQ(sim.nextHop("R4", "H"), nullptr);
+        if (protocol == RoutingProtocol::DistanceVector) {
+            EXPECT_EQ(sim.metric("R1", "H"), sim.infinity());
+        }
+
+        // Przywrócenie łącza: trasy wracają na krótszą ścieżkę
+        sim.restoreLink("R2", "R3", sim.now() + Second);
+        sim.run();
+        EXPECT_EQ(sim.nextHop("R1", "R3")->getName(), "R2");
+    }
+    EXPECT_THROW(ConvergenceSimulator(net).failLink("R1", "R3", 0), std::runtime_error);
+    EXPECT_THROW(ConvergenceSimulator(net).nextHop("H", "R1"), std::runtime_error);
+
+    // Losowa sieć: po awariach każda para routerów dochodzi do celu bez pętli, a trasy trafiają do FIB
+    Network mesh;
+    std::mt19937 rng(11);
+    const int N = 30;
+    for (int i = 0; i < N; i++) mesh.addNode<Router>("M" + std::to_string(i), "10.8.0." + std::to_string(i + 1));
+    for (int i = 0; i < N; i++) {
+        mesh.connect("M" + std::to_string(i), "M" + std::to_string((i + 1) % N));
+        mesh.setLinkDelay("M" + std::to_string(i), "M" + std::to_string((i + 1) % N), 1 + rng() % 5);
+    }
+    for (int k = 0; k < 20; k++) {
+        int a = rng() % N, b = rng() % N;
+        auto neighbors = mesh.getNeighbors("M" + std::to_string(a));
+        if (a == b || std::find(neighbors.begin(), neighbors.end(), "M" + std::to_string(b)) != neighbors.end()) continue;
+        mesh.connect("M" + std::to_string(a), "M" + std::to_string(b));
+        mesh.setLinkDelay("M" + std::to_string(a), "M" + std::to_string(b), 1 + rng() % 10);
+    }
+    for (RoutingProtocol protocol : {RoutingProtocol::DistanceVector, RoutingProtocol::LinkState}) {
+        ConvergenceOptions options;
+        options.protocol = protocol;
+        ConvergenceSimulator sim(mesh, options);
+        sim.run();
+        sim.failLink("M3", "M4", sim.now() + Second);
+        sim.failNode("M17", sim.now() + Second + 20 * Millisecond);
+        ConvergenceReport report = sim.run();
+        EXPECT_EQ(report.loopsOpen, 0u);
+        EXPECT_EQ(report.unreachable, 0u);
+        for (int s = 0; s < N; s++) {
+            for (int d = 0; d < N; d++) {
+                if (s == d || s == 17 || d == 17) continue;
+                std::string at = "M" + std::to_string(s), dest = "M" + std::to_string(d);
+                int hops = 0;
+                while (at != dest && hops++ < N) at = sim.nextHop(at, dest)->getName();
+                EXPECT_EQ(at, dest);
+            }
+        }
+        sim.install();
+        auto* m0 = dynamic_cast<Router*>(mesh.findByName("M0").get());
+        EXPECT_EQ(m0->getNextHop("10.8.0.6"), sim.nextHop("M0", "M5"));
+    }
+}
+
+// Test sprawdza grupy ECMP/WCMP: rozkład przepływów, odporną zmianę składu i liczniki członków
+TEST(FibTest, EcmpGroupsSpreadFlowsResiliently) {
+    Network net;
+    auto r0 = net.addNode<Router>("R0", "10.9.0.1");
+    std::vector<Node*> hops;
+    for (const char* name : {"A", "B", "C", "D"}) hops.push_back(net.addNode<Router>(name, "").get());
+    Router* router = dynamic_cast<Router*>(r0.get());
+    Fib& fib = router->getFib();
+    Fib::GroupId group = router->addRouteGroup("10.0.0.0/16", {{hops[0]}, {hops[1]}, {hops[2]}, {hops[3]}});
+
+    const int FLOWS = 20000;
+    auto hopOf = [&](int flow) { return router->getNextHop("10.0.1.1", flowHash(FlowKey{uint64_t(flow), 42, 1000, 80, 6})); };
+    std::vector<Node*> before(FLOWS);
+    std::map<Node*, int> share;
+    for (int f = 0; f < FLOWS; f++) share[before[f] = hopOf(f)]++;
+    for (Node* hop : hops) {
+        EXPECT_GT(share[hop], FLOWS / 4 * 0.9);
+        EXPECT_LT(share[hop], FLOWS / 4 * 1.1);
+    }
+
+    // Usunięcie C przenosi tylko przepływy C, powrót C zabiera około 1/4 przepływów
+    fib.setGroupMembers(group, {{hops[0]}, {hops[1]}, {hops[3]}});
+    int disturbed = 0;
+    std::vector<Node*> without(FLOWS);
+    for (int f = 0; f < FLOWS; f++) {
+        without[f] = hopOf(f);
+        EXPECT_NE(without[f], hops[2]);
+        disturbed += before[f] != hops[2] && without[f] != before[f];
+    }
+    EXPECT_EQ(disturbed, 0);
+    fib.setGroupMembers(group, {{hops[0]}, {hops[1]}, {hops[2]}, {hops[3]}});
+    int moved = 0;
+    for (int f = 0; f < FLOWS; f++) moved += hopOf(f) != without[f];
+    EXPECT_LT(moved, FLOWS * 0.3);
+    EXPECT_GT(moved, FLOWS * 0.2);
+
+    // WCMP 3:1 - kubełki i ruch w proporcji wag
+    Fib::GroupId weighted = router->addRouteGroup("10.1.0.0/16", {{hops[0], 3}, {hops[1], 1}});
+    int first = 0;
+    for (int f = 0; f < FLOWS; f++)
+        first += router->getNextHop("10.1.2.3", flowHash(FlowKey{uint64_t(f), 7})) == hops[0];
+    EXPECT_NEAR(first / double(FLOWS), 0.75, 0.03);
+    auto stats = fib.groupStats(weighted);
+    ASSERT_EQ(stats.size(), 2u);
+    EXPECT_EQ(stats[0].buckets, 3 * stats[1].buckets);
+
+    // Przekazywanie pakietu liczy pakiety i bajty członka; ten sam przepływ - ten sam next hop
+    Packet p("H1", "10.1.5.5", "data", "tcp", "hello");
+    Node* next = router->nextHopFor(p);
+    EXPECT_EQ(router->nextHopFor(p), next);
+    uint64_t packets = 0, bytes = 0;
+    for (const auto& member : fib.groupStats(weighted)) {
+        packets += member.packets;
+        bytes += member.bytes;
+    }
+    EXPECT_EQ(packets, 2u);
+    EXPECT_EQ(bytes, 10u);
+
+    // Grupa bez członków nie ma trasy; grupa wymaga prefiksu IP
+    fib.setGroupMembers(weighted, {});
+    EXPECT_EQ(router->getNextHop("10.1.2.3"), nullptr);
+    EXPECT_THROW(router->addRouteGroup("zone", {{hops[0]}}), std::runtime_error);
+    EXPECT_THROW(fib.insertGroup(IpPrefix::fromIpv4(0x0a020000, 16), 99), std::runtime_error);
+    std::string balanced = router->getBalancedNextHop("10.0.7.7");
+    EXPECT_TRUE(balanced == "A" || balanced == "B" || balanced == "C" || balanced == "D");
+}
+
+// Test sprawdza przekazywanie paczkami przez 200 routerów (bez rekurencji), TTL, zaporę, brak trasy i awarię węzła
+TEST(ForwardingPipelineTest, ForwardsBatchesAlongLongPaths) {
+    const int ROUTERS = 200;
+    Network net;
+    auto h0 = net.addNode<Host>("H0", "10.1.0.1", 1000);
+    auto h1 = net.addNode<Host>("H1", "10.1.0.2", 1000);
+    std::vector<Router*> routers;
+    for (int i = 0; i < ROUTERS; i++) routers.push_back(net.addNode<Router>("R" + std::to_string(i), "").get());
+    net.connect("H0", "R0");
+    for (int i = 0; i + 1 < ROUTERS; i++) {
+        net.connect(routers[i]->getName(), routers[i + 1]->getName());
+        routers[i]->addRoute("10.1.0.2", routers[i + 1]);
+    }
+    net.connect(routers.back()->getName(), "H1");
+    routers.back()->addRoute("10.1.0.2", h1.get());
+    net.addFirewallRule("H0", "H1", "icmp", false);
+
+    ForwardingPipeline pipeline(net);
+    int deliveredToH1 = 0;
+    pipeline.setDeliveryCallback([&](const Packet& p, Node& at) {
+        deliveredToH1 += &at == h1.get();
+        EXPECT_EQ(p.ttl, 255 - ROUTERS);
+    });
+    for (int i = 0; i < 300; i++) {
+        Packet p("H0", "10.1.0.2", "data", "udp", "x");
+        p.ttl = 255;
+        pipeline.inject(p);
+    }
+    pipeline.inject(Packet("H0", "10.1.0.2", "data", "udp", "x"));        // TTL 64 < 200 skoków
+    Packet blocked("H0", "10.1.0.2", "icmp", "icmp", "");
+    blocked.ttl = 255;
+    pipeline.inject(blocked);
+    pipeline.inject(Packet("H0", "10.9.9.9", "data", "udp", ""));         // R0 nie ma trasy
+    EXPECT_EQ(pipeline.run(), 303u);
+
+    const PipelineStats& s = pipeline.stats();
+    EXPECT_EQ(deliveredToH1, 300);
+    EXPECT_EQ(s.delivered, 300u);
+    EXPECT_EQ(s.droppedTtl, 1u);
+    EXPECT_EQ(s.droppedAcl, 1u);
+    EXPECT_EQ(s.noRoute, 1u);
+    EXPECT_EQ(pipeline.pending(), 0u);
+    // Licznik R0: 300 dostarczonych + pakiet z TTL 64; ramki po 256 pakietów
+    EXPECT_EQ(routers[0]->getPacketCount(), 301);
+    EXPECT_EQ(routers[150]->getPacketCount(), 300);
+    EXPECT_GE(s.batches, 2u * ROUTERS);
+
+    net.failNode("R100");
+    ForwardingPipeline afterFailure(net);
+    Packet p("H0", "10.1.0.2", "data", "udp", "");
+    p.ttl = 255;
+    afterFailure.inject(p);
+    afterFailure.run();
+    EXPECT_EQ(afterFailure.stats().droppedFailed, 1u);
+    EXPECT_THROW(afterFailure.inject(Packet("nobody", "H1", "data", "udp", "")), std::runtime_error);
+}
+
+// Test sprawdza binarne adresy IP i indeks IPAM sieci: wyszukiwanie, prefiksy, wolne adresy i duplikaty
+TEST(IpamTest, AddressIndexQueriesAndAllocation) {
+    IpAddress a, b;
+    ASSERT_TRUE(IpAddress::parse("2001:DB8::1", a));
+    ASSERT_TRUE(IpAddress::parse("2001:db8:0:0::1", b));
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.str(), "2001:db8::1");
+    EXPECT_FALSE(IpAddress::parse("10.0.0.0/8", a));
+    EXPECT_FALSE(IpAddress::parse("router-1", a));
+    EXPECT_TRUE(IpAddress::fromIpv4(0x0a000001) < IpAddress::fromIpv4(0x0a000002));
+    EXPECT_EQ(Endpoint("10.1.0.7").ip(), IpAddress::fromIpv4(0x0a010007));
+    EXPECT_TRUE(Endpoint("H1").ip().empty());
+
+    Network net;
+    auto h1 = net.addNode<Host>("H1", "10.1.0.1", 80);
+    net.addNode<Host>("H2", "10.1.0.2", 80);
+    net.addNode<Host>("H3", "10.1.0.4", 80);
+    net.addNode<Router>("R1", "10.2.0.1");
+    net.addNode<Router>("R2", "");
+    net.addNode<Host>("V6", "2001:db8::10", 80);
+    EXPECT_EQ(net.findByIp(IpAddress::fromIpv4(0x0a010002))->getName(), "H2");
+    EXPECT_EQ(net.findNode("2001:DB8::10")->getName(), "V6");
+    EXPECT_EQ(net.resolveNodeName("10.2.0.1"), "R1");
+    EXPECT_EQ(net.resolveNodeName("10.9.9.9"), "10.9.9.9");
+    EXPECT_THROW(net.findNode("10.9.9.9"), std::runtime_error);
+
+    IpPrefix subnet;
+    ASSERT_TRUE(IpPrefix::parse("10.1.0.0/16", subnet));
+    std::vector<std::string> inSubnet;
+    for (const auto& node : net.findInPrefix(subnet)) inSubnet.push_back(node->getName());
+    EXPECT_EQ(inSubnet, (std::vector<std::string>{"H1", "H2", "H3"}));
+    // .0 to adres sieci, .1 i .2 zajęte - pierwsza luka to .3
+    EXPECT_EQ(net.allocateAddress(subnet).str(), "10.1.0.3");
+    // /29: hosty .1-.6 (.7 to broadcast)
+    IpPrefix small;
+    ASSERT_TRUE(IpPrefix::parse("10.1.0.0/29", small));
+    for (const char* expected : {"10.1.0.3", "10.1.0.5", "10.1.0.6"}) {
+        IpAddress free = net.allocateAddress(small);
+        EXPECT_EQ(free.str(), expected);
+        net.addNode<Host>(std::string("P") + expected, free.str(), 80);
+    }
+    EXPECT_THROW(net.allocateAddress(small), std::runtime_error);
+
+    // Duplikaty są zgłaszane, a w trybie unikalnych adresów odrzucane
+    net.addNode<Host>("Dup", "10.1.0.1", 80);
+    auto conflicts = net.getAddressConflicts();
+    ASSERT_EQ(conflicts.size(), 1u);
+    EXPECT_EQ(conflicts.begin()->second, (std::vector<std::string>{"H1", "Dup"}));
+    net.removeNode("H1");
+    EXPECT_EQ(net.findNode("10.1.0.1")->getName(), "Dup");
+    net.setUniqueAddresses(true);
+    EXPECT_THROW(net.addNode<Host>("Dup2", "10.1.0.2", 80), std::runtime_error);
+    EXPECT_THROW(net.setNodeIp("Dup", "10.2.0.1"), std::runtime_error);
+    net.setNodeIp("Dup", "10.1.0.9");
+    EXPECT_EQ(net.findNode("10.1.0.9")->getName(), "Dup");
+    EXPECT_EQ(net.findByIp(IpAddress::fromIpv4(0x0a010001)), nullptr);
+
+    // Host porównuje adres docelowy binarnie, niezależnie od zapisu
+    Host* v6 = dynamic_cast<Host*>(net.findByName("V6").get());
+    EXPECT_EQ(v6->getAddress(), "2001:db8::10");
+    Packet p("H2", "2001:DB8:0::10", "data", "udp", "hello");
+    v6->receivePacket(p);
+    EXPECT_EQ(h1->getIpAddress().str(), "10.1.0.1");
+}
+
+// Test sprawdza łącza radiowe z pozycji: tworzenie i zrywanie przez zasięg, łącza przewodowe bez zmian
+TEST(WirelessTest, RangeLinksFormAndTearDown) {
+    Network net;
+    for (const char* name : {"S1", "S2", "S3", "S4", "W"})
+        net.addNode<DummyNode>(name, "");
+    net.setPosition("S1", 0, 0);
+    net.setPosition("S2", 30, 0);
+    net.setPosition("S3", 30, 40);   // 50 m od S1, 40 m od S2
+    net.setPosition("S4", 500, 500);
+    net.setPosition("W", 5, 0);
+    for (const char* name : {"S1", "S2", "S3", "S4"})
+        net.setWirelessRange(name, 45);
+    net.setWirelessRange("W", 100);
+    net.connect(net.findByName("W"), net.findByName("S1")); // przewodowe
+    auto linked = [&](const std::string& a, const std::string& b) {
+        auto neighbors = net.getNeighbors(a);
+        return std::find(neighbors.begin(), neighbors.end(), b) != neighbors.end();
+    };
+
+    // Zasięg pary to mniejszy z zasięgów: W-S1, W-S2, S1-S2, S2-S3 (W-S3: 47.2 m > 45)
+    WirelessUpdate update = net.updateWirelessLinks();
+    EXPECT_EQ(update.inRange, 4u);
+    EXPECT_EQ(update.added, 3u); // W-S1 już jest
+    EXPECT_EQ(update.links, 3u);
+    EXPECT_TRUE(net.isWirelessConnected("S1", "S2"));
+    EXPECT_TRUE(net.isWirelessConnected("S2", "S3"));
+    EXPECT_FALSE(net.isWirelessConnected("S1", "S3"));
+    EXPECT_TRUE(net.getNeighbors("S4").empty());
+    EXPECT_EQ(net.getNodesWithin(0, 0, 30), (std::vector<std::string>{"S1", "S2", "W"}));
+
+    // Bez zmian pozycji nic się nie zmienia
+    update = net.updateWirelessLinks();
+    EXPECT_EQ(update.added + update.removed, 0u);
+
+    // S3 odjeżdża do S4: S2-S3 zerwane, S3-S4 utworzone
+    net.setPosition("S3", 480, 480);
+    update = net.updateWirelessLinks();
+    EXPECT_EQ(update.added, 1u);
+    EXPECT_EQ(update.removed, 1u);
+    EXPECT_FALSE(linked("S2", "S3"));
+    EXPECT_TRUE(linked("S3", "S4"));
+
+    // Łącze przewodowe zostaje, gdy W wychodzi z zasięgu
+    net.setPosition("W", 1000, 0);
+    EXPECT_EQ(net.updateWirelessLinks().removed, 1u);
+    EXPECT_TRUE(linked("W", "S1"));
+    EXPECT_FALSE(linked("W", "S2"));
+
+    // Ręczne łącze radiowe też sprawdza odległość
+    EXPECT_THROW(net.connectWirelessRange("S1", "S4", 100), std::runtime_error);
+    EXPECT_THROW(net.getPosition("Missing"), std::runtime_error);
+
+    // Pozycje przechodzą przez eksport/import
+    Network copy;
+    copy.importFromJson(net.exportToJson());
+    EXPECT_TRUE(copy.hasPosition("S3"));
+    EXPECT_DOUBLE_EQ(copy.getPosition("S3").x, 480);
+    EXPECT_DOUBLE_EQ(copy.getPosition("S3").y, 480);
+}
+
+// Test sprawdza modele ruchu: ślad z celami, skoki z pliku, losowe punkty trasy i przyrostowe łącza radiowe
+TEST(MobilityTest, TraceWaypointAndIncrementalLinks) {
+    using namespace netsim::sim;
+    Network net;
+    net.addNode<DummyNode>("A", "10.0.0.1");
+    net.addNode<DummyNode>("B", "10.0.0.2");
+    net.setPosition("A", 0, 0);
+    net.setPosition("B", 200, 0);
+    net.setWirelessRange("A", 50);
+    net.setWirelessRange("B", 50);
+    EXPECT_EQ(net.updateWirelessLinks().links, 0u);
+
+    MobilitySimulator mobility(net);
+    std::vector<std::pair<SimTime, TopologyChange>> changes;
+    mobility.setCallback([&](SimTime at, const std::vector<TopologyChange>& tick) {
+        for (const auto& change : tick) changes.emplace_back(at, change);
+    });
+    // B jedzie 20 m/s z x=200 do x=40: w zasięgu A od x=50, czyli po 7.5 s jazdy
+    mobility.addWaypoint("B", 1 * Second, Position{40, 0}, 20.0);
+    net.advanceTime(8000);
+    EXPECT_TRUE(changes.empty());
+    EXPECT_EQ(mobility.movingCount(), 1u);
+    net.advanceTime(2000);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].second.kind, TopologyChange::Kind::LinkUp);
+    EXPECT_GE(changes[0].first, 8500 * Millisecond);
+    EXPECT_LE(changes[0].first, 8600 * Millisecond);
+    EXPECT_TRUE(net.isWirelessConnected("A", "B"));
+    EXPECT_DOUBLE_EQ(net.getPosition("B").x, 40);
+    // Na miejscu: nic się nie rusza i nie ma kroków w kolejce
+    EXPECT_EQ(mobility.movingCount(), 0u);
+    EXPECT_EQ(net.getScheduler().pending(), 0u);
+
+    // Ślad z pliku (po nazwie i adresie IP): skok B daleko, błędna linia, nieznany węzeł
+    std::string path = testing::TempDir() + "mobility_trace.csv";
+    {
+        std::ofstream csv(path);
+        csv << "time_s,node,x,y,speed\n0.5,10.0.0.2,500,500\n0.7,B,oops\n1,X,0,0\n2,B,30,0,0\n";
+    }
+    mobility.loadTrace(path);
+    net.advanceTime(1000);
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[1].second.kind, TopologyChange::Kind::LinkDown);
+    net.advanceTime(2000);
+    EXPECT_EQ(changes.size(), 3u);
+    EXPECT_TRUE(net.isWirelessConnected("A", "B"));
+    EXPECT_EQ(mobility.stats().waypoints, 3u);
+    EXPECT_EQ(mobility.stats().skipped, 2u);
+    std::remove(path.c_str());
+    EXPECT_THROW(mobility.addNode("B", MobilityModel::RandomWaypoint), std::runtime_error);
+    EXPECT_THROW(MobilitySimulator::parseModel("teleport"), std::runtime_error);
+
+    // Losowe punkty trasy i Gauss-Markov: łącza przyrostowe zgodne z pełnym przeliczeniem
+    MobilityOptions options;
+    options.maxX = options.maxY = 200;
+    options.maxPause = 500 * Millisecond;
+    options.interferencePerNeighbor = 0.1;
+    Network field;
+    MobilitySimulator crowd(field, options);
+    for (int i = 0; i < 40; i++) {
+        std::string name = "M" + std::to_string(i);
+        field.addNode<DummyNode>(name, "");
+        field.setWirelessRange(name, 30);
+        crowd.addNode(name, i % 2 ? MobilityModel::GaussMarkov : MobilityModel::RandomWaypoint);
+    }
+    field.advanceTime(20000);
+    EXPECT_GT(crowd.stats().linksUp, 0u);
+    EXPECT_GT(crowd.stats().linksDown, 0u);
+    EXPECT_GT(crowd.stats().interferenceUpdates, 0u);
+    WirelessUpdate full = field.updateWirelessLinks();
+    EXPECT_EQ(full.added + full.removed, 0u);
+    EXPECT_EQ(full.links, full.inRange);
+    for (int i = 0; i < 40; i++) {
+        Position p = field.getPosition("M" + std::to_string(i));
+        EXPECT_TRUE(p.x >= 0 && p.x <= 200 && p.y >= 0 && p.y <= 200);
+    }
+}
+
+// Test sprawdza, że zmiana adresu przez sam węzeł (setIp) aktualizuje indeks IPAM sieci
+TEST(IpamTest, NodeSetIpKeepsIndexCurrent) {
+    Network net;
+    auto host = net.addNode<Host>("H1", "10.9.0.1", 80);
+    net.addNode<Host>("H2", "10.9.0.2", 80);
+    host->setIp("10.9.0.7");
+    IpAddress moved, old;
+    ASSERT_TRUE(IpAddress::parse("10.9.0.7", moved));
+    ASSERT_TRUE(IpAddress::parse("10.9.0.1", old));
+    EXPECT_EQ(net.findByIp(moved), host);
+    EXPECT_EQ(net.findByIp(old), nullptr);
+    host->setAddress("10.9.0.8");
+    EXPECT_EQ(net.findNode("10.9.0.8"), host);
+    net.setUniqueAddresses(true);
+    EXPECT_THROW(host->setIp("10.9.0.2"), std::runtime_error);
+    EXPECT_EQ(host->getIp(), "10.9.0.8");
+
+    // Gałąź ma własny indeks
+    auto branch = net.fork();
+    branch->findByName("H1")->setIp("10.9.0.20");
+    EXPECT_EQ(net.findNode("10.9.0.8"), host);
+    EXPECT_EQ(branch->findNode("10.9.0.20")->getName(), "H1");
+
+    // Po usunięciu węzła indeks nie wskazuje na pusty wpis, a węzeł zmienia adres bez sieci
+    net.removeNode("H1");
+    IpPrefix subnet;
+    ASSERT_TRUE(IpPrefix::parse("10.9.0.0/24", subnet));
+    auto inSubnet = net.findInPrefix(subnet);
+    ASSERT_EQ(inSubnet.size(), 1u);
+    EXPECT_EQ(inSubnet[0]->getName(), "H2");
+    EXPECT_TRUE(net.getAddressConflicts().empty());
+    host->setIp("10.9.0.2");
+    EXPECT_EQ(net.findNode("10.9.0.2")->getName(), "H2");
+}
+
+// Test sprawdza, że przy recyklingu id pakietów straty na łączu są niezależne dla każdego pakietu
+TEST(PacketSimulatorTest, LossRateWithRecycledPacketIds) {
+    using namespace netsim::sim;
+    Network net;
+    net.addNode<DummyNode>("A", "10.0.0.1");
+    net.addNode<DummyNode>("B", "10.0.0.2");
+    net.connect("A", "B");
+    net.setLinkDelay("A", "B", 1);
+    net.setPacketLoss("A", "B", 0.1);
+
+    for (bool recycle : {false, true}) {
+        PacketSimOptions options;
+        options.recyclePacketIds = recycle;
+        PacketSimulator sim(net, options);
+        TrafficGenerator traffic(net, sim);
+        TrafficOptions cbr;
+        cbr.rateMbps = 100.0;
+        cbr.stop = 2 * Second;
+        GeneratorId flow = traffic.add(TrafficPattern::ConstantBitRate, "A", "B", cbr);
+        sim.run();
+        const auto& stats = traffic.stats(flow);
+        double lossRate = static_cast<double>(stats.dropped) / stats.packets;
+        EXPECT_NEAR(lossRate, 0.1, 0.01) << (recycle ? "recycled ids" : "fresh ids");
+        // Przy recyklingu w obiegu jest tylko kilka id
+        if (recycle) {
+            EXPECT_LT(sim.records().size(), 100u);
+        }
+    }
+}
+
+// Test sprawdza, że nazwy plików z żądań nie wychodzą poza skonfigurowany katalog
+TEST(SandboxPathTest, RejectsEscapesAndNormalizes) {
+    using netsim::utils::sandboxedPath;
+    EXPECT_EQ(sandboxedPath("captures", "run1.pcapng"), "captures/run1.pcapng");
+    EXPECT_EQ(sandboxedPath("captures/", "./day1//run1.pcapng"), "captures/day1/run1.pcapng");
+    EXPECT_EQ(sandboxedPath("traces", "a..b.csv"), "traces/a..b.csv");
+    EXPECT_THROW(sandboxedPath("captures", ""), std::runtime_error);
+    EXPECT_THROW(sandboxedPath("captures", "/etc/passwd"), std::runtime_error);
+    EXPECT_THROW(sandboxedPath("captures", "../secret"), std::runtime_error);
+    EXPECT_THROW(sandboxedPath("captures", "day1/../../secret"), std::runtime_error);
+    EXPECT_THROW(sandboxedPath("captures", "day1/.."), std::runtime_error);
+    EXPECT_THROW(sandboxedPath("captures", "..\\secret"), std::runtime_error);
+    EXPECT_THROW(sandboxedPath("captures", "./"), std::runtime_error);
+}
+
+// Test sprawdza, że tabela wartości pola nie rośnie bez końca - nadmiarowe napisy dostają kod "other"
+TEST(PacketFieldsTest, TagTableIsBounded) {
+    packet_fields::TagTable table({"tcp", "udp", "icmp"});
+    uint8_t custom = table.intern("quic");
+    EXPECT_EQ(table.name(custom), "quic");
+    EXPECT_EQ(table.intern("quic"), custom);
+    EXPECT_EQ(table.kind(table.intern("UDP")), static_cast<uint8_t>(Protocol::Udp));
+
+    uint8_t other = table.intern(std::string(packet_fields::TagTable::MaxNameLength + 1, 'x'));
+    EXPECT_EQ(table.name(other), "other");
+    EXPECT_EQ(table.kind(other), static_cast<uint8_t>(Protocol::Other));
+    for (int i = 0; i < 1000; ++i) {
+        uint8_t code = table.intern("proto-" + std::to_string(i));
+        EXPECT_LT(code, packet_fields::TagTable::MaxCodes);
+    }
+    EXPECT_EQ(table.intern("proto-999"), other);
+    EXPECT_EQ(table.intern("quic"), custom);
+
+    // kindOf nie internuje
+    EXPECT_EQ(PacketTag<Protocol>::kindOf("TCP"), Protocol::Tcp);
+    EXPECT_EQ(PacketTag<Protocol>::kindOf("never-interned"), Protocol::Other);
+}
+
+// Test sprawdza zwalnianie typów zdarzeń: oczekujące zdarzenia przepadają, typ wraca do użytku
+TEST(EventSchedulerTest, UnregisterDropsEventsAndReusesType) {
+    using namespace netsim::sim;
+    EventScheduler scheduler;
+    std::vector<uint64_t> fired;
+    EventType keep = scheduler.registerHandler([&](const Event& ev) { fired.push_back(ev.arg0); });
+    EventType gone = scheduler.registerHandler([&](const Event&) { ADD_FAILURE() << "unregistered handler fired"; });
+    scheduler.schedule(10, keep, 1);
+    scheduler.schedule(20, gone, 2);
+    scheduler.schedule(1ull << 40, gone, 3);
+    scheduler.schedule(30, keep, 4);
+    scheduler.unregisterHandler(gone);
+    EXPECT_EQ(scheduler.pending(), 2u);
+    EXPECT_THROW(scheduler.schedule(40, gone), std::runtime_error);
+    EXPECT_THROW(scheduler.unregisterHandler(gone), std::runtime_error);
+
+    EventType reused = scheduler.registerHandler([&](const Event& ev) { fired.push_back(100 + ev.arg0); });
+    EXPECT_EQ(reused, gone);
+    scheduler.schedule(25, reused, 5);
+    scheduler.run();
+    EXPECT_EQ(fired, (std::vector<uint64_t>{1, 105, 4}));
+
+    // Symulator ruchu tworzony na żądanie nie wyczerpuje typów zdarzeń sieci
+    Network net;
+    net.addNode<DummyNode>("A", "10.0.0.1");
+    for (int i = 0; i < 20000; ++i) {
+        MobilitySimulator mobility(net);
+        mobility.addNode("A", MobilityModel::RandomWaypoint);
+        net.advanceTime(150);
+    }
+    EXPECT_EQ(net.getScheduler().pending(), 0u);
+}
+
+// Test sprawdza ponowne dodanie prefiksu grupy (jak /router/routes): ta sama grupa, przepływy pozostałych członków na miejscu
+TEST(FibTest, ReAddingGroupRouteKeepsSurvivingFlows) {
+    Network net;
+    auto r0 = net.addNode<Router>("R0", "10.9.0.1");
+    std::vector<Node*> hops;
+    for (const char* name : {"A", "B", "C", "D"}) hops.push_back(net.addNode<Router>(name, "").get());
+    Router* router = dynamic_cast<Router*>(r0.get());
+    Fib& fib = router->getFib();
+    Fib::GroupId group = router->addRouteGroup("10.0.0.0/16", {{hops[0]}, {hops[1]}, {hops[2]}, {hops[3]}});
+    size_t groups = fib.groupCount();
+
+    const int FLOWS = 5000;
+    auto hopOf = [&](int flow) { return router->getNextHop("10.0.1.1", flowHash(FlowKey{uint64_t(flow), 42, 1000, 80, 6})); };
+    std::vector<Node*> before(FLOWS);
+    for (int f = 0; f < FLOWS; f++) before[f] = hopOf(f);
+    Packet p("X", "10.0.2.2", "data", "udp", "abcd");
+    Node* packetHop = router->nextHopFor(p);    // liczniki członka idą za next hopem
+
+    EXPECT_EQ(router->addRouteGroup("10.0.0.0/16", {{hops[0]}, {hops[1]}, {hops[3]}}), group);
+    EXPECT_EQ(fib.groupCount(), groups);
+    int disturbed = 0;
+    for (int f = 0; f < FLOWS; f++) {
+        Node* now = hopOf(f);
+        EXPECT_NE(now, hops[2]);
+        disturbed += before[f] != hops[2] && now != before[f];
+    }
+    EXPECT_EQ(disturbed, 0);
+    uint64_t packets = 0;
+    for (const auto& member : fib.groupStats(group)) packets += member.packets;
+    EXPECT_EQ(packets, packetHop == hops[2] ? 0u : 1u);
+
+    // Prefiks ze zwykłą trasą dostaje nową grupę
+    router->addRoute("10.5.0.0/16", hops[0]);
+    EXPECT_NE(router->addRouteGroup("10.5.0.0/16", {{hops[1]}, {hops[2]}}), group);
+    EXPECT_EQ(fib.groupCount(), groups + 1);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
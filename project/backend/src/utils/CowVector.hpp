@@ -0,0 +1,100 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace netsim {
+namespace utils {
+
+/**
+ * @brief Growable array of fixed-size chunks shared copy-on-write between forks
+ *
+ * fork() copies only the chunk pointers, so branching a table of millions
+ * of entries takes microseconds; afterwards each side copies a chunk the
+ * first time it writes to it (mut, push_back into a shared tail chunk).
+ * Reads are a two-level index without any check. Ownership is tracked with
+ * a flag per chunk on each side, which is why fork() is non-const: it also
+ * marks the source's chunks as shared. Chunks are only read by other sides,
+ * so forks may run on different threads.
+ */
+template<typename T, unsigned ChunkBits = 10>
+class CowVector {
+public:
+    static constexpr size_t ChunkSize = size_t(1) << ChunkBits;
+
+    CowVector() = default;
+    CowVector(CowVector&&) noexcept = default;
+    CowVector& operator=(CowVector&&) noexcept = default;
+    CowVector(const CowVector&) = delete;
+    CowVector& operator=(const CowVector&) = delete;
+
+    CowVector fork() {
+        CowVector copy;
+        copy.m_chunks = m_chunks;
+        copy.m_data = m_data;
+        copy.m_size = m_size;
+        copy.m_owned.assign(m_owned.size(), 0);
+        copy.m_shared = m_chunks.size();
+        std::fill(m_owned.begin(), m_owned.end(), 0);
+        m_shared = m_chunks.size();
+        return copy;
+    }
+
+    const T& operator[](size_t i) const { return m_data[i >> ChunkBits][i & (ChunkSize - 1)]; }
+
+    T& mut(size_t i) {
+        const size_t c = i >> ChunkBits;
+        if (m_shared != 0 && !m_owned[c]) detach(c);
+        return m_data[c][i & (ChunkSize - 1)];
+    }
+
+    T& emplace_back() {
+        if ((m_size & (ChunkSize - 1)) == 0 && (m_size >> ChunkBits) == m_chunks.size()) {
+            m_chunks.push_back(std::make_shared<Chunk>());
+            m_data.push_back(m_chunks.back()->items);
+            m_owned.push_back(1);
+        }
+        return mut(m_size++);
+    }
+
+    void push_back(const T& value) { emplace_back() = value; }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    // Chunki współdzielone z innymi forkami (do testów i statystyk)
+    size_t sharedChunks() const { return m_shared; }
+    size_t chunkCount() const { return m_chunks.size(); }
+
+    void clear() {
+        m_chunks.clear();
+        m_data.clear();
+        m_owned.clear();
+        m_shared = 0;
+        m_size = 0;
+    }
+
+private:
+    struct Chunk {
+        T items[ChunkSize];
+    };
+
+    std::vector<std::shared_ptr<Chunk>> m_chunks;
+    std::vector<T*> m_data;           // surowe wskaźniki chunków dla szybkiego odczytu
+    std::vector<uint8_t> m_owned;     // chunk -> tylko ten obiekt go trzyma
+    size_t m_shared = 0;              // chunki z m_owned == 0; przy 0 zapis nic nie sprawdza
+    size_t m_size = 0;
+
+    void detach(size_t c) {
+        if (m_chunks[c].use_count() != 1) {
+            m_chunks[c] = std::make_shared<Chunk>(*m_chunks[c]);
+            m_data[c] = m_chunks[c]->items;
+        }
+        m_owned[c] = 1;
+        m_shared--;
+    }
+};
+
+} // namespace utils
+} // namespace netsim
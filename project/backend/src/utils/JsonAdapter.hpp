@@ -10,9 +10,9 @@ namespace JsonAdapter {
 
 inline json packetToJson(const Packet &p) {
     json j;
-    j["src"] = p.src;
-    j["dest"] = p.dest;
-    j["type"] = p.type;
+    j["src"] = p.src.str();
+    j["dest"] = p.dest.str();
+    j["type"] = p.type.str();
     j["ttl"] = p.ttl;
     return j;
 }
@@ -0,0 +1,92 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace netsim {
+namespace utils {
+
+inline unsigned defaultWorkerCount() {
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : hw;
+}
+
+/**
+ * @brief Reusable barrier for a fixed group of threads
+ *
+ * Spins briefly and then yields, which suits short simulation windows
+ * better than a condition variable, and still behaves when there are more
+ * threads than cores.
+ */
+class Barrier {
+public:
+    explicit Barrier(unsigned count) : m_count(count), m_waiting(0), m_generation(0) {}
+
+    void wait() {
+        unsigned generation = m_generation.load(std::memory_order_acquire);
+        if (m_waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count) {
+            m_waiting.store(0, std::memory_order_relaxed);
+            m_generation.fetch_add(1, std::memory_order_acq_rel);
+            return;
+        }
+        for (unsigned spins = 0; m_generation.load(std::memory_order_acquire) == generation; ++spins)
+            if (spins > 64) std::this_thread::yield();
+    }
+
+private:
+    const unsigned m_count;
+    std::atomic<unsigned> m_waiting;
+    std::atomic<unsigned> m_generation;
+};
+
+/**
+ * @brief Runs fn(worker, index) for every index in [0, count) on `workers` threads
+ *
+ * Indices are handed out dynamically in chunks, so uneven work items balance
+ * out. `worker` is in [0, workers) and lets callers keep per-thread
+ * accumulators without locking. The first exception thrown by fn is
+ * rethrown on the calling thread after all workers have stopped.
+ */
+template<typename Fn>
+void parallelFor(size_t count, unsigned workers, Fn&& fn, size_t chunk = 1) {
+    if (workers == 0) workers = defaultWorkerCount();
+    workers = static_cast<unsigned>(std::min<size_t>(workers, std::max<size_t>(count, 1)));
+    chunk = std::max<size_t>(chunk, 1);
+
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) fn(0u, i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto run = [&](unsigned worker) {
+        try {
+            while (true) {
+                size_t begin = next.fetch_add(chunk);
+                if (begin >= count) break;
+                size_t end = std::min(count, begin + chunk);
+                for (size_t i = begin; i < end; ++i) fn(worker, i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+            next.store(count);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (unsigned w = 1; w < workers; ++w) threads.emplace_back(run, w);
+    run(0);
+    for (auto& t : threads) t.join();
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace utils
+} // namespace netsim
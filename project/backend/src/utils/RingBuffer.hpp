@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace netsim {
+namespace utils {
+
+/**
+ * @brief Fixed-capacity FIFO over storage allocated once at construction
+ *
+ * push/pop only move two indices, so a full queue rejects instead of
+ * growing and steady-state operation never allocates.
+ */
+template<typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity = 0) : m_items(capacity) {}
+
+    bool push(const T& item) {
+        if (m_size == m_items.size()) return false;
+        size_t tail = m_head + m_size;
+        if (tail >= m_items.size()) tail -= m_items.size();
+        m_items[tail] = item;
+        m_size++;
+        return true;
+    }
+
+    T pop() {
+        if (m_size == 0) throw std::runtime_error("RingBuffer is empty");
+        T item = m_items[m_head];
+        if (++m_head == m_items.size()) m_head = 0;
+        m_size--;
+        return item;
+    }
+
+    const T& front() const { return m_items[m_head]; }
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_items.size(); }
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == m_items.size(); }
+    void clear() { m_head = 0; m_size = 0; }
+
+private:
+    std::vector<T> m_items;
+    size_t m_head = 0;
+    size_t m_size = 0;
+};
+
+} // namespace utils
+} // namespace netsim
@@ -0,0 +1,44 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+
+namespace netsim {
+namespace utils {
+
+/**
+ * @brief Resolve a client-supplied file name inside a fixed directory
+ *
+ * REST requests name capture and trace files; they may only address files
+ * below the directory configured for that purpose. The name must be
+ * relative, without ".." components, backslashes or NUL bytes; empty
+ * components and "." are dropped. Symbolic links inside the directory are
+ * trusted, the directory belongs to the operator.
+ *
+ * @throws std::runtime_error when the name could leave the directory
+ */
+inline std::string sandboxedPath(const std::string& dir, const std::string& name) {
+    if (name.empty()) throw std::runtime_error("File name must not be empty");
+    if (name.front() == '/') throw std::runtime_error("Absolute paths are not allowed: " + name);
+    if (name.find('\\') != std::string::npos || name.find('\0') != std::string::npos)
+        throw std::runtime_error("Invalid file name: " + name);
+
+    std::string relative;
+    size_t begin = 0;
+    while (begin <= name.size()) {
+        size_t end = name.find('/', begin);
+        if (end == std::string::npos) end = name.size();
+        std::string part = name.substr(begin, end - begin);
+        if (part == "..") throw std::runtime_error("Parent directory references are not allowed: " + name);
+        if (!part.empty() && part != ".") {
+            if (!relative.empty()) relative += '/';
+            relative += part;
+        }
+        begin = end + 1;
+    }
+    if (relative.empty()) throw std::runtime_error("Invalid file name: " + name);
+    if (dir.empty()) return relative;
+    return dir.back() == '/' ? dir + relative : dir + '/' + relative;
+}
+
+} // namespace utils
+} // namespace netsim
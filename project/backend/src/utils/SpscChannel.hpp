@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace netsim {
+namespace utils {
+
+/**
+ * @brief Unbounded lock-free single-producer/single-consumer channel
+ *
+ * Items are written into fixed-size blocks chained into a list. The producer
+ * publishes each item with a release store of the block's commit counter and
+ * the consumer reads it with an acquire load, so neither side ever blocks;
+ * a full block simply gets a successor. Exactly one thread may push and one
+ * (possibly different) thread may pop.
+ */
+template<typename T, size_t BlockSize = 1024>
+class SpscChannel {
+public:
+    SpscChannel() : m_head(new Block()), m_tail(m_head) {}
+    ~SpscChannel() {
+        while (m_head) {
+            Block* next = m_head->next.load(std::memory_order_relaxed);
+            delete m_head;
+            m_head = next;
+        }
+    }
+    SpscChannel(const SpscChannel&) = delete;
+    SpscChannel& operator=(const SpscChannel&) = delete;
+
+    void push(const T& item) {
+        if (m_tailIndex == BlockSize) {
+            Block* block = new Block();
+            block->items[0] = item;
+            block->committed.store(1, std::memory_order_relaxed);
+            m_tail->next.store(block, std::memory_order_release);
+            m_tail = block;
+            m_tailIndex = 1;
+            return;
+        }
+        m_tail->items[m_tailIndex++] = item;
+        m_tail->committed.store(m_tailIndex, std::memory_order_release);
+    }
+
+    bool pop(T& out) {
+        while (true) {
+            if (m_headIndex < m_head->committed.load(std::memory_order_acquire)) {
+                out = m_head->items[m_headIndex++];
+                return true;
+            }
+            if (m_headIndex < BlockSize) return false;
+            Block* next = m_head->next.load(std::memory_order_acquire);
+            if (!next) return false;
+            delete m_head;
+            m_head = next;
+            m_headIndex = 0;
+        }
+    }
+
+private:
+    struct Block {
+        std::array<T, BlockSize> items;
+        std::atomic<size_t> committed{0};
+        std::atomic<Block*> next{nullptr};
+    };
+
+    // Strona konsumenta
+    alignas(64) Block* m_head;
+    size_t m_headIndex = 0;
+    // Strona producenta
+    alignas(64) Block* m_tail;
+    size_t m_tailIndex = 0;
+};
+
+} // namespace utils
+} // namespace netsim